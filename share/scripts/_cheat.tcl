@@ -28,7 +28,6 @@ Examples:
 namespace eval cheat_finder {
 
 variable max_num_results 15 ;# maximum to display cheats
-variable mem
 
 # build translation dictionary for convenience expressions
 variable translate [dict create \
@@ -70,44 +69,45 @@ proc tab_cheat_type {args} {
 
 # Restart cheat finder.
 proc start {} {
-	variable mem [dict create]
-
-	set mymem [debug read_block memory 0 0x10000]
-	binary scan $mymem c* values
-	set addr 0
-	foreach val $values {
-		dict append mem $addr $val
-		incr addr
-	}
+	debug memsearch start
 }
 
 # Helper function to do the actual search.
 # Returns a list of triplets (addr, old, new)
 proc search {expression} {
-	variable mem
-
-	set result [list]
-	dict for {addr old} $mem {
-		set new [debug read memory $addr]
-		#note: NO braces around $expression
-		if $expression {
-			dict set mem $addr $new
-			lappend result [list $addr $old $new]
+	if {$expression eq "true"} {
+		debug memsearch update
+	} elseif {[regexp {^\s*\$new\s*(==|!=|<=|>=|<|>)\s*(\$old|0x[0-9a-fA-F]+|[0-9]+)\s*$} $expression -> op arg] &&
+	          ($arg eq {$old} || $arg <= 255)} {
+		# simple comparison, handled natively
+		if {$arg eq {$old}} {
+			debug memsearch search $op
 		} else {
-			dict unset mem $addr
+			debug memsearch search $op $arg
+		}
+	} else {
+		# arbitrary expression, evaluate it for each remaining location
+		debug memsearch update
+		set keep [list]
+		foreach triple [debug memsearch results] {
+			lassign $triple addr old new
+			#note: NO braces around $expression
+			if $expression {
+				lappend keep $addr
+			}
 		}
+		debug memsearch retain $keep
 	}
-	return $result
+	return [debug memsearch results]
 }
 
 # main routine
 proc findcheat {args} {
-	variable mem
 	variable max_num_results
 	variable translate
 
-	# create mem dictionary
-	if {![info exists mem]} start
+	# start a search, if not yet done
+	if {![debug memsearch active]} start
 
 	# parse options
 	while (1) {
@@ -19,7 +19,9 @@ proc savestate {{name ""}} {
 		catch {file delete -- $png}
 	}
 	set currentID [machine]
-	store_machine $currentID $fullname
+	# compressing and writing the file is done in the background, a failure
+	# is reported (as a warning) as soon as the write finished
+	store_machine -async $currentID $fullname
 	return $fullname
 }
 
@@ -41,6 +41,8 @@ screenshot -raw -size 640    640x480 raw screenshot (of MSX screen only)
 screenshot -raw -size 320    320x240 raw screenshot (of MSX screen only)
 screenshot -raw -size auto   raw screenshot (of MSX screen only), with size determined by screen mode
 screenshot -raw              raw screenshot (of MSX screen only), default -size (auto)
+screenshot -raw -scaled      raw screenshot with the current scaler, scanline and blur settings applied
+screenshot -raw -scaled -size 960  960x720 scaled raw screenshot
 screenshot -with-osd         Include OSD elements in the screenshot
 screenshot -no-sprites       Don't include sprites in the screenshot
 screenshot -guess-name       Guess the name of the running software and use it as prefix
@@ -48,7 +50,7 @@ screenshot -guess-name       Guess the name of the running software and use it a
 
 set_tabcompletion_proc screenshot [namespace code screenshot_tab]
 proc screenshot_tab {args} {
-	list "-prefix" "-raw" "-size" "-with-osd" "-no-sprites" "-guess-name"
+	list "-prefix" "-raw" "-scaled" "-size" "-with-osd" "-no-sprites" "-guess-name"
 }
 
 namespace export screenshot
@@ -33,6 +33,7 @@
 #include "RomInfo.hh"
 #include "StateChangeDistributor.hh"
 #include "SymbolManager.hh"
+#include "TclArgParser.hh"
 #include "TclCallbackMessages.hh"
 #include "TclObject.hh"
 #include "UserSettings.hh"
@@ -56,8 +57,11 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
+#include <future>
 #include <memory>
 #include <ranges>
+#include <thread>
 
 namespace openmsx {
 
@@ -142,15 +146,37 @@ private:
 	Reactor& reactor;
 };
 
-class StoreMachineCommand final : public Command
+class StoreMachineCommand final : public Command, private EventListener
 {
 public:
 	StoreMachineCommand(CommandController& commandController, Reactor& reactor);
+	~StoreMachineCommand();
 	void execute(std::span<const TclObject> tokens, TclObject& result) override;
 	[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
 	void tabCompletion(std::vector<std::string>& tokens) const override;
+
+	/** Wait till a pending (asynchronous) write to the given file is done.
+	  * @param filename Name of the file, with '~' already expanded. */
+	void waitFor(std::string_view filename);
+
+private:
+	struct PendingWrite {
+		std::string filename;
+		std::future<void> result;
+		std::thread thread;
+	};
+
+	// EventListener
+	bool signalEvent(const Event& event) override;
+
+	void reapFinishedWrites();
+	void finishWrite(PendingWrite& write);
+
 private:
 	Reactor& reactor;
+	// Asynchronous writes that are still in progress (or of which the
+	// result wasn't reported yet).
+	std::vector<PendingWrite> pendingWrites;
 };
 
 class RestoreMachineCommand final : public Command
@@ -1030,26 +1056,119 @@ StoreMachineCommand::StoreMachineCommand(
 	: Command(commandController_, "store_machine")
 	, reactor(reactor_)
 {
+	reactor.getEventDistributor().registerEventListener(
+		EventType::STORE_MACHINE_DONE, *this);
+}
+
+StoreMachineCommand::~StoreMachineCommand()
+{
+	for (auto& write : pendingWrites) {
+		finishWrite(write);
+	}
+	reactor.getEventDistributor().unregisterEventListener(
+		EventType::STORE_MACHINE_DONE, *this);
 }
 
 void StoreMachineCommand::execute(std::span<const TclObject> tokens, TclObject& result)
 {
-	checkNumArgs(tokens, 3, Prefix{1}, "id filename");
-	const auto& machineID = tokens[1].getString();
-	const auto& filename = tokens[2].getString();
+	reapFinishedWrites();
+
+	bool async = false;
+	std::array info = {flagArg("-async", async)};
+	auto arguments = parseTclArgs(getInterpreter(), tokens.subspan(1), info);
+	if (arguments.size() != 2) {
+		throw SyntaxError();
+	}
+	const auto& machineID = arguments[0].getString();
+	// same normalization as in RestoreMachineCommand, see waitFor()
+	const auto filename = FileOperations::expandTilde(std::string(arguments[1].getString()));
 
 	const auto& board = *reactor.getMachine(machineID);
 
-	XmlOutputArchive out(filename);
-	out.serialize("machine", board);
-	out.close();
-	result = filename;
+	// never have two writes to the same file in flight
+	waitFor(filename);
+
+	if (async) {
+		// Only take the snapshot here, compressing and writing to disk
+		// (the slow part) is done on a separate thread.
+		XmlOutputArchive out;
+		out.serialize("machine", board);
+		std::promise<void> promise;
+		auto future = promise.get_future();
+		std::thread thread(
+			[snapshot = std::move(out).releaseSnapshot(),
+			 name = filename, promise = std::move(promise),
+			 &distributor = reactor.getEventDistributor()]() mutable {
+				try {
+					snapshot.write(name);
+					promise.set_value();
+				} catch (...) {
+					promise.set_exception(std::current_exception());
+				}
+				// report the result as soon as possible (in the main thread)
+				distributor.distributeEvent(StoreMachineDoneEvent());
+			});
+		pendingWrites.push_back({filename, std::move(future), std::move(thread)});
+	} else {
+		XmlOutputArchive out(filename);
+		out.serialize("machine", board);
+		out.close();
+	}
+	result = arguments[1];
+}
+
+void StoreMachineCommand::waitFor(std::string_view filename)
+{
+	auto it = std::ranges::find(pendingWrites, filename, &PendingWrite::filename);
+	if (it == pendingWrites.end()) return;
+	finishWrite(*it);
+	move_pop_back(pendingWrites, it);
+}
+
+bool StoreMachineCommand::signalEvent(const Event& /*event*/)
+{
+	reapFinishedWrites();
+	return false;
+}
+
+void StoreMachineCommand::reapFinishedWrites()
+{
+	std::erase_if(pendingWrites, [&](auto& write) {
+		if (write.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			return false;
+		}
+		finishWrite(write);
+		return true;
+	});
+}
+
+void StoreMachineCommand::finishWrite(PendingWrite& write)
+{
+	// Also called from the destructor, so don't let anything escape.
+	const auto& filename = write.filename;
+	try {
+		write.result.get(); // waits, rethrows exception from the writer thread
+	} catch (MSXException& e) {
+		reactor.getCliComm().printWarning(
+			"Saving state to \"", filename, "\" failed: ", e.getMessage());
+	} catch (std::exception& e) {
+		reactor.getCliComm().printWarning(
+			"Saving state to \"", filename, "\" failed: ", e.what());
+	} catch (...) {
+		reactor.getCliComm().printWarning(
+			"Saving state to \"", filename, "\" failed");
+	}
+	write.thread.join(); // at most still sending the event
 }
 
 std::string StoreMachineCommand::help(std::span<const TclObject> /*tokens*/) const
 {
 	return
-		"store_machine machineID <filename>  Save state of machine \"machineID\" to indicated file\n"
+		"store_machine [-async] machineID <filename>  Save state of machine \"machineID\" to indicated file\n"
+		"\n"
+		"With -async only the snapshot is taken immediately, compressing and\n"
+		"writing the file happens in the background. Errors are then reported\n"
+		"as a warning (as soon as the write finished) instead of as a Tcl error.\n"
 		"\n"
 		"This is a low-level command, the 'savestate' script is easier to use.";
 }
@@ -1076,6 +1195,7 @@ void RestoreMachineCommand::execute(std::span<const TclObject> tokens,
 	auto newBoard = reactor.createEmptyMotherBoard();
 
 	const auto filename = FileOperations::expandTilde(std::string(tokens[1].getString()));
+	reactor.storeMachineCommand->waitFor(filename);
 
 	try {
 		XmlInputArchive in(filename);
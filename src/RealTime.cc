@@ -100,6 +100,7 @@ void RealTime::internalSync(EmuTime time, bool allowSleep)
 				Timer::sleep(sleep); // request to sleep for 'sleep+sleepAdjust'
 				auto slept = narrow<int64_t>(Timer::getTime() - currentRealTime);
 				delta = sleep - slept; // actually slept for 'slept' us
+				sleptTime += narrow<uint64_t>(slept);
 			}
 			const double ALPHA = 0.2;
 			sleepAdjust = sleepAdjust * (1 - ALPHA) + narrow_cast<double>(delta) * ALPHA;
@@ -45,6 +45,11 @@ public:
 	  */
 	[[nodiscard]] bool timeLeft(uint64_t us, EmuTime time) const;
 
+	/** Total real time (in us) spent sleeping to stay in sync, since this
+	  * object was created. Used to measure how busy the host is.
+	  */
+	[[nodiscard]] uint64_t getSleptTime() const { return sleptTime; }
+
 	void resync();
 
 	void enable();
@@ -84,6 +89,7 @@ private:
 	uint64_t idealRealTime;
 	EmuTime emuTime = EmuTime::zero();
 	double sleepAdjust;
+	uint64_t sleptTime = 0;
 	bool enabled = true;
 };
 
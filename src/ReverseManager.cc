@@ -518,6 +518,9 @@ void ReverseManager::transferState(MSXMotherBoard& newBoard)
 	// transfer debugger state (watchpoints, probes, traces)
 	newBoard.getDebugger().transfer(motherBoard.getDebugger());
 
+	// continue an ongoing VGM recording
+	newBoard.getMSXMixer().getVGMRecorder().transfer(motherBoard.getMSXMixer().getVGMRecorder());
+
 	// copy rerecord count
 	newManager.reRecordCount = reRecordCount;
 
@@ -159,6 +159,48 @@ bool Interpreter::hasCommand(zstring_view name) const
 	return Tcl_FindCommand(interp, name.c_str(), nullptr, 0);
 }
 
+std::string Interpreter::getCommandOrigin(zstring_view name)
+{
+	if (!Tcl_FindCommand(interp, name.c_str(), nullptr, TCL_GLOBAL_ONLY)) return {};
+	// this can be called while a Tcl command is executing, so preserve
+	// the result of that command
+	auto state = Tcl_SaveInterpState(interp, TCL_OK);
+	std::string result;
+	auto command = makeTclList("namespace", "origin", name);
+	if (Tcl_EvalObjEx(interp, command.getTclObjectNonConst(), TCL_EVAL_GLOBAL) == TCL_OK) {
+		result = TclObject(Tcl_GetObjResult(interp)).getString();
+	}
+	Tcl_RestoreInterpState(interp, state);
+	return result;
+}
+
+void Interpreter::watchCommand(zstring_view name)
+{
+	static constexpr int flags = TCL_TRACE_RENAME | TCL_TRACE_DELETE;
+	if (!Tcl_FindCommand(interp, name.c_str(), nullptr, TCL_GLOBAL_ONLY)) return;
+	if (Tcl_CommandTraceInfo(interp, name.c_str(), TCL_GLOBAL_ONLY, commandTraceProc, nullptr) == this) {
+		return; // already watched
+	}
+	Tcl_TraceCommand(interp, name.c_str(), flags, commandTraceProc, this);
+}
+
+bool Interpreter::wasCommandModified(std::string_view name) const
+{
+	return contains(modifiedCommands, name);
+}
+
+void Interpreter::commandTraceProc(ClientData clientData, Tcl_Interp* /*interp*/,
+                                   const char* oldName, const char* /*newName*/, int /*flags*/)
+{
+	// Note: redefining a command first deletes the old command. The trace
+	// is removed together with the command.
+	auto* self = static_cast<Interpreter*>(clientData);
+	++self->commandGeneration;
+	if (!contains(self->modifiedCommands, std::string_view(oldName))) {
+		self->modifiedCommands.emplace_back(oldName);
+	}
+}
+
 void Interpreter::registerCommand(zstring_view name, Command& command)
 {
 	auto token = Tcl_CreateObjCommand(
@@ -250,6 +292,15 @@ static Tcl_Obj* getVar(Tcl_Interp* interp, const TclObject& name)
 	                      TCL_GLOBAL_ONLY);
 }
 
+std::optional<int64_t> Interpreter::getIntVariable(const TclObject& name)
+{
+	auto* obj = getVar(interp, name);
+	if (!obj) return {};
+	Tcl_WideInt w;
+	if (Tcl_GetWideIntFromObj(nullptr, obj, &w) != TCL_OK) return {};
+	return int64_t(w);
+}
+
 void Interpreter::setVariable(const TclObject& name, const TclObject& value)
 {
 	if (!Tcl_ObjSetVar2(interp, name.getTclObjectNonConst(), nullptr,
@@ -273,6 +324,11 @@ void Interpreter::unsetVariable(const char* name)
 	Tcl_UnsetVar(interp, name, TCL_GLOBAL_ONLY);
 }
 
+void Interpreter::unsetVariable(const char* arrayName, const char* arrayIndex)
+{
+	Tcl_UnsetVar2(interp, arrayName, arrayIndex, TCL_GLOBAL_ONLY);
+}
+
 static TclObject getSafeValue(const BaseSetting& setting)
 {
 	// TODO use c++23 std::optional<T>::or_else()
@@ -8,9 +8,12 @@
 
 #include "tcl.hh"
 
+#include <cstdint>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace openmsx {
 
@@ -35,6 +38,17 @@ public:
 	void registerCommand(zstring_view name, Command& command);
 	void unregisterCommand(Command& command);
 	[[nodiscard]] TclObject getCommandNames();
+	/** The fully qualified name of the command that 'name' refers to in
+	  * the global namespace, after following imports (e.g. '::disasm::peek'
+	  * for 'peek'). Empty when there's no such command. */
+	[[nodiscard]] std::string getCommandOrigin(zstring_view name);
+	/** Start watching the command 'name' (fully qualified, if not yet
+	  * watched). When that command is deleted, renamed or redefined, the
+	  * command generation is incremented and wasCommandModified() will
+	  * return true for 'name'. */
+	void watchCommand(zstring_view name);
+	[[nodiscard]] unsigned getCommandGeneration() const { return commandGeneration; }
+	[[nodiscard]] bool wasCommandModified(std::string_view name) const;
 	[[nodiscard]] bool isComplete(zstring_view command) const;
 	TclObject execute(zstring_view command);
 	TclObject executeFile(zstring_view filename);
@@ -42,6 +56,11 @@ public:
 	void setVariable(const TclObject& name, const TclObject& value);
 	void setVariable(const TclObject& arrayName, const TclObject& arrayIndex, const TclObject& value);
 	void unsetVariable(const char* name);
+	void unsetVariable(const char* arrayName, const char* arrayIndex);
+	/** Get the value of a global variable as an integer. Returns an
+	  * empty optional when the variable doesn't exist or doesn't hold
+	  * an integer value. */
+	[[nodiscard]] std::optional<int64_t> getIntVariable(const TclObject& name);
 	void registerSetting(BaseSetting& variable);
 	void unregisterSetting(BaseSetting& variable);
 
@@ -71,10 +90,14 @@ private:
 	                       int objc, Tcl_Obj* const* objv);
 	static char* traceProc(ClientData clientData, Tcl_Interp* interp,
 	                       const char* part1, const char* part2, int flags);
+	static void commandTraceProc(ClientData clientData, Tcl_Interp* interp,
+	                             const char* oldName, const char* newName, int flags);
 
 	static Tcl_ChannelType channelType;
 	Tcl_Interp* interp;
 	InterpreterOutput* output;
+	unsigned commandGeneration = 1;
+	std::vector<std::string> modifiedCommands; // watched commands only
 
 	friend class TclObject;
 };
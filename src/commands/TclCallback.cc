@@ -45,8 +45,16 @@ TclObject TclCallback::execute() const
 	const auto& callback = getValue();
 	if (callback.empty()) return {};
 
-	auto command = makeTclList(callback);
-	return executeCommon(command);
+	// Callbacks without arguments are often executed repeatedly (e.g.
+	// every frame), so reuse the command object as long as the setting
+	// doesn't change, and compile it so that its bytecode is reused as
+	// well.
+	if (callback.getTclObjectNonConst() != cachedCallback.getTclObjectNonConst()) {
+		cachedCallback = callback;
+		cachedCommand = makeTclList(callback);
+	}
+	auto command = cachedCommand;
+	return executeCommon(command, true);
 }
 
 TclObject TclCallback::execute(int arg1) const
@@ -85,10 +93,10 @@ TclObject TclCallback::execute(std::string_view arg1, std::string_view arg2) con
 	return executeCommon(command);
 }
 
-TclObject TclCallback::executeCommon(TclObject& command) const
+TclObject TclCallback::executeCommon(TclObject& command, bool compile) const
 {
 	try {
-		return command.executeCommand(callbackSetting.getInterpreter());
+		return command.executeCommand(callbackSetting.getInterpreter(), compile);
 	} catch (CommandException& e) {
 		auto message = strCat(
 			"Error executing callback function \"",
@@ -36,11 +36,13 @@ public:
 	[[nodiscard]] StringSetting& getSetting() const { return callbackSetting; }
 
 private:
-	TclObject executeCommon(TclObject& command) const;
+	TclObject executeCommon(TclObject& command, bool compile = false) const;
 
 	std::optional<StringSetting> callbackSetting2;
 	StringSetting& callbackSetting;
 	const bool isMessageCallback;
+	mutable TclObject cachedCallback; // value of the setting when 'cachedCommand' was created
+	mutable TclObject cachedCommand;
 };
 
 } // namespace openmsx
@@ -2,15 +2,19 @@
 #define BREAKPOINTBASE_HH
 
 #include "CommandException.hh"
+#include "CompiledCondition.hh"
 #include "GlobalCliComm.hh"
 #include "TclObject.hh"
 
 #include "ScopedAssign.hh"
 #include "strCat.hh"
 
+#include <memory>
+
 namespace openmsx {
 
 class Interpreter;
+class MSXMotherBoard;
 
 /** CRTP base class for CPU break and watch points.
  */
@@ -26,7 +30,10 @@ public:
 	[[nodiscard]] bool isEnabled() const { return enabled; }
 	[[nodiscard]] bool onlyOnce() const { return once; }
 
-	void setCondition(const TclObject& c) { condition = c; }
+	void setCondition(const TclObject& c) {
+		condition = c;
+		compiledCondition = CompiledCondition::compile(c.getString());
+	}
 	void setCommand(const TclObject& c) { command = c; }
 	void setEnabled(Interpreter& interp, const TclObject& e) {
 		setEnabled(e.getBoolean(interp)); // may throw
@@ -37,19 +44,25 @@ public:
 	}
 	void setOnce(bool o) { once = o; }
 
-	bool checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp) {
+	bool checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp,
+	                     MSXMotherBoard& motherBoard) {
+		return checkAndExecute(cliComm, interp, motherBoard,
+		                       [&]{ executeCommand(cliComm, interp); });
+	}
+
+	/** Like above, but when the condition is true, call 'action' instead
+	  * of executing the Tcl command. */
+	template<typename Action>
+	bool checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp,
+	                     MSXMotherBoard& motherBoard, Action action) {
 		if (!enabled) return false;
 		if (executing) {
 			// no recursive execution
 			return false;
 		}
 		ScopedAssign sa(executing, true);
-		if (isTrue(cliComm, interp)) {
-			try {
-				command.executeCommand(interp, true); // compile command
-			} catch (CommandException& e) {
-				cliComm.printWarning(e.getMessage());
-			}
+		if (isTrue(cliComm, interp, motherBoard)) {
+			action();
 			return onlyOnce();
 		}
 		return false;
@@ -57,17 +70,34 @@ public:
 
 protected:
 	BreakPointBase() : id(++lastId) {}
+
+	void executeCommand(GlobalCliComm& cliComm, Interpreter& interp) {
+		try {
+			command.executeCommand(interp, true); // compile command
+		} catch (CommandException& e) {
+			cliComm.printWarning(e.getMessage());
+		}
+	}
+
 	unsigned id;
 
 private:
 	// Note: we require GlobalCliComm here because breakpoint objects can
 	// be transferred to different MSX machines, and so the MSXCliComm
 	// object won't remain valid.
-	[[nodiscard]] bool isTrue(GlobalCliComm& cliComm, Interpreter& interp) const {
+	[[nodiscard]] bool isTrue(GlobalCliComm& cliComm, Interpreter& interp,
+	                          MSXMotherBoard& motherBoard) const {
 		if (condition.getString().empty()) {
 			// unconditional bp
 			return true;
 		}
+		if (compiledCondition) {
+			// fast path, if this fails, let Tcl handle it (e.g. to
+			// produce an error message)
+			if (auto result = compiledCondition->evaluate(motherBoard, interp)) {
+				return *result;
+			}
+		}
 		try {
 			return condition.evalBool(interp);
 		} catch (CommandException& e) {
@@ -79,6 +109,9 @@ private:
 private:
 	TclObject command{"debug break"};
 	TclObject condition;
+	// Natively compiled version of 'condition', nullptr if the condition
+	// can only be evaluated by Tcl. Shared between copies of this object.
+	std::shared_ptr<const CompiledCondition> compiledCondition;
 	bool enabled = true;
 	bool once = false;
 	bool executing = false;
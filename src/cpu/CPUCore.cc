@@ -161,7 +161,9 @@
 #include "CPUCore.hh"
 
 #include "Dasm.hh"
+#include "InstructionHistory.hh"
 #include "MSXCPUInterface.hh"
+#include "Profiler.hh"
 #include "R800.hh"
 #include "Z80.hh"
 
@@ -759,6 +761,7 @@ template<typename T> inline void CPUCore<T>::nmi()
 	setIFF1(false);
 	PUSH<T::EE_NMI_1>(getPC());
 	setPC(0x0066);
+	if (profiler) [[unlikely]] profiler->enterFunction(getPC(), getSP(), T::getTimeFast());
 	T::add(T::CC_NMI);
 }
 
@@ -774,6 +777,7 @@ template<typename T> inline void CPUCore<T>::irq0()
 	setIFF2(false);
 	PUSH<T::EE_IRQ0_1>(getPC());
 	setPC(0x0038);
+	if (profiler) [[unlikely]] profiler->enterFunction(getPC(), getSP(), T::getTimeFast());
 	T::setMemPtr(getPC());
 	T::add(T::CC_IRQ0);
 }
@@ -787,6 +791,7 @@ template<typename T> inline void CPUCore<T>::irq1()
 	setIFF2(false);
 	PUSH<T::EE_IRQ1_1>(getPC());
 	setPC(0x0038);
+	if (profiler) [[unlikely]] profiler->enterFunction(getPC(), getSP(), T::getTimeFast());
 	T::setMemPtr(getPC());
 	T::add(T::CC_IRQ1);
 }
@@ -801,6 +806,7 @@ template<typename T> inline void CPUCore<T>::irq2()
 	PUSH<T::EE_IRQ2_1>(getPC());
 	unsigned x = interface->readIRQVector() | (getI() << 8);
 	setPC(RD_WORD(x, T::CC_IRQ2_2));
+	if (profiler) [[unlikely]] profiler->enterFunction(getPC(), getSP(), T::getTimeFast());
 	T::setMemPtr(getPC());
 	T::add(T::CC_IRQ2);
 }
@@ -854,10 +860,10 @@ void CPUCore<T>::executeInstructions()
 	T::add(ii.cycles); \
 	T::R800Refresh(*this); \
 	if (!T::limitReached()) [[likely]] { \
-		incR(1); \
 		unsigned address = getPC(); \
 		const uint8_t* line = readCacheLine[address >> CacheLine::BITS]; \
 		if (uintptr_t(line) > 1) [[likely]] { \
+			incR(1); \
 			T::template PRE_MEM<false, false>(address); \
 			T::template POST_MEM<      false>(address); \
 			uint8_t op = line[address]; \
@@ -893,7 +899,10 @@ void CPUCore<T>::executeInstructions()
 	T::add(ii.cycles); \
 	T::R800Refresh(*this); \
 	if (!T::limitReached()) [[likely]] { \
-		goto start; \
+		if ((uintptr_t(readCacheLine[getPC() >> CacheLine::BITS]) > 1) || \
+		    !interface->hasBreakPointAt(getPC())) [[likely]] { \
+			goto start; \
+		} \
 	} \
 	return;
 
@@ -926,6 +935,10 @@ start:
 
 fetchSlow: {
 	unsigned address = getPC();
+	// Cache lines that contain a breakpoint are never cached. Return so
+	// that execute2() can check the breakpoint before this instruction.
+	if (interface->hasBreakPointAt(address)) return;
+	incR(1);
 	uint8_t opcodeSlow = RDMEMslow<false, false>(address, T::CC_MAIN);
 	goto *(opcodeTable[opcodeSlow]);
 }
@@ -2470,6 +2483,7 @@ template<typename T> void CPUCore<T>::executeSlow(ExecIRQ execIRQ)
 		setSlowInstructions();
 	} else {
 		assert(T::limitReached()); // we want only one instruction
+		if (history) [[unlikely]] history->record(*this, T::getTimeFast());
 		executeInstructions();
 		endInstruction();
 
@@ -2511,11 +2525,16 @@ template<typename T> void CPUCore<T>::execute2(bool fastForward)
 	//       once in this method is enough.
 	scheduler.schedule(T::getTime());
 	setSlowInstructions();
+	// Breakpoints are shared by all machines, they may have changed while
+	// another machine was running.
+	interface->updateBreakPointCache();
 
 	// Note: we call scheduler _after_ executing the instruction and before
 	// deciding between executeFast() and executeSlow() (because a
 	// SyncPoint could set an IRQ and then we must choose executeSlow())
-	if (fastForward || !interface->anyBreakPoints()) {
+	// The instruction history (if any) is only recorded in the slow path
+	// (one instruction at a time), but not during fast-forward.
+	if (fastForward || (!interface->anyBreakPoints() && !history)) {
 		// fast path, no breakpoints, no tracing
 		do {
 			if (slowInstructions) {
@@ -2537,10 +2556,41 @@ template<typename T> void CPUCore<T>::execute2(bool fastForward)
 				}
 			}
 		} while (!needExitCPULoop());
+	} else if (!interface->anyConditions() && !history) {
+		// Only breakpoints (no conditions): mostly the same as the fast
+		// path above. Instruction fetches from a cache line that
+		// contains a breakpoint are not cached, on such an address
+		// executeInstructions() returns early, so that we can check the
+		// breakpoint here. Like in the slow path below, the check is
+		// done after executing (so never for the instruction we might
+		// be resuming from a break) and not when we're about to jump
+		// to an IRQ handler.
+		do {
+			bool executed = true;
+			if (slowInstructions) {
+				--slowInstructions;
+				executeSlow(getExecIRQ());
+			} else {
+				T::enableLimit(); // does CPUClock::sync()
+				if (!T::limitReached()) [[likely]] {
+					executeInstructions();
+					endInstruction();
+				} else {
+					executed = false;
+				}
+			}
+			scheduler.schedule(T::getTimeFast());
+			if (executed && (getExecIRQ() == ExecIRQ::NONE) &&
+			    interface->checkBreakPoints(getPC())) {
+				assert(interface->isBreaked());
+				break;
+			}
+		} while (!needExitCPULoop());
 	} else {
 		do {
 			if (slowInstructions == 0) {
 				assert(T::limitReached()); // only one instruction
+				if (history) [[unlikely]] history->record(*this, T::getTimeFast());
 				executeInstructions();
 				endInstruction();
 			} else {
@@ -3821,6 +3871,7 @@ template<typename T> template<typename COND> II CPUCore<T>::call(COND cond) {
 	if (cond(getF())) {
 		PUSH<T::EE_CALL>(getPC() + 3); /**/
 		setPC(addr);
+		if (profiler) [[unlikely]] profiler->enterFunction(addr, getSP(), T::getTimeFast());
 		if constexpr (T::IS_R800) {
 			setCurrentCall();
 			setSlowInstructions();
@@ -3837,6 +3888,7 @@ template<typename T> template<unsigned ADDR> II CPUCore<T>::rst() {
 	PUSH<0>(getPC() + 1); /**/
 	T::setMemPtr(ADDR);
 	setPC(ADDR);
+	if (profiler) [[unlikely]] profiler->enterFunction(ADDR, getSP(), T::getTimeFast());
 	if constexpr (T::IS_R800) {
 		setCurrentCall();
 		setSlowInstructions();
@@ -3848,6 +3900,7 @@ template<typename T> template<unsigned ADDR> II CPUCore<T>::rst() {
 // RET
 template<typename T> template<int EE, typename COND> inline II CPUCore<T>::RET(COND cond) {
 	if (cond(getF())) {
+		if (profiler) [[unlikely]] profiler->leaveFunction(getSP(), T::getTimeFast());
 		auto addr = POP<EE>();
 		T::setMemPtr(addr);
 		setPC(addr);
@@ -19,6 +19,8 @@
 namespace openmsx {
 
 class MSXCPUInterface;
+class InstructionHistory;
+class Profiler;
 class Scheduler;
 class MSXMotherBoard;
 class TclCallback;
@@ -59,6 +61,8 @@ public:
 	        TclCallback& diHaltCallback, EmuTime time);
 
 	void setInterface(MSXCPUInterface* interface_) { interface = interface_; }
+	void setProfiler(Profiler* profiler_) { profiler = profiler_; }
+	void setInstructionHistory(InstructionHistory* history_) { history = history_; }
 
 	/**
 	 * Reset the CPU.
@@ -141,6 +145,8 @@ private:
 	MSXMotherBoard& motherboard;
 	Scheduler& scheduler;
 	MSXCPUInterface* interface = nullptr;
+	Profiler* profiler = nullptr; // normally nullptr
+	InstructionHistory* history = nullptr; // normally nullptr
 
 	TclCallback& diHaltCallback;
 
@@ -68,6 +68,23 @@ MSXCPU::~MSXCPU()
 	motherboard.getDebugger() .setCPU(nullptr);
 }
 
+unsigned MSXCPU::getFreq() const
+{
+	return z80Active ? z80->getFreq() : r800->getFreq();
+}
+
+void MSXCPU::setProfiler(Profiler* profiler)
+{
+	          z80 ->setProfiler(profiler);
+	if (r800) r800->setProfiler(profiler);
+}
+
+void MSXCPU::setInstructionHistory(InstructionHistory* history)
+{
+	          z80 ->setInstructionHistory(history);
+	if (r800) r800->setInstructionHistory(history);
+}
+
 void MSXCPU::setInterface(MSXCPUInterface* interface_)
 {
 	interface = interface_;
@@ -20,6 +20,8 @@ namespace openmsx {
 
 class MSXMotherBoard;
 class MSXCPUInterface;
+class InstructionHistory;
+class Profiler;
 class CPUClock;
 class CPURegs;
 class Z80TYPE;
@@ -135,6 +137,15 @@ public:
 	/** Switch the Z80 clock freq. */
 	void setZ80Freq(unsigned freq);
 
+	/** Clock frequency of the currently active CPU. */
+	[[nodiscard]] unsigned getFreq() const;
+
+	/** Report calls and returns to the given profiler (nullptr to stop). */
+	void setProfiler(Profiler* profiler);
+	/** Report each executed instruction to the given recorder (nullptr
+	  * to stop). */
+	void setInstructionHistory(InstructionHistory* history);
+
 	void setInterface(MSXCPUInterface* interface);
 
 	/** (un)pause CPU. During pause the CPU executes NOP instructions
@@ -49,6 +49,7 @@ static unsigned breakedSettingCount = 0;
 static constexpr uint8_t SECONDARY_SLOT_BIT = 0x01;
 static constexpr uint8_t MEMORY_WATCH_BIT   = 0x02;
 static constexpr uint8_t GLOBAL_RW_BIT      = 0x04;
+static constexpr uint8_t BREAKPOINT_BIT     = 0x08;
 
 std::ostream& operator<<(std::ostream& os, EnumTypeName<CacheLineCounters>)
 {
@@ -203,7 +204,7 @@ uint8_t MSXCPUInterface::readMemSlow(uint16_t address, EmuTime time)
 		// execute read watches before actual read
 		if (readWatchSet[address >> CacheLine::BITS]
 		                [address &  CacheLine::LOW]) {
-			executeMemWatch(WatchPoint::Type::READ_MEM, address);
+			executeMemWatch(WatchPoint::Type::READ_MEM, address, time);
 		}
 	}
 	if ((address == 0xFFFF) && isExpanded(primarySlotState[3])) [[unlikely]] {
@@ -243,7 +244,7 @@ void MSXCPUInterface::writeMemSlow(uint16_t address, uint8_t value, EmuTime time
 		motherBoard.getScheduler().schedule(time + EmuDuration::epsilon());
 		if (writeWatchSet[address >> CacheLine::BITS]
 		                 [address &  CacheLine::LOW]) {
-			executeMemWatch(WatchPoint::Type::WRITE_MEM, address, value);
+			executeMemWatch(WatchPoint::Type::WRITE_MEM, address, time, value);
 		}
 	}
 }
@@ -773,34 +774,26 @@ uint8_t MSXCPUInterface::peekMem(uint16_t address, EmuTime time) const
 	}
 }
 
-// Similar to peekSlottedMem(), but can read a whole block at once
-void MSXCPUInterface::peekSlottedMemBlock(unsigned address, std::span<uint8_t> output, EmuTime time) const
+// Helper for peekMemBlock() and peekSlottedMemBlock(): split the block in
+// (parts of) cache lines. Copy directly from the cache line when possible,
+// otherwise fall back to peeking byte per byte.
+template<typename GetCacheLine, typename Peek>
+static void peekBlockHelper(unsigned address, std::span<uint8_t> output,
+                            GetCacheLine getCacheLine, Peek peek)
 {
-	auto getCacheLine = [&]() -> const uint8_t* {
-		uint8_t primSlot = (address & 0xC0000) >> 18;
-		bool exp = isExpanded(primSlot);
-		uint16_t offset = (address & (0xFFFF & CacheLine::HIGH)); // includes page
-		if ((offset == (0xFFFF & CacheLine::HIGH)) && exp) {
-			return nullptr;
-		} else {
-			uint8_t subSlot = exp ? ((address & 0x30000) >> 16) : 0;
-			uint8_t page = (address & 0x0C000) >> 14;
-			return slotLayout[primSlot][subSlot][page]->getReadCacheLine(offset);
-		}
-	};
 	auto processChunk = [&](size_t start, size_t n) {
 		assert(start < CacheLine::SIZE);
 		assert((start + n) <= CacheLine::SIZE);
 
-		if (const auto* line = getCacheLine()) {
+		if (const auto* line = getCacheLine(address)) {
 			copy_to_range(std::span{line + start, n}, output);
 		} else {
 			for (auto i : xrange(n)) {
-				output[i] = peekSlottedMem(narrow<unsigned>(address + i), time);
+				output[i] = peek(narrow<unsigned>(address + i));
 			}
 		}
 		output = output.subspan(n);
-		address += n;
+		address += narrow<unsigned>(n);
 	};
 
 	if (auto l = address & CacheLine::LOW) { // start not aligned on cacheline boundary
@@ -816,6 +809,40 @@ void MSXCPUInterface::peekSlottedMemBlock(unsigned address, std::span<uint8_t> o
 	assert(output.empty()); // fully processed
 }
 
+// Similar to peekMem(), but can read a whole block at once
+void MSXCPUInterface::peekMemBlock(unsigned address, std::span<uint8_t> output, EmuTime time) const
+{
+	assert((address + output.size()) <= 0x10000);
+	peekBlockHelper(address, output,
+		[&](unsigned addr) -> const uint8_t* {
+			uint16_t offset = (addr & (0xFFFF & CacheLine::HIGH)); // includes page
+			if ((offset == (0xFFFF & CacheLine::HIGH)) && isExpanded(primarySlotState[3])) {
+				return nullptr;
+			}
+			return visibleDevices[offset >> 14]->getReadCacheLine(offset);
+		},
+		[&](unsigned addr) { return peekMem(narrow<uint16_t>(addr), time); });
+}
+
+// Similar to peekSlottedMem(), but can read a whole block at once
+void MSXCPUInterface::peekSlottedMemBlock(unsigned address, std::span<uint8_t> output, EmuTime time) const
+{
+	peekBlockHelper(address, output,
+		[&](unsigned addr) -> const uint8_t* {
+			uint8_t primSlot = (addr & 0xC0000) >> 18;
+			bool exp = isExpanded(primSlot);
+			uint16_t offset = (addr & (0xFFFF & CacheLine::HIGH)); // includes page
+			if ((offset == (0xFFFF & CacheLine::HIGH)) && exp) {
+				return nullptr;
+			} else {
+				uint8_t subSlot = exp ? ((addr & 0x30000) >> 16) : 0;
+				uint8_t page = (addr & 0x0C000) >> 14;
+				return slotLayout[primSlot][subSlot][page]->getReadCacheLine(offset);
+			}
+		},
+		[&](unsigned addr) { return peekSlottedMem(addr, time); });
+}
+
 uint8_t MSXCPUInterface::peekSlottedMem(unsigned address, EmuTime time) const
 {
 	uint8_t primSlot = (address & 0xC0000) >> 18;
@@ -870,12 +897,14 @@ void MSXCPUInterface::insertBreakPoint(BreakPoint bp)
 {
 	cliComm.update(CliComm::UpdateType::DEBUG_UPDT, bp.getIdStr(), "add");
 	breakPoints.push_back(std::move(bp));
+	changedBreakPoints();
 }
 
 void MSXCPUInterface::removeBreakPoint(const BreakPoint& bp)
 {
 	cliComm.update(CliComm::UpdateType::DEBUG_UPDT, bp.getIdStr(), "remove");
 	breakPoints.erase(find_unguarded(breakPoints, &bp, [](const BreakPoint& i) { return &i; }));
+	changedBreakPoints();
 }
 void MSXCPUInterface::removeBreakPoint(unsigned id)
 {
@@ -884,16 +913,58 @@ void MSXCPUInterface::removeBreakPoint(unsigned id)
 	    it != breakPoints.end()) {
 		cliComm.update(CliComm::UpdateType::DEBUG_UPDT, it->getIdStr(), "remove");
 		breakPoints.erase(it);
+		changedBreakPoints();
+	}
+}
+
+void MSXCPUInterface::rebuildBreakPointIndex()
+{
+	auto oldSet = breakPointSet;
+	for (auto& s : breakPointSet) s.reset();
+	breakPointIndex.clear();
+	for (auto i : xrange(breakPoints.size())) {
+		const auto& bp = breakPoints[i];
+		if (!bp.isEnabled()) continue;
+		auto addr = bp.getAddress();
+		if (!addr) continue;
+		breakPointSet[*addr >> CacheLine::BITS].set(*addr & CacheLine::LOW);
+		breakPointIndex[*addr].push_back(narrow<unsigned>(i));
+	}
+	if (breakPointSet != oldSet) ++breakPointSetGeneration;
+}
+
+void MSXCPUInterface::changedBreakPoints()
+{
+	rebuildBreakPointIndex();
+	updateBreakPointCache();
+}
+
+void MSXCPUInterface::updateBreakPointCache()
+{
+	if (breakPointCacheGeneration == breakPointSetGeneration) return;
+	breakPointCacheGeneration = breakPointSetGeneration;
+
+	for (auto i : xrange(CacheLine::NUM)) {
+		if (breakPointSet[i].any()) {
+			disallowReadCache[i] |=  BREAKPOINT_BIT;
+		} else {
+			disallowReadCache[i] &= ~BREAKPOINT_BIT;
+		}
 	}
+	msxcpu.invalidateAllSlotsRWCache(0x0000, 0x10000);
 }
 
 bool MSXCPUInterface::checkBreakPoints(unsigned pc)
 {
+	if (!hasBreakPointAt(pc) && conditions.empty()) return false;
+
 	// create copy for the case that breakpoint/condition removes itself
 	//  - avoids iterating over a changing collection
 	std::vector<BreakPoint> bpCopy;
-	for (const auto& bp : breakPoints) {
-		if (bp.isEnabled() && bp.getAddress() == pc) bpCopy.push_back(bp);
+	if (hasBreakPointAt(pc)) {
+		for (auto i : breakPointIndex[narrow_cast<uint16_t>(pc)]) {
+			bpCopy.push_back(breakPoints[i]);
+		}
 	}
 	std::vector<DebugCondition> condCopy;
 	for (const auto& cond : conditions) {
@@ -905,13 +976,13 @@ bool MSXCPUInterface::checkBreakPoints(unsigned pc)
 	auto& interp        = motherBoard.getReactor().getInterpreter();
 	auto scopedBlock = motherBoard.getStateChangeDistributor().tempBlockNewEventsDuringReplay();
 	for (auto& p : bpCopy) {
-		bool remove = p.checkAndExecute(globalCliComm, interp);
+		bool remove = p.checkAndExecute(globalCliComm, interp, motherBoard);
 		if (remove) {
 			removeBreakPoint(p.getId());
 		}
 	}
 	for (auto& c : condCopy) {
-		bool remove = c.checkAndExecute(globalCliComm, interp);
+		bool remove = c.checkAndExecute(globalCliComm, interp, motherBoard);
 		if (remove) {
 			removeCondition(c.getId());
 		}
@@ -1013,10 +1084,14 @@ void MSXCPUInterface::removeCondition(unsigned id)
 
 void MSXCPUInterface::updateMemWatch(WatchPoint::Type type)
 {
+	bool isRead = type == WatchPoint::Type::READ_MEM;
 	std::span<std::bitset<CacheLine::SIZE>, CacheLine::NUM> watchSet =
-		(type == WatchPoint::Type::READ_MEM) ? readWatchSet : writeWatchSet;
+		isRead ? readWatchSet : writeWatchSet;
+	std::span<WatchPoints, CacheLine::NUM> watchIndex =
+		isRead ? readWatchIndex : writeWatchIndex;
 	for (auto i : xrange(CacheLine::NUM)) {
 		watchSet[i].reset();
+		watchIndex[i].clear();
 	}
 	for (const auto& w : watchPoints) {
 		if (w->getType() == type) {
@@ -1028,6 +1103,9 @@ void MSXCPUInterface::updateMemWatch(WatchPoint::Type type)
 				watchSet[addr >> CacheLine::BITS].set(
 				         addr  & CacheLine::LOW);
 			}
+			for (unsigned line = *begin >> CacheLine::BITS; line <= (*end >> CacheLine::BITS); ++line) {
+				watchIndex[line].push_back(w);
+			}
 		}
 	}
 	for (auto i : xrange(CacheLine::NUM)) {
@@ -1046,34 +1124,50 @@ void MSXCPUInterface::updateMemWatch(WatchPoint::Type type)
 }
 
 void MSXCPUInterface::executeMemWatch(WatchPoint::Type type,
-                                      unsigned address, unsigned value)
+                                      unsigned address, EmuTime time, unsigned value)
 {
 	assert(!watchPoints.empty());
 	if (isFastForward()) return;
 
+	// Only visit the watchpoints that overlap with this cache line. Copy
+	// the matching ones, for the case a watchpoint removes itself.
+	const auto& candidates = (type == WatchPoint::Type::READ_MEM)
+	                       ? readWatchIndex [address >> CacheLine::BITS]
+	                       : writeWatchIndex[address >> CacheLine::BITS];
+	WatchPoints wpCopy;
+	bool needVars = false;
+	for (const auto& w : candidates) {
+		if ((w->getBeginAddress() <= address) &&
+		    (w->getEndAddress()   >= address) &&
+		    (w->getType()         == type)) {
+			wpCopy.push_back(w);
+			needVars |= w->needsTclVariables();
+		}
+	}
+
 	auto& globalCliComm = motherBoard.getReactor().getGlobalCliComm();
 	auto& interp        = motherBoard.getReactor().getInterpreter();
-	interp.setVariable(TclObject("wp_last_address"),
-	                   TclObject(int(address)));
-	if (value != ~0u) {
-		interp.setVariable(TclObject("wp_last_value"),
-		                   TclObject(int(value)));
+	if (needVars) {
+		interp.setVariable(TclObject("wp_last_address"),
+		                   TclObject(int(address)));
+		if (value != ~0u) {
+			interp.setVariable(TclObject("wp_last_value"),
+			                   TclObject(int(value)));
+		}
 	}
 
 	auto scopedBlock = motherBoard.getStateChangeDistributor().tempBlockNewEventsDuringReplay();
-	for( auto wpCopy = watchPoints; auto& w : wpCopy) {
-		if ((w->getBeginAddress() <= address) &&
-		    (w->getEndAddress()   >= address) &&
-		    (w->getType()         == type)) {
-			bool remove = w->checkAndExecute(globalCliComm, interp);
-			if (remove) {
-				removeWatchPoint(w);
-			}
+	for (auto& w : wpCopy) {
+		bool remove = w->trigger(globalCliComm, interp, motherBoard, address, value, time);
+		if (remove) {
+			removeWatchPoint(w);
 		}
 	}
 
-	interp.unsetVariable("wp_last_address");
-	interp.unsetVariable("wp_last_value");
+	if (needVars) {
+		interp.unsetVariable("wp_last_address");
+		interp.unsetVariable("wp_last_value");
+	}
 }
 
 
@@ -1124,6 +1218,7 @@ void MSXCPUInterface::cleanup()
 	// TODO it would be nicer if breakpoints and conditions were not
 	//      global objects.
 	breakPoints.clear();
+	rebuildBreakPointIndex();
 	conditions.clear();
 }
 
@@ -1149,6 +1244,19 @@ uint8_t MSXCPUInterface::MemoryDebug::read(unsigned address, EmuTime time)
 	return interface.peekMem(narrow<uint16_t>(address), time);
 }
 
+void MSXCPUInterface::MemoryDebug::readBlock(unsigned start, std::span<uint8_t> output)
+{
+	const auto& interface = OUTER(MSXCPUInterface, memoryDebug);
+	interface.peekMemBlock(start, output, getMotherBoard().getCurrentTime());
+
+#ifdef DEBUG
+	auto time = getMotherBoard().getCurrentTime();
+	for (auto i : xrange(output.size())) {
+		assert(output[i] == read(narrow<unsigned>(start + i), time));
+	}
+#endif
+}
+
 void MSXCPUInterface::MemoryDebug::write(unsigned address, uint8_t value,
                                          EmuTime time)
 {
@@ -11,6 +11,7 @@
 #include "ProfileCounters.hh"
 #include "SimpleDebuggable.hh"
 
+#include "hash_map.hh"
 #include "narrow.hh"
 
 #include <array>
@@ -242,6 +243,7 @@ public:
 	 * @see MSXDevice::peekMem()
 	 */
 	[[nodiscard]] uint8_t peekMem(uint16_t address, EmuTime time) const;
+	void peekMemBlock(unsigned address, std::span<uint8_t> output, EmuTime time) const;
 	[[nodiscard]] uint8_t peekSlottedMem(unsigned address, EmuTime time) const;
 	void peekSlottedMemBlock(unsigned address, std::span<uint8_t> output, EmuTime time) const;
 	uint8_t readSlottedMem(unsigned address, EmuTime time);
@@ -264,12 +266,37 @@ public:
 	void removeBreakPoint(const BreakPoint& bp);
 	void removeBreakPoint(unsigned id);
 	using BreakPoints = std::vector<BreakPoint>;
+	// Note: when modifying a breakpoint (e.g. enable/disable it or change
+	// its address), do so while holding a ScopedChangeBreakPoints.
 	[[nodiscard]] static BreakPoints& getBreakPoints() { return breakPoints; }
 
+	// Rebuilds the address index on the breakpoints when it goes out of
+	// scope. Use this when modifying breakpoints that are already inserted.
+	struct ScopedChangeBreakPoints {
+		ScopedChangeBreakPoints(const ScopedChangeBreakPoints&) = delete;
+		ScopedChangeBreakPoints(ScopedChangeBreakPoints&&) = delete;
+		ScopedChangeBreakPoints& operator=(const ScopedChangeBreakPoints&) = delete;
+		ScopedChangeBreakPoints& operator=(ScopedChangeBreakPoints&&) = delete;
+
+		explicit ScopedChangeBreakPoints(MSXCPUInterface& interface_)
+			: interface(interface_) {}
+		~ScopedChangeBreakPoints() {
+			interface.changedBreakPoints();
+		}
+	private:
+		MSXCPUInterface& interface;
+	};
+	[[nodiscard]] auto getScopedChangeBreakPoints() {
+		return ScopedChangeBreakPoints(*this);
+	}
+	// Same, but without a machine: updateBreakPointCache() must be called
+	// on each MSXCPUInterface afterwards (the CPU does this itself).
+	static void rebuildBreakPointIndex();
+
 	void setWatchPoint(const std::shared_ptr<WatchPoint>& watchPoint);
 	void removeWatchPoint(std::shared_ptr<WatchPoint> watchPoint);
 	void removeWatchPoint(unsigned id);
-	// note: must be shared_ptr (not unique_ptr), see WatchIO::doReadCallback()
+	// note: must be shared_ptr (not unique_ptr), see WatchPoint::doCallback()
 	using WatchPoints = std::vector<std::shared_ptr<WatchPoint>>;
 	[[nodiscard]] const WatchPoints& getWatchPoints() const { return watchPoints; }
 	[[nodiscard]] WatchPoints& getWatchPoints() { return watchPoints; }
@@ -314,6 +341,22 @@ public:
 	{
 		return !breakPoints.empty() || !conditions.empty();
 	}
+	[[nodiscard]] static bool anyConditions()
+	{
+		return !conditions.empty();
+	}
+	/** Is there an (enabled) breakpoint on the given address? */
+	[[nodiscard]] static bool hasBreakPointAt(unsigned address)
+	{
+		return breakPointSet[address >> CacheLine::BITS][address & CacheLine::LOW];
+	}
+	/** Disallow the read cache for the cache lines that contain a
+	  * breakpoint. That way the CPU only leaves its fast path when it
+	  * fetches an instruction from such a cache line. This is already done
+	  * when the breakpoints change via this object, but the breakpoints are
+	  * shared by all machines, so the CPU also calls this (cheap when
+	  * nothing changed) before it starts executing. */
+	void updateBreakPointCache();
 	[[nodiscard]] bool checkBreakPoints(unsigned pc);
 
 	// cleanup global variables
@@ -351,12 +394,14 @@ private:
 
 	void removeAllWatchPoints();
 	void updateMemWatch(WatchPoint::Type type);
+	void changedBreakPoints();
 	void executeMemWatch(WatchPoint::Type type, unsigned address,
-	                     unsigned value = ~0u);
+	                     EmuTime time, unsigned value = ~0u);
 
 	struct MemoryDebug final : SimpleDebuggable {
 		explicit MemoryDebug(MSXMotherBoard& motherBoard);
 		[[nodiscard]] uint8_t read(unsigned address, EmuTime time) override;
+		void readBlock(unsigned start, std::span<uint8_t> output) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
 	} memoryDebug;
 
@@ -437,6 +482,11 @@ private:
 	std::array<uint8_t, CacheLine::NUM> disallowWriteCache;
 	std::array<std::bitset<CacheLine::SIZE>, CacheLine::NUM> readWatchSet;
 	std::array<std::bitset<CacheLine::SIZE>, CacheLine::NUM> writeWatchSet;
+	// Per cache line, the memory watchpoints that (partly) overlap with it
+	// (in creation order). Rebuilt together with the watch sets.
+	std::array<WatchPoints, CacheLine::NUM> readWatchIndex;
+	std::array<WatchPoints, CacheLine::NUM> writeWatchIndex;
+	unsigned breakPointCacheGeneration = 0; // compared to 'breakPointSetGeneration'
 
 	struct GlobalRwInfo {
 		MSXDevice* device;
@@ -460,6 +510,10 @@ private:
 
 	//  All CPUs (Z80 and R800) of all MSX machines share this state.
 	static inline BreakPoints breakPoints; // unsorted
+	// Index on the (enabled) breakpoints, rebuilt whenever they change.
+	static inline std::array<std::bitset<CacheLine::SIZE>, CacheLine::NUM> breakPointSet;
+	static inline hash_map<uint16_t, std::vector<unsigned>> breakPointIndex{0}; // address -> indices in 'breakPoints'
+	static inline unsigned breakPointSetGeneration = 0; // incremented when 'breakPointSet' changes
 	WatchPoints watchPoints; // ordered in creation order,  TODO must also be static
 	static inline Conditions conditions; // ordered in creation order
 	static inline bool breaked = false;
@@ -8,7 +8,9 @@
 #include "TclObject.hh"
 
 #include "checked_cast.hh"
+#include "narrow.hh"
 #include "one_of.hh"
+#include "unreachable.hh"
 
 #include <cassert>
 #include <memory>
@@ -53,28 +55,34 @@ void WatchPoint::unregisterIOWatch(std::span<MSXDevice*, 256> devices)
 	registered = false;
 }
 
-void WatchPoint::doReadCallback(MSXMotherBoard& motherBoard, unsigned port)
+bool WatchPoint::trigger(GlobalCliComm& cliComm, Interpreter& interp, MSXMotherBoard& motherBoard,
+                         unsigned address, unsigned value, EmuTime time)
 {
-	auto& cpuInterface = motherBoard.getCPUInterface();
-	if (cpuInterface.isFastForward()) return;
-
-	auto& reactor = motherBoard.getReactor();
-	auto& cliComm = reactor.getGlobalCliComm();
-	auto& interp  = reactor.getInterpreter();
-	interp.setVariable(TclObject("wp_last_address"), TclObject(int(port)));
-
-	// keep this object alive by holding a shared_ptr to it, for the case
-	// this watchpoint deletes itself in checkAndExecute()
-	auto keepAlive = shared_from_this();
-	auto scopedBlock = motherBoard.getStateChangeDistributor().tempBlockNewEventsDuringReplay();
-	if (bool remove = checkAndExecute(cliComm, interp); remove) {
-		cpuInterface.removeWatchPoint(keepAlive);
-	}
-
-	interp.unsetVariable("wp_last_address");
+	return checkAndExecute(cliComm, interp, motherBoard, [&]{
+		++hits;
+		switch (action) {
+		using enum Action;
+		case COMMAND:
+			executeCommand(cliComm, interp);
+			break;
+		case COUNT:
+			break;
+		case LOG:
+			if (log.capacity() == 0) log.set_capacity(LOG_CAPACITY);
+			if (log.full()) log.pop_front();
+			log.push_back(LogEntry{time, narrow_cast<uint16_t>(address),
+			                       (value == ~0u) ? -1 : int(value)});
+			break;
+		case BREAK:
+			motherBoard.getCPUInterface().doBreak();
+			break;
+		default:
+			UNREACHABLE;
+		}
+	});
 }
 
-void WatchPoint::doWriteCallback(MSXMotherBoard& motherBoard, unsigned port, unsigned value)
+void WatchPoint::doCallback(MSXMotherBoard& motherBoard, unsigned port, unsigned value, EmuTime time)
 {
 	auto& cpuInterface = motherBoard.getCPUInterface();
 	if (cpuInterface.isFastForward()) return;
@@ -82,18 +90,26 @@ void WatchPoint::doWriteCallback(MSXMotherBoard& motherBoard, unsigned port, uns
 	auto& reactor = motherBoard.getReactor();
 	auto& cliComm = reactor.getGlobalCliComm();
 	auto& interp  = reactor.getInterpreter();
-	interp.setVariable(TclObject("wp_last_address"), TclObject(int(port)));
-	interp.setVariable(TclObject("wp_last_value"),   TclObject(int(value)));
+	bool setVars = needsTclVariables();
+	if (setVars) {
+		interp.setVariable(TclObject("wp_last_address"), TclObject(int(port)));
+		if (value != ~0u) {
+			interp.setVariable(TclObject("wp_last_value"), TclObject(int(value)));
+		}
+	}
 
-	// see comment in doReadCallback() above
+	// keep this object alive by holding a shared_ptr to it, for the case
+	// this watchpoint deletes itself in trigger()
 	auto keepAlive = shared_from_this();
 	auto scopedBlock = motherBoard.getStateChangeDistributor().tempBlockNewEventsDuringReplay();
-	if (bool remove = checkAndExecute(cliComm, interp); remove) {
+	if (bool remove = trigger(cliComm, interp, motherBoard, port, value, time); remove) {
 		cpuInterface.removeWatchPoint(keepAlive);
 	}
 
-	interp.unsetVariable("wp_last_address");
-	interp.unsetVariable("wp_last_value");
+	if (setVars) {
+		interp.unsetVariable("wp_last_address");
+		interp.unsetVariable("wp_last_value");
+	}
 }
 
 
@@ -123,7 +139,7 @@ uint8_t MSXWatchIODevice::readIO(uint16_t port, EmuTime time)
 	assert(device);
 
 	// first trigger watchpoint, then read from device
-	wp.doReadCallback(getMotherBoard(), port);
+	wp.doCallback(getMotherBoard(), port, ~0u, time);
 	return device->readIO(port, time);
 }
 
@@ -133,7 +149,7 @@ void MSXWatchIODevice::writeIO(uint16_t port, uint8_t value, EmuTime time)
 
 	// first write to device, then trigger watchpoint
 	device->writeIO(port, value, time);
-	wp.doWriteCallback(getMotherBoard(), port, value);
+	wp.doCallback(getMotherBoard(), port, value, time);
 }
 
 } // namespace openmsx
@@ -3,8 +3,10 @@
 
 #include "BreakPointBase.hh"
 #include "CommandException.hh"
+#include "EmuTime.hh"
 #include "MSXMultiDevice.hh"
 
+#include "circular_buffer.hh"
 #include "narrow.hh"
 #include "one_of.hh"
 #include "strCat.hh"
@@ -67,6 +69,44 @@ public:
 		if (str == "write_mem") return WRITE_MEM;
 		throw CommandException("Invalid type: ", str);
 	}
+	/** What to do when the watchpoint triggers (and the condition is true).
+	  * Only COMMAND involves Tcl, the others are handled natively (much
+	  * faster when a watchpoint triggers very often). */
+	enum class Action : uint8_t {
+		COMMAND, // execute the Tcl command
+		COUNT,   // only increase the hit counter
+		LOG,     // append time, address and value to the log
+		BREAK,   // break CPU emulation (like 'debug break')
+	};
+
+	static std::string_view format(Action action)
+	{
+		switch (action) {
+		using enum Action;
+		case COMMAND: return "command";
+		case COUNT:   return "count";
+		case LOG:     return "log";
+		case BREAK:   return "break";
+		}
+		UNREACHABLE;
+	}
+	static Action parseAction(std::string_view str)
+	{
+		using enum Action;
+		if (str == "command") return COMMAND;
+		if (str == "count")   return COUNT;
+		if (str == "log")     return LOG;
+		if (str == "break")   return BREAK;
+		throw CommandException("Invalid action: ", str);
+	}
+
+	struct LogEntry {
+		EmuTime time = EmuTime::zero();
+		uint16_t address = 0;
+		int value = -1; // -1 for reads
+	};
+	static constexpr size_t LOG_CAPACITY = 10000; // only keep the most recent entries
+
 	static unsigned rangeForType(Type type)
 	{
 		return (type == one_of(Type::READ_IO, Type::WRITE_IO)) ? 0x100 : 0x10000;
@@ -91,6 +131,7 @@ public:
 		, type(wp.type)
 		, beginAddrStr(wp.beginAddrStr), endAddrStr(wp.endAddrStr)
 		, beginAddr(wp.beginAddr), endAddr(wp.endAddr)
+		, log(wp.log), hits(wp.hits), action(wp.action)
 	{
 		id = wp.id;
 		assert(ios.empty());
@@ -143,12 +184,35 @@ public:
 		}
 	}
 
+	[[nodiscard]] Action getAction() const { return action; }
+	void setAction(Action a) { action = a; }
+	void setAction(const TclObject& a) { setAction(parseAction(a.getString())); }
+
+	/** Number of times this watchpoint triggered (with a true condition). */
+	[[nodiscard]] uint64_t getHits() const { return hits; }
+	void setHits(uint64_t h) { hits = h; }
+
+	[[nodiscard]] const auto& getLog() const { return log; }
+	void clearLog() { log.clear(); }
+
+	/** Does triggering this watchpoint require the 'wp_last_*' Tcl
+	  * variables? */
+	[[nodiscard]] bool needsTclVariables() const {
+		return (action == Action::COMMAND) || !getCondition().getString().empty();
+	}
+
+	/** Check the condition, and if true perform the action. Returns true
+	  * when the watchpoint should be removed (see checkAndExecute()).
+	  * 'value' is ~0u for reads. */
+	bool trigger(GlobalCliComm& cliComm, Interpreter& interp, MSXMotherBoard& motherBoard,
+	             unsigned address, unsigned value, EmuTime time);
+
 	void registerIOWatch(MSXMotherBoard& motherBoard, std::span<MSXDevice*, 256> devices);
 	void unregisterIOWatch(std::span<MSXDevice*, 256> devices);
 
 private:
-	void doReadCallback(MSXMotherBoard& motherBoard, unsigned port);
-	void doWriteCallback(MSXMotherBoard& motherBoard, unsigned port, unsigned value);
+	// 'value' is ~0u for reads
+	void doCallback(MSXMotherBoard& motherBoard, unsigned port, unsigned value, EmuTime time);
 
 	std::pair<uint16_t, uint16_t> parseAddress(Interpreter& interp) const {
 		auto begin = beginAddrStr.eval(interp).getInt(interp); // may throw
@@ -171,6 +235,10 @@ private:
 	std::optional<uint16_t> beginAddr; // begin and end address are inclusive (IOW range = [begin, end])
 	std::optional<uint16_t> endAddr;
 
+	circular_buffer<LogEntry> log; // capacity is allocated on first use
+	uint64_t hits = 0;
+	Action action = Action::COMMAND;
+
 	std::vector<std::unique_ptr<MSXWatchIODevice>> ios;
 	bool registered = false; // for debugging only
 
@@ -0,0 +1,654 @@
+#include "CompiledCondition.hh"
+
+#include "CPURegs.hh"
+#include "Debuggable.hh"
+#include "Debugger.hh"
+#include "Interpreter.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXMotherBoard.hh"
+
+#include "StringOp.hh"
+#include "one_of.hh"
+#include "strCat.hh"
+
+#include <algorithm>
+#include <limits>
+
+namespace openmsx {
+
+// Thrown (and caught) while compiling, when an unsupported construct is found.
+struct Unsupported {};
+
+[[nodiscard]] static std::optional<int64_t> parseInteger(std::string_view str)
+{
+	bool negative = false;
+	if (!str.empty() && (str.front() == one_of('-', '+'))) {
+		negative = str.front() == '-';
+		str.remove_prefix(1);
+	}
+	if (str.empty()) return {};
+
+	int base = 10;
+	if ((str.size() > 2) && (str[0] == '0')) {
+		switch (str[1]) {
+			case 'x': case 'X': base = 16; break;
+			case 'b': case 'B': base = 2; break;
+			case 'o': case 'O': base = 8; break;
+			default: return {}; // leading zero: old-style octal in Tcl
+		}
+		str.remove_prefix(2);
+	} else if ((str.size() > 1) && (str[0] == '0')) {
+		return {};
+	}
+
+	uint64_t result = 0;
+	for (char c : str) {
+		unsigned digit = [&] {
+			if (('0' <= c) && (c <= '9')) return unsigned(c - '0');
+			if (('a' <= c) && (c <= 'f')) return unsigned(c - 'a' + 10);
+			if (('A' <= c) && (c <= 'F')) return unsigned(c - 'A' + 10);
+			return 99u;
+		}();
+		if (digit >= unsigned(base)) return {};
+		if (result > (uint64_t(std::numeric_limits<int64_t>::max()) - digit) / base) {
+			return {}; // too large, Tcl would use a bignum
+		}
+		result = result * base + digit;
+	}
+	auto value = int64_t(result);
+	return negative ? -value : value;
+}
+
+[[nodiscard]] static bool isVarChar(char c)
+{
+	return (('a' <= c) && (c <= 'z')) || (('A' <= c) && (c <= 'Z')) ||
+	       (('0' <= c) && (c <= '9')) || (c == '_');
+}
+
+class CompiledCondition::Parser
+{
+public:
+	Parser(std::string_view input_, std::vector<Node>& nodes_, std::vector<UsedCommand>& commands_)
+		: input(input_), nodes(nodes_), commands(commands_) {}
+
+	unsigned parseAll()
+	{
+		auto result = parseTernary();
+		skipSpace();
+		if (pos != input.size()) throw Unsupported{};
+		return result;
+	}
+
+private:
+	struct Word {
+		std::optional<std::string_view> literal;
+		unsigned node = 0; // only valid when there's no literal
+	};
+
+	[[nodiscard]] bool atEnd() const { return pos == input.size(); }
+	[[nodiscard]] char peek(size_t offset = 0) const
+	{
+		return (pos + offset < input.size()) ? input[pos + offset] : '\0';
+	}
+	void skipSpace()
+	{
+		while (!atEnd() && (peek() == one_of(' ', '\t', '\n', '\r'))) ++pos;
+	}
+	bool consume(std::string_view token)
+	{
+		if (!input.substr(pos).starts_with(token)) return false;
+		pos += token.size();
+		return true;
+	}
+
+	unsigned add(Op op, unsigned a0 = 0, unsigned a1 = 0, unsigned a2 = 0)
+	{
+		auto& n = nodes.emplace_back();
+		n.op = op;
+		n.args = {a0, a1, a2};
+		return unsigned(nodes.size() - 1);
+	}
+	unsigned addConst(int64_t value)
+	{
+		auto idx = add(Op::CONSTANT);
+		nodes[idx].value = value;
+		return idx;
+	}
+	void use(std::string_view name, std::string_view origin)
+	{
+		if (std::ranges::any_of(commands, [&](const auto& c) { return c.name == name; })) return;
+		commands.push_back({std::string(name), std::string(origin)});
+	}
+
+	unsigned addRead(std::string_view debuggable, unsigned addr)
+	{
+		auto idx = add(Op::READ, addr);
+		nodes[idx].name = debuggable;
+		return idx;
+	}
+
+	unsigned parseTernary()
+	{
+		auto cond = parseBinary(0);
+		skipSpace();
+		if (!consume("?")) return cond;
+		auto ifTrue = parseTernary();
+		skipSpace();
+		if (!consume(":")) throw Unsupported{};
+		auto ifFalse = parseTernary();
+		return add(Op::COND, cond, ifTrue, ifFalse);
+	}
+
+	// Match a binary operator of the given precedence level (0 = lowest).
+	std::optional<Op> matchOperator(int level)
+	{
+		auto next = peek(1);
+		switch (level) {
+		case 0: if (consume("||")) return Op::OR; break;
+		case 1: if (consume("&&")) return Op::AND; break;
+		case 2: if ((peek() == '|') && (next != '|')) { ++pos; return Op::BIT_OR; } break;
+		case 3: if (consume("^")) return Op::BIT_XOR; break;
+		case 4: if ((peek() == '&') && (next != '&')) { ++pos; return Op::BIT_AND; } break;
+		case 5:
+			if (consume("==")) return Op::EQ;
+			if (consume("!=")) return Op::NE;
+			break;
+		case 6:
+			if (consume("<=")) return Op::LE;
+			if (consume(">=")) return Op::GE;
+			if ((peek() == '<') && (next != '<')) { ++pos; return Op::LT; }
+			if ((peek() == '>') && (next != '>')) { ++pos; return Op::GT; }
+			break;
+		case 7:
+			if (consume("<<")) return Op::SHL;
+			if (consume(">>")) return Op::SHR;
+			break;
+		case 8:
+			if (consume("+")) return Op::ADD;
+			if (consume("-")) return Op::SUB;
+			break;
+		case 9:
+			if (consume("**")) throw Unsupported{}; // exponentiation
+			if (consume("*")) return Op::MUL;
+			if (consume("/")) return Op::DIV;
+			if (consume("%")) return Op::MOD;
+			break;
+		}
+		return {};
+	}
+
+	unsigned parseBinary(int level)
+	{
+		if (level == 10) return parseUnary();
+		auto lhs = parseBinary(level + 1);
+		while (true) {
+			skipSpace();
+			auto op = matchOperator(level);
+			if (!op) return lhs;
+			auto rhs = parseBinary(level + 1);
+			lhs = add(*op, lhs, rhs);
+		}
+	}
+
+	unsigned parseUnary()
+	{
+		skipSpace();
+		if (consume("-")) return add(Op::NEG, parseUnary());
+		if (consume("+")) return parseUnary();
+		if (consume("~")) return add(Op::BIT_NOT, parseUnary());
+		if (consume("!")) return add(Op::NOT, parseUnary());
+		return parsePrimary();
+	}
+
+	unsigned parsePrimary()
+	{
+		skipSpace();
+		switch (peek()) {
+		case '(': {
+			++pos;
+			auto result = parseTernary();
+			skipSpace();
+			if (!consume(")")) throw Unsupported{};
+			return result;
+		}
+		case '$':
+			return parseVariable();
+		case '[':
+			return parseCommand();
+		default: {
+			auto begin = pos;
+			while (!atEnd() && isVarChar(peek())) ++pos;
+			if (peek() == one_of('.', '(')) throw Unsupported{}; // float or function
+			auto value = parseInteger(input.substr(begin, pos - begin));
+			if (!value) throw Unsupported{};
+			return addConst(*value);
+		}
+		}
+	}
+
+	unsigned parseVariable()
+	{
+		++pos; // skip '$'
+		std::string_view name;
+		if (consume("{")) {
+			auto end = input.find('}', pos);
+			if (end == std::string_view::npos) throw Unsupported{};
+			name = input.substr(pos, end - pos);
+			pos = end + 1;
+		} else {
+			auto begin = pos;
+			while (true) {
+				if (isVarChar(peek())) {
+					++pos;
+				} else if (!consume("::")) {
+					break;
+				}
+			}
+			name = input.substr(begin, pos - begin);
+			if (peek() == '(') throw Unsupported{}; // array element
+		}
+		if (name.empty()) throw Unsupported{};
+		auto idx = add(Op::VAR);
+		nodes[idx].var = TclObject(name);
+		return idx;
+	}
+
+	// Parse a single word of a command, the opening '[' of the command
+	// has already been consumed.
+	Word parseWord()
+	{
+		switch (peek()) {
+		case '[':
+			return {{}, parseCommand()};
+		case '$':
+			return {{}, parseVariable()};
+		case '{': {
+			++pos;
+			auto begin = pos;
+			int depth = 1;
+			while (!atEnd()) {
+				if (peek() == '{') ++depth;
+				if (peek() == '}' && (--depth == 0)) break;
+				if (peek() == '\\') throw Unsupported{};
+				++pos;
+			}
+			if (atEnd()) throw Unsupported{};
+			auto result = input.substr(begin, pos - begin);
+			++pos; // skip '}'
+			return {result};
+		}
+		case '"': {
+			++pos;
+			auto end = input.find('"', pos);
+			if (end == std::string_view::npos) throw Unsupported{};
+			auto result = input.substr(pos, end - pos);
+			if (result.find_first_of("$[\\") != std::string_view::npos) {
+				throw Unsupported{}; // needs substitution
+			}
+			pos = end + 1;
+			return {result};
+		}
+		default: {
+			auto begin = pos;
+			while (!atEnd() && (peek() != one_of(' ', '\t', ']'))) {
+				if (peek() == one_of('$', '[', '\\', '{', '"', ';', '\n')) {
+					throw Unsupported{};
+				}
+				++pos;
+			}
+			return {input.substr(begin, pos - begin)};
+		}
+		}
+	}
+
+	[[nodiscard]] static std::string_view literal(const Word& w)
+	{
+		if (!w.literal) throw Unsupported{};
+		return *w.literal;
+	}
+	unsigned valueOf(const Word& w)
+	{
+		if (!w.literal) return w.node;
+		auto value = parseInteger(*w.literal);
+		if (!value) throw Unsupported{};
+		return addConst(*value);
+	}
+	[[nodiscard]] static int64_t slotNumber(const Word& w)
+	{
+		auto str = literal(w);
+		if (str == "X") return -1;
+		auto value = parseInteger(str);
+		if (!value || (*value < 0) || (*value > 3)) throw Unsupported{};
+		return *value;
+	}
+
+	unsigned parseCommand()
+	{
+		++pos; // skip '['
+		std::vector<Word> words;
+		while (true) {
+			while (peek() == one_of(' ', '\t')) ++pos;
+			if (atEnd()) throw Unsupported{};
+			if (peek() == ']') break;
+			words.push_back(parseWord());
+		}
+		++pos; // skip ']'
+		if (words.empty()) throw Unsupported{};
+
+		auto cmd = literal(words[0]);
+		std::span<const Word> args = std::span(words).subspan(1);
+		if (cmd == "expr") {
+			if (args.size() != 1) throw Unsupported{};
+			use(cmd, "::expr");
+			Parser sub(literal(args[0]), nodes, commands);
+			return sub.parseAll();
+		} else if (cmd == "reg") {
+			if (args.size() != 1) throw Unsupported{};
+			use(cmd, "::cpuregs::reg");
+			return compileReg(literal(args[0]));
+		} else if (cmd == "debug") {
+			if ((args.size() != 3) || (literal(args[0]) != "read")) throw Unsupported{};
+			use(cmd, "::debug");
+			return addRead(literal(args[1]), valueOf(args[2]));
+		} else if (cmd.starts_with("peek")) {
+			if (args.empty() || (args.size() > 2)) throw Unsupported{};
+			use(cmd, strCat("::disasm::", cmd));
+			return compilePeek(cmd, args);
+		} else if (cmd == one_of("pc_in_slot", "watch_in_slot")) {
+			if (args.empty() || (args.size() > 3)) throw Unsupported{};
+			if ((args.size() == 3) && (literal(args[2]) != "X")) {
+				throw Unsupported{}; // mapper/rom block check
+			}
+			use(cmd, strCat("::slot::", cmd));
+			auto idx = add(cmd == "pc_in_slot" ? Op::SLOT_PC : Op::SLOT_WP);
+			nodes[idx].value = slotNumber(args[0]);
+			nodes[idx].value2 = (args.size() >= 2) ? slotNumber(args[1]) : -1;
+			return idx;
+		}
+		throw Unsupported{};
+	}
+
+	// See 'reg' in share/scripts/_cpuregs.tcl
+	unsigned compileReg(std::string_view name)
+	{
+		static constexpr std::array<std::string_view, 28> byteRegs = {
+			"A",   "F",   "B",   "C",   "D",   "E",   "H",   "L",
+			"A2",  "F2",  "B2",  "C2",  "D2",  "E2",  "H2",  "L2",
+			"IXH", "IXL", "IYH", "IYL", "PCH", "PCL", "SPH", "SPL",
+			"I",   "R",   "IM",  "IFF",
+		};
+		static constexpr std::array<std::string_view, 12> wordRegs = {
+			"AF",  "BC",  "DE",  "HL",
+			"AF2", "BC2", "DE2", "HL2",
+			"IX",  "IY",  "PC",  "SP",
+		};
+		auto sameName = [&](std::string_view r) { return StringOp::casecmp{}(r, name); };
+		if (auto it = std::ranges::find_if(byteRegs, sameName); it != byteRegs.end()) {
+			auto i = std::distance(byteRegs.begin(), it);
+			return addRead("CPU regs", addConst(i));
+		}
+		if (auto it = std::ranges::find_if(wordRegs, sameName); it != wordRegs.end()) {
+			auto i = 2 * std::distance(wordRegs.begin(), it);
+			return add(Op::ADD, add(Op::MUL, addConst(256), addRead("CPU regs", addConst(i))),
+			                    addRead("CPU regs", addConst(i + 1)));
+		}
+		throw Unsupported{};
+	}
+
+	// See 'peek' and friends in share/scripts/_disasm.tcl
+	unsigned compilePeek(std::string_view cmd, std::span<const Word> args)
+	{
+		auto addr = valueOf(args[0]);
+		std::string_view debuggable = (args.size() == 2) ? literal(args[1]) : "memory";
+		auto read16 = [&](bool bigEndian) {
+			auto lo = addRead(debuggable, bigEndian ? add(Op::ADD, addr, addConst(1)) : addr);
+			auto hi = addRead(debuggable, bigEndian ? addr : add(Op::ADD, addr, addConst(1)));
+			return add(Op::ADD, lo, add(Op::MUL, addConst(256), hi));
+		};
+		if (cmd == one_of("peek", "peek8", "peek_u8")) {
+			return addRead(debuggable, addr);
+		} else if (cmd == "peek_s8") {
+			return add(Op::SIGN8, addRead(debuggable, addr));
+		} else if (cmd == one_of("peek16", "peek16_LE", "peek_u16", "peek_u16LE")) {
+			return read16(false);
+		} else if (cmd == one_of("peek16_BE", "peek_u16BE")) {
+			return read16(true);
+		} else if (cmd == one_of("peek_s16", "peek_s16LE")) {
+			return add(Op::SIGN16, read16(false));
+		} else if (cmd == "peek_s16BE") {
+			return add(Op::SIGN16, read16(true));
+		}
+		throw Unsupported{};
+	}
+
+private:
+	std::string_view input;
+	size_t pos = 0;
+	std::vector<Node>& nodes;
+	std::vector<UsedCommand>& commands;
+};
+
+std::unique_ptr<CompiledCondition> CompiledCondition::compile(std::string_view expression)
+{
+	auto result = std::make_unique<CompiledCondition>();
+	try {
+		Parser parser(expression, result->nodes, result->commands);
+		result->root = parser.parseAll();
+	} catch (Unsupported&) {
+		return nullptr;
+	}
+	return result;
+}
+
+
+class CompiledCondition::Evaluator
+{
+public:
+	Evaluator(const std::vector<Node>& nodes_, Machine& machine_, Interpreter& interp_)
+		: nodes(nodes_), machine(machine_), interp(interp_) {}
+
+	int64_t eval(unsigned idx)
+	{
+		const auto& n = nodes[idx];
+		auto arg = [&](int i) { return eval(n.args[i]); };
+		switch (n.op) {
+		using enum Op;
+		case CONSTANT: return n.value;
+		case VAR: {
+			auto v = interp.getIntVariable(n.var);
+			if (!v) return fail();
+			return *v;
+		}
+		case READ: return read(n.name, arg(0));
+		case SLOT_PC: return inSlot(machine.getPC(), n.value, n.value2);
+		case SLOT_WP: {
+			auto addr = interp.getIntVariable(TclObject("wp_last_address"));
+			if (!addr) return fail();
+			return inSlot(*addr, n.value, n.value2);
+		}
+		case NEG: {
+			auto a = arg(0);
+			if (a == std::numeric_limits<int64_t>::min()) return fail();
+			return -a;
+		}
+		case NOT:     return !arg(0);
+		case BIT_NOT: return ~arg(0);
+		case SIGN8:  { auto a = arg(0); return (a < 128)   ? a : a - 256; }
+		case SIGN16: { auto a = arg(0); return (a < 32768) ? a : a - 65536; }
+		case MUL: {
+			auto a = arg(0); auto b = arg(1);
+			auto r = int64_t(uint64_t(a) * uint64_t(b));
+			if ((a != 0) && (((a == -1) && (b == std::numeric_limits<int64_t>::min())) ||
+			                 (r / a != b))) {
+				return fail();
+			}
+			return r;
+		}
+		case DIV: {
+			auto a = arg(0); auto b = arg(1);
+			if ((b == 0) || ((b == -1) && (a == std::numeric_limits<int64_t>::min()))) {
+				return fail();
+			}
+			auto q = a / b;
+			if (((a % b) != 0) && ((a < 0) != (b < 0))) --q; // Tcl rounds down
+			return q;
+		}
+		case MOD: {
+			auto a = arg(0); auto b = arg(1);
+			if (b == 0) return fail();
+			if (b == -1) return 0;
+			auto r = a % b;
+			if ((r != 0) && ((r < 0) != (b < 0))) r += b; // sign of divisor
+			return r;
+		}
+		case ADD: {
+			auto a = arg(0); auto b = arg(1);
+			auto r = int64_t(uint64_t(a) + uint64_t(b));
+			if (((a < 0) == (b < 0)) && ((r < 0) != (a < 0))) return fail();
+			return r;
+		}
+		case SUB: {
+			auto a = arg(0); auto b = arg(1);
+			auto r = int64_t(uint64_t(a) - uint64_t(b));
+			if (((a < 0) != (b < 0)) && ((r < 0) != (a < 0))) return fail();
+			return r;
+		}
+		case SHL: {
+			auto a = arg(0); auto b = arg(1);
+			if (b < 0) return fail();
+			if (a == 0) return 0;
+			if (b >= 63) return fail();
+			auto r = int64_t(uint64_t(a) << b);
+			if ((r >> b) != a) return fail();
+			return r;
+		}
+		case SHR: {
+			auto a = arg(0); auto b = arg(1);
+			if (b < 0) return fail();
+			return a >> std::min<int64_t>(b, 63);
+		}
+		case LT: return arg(0) <  arg(1);
+		case GT: return arg(0) >  arg(1);
+		case LE: return arg(0) <= arg(1);
+		case GE: return arg(0) >= arg(1);
+		case EQ: return arg(0) == arg(1);
+		case NE: return arg(0) != arg(1);
+		case BIT_AND: return arg(0) & arg(1);
+		case BIT_XOR: return arg(0) ^ arg(1);
+		case BIT_OR:  return arg(0) | arg(1);
+		case AND: return arg(0) && arg(1);
+		case OR:  return arg(0) || arg(1);
+		case COND: return arg(0) ? arg(1) : arg(2);
+		}
+		return fail();
+	}
+
+	bool failed = false;
+
+private:
+	int64_t fail()
+	{
+		failed = true;
+		return 0;
+	}
+
+	int64_t read(std::string_view name, int64_t addr)
+	{
+		auto value = machine.read(name, addr);
+		if (!value) return fail();
+		return *value;
+	}
+
+	int64_t inSlot(int64_t addr, int64_t ps, int64_t ss)
+	{
+		if ((addr < 0) || (addr > 0xffff)) return fail();
+		auto result = machine.inSlot(addr, ps, ss);
+		if (!result) return fail();
+		return *result;
+	}
+
+private:
+	const std::vector<Node>& nodes;
+	Machine& machine;
+	Interpreter& interp;
+};
+
+namespace {
+class MotherBoardMachine final : public CompiledCondition::Machine
+{
+public:
+	explicit MotherBoardMachine(MSXMotherBoard& motherBoard_)
+		: motherBoard(motherBoard_) {}
+
+	[[nodiscard]] std::optional<uint8_t> read(std::string_view name, int64_t addr) override
+	{
+		auto* debuggable = motherBoard.getDebugger().findDebuggable(name);
+		if (!debuggable || (addr < 0) || (addr >= int64_t(debuggable->getSize()))) {
+			return {};
+		}
+		return debuggable->read(unsigned(addr));
+	}
+
+	[[nodiscard]] uint16_t getPC() override
+	{
+		return motherBoard.getCPU().getRegisters().getPC();
+	}
+
+	// See 'address_in_slot' in share/scripts/_slot.tcl
+	[[nodiscard]] std::optional<bool> inSlot(int64_t addr, int64_t ps, int64_t ss) override
+	{
+		if (motherBoard.getMachineType() == "SVI") return {};
+		auto& cpuInterface = motherBoard.getCPUInterface();
+		auto page = int(addr >> 14);
+		auto pcPs = cpuInterface.getPrimarySlot(page);
+		if ((ps != -1) && (pcPs != ps)) return false;
+		if ((ss != -1) && cpuInterface.isExpanded(pcPs) &&
+		    (cpuInterface.getSecondarySlot(page) != ss)) return false;
+		return true;
+	}
+
+private:
+	MSXMotherBoard& motherBoard;
+};
+} // namespace
+
+bool CompiledCondition::checkCommands(Interpreter& interp) const
+{
+	// Only recheck when a watched command got deleted, renamed or
+	// redefined. A failed check is repeated on each evaluation (that's
+	// still cheaper than the Tcl evaluation we fall back to), because a
+	// missing command (e.g. while the scripts are still being loaded)
+	// can't be watched.
+	auto generation = interp.getCommandGeneration();
+	if (checkedGeneration == generation) return true;
+	for (const auto& cmd : commands) {
+		if ((interp.getCommandOrigin(cmd.name) != cmd.origin) ||
+		    interp.wasCommandModified(cmd.origin)) {
+			return false;
+		}
+		// Also watch the original command: redefining that one keeps
+		// the imported command.
+		interp.watchCommand(strCat("::", cmd.name));
+		interp.watchCommand(cmd.origin);
+	}
+	checkedGeneration = generation;
+	return true;
+}
+
+std::optional<bool> CompiledCondition::evaluate(MSXMotherBoard& motherBoard, Interpreter& interp) const
+{
+	MotherBoardMachine machine(motherBoard);
+	return evaluate(machine, interp);
+}
+
+std::optional<bool> CompiledCondition::evaluate(Machine& machine, Interpreter& interp) const
+{
+	if (!checkCommands(interp)) return {};
+	Evaluator evaluator(nodes, machine, interp);
+	auto result = evaluator.eval(root);
+	if (evaluator.failed) return {};
+	return result != 0;
+}
+
+} // namespace openmsx
@@ -0,0 +1,101 @@
+#ifndef COMPILEDCONDITION_HH
+#define COMPILEDCONDITION_HH
+
+#include "TclObject.hh"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openmsx {
+
+class Interpreter;
+class MSXMotherBoard;
+
+/** Native evaluator for the conditions of breakpoints, watchpoints and
+  * debug conditions.
+  *
+  * Evaluating a condition via Tcl is slow compared to emulating a single
+  * Z80 instruction (and debug conditions are checked after every
+  * instruction). Most conditions only use a small subset of Tcl though,
+  * so that subset is compiled into an expression tree that's evaluated
+  * without going through the Tcl interpreter. Anything else is still
+  * evaluated by Tcl. Supported are:
+  *  - integer literals (decimal, 0x.., 0b.., 0o..) and global variables
+  *    ($name, $::name, ${name}), e.g. $wp_last_value
+  *  - the unary operators - + ~ ! and the binary operators
+  *    * / % + - << >> < > <= >= == != & ^ | && || ?: with Tcl precedence
+  *    and (integer) semantics
+  *  - the commands [reg <name>], [peek* <addr> ?<debuggable>?],
+  *    [debug read <debuggable> <addr>], [pc_in_slot <ps> ?<ss>?],
+  *    [watch_in_slot <ps> ?<ss>?] and [expr {...}]
+  * The commands are only evaluated natively as long as they still refer
+  * to the openMSX built-in versions (e.g. '::disasm::peek'), so a user
+  * script that redefines e.g. 'peek' gets the Tcl evaluation again.
+  */
+class CompiledCondition
+{
+public:
+	/** The state of the emulated machine that's used by a condition.
+	  * Normally this is an MSXMotherBoard, the unittests use a fake one. */
+	class Machine {
+	public:
+		/** Read from a debuggable, empty when the debuggable doesn't
+		  * exist or 'addr' is out of range. */
+		[[nodiscard]] virtual std::optional<uint8_t> read(std::string_view debuggable, int64_t addr) = 0;
+		[[nodiscard]] virtual uint16_t getPC() = 0;
+		/** Is 'addr' currently mapped to slot 'ps'-'ss' (-1 means any
+		  * slot)? Empty when that can't be determined natively. */
+		[[nodiscard]] virtual std::optional<bool> inSlot(int64_t addr, int64_t ps, int64_t ss) = 0;
+	protected:
+		~Machine() = default;
+	};
+
+	/** Returns nullptr when the expression uses unsupported constructs. */
+	[[nodiscard]] static std::unique_ptr<CompiledCondition> compile(std::string_view expression);
+
+	/** Returns an empty optional when the expression cannot be evaluated
+	  * natively right now (e.g. a debuggable doesn't exist or a division
+	  * by zero). The caller should then fall back to Tcl, which will also
+	  * produce the proper error message. */
+	[[nodiscard]] std::optional<bool> evaluate(MSXMotherBoard& motherBoard, Interpreter& interp) const;
+	[[nodiscard]] std::optional<bool> evaluate(Machine& machine, Interpreter& interp) const;
+
+private:
+	enum class Op : uint8_t {
+		CONSTANT, VAR, READ, SLOT_PC, SLOT_WP,
+		NEG, NOT, BIT_NOT, SIGN8, SIGN16,
+		MUL, DIV, MOD, ADD, SUB, SHL, SHR,
+		LT, GT, LE, GE, EQ, NE,
+		BIT_AND, BIT_XOR, BIT_OR, AND, OR, COND,
+	};
+	struct Node {
+		Op op;
+		int64_t value = 0;  // CONSTANT: the value, SLOT_*: primary slot (-1 for 'X')
+		int64_t value2 = 0; // SLOT_*: secondary slot (-1 for 'X')
+		std::string name;   // READ: name of the debuggable
+		TclObject var;      // VAR: name of the variable
+		std::array<unsigned, 3> args = {};
+	};
+	struct UsedCommand {
+		std::string name;   // e.g. "peek"
+		std::string origin; // e.g. "::disasm::peek"
+	};
+	class Parser;
+	class Evaluator;
+
+	[[nodiscard]] bool checkCommands(Interpreter& interp) const;
+
+	std::vector<Node> nodes;
+	std::vector<UsedCommand> commands;
+	unsigned root = 0;
+	mutable unsigned checkedGeneration = 0; // 0 -> not (successfully) checked
+};
+
+} // namespace openmsx
+
+#endif
@@ -2,6 +2,7 @@
 #define DEBUGGABLE_HH
 
 #include "narrow.hh"
+#include "ranges.hh"
 #include "xrange.hh"
 
 #include <cassert>
@@ -27,11 +28,23 @@ public:
 	virtual void readBlock(unsigned start, std::span<uint8_t> output) {
 		// default implementation, subclasses may override it with a more efficient version
 		assert(narrow<unsigned>(start + output.size()) <= getSize());
+		if (auto block = getDirectBlock(); !block.empty()) {
+			copy_to_range(block.subspan(start, output.size()), output);
+			return;
+		}
 		for (auto i : xrange(output.size())) {
 			output[i] = read(narrow_cast<unsigned>(start + i));
 		}
 	}
 
+	/** Zero-copy access to the whole content of this debuggable. Only
+	  * possible when the content is a contiguous block of memory that can
+	  * be read without side effects, otherwise an empty span is returned
+	  * (the default), then use readBlock() instead. The result is only
+	  * valid until the emulation continues or the debuggable is written.
+	  */
+	[[nodiscard]] virtual std::span<const uint8_t> getDirectBlock() { return {}; }
+
 protected:
 	Debuggable() = default;
 	~Debuggable() = default;
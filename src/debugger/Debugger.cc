@@ -39,9 +39,21 @@ Debugger::Debugger(MSXMotherBoard& motherBoard_)
 	      motherBoard.getStateChangeDistributor(),
 	      motherBoard.getScheduler())
 	, tracer(*this)
+	, profiler(*this)
+	, history(*this)
+	, memSearch(*this)
 {
 }
 
+void Debugger::setCPU(MSXCPU* cpu_)
+{
+	if (!cpu_) {
+		profiler.cpuDeleted();
+		history.cpuDeleted();
+	}
+	cpu = cpu_;
+}
+
 Debugger::~Debugger()
 {
 	assert(!cpu);
@@ -178,6 +190,9 @@ void Debugger::transfer(Debugger& other)
 	}
 
 	tracer.transfer(other, *this);
+	profiler.transfer(other.profiler);
+	history.transfer(other.history);
+	memSearch.transfer(other.memSearch);
 
 	// Breakpoints and conditions are (currently) global, so no need to
 	// copy those.
@@ -255,7 +270,10 @@ void Debugger::Cmd::execute(
 		"list_conditions",   [&]{ listConditions(tokens, result); },
 		"probe",             [&]{ probe(tokens, result); },
 		"symbols",           [&]{ symbols(tokens, result); },
-		"trace",             [&]{ auto& d = debugger(); d.tracer.execute(d, tokens, result, time); });
+		"trace",             [&]{ auto& d = debugger(); d.tracer.execute(d, tokens, result, time); },
+		"profile",           [&]{ debugger().profiler.execute(tokens, result, time); },
+		"history",           [&]{ debugger().history.execute(tokens, result); },
+		"memsearch",         [&]{ debugger().memSearch.execute(tokens, result); });
 }
 
 void Debugger::Cmd::list(TclObject& result)
@@ -415,7 +433,8 @@ void Debugger::Cmd::watchPoint(std::span<const TclObject> tokens, TclObject& res
 		"list",      [&]{ watchPointList(tokens, result); },
 		"create",    [&]{ watchPointCreate(tokens, result); },
 		"configure", [&]{ watchPointConfigure(tokens, result); },
-		"remove",    [&]{ watchPointRemove(tokens, result); });
+		"remove",    [&]{ watchPointRemove(tokens, result); },
+		"log",       [&]{ watchPointLog(tokens, result); });
 }
 
 void Debugger::Cmd::watchExpr(std::span<const TclObject> tokens, TclObject& result)
@@ -526,8 +545,10 @@ void Debugger::Cmd::watchPointList(std::span<const TclObject> /*tokens*/, TclObj
 			TclObject("-address"), formatWpAddr(*wp),
 			TclObject("-condition"), wp->getCondition(),
 			TclObject("-command"), wp->getCommand(),
+			TclObject("-action"), WatchPoint::format(wp->getAction()),
 			TclObject("-enabled"), wp->isEnabled(),
-			TclObject("-once"), wp->onlyOnce());
+			TclObject("-once"), wp->onlyOnce(),
+			TclObject("-hits"), wp->getHits());
 		result.addDictKeyValue(wp->getIdStr(), std::move(dict));
 	}
 }
@@ -593,6 +614,14 @@ void Debugger::Cmd::parseCreateWatchPoint(WatchPoint& wp, std::span<const TclObj
 		funcArg("-command", [&](Interpreter& /*interp*/, const TclObject& arg) {
 			wp.setCommand(arg);
 		}),
+		funcArg("-action", [&](Interpreter& /*interp*/, const TclObject& arg) {
+			wp.setAction(arg);
+		}),
+		funcArg("-hits", [&](Interpreter& interp, const TclObject& arg) {
+			auto h = arg.getInt(interp); // may throw
+			if (h < 0) throw CommandException("-hits must be non-negative");
+			wp.setHits(uint64_t(h));
+		}),
 		funcArg("-enabled", [&](Interpreter& interp, const TclObject& arg) {
 			wp.setEnabled(interp, arg);
 		}),
@@ -681,7 +710,7 @@ void Debugger::Cmd::breakPointConfigure(std::span<const TclObject> tokens, TclOb
 	if (!bp) {
 		throw CommandException("No such breakpoint: ", id);
 	}
-	// No need to get a scoped change breakpoint.
+	auto ch = debugger().motherBoard.getCPUInterface().getScopedChangeBreakPoints();
 	parseCreateBreakPoint(*bp, tokens.subspan(4));
 }
 
@@ -742,6 +771,24 @@ void Debugger::Cmd::watchPointRemove(std::span<const TclObject> tokens, TclObjec
 	debugger().motherBoard.getCPUInterface().removeWatchPoint(wp);
 }
 
+void Debugger::Cmd::watchPointLog(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, Between{4, 5}, "id ?clear?");
+	auto id = tokens[3].getString();
+	auto wp = lookupWatchPoint(id);
+	if (!wp) {
+		throw CommandException("No such watchpoint: ", id);
+	}
+	if (tokens.size() == 5) {
+		if (tokens[4] != "clear") throw SyntaxError();
+		wp->clearLog();
+		return;
+	}
+	for (const auto& e : wp->getLog()) {
+		result.addListElement(makeTclList(e.time.toDouble(), e.address, e.value));
+	}
+}
+
 void Debugger::Cmd::watchExprRemove(std::span<const TclObject> tokens, TclObject& /*result*/)
 {
 	checkNumArgs(tokens, 4, "id");
@@ -1168,6 +1215,9 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 		"    disasm_blob  disassemble a instruction in Tcl binary string\n"
 		"    symbols      manage debug symbols\n"
 		"    trace        trace related subcommands\n"
+		"    profile      profile the emulated code\n"
+		"    history      record the executed instructions\n"
+		"    memsearch    search memory for changing values (cheat finder)\n"
 		"  The arguments are specific for each subcommand.\n"
 		"  Type 'help debug <subcommand>' for help about a specific subcommand.\n";
 
@@ -1227,6 +1277,7 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 		"    create    create a new watchpoint\n"
 		"    configure configure an existing watchpoint\n"
 		"    remove    remove an existing watchpoint\n"
+		"    log       get or clear the log of a watchpoint\n"
 		"  Type 'help debug watchpoint <subcommand>' for help about a specific subcommand.\n";
 	constexpr auto watchExprHelp =
 		"debug watchexpr <subcommand> [<arguments>]\n"
@@ -1283,8 +1334,15 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 		"  -address    the address(es) where the watchpoint should trigger, can be a single address or a begin/end-pair\n"
 		"  -condition  a Tcl expression that must evaluate to true for the watchpoint to trigger (default = no condition)\n"
 		"  -command    a Tcl command that should be executed when the watchpoint triggers (default = 'debug break')\n"
+		"  -action     what to do when the watchpoint triggers, one of:\n"
+		"                command: execute the -command (default)\n"
+		"                count:   only increase the hit counter\n"
+		"                log:     log time, address and value, see 'help debug watchpoint log'\n"
+		"                break:   break CPU emulation\n"
+		"              The latter three don't involve Tcl, so they're a lot faster for watchpoints that trigger often.\n"
 		"  -enabled    set to false to (temporarily) disable this watchpoint\n"
-		"  -once       if 'true' the watchpoint is automatically removed after it triggered (default = 'false', meaning recurring)\n";
+		"  -once       if 'true' the watchpoint is automatically removed after it triggered (default = 'false', meaning recurring)\n"
+		"  -hits       the number of times the watchpoint triggered (and the condition was true), can be set to reset it\n";
 	constexpr auto watchExprCreateHelp =
 		"debug watchexpr create [<property-name> <property-value>]...\n"
 		"  Create a new watch expression with given properties. The following properties are supported:\n"
@@ -1322,6 +1380,11 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 	constexpr auto watchPointRemoveHelp =
 		"debug watchpoint remove <id>\n"
 		"  Remove the watchpoint with given ID.\n";
+	constexpr auto watchPointLogHelp =
+		"debug watchpoint log <id> [clear]\n"
+		"  Returns the log of a watchpoint with '-action log', a list of {<time> <address> <value>} triples,\n"
+		"  oldest first (value is -1 for reads). Only the most recent 10000 entries are kept.\n"
+		"  With 'clear' the log is emptied instead.\n";
 	constexpr auto watchExprRemoveHelp =
 		"debug watchexpr remove <id>\n"
 		"  Remove the watch expression with given ID.\n";
@@ -1531,6 +1594,8 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 			return watchPointConfigureHelp;
 		} else if (tokens[2] == "remove") {
 			return watchPointRemoveHelp;
+		} else if (tokens[2] == "log") {
+			return watchPointLogHelp;
 		} else {
 			return watchPointHelp;
 		}
@@ -1598,6 +1663,12 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 		return symbolsHelp;
 	} else if (tokens[1] == "trace") {
 		return debugger().tracer.help(tokens);
+	} else if (tokens[1] == "profile") {
+		return debugger().profiler.help(tokens);
+	} else if (tokens[1] == "history") {
+		return debugger().history.help(tokens);
+	} else if (tokens[1] == "memsearch") {
+		return debugger().memSearch.help(tokens);
 	} else {
 		return unknownHelp;
 	}
@@ -1642,7 +1713,7 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 	static constexpr std::array otherCmds = {
 		"disasm"sv, "disasm_blob"sv, "set_bp"sv, "remove_bp"sv, "set_watchpoint"sv,
 		"remove_watchpoint"sv, "set_condition"sv, "remove_condition"sv, "trace"sv,
-		"probe"sv, "symbols"sv, "breakpoint"sv, "watchpoint"sv, "watchexpr"sv, "condition"sv,
+		"profile"sv, "history"sv, "memsearch"sv, "probe"sv, "symbols"sv, "breakpoint"sv, "watchpoint"sv, "watchexpr"sv, "condition"sv,
 	};
 	static constexpr std::array types = {
 		"read_io"sv, "write_io"sv, "read_mem"sv, "write_mem"sv,
@@ -1663,7 +1734,15 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 					"list"sv, "create"sv,
 					"configure"sv, "remove"sv,
 				};
-				completeString(tokens, subCmds);
+				static constexpr std::array wpSubCmds = {
+					"list"sv, "create"sv,
+					"configure"sv, "remove"sv, "log"sv,
+				};
+				if (tokens[1] == "watchpoint") {
+					completeString(tokens, wpSubCmds);
+				} else {
+					completeString(tokens, subCmds);
+				}
 			} else if (tokens[1] == "remove_bp") {
 				// this one takes a bp id
 				completeString(tokens, getBreakPointIds());
@@ -1689,6 +1768,12 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 				completeString(tokens, subCmds);
 			} else if (tokens[1] == "trace") {
 				debugger().tracer.tabCompletion(debugger(), tokens);
+			} else if (tokens[1] == "profile") {
+				debugger().profiler.tabCompletion(tokens);
+			} else if (tokens[1] == "history") {
+				debugger().history.tabCompletion(tokens);
+			} else if (tokens[1] == "memsearch") {
+				debugger().memSearch.tabCompletion(tokens);
 			}
 		}
 		break;
@@ -1708,15 +1793,24 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 				completeString(tokens, properties);
 			}
 		} else if (tokens[1] == "watchpoint") {
-			if ((size == 4) && tokens[2] == one_of("remove"sv, "configure"sv)) {
+			if ((size == 4) && tokens[2] == one_of("remove"sv, "configure"sv, "log"sv)) {
 				completeString(tokens, getWatchPointIds());
+			} else if ((size == 5) && (tokens[2] == "log")) {
+				static constexpr std::array clear = {"clear"sv};
+				completeString(tokens, clear);
 			} else if (((size >= 4) && (tokens[2] == "create")) ||
 			           ((size >= 5) && (tokens[2] == "configure"))) {
 				if (tokens[size - 2] == "-type") {
 					completeString(tokens, types);
+				} else if (tokens[size - 2] == "-action") {
+					static constexpr std::array actions = {
+						"command"sv, "count"sv, "log"sv, "break"sv,
+					};
+					completeString(tokens, actions);
 				} else {
 					static constexpr std::array properties = {
-						"-type"sv, "-address"sv, "-command"sv, "-condition"sv, "-enabled"sv, "-once"sv,
+						"-type"sv, "-address"sv, "-command"sv, "-condition"sv, "-action"sv,
+						"-enabled"sv, "-once"sv, "-hits"sv,
 					};
 					completeString(tokens, properties);
 				}
@@ -1743,6 +1837,12 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 			}
 		} else if (tokens[1] == "trace") {
 			debugger().tracer.tabCompletion(debugger(), tokens);
+		} else if (tokens[1] == "profile") {
+			debugger().profiler.tabCompletion(tokens);
+		} else if (tokens[1] == "history") {
+			debugger().history.tabCompletion(tokens);
+		} else if (tokens[1] == "memsearch") {
+			debugger().memSearch.tabCompletion(tokens);
 		}
 		break;
 	}
@@ -2,6 +2,9 @@
 #define DEBUGGER_HH
 
 #include "Probe.hh"
+#include "InstructionHistory.hh"
+#include "MemorySearch.hh"
+#include "Profiler.hh"
 #include "Tracer.hh"
 
 #include "ImGuiWatchExpr.hh"
@@ -47,7 +50,7 @@ public:
 	[[nodiscard]] ProbeBase* findProbe(std::string_view name);
 
 	void removeProbeBreakPoint(ProbeBreakPoint& bp);
-	void setCPU(MSXCPU* cpu_) { cpu = cpu_; }
+	void setCPU(MSXCPU* cpu_);
 
 	void transfer(Debugger& other);
 
@@ -57,6 +60,9 @@ public:
 
 	[[nodiscard]] auto& getProbes() { return probes; }
 	[[nodiscard]] Tracer& getTracer() { return tracer; }
+	[[nodiscard]] Profiler& getProfiler() { return profiler; }
+	[[nodiscard]] InstructionHistory& getInstructionHistory() { return history; }
+	[[nodiscard]] MemorySearch& getMemorySearch() { return memSearch; }
 
 private:
 	[[nodiscard]] Debuggable& getDebuggable(std::string_view name);
@@ -119,6 +125,7 @@ private:
 		void conditionConfigure (std::span<const TclObject> tokens, TclObject& result);
 		void breakPointRemove(std::span<const TclObject> tokens, TclObject& result);
 		void watchPointRemove(std::span<const TclObject> tokens, TclObject& result);
+		void watchPointLog(std::span<const TclObject> tokens, TclObject& result);
 		void watchExprRemove(std::span<const TclObject> tokens, TclObject& result);
 		void conditionRemove (std::span<const TclObject> tokens, TclObject& result);
 		void setBreakPoint(std::span<const TclObject> tokens, TclObject& result);
@@ -151,6 +158,12 @@ private:
 
 	Tracer tracer;
 	friend class Tracer;
+	Profiler profiler;
+	friend class Profiler;
+	InstructionHistory history;
+	friend class InstructionHistory;
+	MemorySearch memSearch;
+	friend class MemorySearch;
 
 	hash_map<std::string, Debuggable*, XXHasher> debuggables;
 	std::vector<ProbeBase*> probes; // sorted on name
@@ -0,0 +1,596 @@
+#include "InstructionHistory.hh"
+
+#include "Debugger.hh"
+
+#include "CPURegs.hh"
+#include "CommandException.hh"
+#include "Dasm.hh"
+#include "Interpreter.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXCliComm.hh"
+#include "MSXException.hh"
+#include "MSXMotherBoard.hh"
+#include "TclArgParser.hh"
+#include "TclObject.hh"
+
+#include "FileContext.hh"
+#include "endian.hh"
+#include "lz4.hh"
+#include "narrow.hh"
+#include "one_of.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+using namespace std::literals;
+
+namespace openmsx {
+
+static constexpr std::string_view SIGNATURE = "OMSXITR1";
+static constexpr uint32_t MAX_BLOCK_SIZE = 64 * 1024 * 1024; // sanity check when reading
+
+static constexpr uint8_t FLAG_LENGTH = 0x03;
+static constexpr uint8_t FLAG_PC     = 0x04;
+static constexpr uint8_t FLAG_REGS_LO = 0x08;
+static constexpr uint8_t FLAG_REGS_HI = 0x10;
+
+static constexpr std::array<std::string_view, InstructionHistory::NUM_REGS> regNames = {
+	"AF"sv, "BC"sv, "DE"sv, "HL"sv, "IX"sv, "IY"sv, "SP"sv, "AF2"sv,
+	"BC2"sv, "DE2"sv, "HL2"sv, "MISC"sv,
+};
+
+static void put16(std::vector<uint8_t>& out, uint16_t value)
+{
+	out.push_back(uint8_t(value & 0xFF));
+	out.push_back(uint8_t(value >> 8));
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(uint8_t(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(uint8_t(value));
+}
+
+[[nodiscard]] static InstructionHistory::Registers getRegisters(const CPURegs& r)
+{
+	auto misc = (r.getI() << 8) | (r.getIM() << 2) | (r.getIFF2() << 1) | (r.getIFF1() << 0);
+	return {r.getAF(), r.getBC(), r.getDE(), r.getHL(),
+	        r.getIX(), r.getIY(), r.getSP(), r.getAF2(),
+	        r.getBC2(), r.getDE2(), r.getHL2(), narrow_cast<uint16_t>(misc)};
+}
+
+
+// class InstructionHistory::Decoder
+
+InstructionHistory::Decoder::Decoder(std::span<const uint8_t> block)
+	: data(block)
+{
+	if (data.size() < 8) throw MSXException("Corrupt instruction history.");
+	entry.time = EmuTime::fromUint64(Endian::read_UA_L64(data.data()));
+	data = data.subspan(8);
+}
+
+uint8_t InstructionHistory::Decoder::get8()
+{
+	if (data.empty()) throw MSXException("Corrupt instruction history.");
+	auto result = data.front();
+	data = data.subspan(1);
+	return result;
+}
+
+uint16_t InstructionHistory::Decoder::get16()
+{
+	auto lo = get8();
+	auto hi = get8();
+	return narrow_cast<uint16_t>(lo | (hi << 8));
+}
+
+uint64_t InstructionHistory::Decoder::getVarint()
+{
+	uint64_t result = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7) {
+		auto b = get8();
+		result |= uint64_t(b & 0x7F) << shift;
+		if (!(b & 0x80)) return result;
+	}
+	throw MSXException("Corrupt instruction history.");
+}
+
+const InstructionHistory::Entry& InstructionHistory::Decoder::next()
+{
+	auto flags = get8();
+	if (first && !(flags & FLAG_PC)) throw MSXException("Corrupt instruction history.");
+	first = false;
+
+	entry.time = EmuTime::fromUint64(entry.time.toUint64() + getVarint());
+	entry.pc = (flags & FLAG_PC) ? get16() : uint16_t(entry.pc + entry.length);
+	entry.length = uint8_t((flags & FLAG_LENGTH) + 1);
+	entry.opcode = {};
+	for (auto i : xrange(entry.length)) entry.opcode[i] = get8();
+	if (flags & FLAG_REGS_LO) {
+		auto mask = get8();
+		for (auto i : xrange(8)) {
+			if (mask & (1 << i)) entry.regs[i] = get16();
+		}
+	}
+	if (flags & FLAG_REGS_HI) {
+		auto mask = get8();
+		for (auto i : xrange(size_t(NUM_REGS - 8))) {
+			if (mask & (1 << i)) entry.regs[8 + i] = get16();
+		}
+	}
+	return entry;
+}
+
+
+// class InstructionHistory::Buffer
+
+void InstructionHistory::Buffer::beginBlock(EmuTime time)
+{
+	// drop the oldest blocks, but keep at least 'depth' instructions
+	while (!blocks.empty() && ((numInstructions - blocks.front().count) >= depth)) {
+		numInstructions -= blocks.front().count;
+		spare = std::move(blocks.front().data);
+		blocks.pop_front();
+	}
+
+	auto& block = blocks.emplace_back();
+	block.data = std::move(spare);
+	block.data.clear();
+	block.data.reserve(BLOCK_SIZE * 12);
+	block.data.resize(8);
+	Endian::write_UA_L64(block.data.data(), time.toUint64());
+	prev.time = time;
+}
+
+void InstructionHistory::Buffer::append(const Entry& entry)
+{
+	assert(!blocks.empty());
+	auto& block = blocks.back();
+	auto& out = block.data;
+	bool first = block.count == 0;
+
+	uint8_t flags = entry.length - 1;
+	bool storePC = first || (entry.pc != uint16_t(prev.pc + prev.length));
+	if (storePC) flags |= FLAG_PC;
+	uint8_t maskLo = 0;
+	uint8_t maskHi = 0;
+	for (auto i : xrange(size_t(NUM_REGS))) {
+		if (first || (entry.regs[i] != prev.regs[i])) {
+			if (i < 8) {
+				maskLo |= uint8_t(1 << i);
+			} else {
+				maskHi |= uint8_t(1 << (i - 8));
+			}
+		}
+	}
+	if (maskLo) flags |= FLAG_REGS_LO;
+	if (maskHi) flags |= FLAG_REGS_HI;
+
+	out.push_back(flags);
+	putVarint(out, (entry.time - prev.time).toUint64());
+	if (storePC) put16(out, entry.pc);
+	out.insert(out.end(), entry.opcode.begin(), entry.opcode.begin() + entry.length);
+	if (maskLo) {
+		out.push_back(maskLo);
+		for (auto i : xrange(8)) {
+			if (maskLo & (1 << i)) put16(out, entry.regs[i]);
+		}
+	}
+	if (maskHi) {
+		out.push_back(maskHi);
+		for (auto i : xrange(size_t(NUM_REGS - 8))) {
+			if (maskHi & (1 << i)) put16(out, entry.regs[8 + i]);
+		}
+	}
+
+	prev = entry;
+	++block.count;
+	++numInstructions;
+}
+
+void InstructionHistory::Buffer::truncate(EmuTime time)
+{
+	while (!blocks.empty()) {
+		auto& block = blocks.back();
+		Decoder decoder(block.data);
+		size_t pos = block.data.size();
+		unsigned count = 0;
+		Entry last;
+		while (!decoder.atEnd()) {
+			auto left = decoder.bytesLeft();
+			const auto& entry = decoder.next();
+			if (entry.time >= time) {
+				pos = block.data.size() - left;
+				break;
+			}
+			last = entry;
+			++count;
+		}
+		numInstructions -= block.count - count;
+		if (count != 0) {
+			block.data.resize(pos);
+			block.count = count;
+			prev = last; // so that append() can continue this block
+			break;
+		}
+		blocks.pop_back();
+	}
+}
+
+void InstructionHistory::Buffer::clear()
+{
+	blocks.clear();
+	numInstructions = 0;
+}
+
+void InstructionHistory::Buffer::forEach(const std::function<void(const Entry&)>& callback) const
+{
+	for (const auto& block : blocks) {
+		Decoder decoder(block.data);
+		while (!decoder.atEnd()) callback(decoder.next());
+	}
+}
+
+std::vector<InstructionHistory::Entry> InstructionHistory::Buffer::getLast(size_t count) const
+{
+	// only decode the blocks we need
+	auto it = blocks.end();
+	size_t n = 0;
+	while ((it != blocks.begin()) && (n < count)) {
+		--it;
+		n += it->count;
+	}
+	std::vector<Entry> result;
+	result.reserve(n);
+	for (/**/; it != blocks.end(); ++it) {
+		Decoder decoder(it->data);
+		while (!decoder.atEnd()) result.push_back(decoder.next());
+	}
+	if (result.size() > count) {
+		result.erase(result.begin(), result.end() - narrow<ptrdiff_t>(count));
+	}
+	return result;
+}
+
+
+// class InstructionHistory
+
+InstructionHistory::InstructionHistory(Debugger& debugger_)
+	: debugger(debugger_)
+{
+}
+
+InstructionHistory::~InstructionHistory()
+{
+	assert(!cpu);
+}
+
+void InstructionHistory::start(unsigned depth_, const std::string& filename_)
+{
+	stop();
+	buffer.setDepth(std::max(depth_, BLOCK_SIZE));
+	if (!filename_.empty()) {
+		file = FileOperations::openFile(filename_, "wb");
+		if (!file) {
+			throw MSXException("Couldn't open file for writing: ", filename_);
+		}
+		writeHeader(file.get());
+		filename = filename_;
+	}
+	startNewBlock = true;
+	attachCPU();
+}
+
+void InstructionHistory::attachCPU()
+{
+	auto& motherBoard = debugger.getMotherBoard();
+	cpuInterface = &motherBoard.getCPUInterface();
+	cpu = &motherBoard.getCPU();
+	cpu->setInstructionHistory(this);
+	cpu->exitCPULoopSync(); // switch to the single-step loop
+}
+
+void InstructionHistory::stop()
+{
+	if (!cpu) return;
+	cpu->setInstructionHistory(nullptr);
+	cpu->exitCPULoopSync();
+	cpuDeleted();
+}
+
+void InstructionHistory::cpuDeleted()
+{
+	// the CPU is (possibly) already destroyed, don't touch it anymore
+	cpu = nullptr;
+	cpuInterface = nullptr;
+	if (file) {
+		// the remaining instructions, the block may not be full
+		streamBlock();
+		file.reset();
+	}
+	startNewBlock = true;
+}
+
+void InstructionHistory::clear()
+{
+	buffer.clear();
+	startNewBlock = true;
+}
+
+void InstructionHistory::transfer(InstructionHistory& other)
+{
+	assert(!cpu);
+	bool wasRunning = other.isRunning();
+	if (wasRunning && other.file) {
+		// The file keeps the instructions that are dropped below, the
+		// time of the next block then jumps back.
+		other.streamBlock();
+		file = std::move(other.file);
+		filename = std::move(other.filename);
+	}
+	buffer = std::move(other.buffer);
+	other.clear();
+
+	auto& motherBoard = debugger.getMotherBoard();
+	buffer.truncate(motherBoard.getCurrentTime());
+	startNewBlock = true;
+	if (wasRunning) attachCPU();
+}
+
+void InstructionHistory::streamBlock()
+{
+	// when 'startNewBlock' is set, the last block was already written
+	const auto& blocks = buffer.getBlocks();
+	if (!file || startNewBlock || blocks.empty() || blocks.back().count == 0) return;
+	try {
+		writeBlock(file.get(), blocks.back());
+	} catch (MSXException& e) {
+		debugger.getMotherBoard().getMSXCliComm().printWarning(
+			"Stopped writing the instruction history to ", filename, ": ", e.getMessage());
+		file.reset();
+	}
+}
+
+void InstructionHistory::record(const CPURegs& r, EmuTime time)
+{
+	if (startNewBlock || buffer.isLastBlockFull()) [[unlikely]] {
+		streamBlock();
+		buffer.beginBlock(time);
+		startNewBlock = false;
+	}
+	Entry entry{.time = time, .regs = getRegisters(r), .pc = r.getPC()};
+	for (auto i : xrange(4)) {
+		entry.opcode[i] = cpuInterface->peekMem(uint16_t(entry.pc + i), time);
+	}
+	entry.length = narrow<uint8_t>(instructionLength(entry.opcode).value_or(1));
+	buffer.append(entry);
+}
+
+void InstructionHistory::forEach(std::function<void(const Entry&)> callback) const
+{
+	buffer.forEach(callback);
+}
+
+std::vector<InstructionHistory::Entry> InstructionHistory::getLast(size_t count) const
+{
+	return buffer.getLast(count);
+}
+
+void InstructionHistory::writeHeader(FILE* f)
+{
+	if (fwrite(SIGNATURE.data(), SIGNATURE.size(), 1, f) != 1) {
+		throw MSXException("Error while writing instruction history.");
+	}
+}
+
+void InstructionHistory::writeBlock(FILE* f, const Buffer::Block& block)
+{
+	auto rawSize = narrow<int>(block.data.size());
+	std::vector<uint8_t> buf(8 + LZ4::compressBound(rawSize));
+	auto compressedSize = LZ4::compress(block.data.data(), buf.data() + 8, rawSize);
+	Endian::write_UA_L32(&buf[0], uint32_t(rawSize));
+	Endian::write_UA_L32(&buf[4], uint32_t(compressedSize));
+	if (fwrite(buf.data(), 8 + compressedSize, 1, f) != 1) {
+		throw MSXException("Error while writing instruction history.");
+	}
+}
+
+void InstructionHistory::save(zstring_view filename_) const
+{
+	auto f = FileOperations::openFile(filename_, "wb");
+	if (!f) throw MSXException("Couldn't open file for writing: ", filename_);
+	writeHeader(f.get());
+	for (const auto& block : buffer.getBlocks()) {
+		if (block.count) writeBlock(f.get(), block);
+	}
+}
+
+void InstructionHistory::readFile(zstring_view filename_, std::function<void(const Entry&)> callback)
+{
+	auto f = FileOperations::openFile(filename_, "rb");
+	if (!f) throw MSXException("Couldn't open file for reading: ", filename_);
+
+	std::array<char, SIGNATURE.size()> signature;
+	if ((fread(signature.data(), signature.size(), 1, f.get()) != 1) ||
+	    (std::string_view(signature.data(), signature.size()) != SIGNATURE)) {
+		throw MSXException("Not an instruction history file: ", filename_);
+	}
+	std::vector<uint8_t> compressed;
+	std::vector<uint8_t> raw;
+	while (true) {
+		std::array<uint8_t, 8> sizes;
+		auto r = fread(sizes.data(), 1, sizes.size(), f.get());
+		if (r == 0) break; // end of file
+		if (r != sizes.size()) throw MSXException("Truncated instruction history file.");
+		auto rawSize        = Endian::read_UA_L32(&sizes[0]);
+		auto compressedSize = Endian::read_UA_L32(&sizes[4]);
+		if ((rawSize > MAX_BLOCK_SIZE) || (compressedSize > uint32_t(LZ4::compressBound(int(rawSize))))) {
+			throw MSXException("Corrupt instruction history file.");
+		}
+		compressed.resize(compressedSize);
+		raw.resize(rawSize);
+		if (fread(compressed.data(), compressedSize, 1, f.get()) != 1) {
+			throw MSXException("Truncated instruction history file.");
+		}
+		// our LZ4 decompressor has no safety checks of its own
+		if (!LZ4::isValid(compressed.data(), int(compressedSize), int(rawSize))) {
+			throw MSXException("Corrupt instruction history file.");
+		}
+		LZ4::decompress(compressed.data(), raw.data(), int(compressedSize), int(rawSize));
+		Decoder decoder(raw);
+		while (!decoder.atEnd()) callback(decoder.next());
+	}
+}
+
+void InstructionHistory::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	auto& cmd = debugger.cmd;
+	auto& interp = cmd.getInterpreter();
+	cmd.checkNumArgs(tokens, Completer::AtLeast{3}, "subcommand ?arg ...?");
+	auto toTcl = [](const Entry& e) {
+		TclObject bytes;
+		bytes.addListElements(std::span{e.opcode.data(), e.length});
+		TclObject regs;
+		for (auto i : xrange(size_t(NUM_REGS))) {
+			regs.addDictKeyValue(regNames[i], e.regs[i]);
+		}
+		return makeTclList(e.time.toDouble(), e.pc, bytes, regs);
+	};
+	cmd.executeSubCommand(tokens[2].getString(),
+		"start", [&]{
+			int newDepth = DEFAULT_DEPTH;
+			std::string_view fileArg;
+			std::array info = {valueArg("-depth", newDepth), valueArg("-file", fileArg)};
+			auto arguments = parseTclArgs(interp, tokens.subspan(3), info);
+			if (!arguments.empty()) throw SyntaxError();
+			if (newDepth <= 0) throw CommandException("Depth must be positive.");
+			try {
+				start(narrow<unsigned>(newDepth),
+				      fileArg.empty() ? std::string{} : FileOperations::expandTilde(std::string(fileArg)));
+			} catch (MSXException& e) {
+				throw CommandException(e.getMessage());
+			}
+		},
+		"stop", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			stop();
+		},
+		"clear", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			clear();
+		},
+		"running", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			result = isRunning();
+		},
+		"size", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			result = size();
+		},
+		"list", [&]{
+			cmd.checkNumArgs(tokens, Completer::Between{3, 4}, "?count?");
+			size_t count = 20;
+			if (tokens.size() == 4) {
+				auto c = tokens[3].getInt(interp);
+				if (c < 0) throw CommandException("Count must be positive.");
+				count = size_t(c);
+			}
+			for (const auto& e : getLast(count)) {
+				result.addListElement(toTcl(e));
+			}
+		},
+		"save", [&]{
+			cmd.checkNumArgs(tokens, 4, "filename");
+			auto saveName = FileOperations::expandTilde(std::string(tokens[3].getString()));
+			try {
+				save(saveName);
+			} catch (MSXException& e) {
+				throw CommandException(e.getMessage());
+			}
+			result = saveName;
+		});
+}
+
+void InstructionHistory::tabCompletion(std::vector<std::string>& tokens) const
+{
+	static constexpr std::array cmds = {
+		"start"sv, "stop"sv, "clear"sv, "running"sv, "size"sv, "list"sv, "save"sv,
+	};
+	auto& cmd = debugger.cmd;
+	if (tokens.size() == 3) {
+		cmd.completeString(tokens, cmds);
+	} else if (tokens[2] == "start") {
+		if (tokens[tokens.size() - 2] == "-file") {
+			cmd.completeFileName(tokens, userFileContext());
+		} else {
+			static constexpr std::array options = {"-depth"sv, "-file"sv};
+			cmd.completeString(tokens, options);
+		}
+	} else if ((tokens[2] == "save") && (tokens.size() == 4)) {
+		cmd.completeFileName(tokens, userFileContext());
+	}
+}
+
+std::string InstructionHistory::help(std::span<const TclObject> tokens) const
+{
+	constexpr auto generalHelp =
+		"debug history <subcommand> [<arguments>]\n"
+		"  Record the executed CPU instructions. Possible subcommands are:\n"
+		"    start    start recording\n"
+		"    stop     stop recording\n"
+		"    clear    drop the recorded instructions\n"
+		"    running  is the recorder running?\n"
+		"    size     the number of recorded instructions (in memory)\n"
+		"    list     show the last recorded instructions\n"
+		"    save     write the recorded instructions to a file\n"
+		"  Type 'help debug history <subcommand>' for help about a specific subcommand.\n";
+
+	constexpr auto startHelp =
+		"debug history start [-depth <count>] [-file <filename>]\n"
+		"  Start recording all executed instructions (this slows down emulation).\n"
+		"  The last <count> instructions (default 1000000) are kept in memory.\n"
+		"  With -file, all instructions are also written (LZ4 compressed) to the\n"
+		"  given file.\n";
+
+	constexpr auto listHelp =
+		"debug history list [<count>]\n"
+		"  Returns the last <count> (default 20) recorded instructions. Per\n"
+		"  instruction: time, PC, the opcode bytes and a dict with the registers\n"
+		"  before the instruction was executed. Register MISC contains I (bit\n"
+		"  8-15), IM (bit 2-3), IFF2 (bit 1) and IFF1 (bit 0).\n";
+
+	constexpr auto saveHelp =
+		"debug history save <filename>\n"
+		"  Write the recorded instructions in memory to a file, in the same\n"
+		"  format as 'debug history start -file'.\n";
+
+	constexpr auto simpleHelp =
+		"debug history stop|clear|running|size\n"
+		"  Stop recording, drop all recorded instructions or query the state of\n"
+		"  the recorder.\n";
+
+	auto numTokens = tokens.size();
+	assert(numTokens >= 2);
+	if (numTokens == 2) {
+		return generalHelp;
+	} else if (tokens[2] == "start") {
+		return startHelp;
+	} else if (tokens[2] == "list") {
+		return listHelp;
+	} else if (tokens[2] == "save") {
+		return saveHelp;
+	} else if (tokens[2] == one_of("stop", "clear", "running", "size")) {
+		return simpleHelp;
+	} else {
+		return "Unknown subcommand, use 'help debug history' to see a list of valid subcommands.\n";
+	}
+}
+
+} // namespace openmsx
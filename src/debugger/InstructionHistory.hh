@@ -0,0 +1,192 @@
+#ifndef INSTRUCTIONHISTORY_HH
+#define INSTRUCTIONHISTORY_HH
+
+#include "EmuTime.hh"
+#include "FileOperations.hh"
+
+#include "zstring_view.hh"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class CPURegs;
+class Debugger;
+class MSXCPU;
+class MSXCPUInterface;
+class TclObject;
+
+/** Records every executed CPU instruction, in a compact binary format.
+  *
+  * While recording the CPU single-steps (like with breakpoints), and before
+  * each instruction it reports its PC, opcode bytes and registers. These
+  * are stored in blocks of (at most) BLOCK_SIZE instructions. Each block
+  * starts with the absolute time; per instruction only the differences
+  * with the previous instruction are stored:
+  *
+  *   flags     1 byte: bit 0-1: instruction length - 1
+  *                     bit 2:   PC is stored (not the previous PC + length)
+  *                     bit 3:   register mask for registers 0-7 follows
+  *                     bit 4:   register mask for registers 8-11 follows
+  *   time      varint (LEB128): EmuTime ticks since the previous instruction
+  *   [pc]      2 bytes
+  *   opcode    1-4 bytes
+  *   [mask]    1 byte, for each set bit a 2 byte register value
+  *   [mask]    1 byte, idem for the registers 8-11
+  * All multi-byte values are little endian. The first instruction in a
+  * block stores the PC and all registers. Typically an instruction takes
+  * 6 to 10 bytes.
+  *
+  * Only the most recent blocks (the 'depth') are kept in memory. Optionally
+  * all blocks are also streamed to disk, LZ4 compressed. The file starts
+  * with the 8 byte signature "OMSXITR1", followed by the blocks, each
+  * prefixed by its uncompressed and compressed size (2 x 4 bytes).
+  *
+  * The Decoder and readFile() can be used to read back the data, e.g. by
+  * GUI viewers or by offline tools.
+  */
+class InstructionHistory
+{
+public:
+	enum Reg : uint8_t {
+		AF, BC, DE, HL, IX, IY, SP, AF2,
+		BC2, DE2, HL2, MISC, // MISC: I in the high byte, IM in bit 2-3, IFF2 in bit 1, IFF1 in bit 0
+		NUM_REGS
+	};
+	using Registers = std::array<uint16_t, NUM_REGS>;
+
+	struct Entry {
+		EmuTime time = EmuTime::zero(); // start of the instruction
+		Registers regs = {}; // before the instruction was executed
+		uint16_t pc = 0;
+		uint8_t length = 0;
+		std::array<uint8_t, 4> opcode = {};
+	};
+
+	/** Decodes one block. */
+	class Decoder {
+	public:
+		explicit Decoder(std::span<const uint8_t> block);
+		[[nodiscard]] bool atEnd() const { return data.empty(); }
+		/** The number of not yet decoded bytes. */
+		[[nodiscard]] size_t bytesLeft() const { return data.size(); }
+		/** Decode the next instruction. Throws MSXException on corrupt data. */
+		const Entry& next();
+
+	private:
+		[[nodiscard]] uint8_t get8();
+		[[nodiscard]] uint16_t get16();
+		[[nodiscard]] uint64_t getVarint();
+
+		std::span<const uint8_t> data;
+		Entry entry;
+		bool first = true;
+	};
+
+	static constexpr unsigned BLOCK_SIZE = 4096; // instructions
+	static constexpr unsigned DEFAULT_DEPTH = 1'000'000; // instructions
+
+	/** The instructions in memory, encoded in blocks. */
+	class Buffer {
+	public:
+		struct Block {
+			std::vector<uint8_t> data;
+			unsigned count = 0;
+		};
+
+		/** Keep (at least) the last 'depth' instructions. */
+		void setDepth(unsigned depth_) { depth = depth_; }
+		[[nodiscard]] size_t size() const { return numInstructions; }
+		[[nodiscard]] const std::deque<Block>& getBlocks() const { return blocks; }
+		[[nodiscard]] bool isLastBlockFull() const {
+			return blocks.empty() || (blocks.back().count == BLOCK_SIZE);
+		}
+
+		/** Start a new block, and drop the oldest blocks that are no
+		  * longer needed to keep 'depth' instructions. */
+		void beginBlock(EmuTime time);
+		/** Append an instruction to the last block. */
+		void append(const Entry& entry);
+		/** Drop the instructions that started at or after 'time'. */
+		void truncate(EmuTime time);
+		void clear();
+
+		void forEach(const std::function<void(const Entry&)>& callback) const;
+		[[nodiscard]] std::vector<Entry> getLast(size_t count) const;
+
+	private:
+		std::deque<Block> blocks; // the last one is being filled
+		std::vector<uint8_t> spare; // buffer of a dropped block, for reuse
+		size_t numInstructions = 0; // in 'blocks'
+		unsigned depth = DEFAULT_DEPTH;
+		Entry prev; // the last appended instruction
+	};
+
+public:
+	explicit InstructionHistory(Debugger& debugger);
+	InstructionHistory(const InstructionHistory&) = delete;
+	InstructionHistory(InstructionHistory&&) = delete;
+	InstructionHistory& operator=(const InstructionHistory&) = delete;
+	InstructionHistory& operator=(InstructionHistory&&) = delete;
+	~InstructionHistory();
+
+	void execute(std::span<const TclObject> tokens, TclObject& result);
+	void tabCompletion(std::vector<std::string>& tokens) const;
+	[[nodiscard]] std::string help(std::span<const TclObject> tokens) const;
+
+	/** Start recording, keep (at least) the last 'depth' instructions in
+	  * memory. When 'filename' is not empty, also stream to that file. */
+	void start(unsigned depth, const std::string& filename = {});
+	void stop();
+	void clear();
+	[[nodiscard]] bool isRunning() const { return cpu != nullptr; }
+	[[nodiscard]] size_t size() const { return buffer.size(); }
+
+	/** Called when the CPU is about to be deleted. */
+	void cpuDeleted();
+	/** Take over the recorded history of another machine (e.g. on
+	  * reverse), but drop the instructions after the current time of this
+	  * machine. When the other machine was recording, continue recording on
+	  * this machine (and continue streaming to the same file). */
+	void transfer(InstructionHistory& other);
+
+	// called by the CPU, before each instruction
+	void record(const CPURegs& regs, EmuTime time);
+
+	/** Visit all instructions in memory, oldest first. */
+	void forEach(std::function<void(const Entry&)> callback) const;
+	/** The last (at most) 'count' instructions, oldest first. */
+	[[nodiscard]] std::vector<Entry> getLast(size_t count) const;
+
+	/** Write the instructions in memory to a file (same format as when
+	  * streaming). */
+	void save(zstring_view filename) const;
+	/** Read a file written by save() or by streaming. */
+	static void readFile(zstring_view filename, std::function<void(const Entry&)> callback);
+
+private:
+	void attachCPU();
+	void streamBlock();
+	static void writeHeader(FILE* f);
+	static void writeBlock(FILE* f, const Buffer::Block& block);
+
+	Debugger& debugger;
+	MSXCPU* cpu = nullptr; // only non-nullptr while recording
+	MSXCPUInterface* cpuInterface = nullptr; // idem
+
+	Buffer buffer;
+	bool startNewBlock = false; // don't append to the last block
+
+	FileOperations::FILE_t file; // only when streaming
+	std::string filename;
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,496 @@
+#include "MemorySearch.hh"
+
+#include "Debuggable.hh"
+#include "Debugger.hh"
+
+#include "CommandException.hh"
+#include "Interpreter.hh"
+#include "MSXException.hh"
+#include "TclArgParser.hh"
+#include "TclObject.hh"
+
+#include "one_of.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <numeric>
+#include <ranges>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std::literals;
+
+namespace openmsx {
+
+using Op = MemorySearch::Op;
+
+template<Op OP> [[nodiscard]] static inline bool compare(unsigned n, unsigned o)
+{
+	if constexpr (OP == Op::EQ) return n == o;
+	if constexpr (OP == Op::NE) return n != o;
+	if constexpr (OP == Op::LT) return n <  o;
+	if constexpr (OP == Op::LE) return n <= o;
+	if constexpr (OP == Op::GT) return n >  o;
+	if constexpr (OP == Op::GE) return n >= o;
+}
+
+#ifdef __SSE2__
+// Compare 16 unsigned bytes, returns a bitmask.
+template<Op OP> [[nodiscard]] static inline unsigned compare(__m128i n, __m128i o)
+{
+	if constexpr ((OP == Op::EQ) || (OP == Op::NE)) {
+		unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(n, o));
+		return (OP == Op::EQ) ? m : (~m & 0xffff);
+	} else if constexpr ((OP == Op::GE) || (OP == Op::LT)) {
+		// n >= o  <=>  max(n, o) == n
+		unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(n, o), n));
+		return (OP == Op::GE) ? m : (~m & 0xffff);
+	} else {
+		// n <= o  <=>  min(n, o) == n
+		unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(n, o), n));
+		return (OP == Op::LE) ? m : (~m & 0xffff);
+	}
+}
+#endif
+
+// Compare 64 bytes at a time, and only for words that still have candidates.
+// When CONSTANT, compare against 'value' instead of 'oldData'.
+template<Op OP, bool CONSTANT>
+static void filter8(std::span<uint64_t> candidates, const uint8_t* newData,
+                    const uint8_t* oldData, uint8_t value)
+{
+	for (auto w : xrange(candidates.size())) {
+		auto& c = candidates[w];
+		if (c == 0) continue;
+		const uint8_t* n = newData + 64 * w;
+		uint64_t mask = 0;
+#ifdef __SSE2__
+		for (auto i : xrange(4)) {
+			auto vn = _mm_loadu_si128(reinterpret_cast<const __m128i*>(n + 16 * i));
+			__m128i vo;
+			if constexpr (CONSTANT) {
+				vo = _mm_set1_epi8(char(value));
+			} else {
+				vo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(oldData + 64 * w + 16 * i));
+			}
+			mask |= uint64_t(compare<OP>(vn, vo)) << (16 * i);
+		}
+#else
+		for (auto i : xrange(64)) {
+			unsigned o = CONSTANT ? value : oldData[64 * w + i];
+			mask |= uint64_t(compare<OP>(n[i], o)) << i;
+		}
+#endif
+		c &= mask;
+	}
+}
+
+template<bool CONSTANT>
+static void filter8(Op op, std::span<uint64_t> candidates, const uint8_t* newData,
+                    const uint8_t* oldData, uint8_t value)
+{
+	switch (op) {
+	using enum Op;
+	case EQ: filter8<EQ, CONSTANT>(candidates, newData, oldData, value); break;
+	case NE: filter8<NE, CONSTANT>(candidates, newData, oldData, value); break;
+	case LT: filter8<LT, CONSTANT>(candidates, newData, oldData, value); break;
+	case LE: filter8<LE, CONSTANT>(candidates, newData, oldData, value); break;
+	case GT: filter8<GT, CONSTANT>(candidates, newData, oldData, value); break;
+	case GE: filter8<GE, CONSTANT>(candidates, newData, oldData, value); break;
+	}
+}
+
+[[nodiscard]] static inline unsigned read16(const uint8_t* data, unsigned address)
+{
+	return data[address] | (data[address + 1] << 8);
+}
+
+// Words are unaligned, so simply visit each remaining candidate.
+template<Op OP>
+static void filter16(std::span<uint64_t> candidates, const uint8_t* newData,
+                     const uint8_t* oldData, std::optional<unsigned> value)
+{
+	for (auto w : xrange(candidates.size())) {
+		auto c = candidates[w];
+		auto keep = c;
+		while (c) {
+			auto b = std::countr_zero(c);
+			c &= c - 1;
+			auto address = unsigned(64 * w + b);
+			auto n = read16(newData, address);
+			auto o = value ? *value : read16(oldData, address);
+			if (!compare<OP>(n, o)) keep &= ~(uint64_t(1) << b);
+		}
+		candidates[w] = keep;
+	}
+}
+
+static void filter16(Op op, std::span<uint64_t> candidates, const uint8_t* newData,
+                     const uint8_t* oldData, std::optional<unsigned> value)
+{
+	switch (op) {
+	using enum Op;
+	case EQ: filter16<EQ>(candidates, newData, oldData, value); break;
+	case NE: filter16<NE>(candidates, newData, oldData, value); break;
+	case LT: filter16<LT>(candidates, newData, oldData, value); break;
+	case LE: filter16<LE>(candidates, newData, oldData, value); break;
+	case GT: filter16<GT>(candidates, newData, oldData, value); break;
+	case GE: filter16<GE>(candidates, newData, oldData, value); break;
+	}
+}
+
+
+void filterCandidates(Op op, unsigned bits, std::span<uint64_t> candidates,
+                      const uint8_t* newData, const uint8_t* oldData,
+                      std::optional<unsigned> value)
+{
+	if (bits == 8) {
+		if (value) {
+			filter8<true >(op, candidates, newData, nullptr, uint8_t(*value));
+		} else {
+			filter8<false>(op, candidates, newData, oldData, 0);
+		}
+	} else {
+		filter16(op, candidates, newData, oldData, value);
+	}
+}
+
+
+// class MemorySearch::State
+
+void MemorySearch::State::start(std::span<const uint8_t> data, unsigned bits_)
+{
+	assert(bits_ == one_of(8u, 16u));
+	auto newSize = unsigned(data.size());
+	unsigned numLocations = (bits_ == 8) ? newSize : (newSize - 1);
+	assert((newSize != 0) && (numLocations != 0));
+
+	bits = bits_;
+	size = newSize;
+	auto paddedSize = (size + 63) & ~63u;
+	lastSnapshot.assign(paddedSize, 0);
+	std::ranges::copy(data, lastSnapshot.begin());
+	prevSnapshot = lastSnapshot;
+
+	candidates.assign(paddedSize / 64, 0);
+	for (auto w : xrange(numLocations / 64)) {
+		candidates[w] = ~uint64_t(0);
+	}
+	if (auto rest = numLocations % 64) {
+		candidates[numLocations / 64] = (uint64_t(1) << rest) - 1;
+	}
+}
+
+void MemorySearch::State::filter(Op op, std::optional<unsigned> value)
+{
+	filterCandidates(op, bits, candidates, lastSnapshot.data(), prevSnapshot.data(), value);
+}
+
+void MemorySearch::State::retain(std::span<const unsigned> addresses)
+{
+	std::vector<uint64_t> keep(candidates.size(), 0);
+	for (auto a : addresses) {
+		if (a < size) keep[a / 64] |= uint64_t(1) << (a % 64);
+	}
+	for (auto w : xrange(candidates.size())) {
+		candidates[w] &= keep[w];
+	}
+}
+
+void MemorySearch::State::clear()
+{
+	size = 0;
+	prevSnapshot.clear();
+	lastSnapshot.clear();
+	candidates.clear();
+}
+
+size_t MemorySearch::State::count() const
+{
+	return std::transform_reduce(candidates.begin(), candidates.end(), size_t(0), std::plus{},
+	                             [](uint64_t c) { return size_t(std::popcount(c)); });
+}
+
+unsigned MemorySearch::State::getValue(std::span<const uint8_t> data, unsigned address) const
+{
+	return (bits == 8) ? data[address] : read16(data.data(), address);
+}
+
+std::vector<MemorySearch::Result> MemorySearch::State::getResults(size_t max) const
+{
+	std::vector<Result> result;
+	for (auto w : xrange(candidates.size())) {
+		auto c = candidates[w];
+		while (c) {
+			if (result.size() == max) return result;
+			auto address = unsigned(64 * w + std::countr_zero(c));
+			c &= c - 1;
+			result.push_back(Result{address,
+			                        getValue(prevSnapshot, address),
+			                        getValue(lastSnapshot, address)});
+		}
+	}
+	return result;
+}
+
+
+// class MemorySearch
+
+MemorySearch::MemorySearch(Debugger& debugger_)
+	: debugger(debugger_)
+{
+}
+
+void MemorySearch::start(std::string debuggableName_, unsigned bits_)
+{
+	assert(bits_ == one_of(8u, 16u));
+	auto* debuggable = debugger.findDebuggable(debuggableName_);
+	if (!debuggable) {
+		throw MSXException("No such debuggable: ", debuggableName_);
+	}
+	auto newSize = debuggable->getSize();
+	unsigned numLocations = (bits_ == 8) ? newSize : (newSize - 1);
+	if ((newSize == 0) || (numLocations == 0)) {
+		throw MSXException("Debuggable is too small: ", debuggableName_);
+	}
+
+	debuggableName = std::move(debuggableName_);
+	std::vector<uint8_t> data(newSize);
+	debuggable->readBlock(0, data);
+	state.start(data, bits_);
+}
+
+void MemorySearch::clear()
+{
+	debuggableName.clear();
+	state.clear();
+}
+
+void MemorySearch::takeSnapshot()
+{
+	assert(isActive());
+	auto* debuggable = debugger.findDebuggable(debuggableName);
+	if (!debuggable) {
+		throw MSXException("Debuggable doesn't exist anymore: ", debuggableName);
+	}
+	if (debuggable->getSize() != state.getSize()) {
+		throw MSXException("Size of debuggable has changed: ", debuggableName);
+	}
+	state.update([&](std::span<uint8_t> output) {
+		debuggable->readBlock(0, output);
+	});
+}
+
+void MemorySearch::update()
+{
+	takeSnapshot();
+}
+
+void MemorySearch::search(Op op, std::optional<unsigned> value)
+{
+	auto bits = getBits();
+	if (value && (*value >= (1u << bits))) {
+		throw MSXException("Value out of range for a ", bits, "-bit search: ", *value);
+	}
+	takeSnapshot();
+	state.filter(op, value);
+}
+
+void MemorySearch::retain(std::span<const unsigned> addresses)
+{
+	state.retain(addresses);
+}
+
+void MemorySearch::transfer(const MemorySearch& other)
+{
+	debuggableName = other.debuggableName;
+	state = other.state;
+}
+
+std::optional<Op> MemorySearch::parseOp(std::string_view str)
+{
+	using enum Op;
+	if (str == "==") return EQ;
+	if (str == "!=") return NE;
+	if (str == "<")  return LT;
+	if (str == "<=") return LE;
+	if (str == ">")  return GT;
+	if (str == ">=") return GE;
+	return {};
+}
+
+void MemorySearch::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	auto& cmd = debugger.cmd;
+	auto& interp = cmd.getInterpreter();
+	cmd.checkNumArgs(tokens, Completer::AtLeast{3}, "subcommand ?arg ...?");
+	auto checkActive = [&] {
+		if (!isActive()) {
+			throw CommandException("No search in progress, use 'debug memsearch start' first.");
+		}
+	};
+	auto wrap = [&](auto action) {
+		try {
+			action();
+		} catch (MSXException& e) {
+			throw CommandException(e.getMessage());
+		}
+	};
+	cmd.executeSubCommand(tokens[2].getString(),
+		"start", [&]{
+			std::string_view name = "memory";
+			int newBits = 8;
+			std::array info = {valueArg("-debuggable", name), valueArg("-bits", newBits)};
+			auto arguments = parseTclArgs(interp, tokens.subspan(3), info);
+			if (!arguments.empty()) throw SyntaxError();
+			if (newBits != one_of(8, 16)) throw CommandException("Bits must be 8 or 16.");
+			wrap([&]{ start(std::string(name), unsigned(newBits)); });
+		},
+		"search", [&]{
+			cmd.checkNumArgs(tokens, Completer::Between{4, 5}, "operator ?value?");
+			checkActive();
+			auto op = parseOp(tokens[3].getString());
+			if (!op) throw CommandException("Invalid operator: ", tokens[3].getString());
+			std::optional<unsigned> value;
+			if (tokens.size() == 5) {
+				auto v = tokens[4].getInt(interp);
+				if (v < 0) throw CommandException("Value must be positive.");
+				value = unsigned(v);
+			}
+			wrap([&]{ search(*op, value); });
+			result = count();
+		},
+		"update", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			checkActive();
+			wrap([&]{ update(); });
+		},
+		"retain", [&]{
+			cmd.checkNumArgs(tokens, 4, "addresses");
+			checkActive();
+			std::vector<unsigned> addresses;
+			for (auto i : xrange(tokens[3].getListLength(interp))) {
+				auto a = tokens[3].getListIndex(interp, i).getInt(interp);
+				if (a >= 0) addresses.push_back(unsigned(a));
+			}
+			retain(addresses);
+			result = count();
+		},
+		"results", [&]{
+			cmd.checkNumArgs(tokens, Completer::Between{3, 4}, "?max?");
+			checkActive();
+			size_t max = size_t(-1);
+			if (tokens.size() == 4) {
+				auto m = tokens[3].getInt(interp);
+				if (m < 0) throw CommandException("Max must be positive.");
+				max = size_t(m);
+			}
+			for (const auto& r : getResults(max)) {
+				result.addListElement(makeTclList(r.address, r.oldValue, r.newValue));
+			}
+		},
+		"count", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			result = isActive() ? count() : 0;
+		},
+		"active", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			result = isActive();
+		},
+		"clear", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			clear();
+		});
+}
+
+void MemorySearch::tabCompletion(std::vector<std::string>& tokens) const
+{
+	static constexpr std::array cmds = {
+		"start"sv, "search"sv, "update"sv, "retain"sv, "results"sv,
+		"count"sv, "active"sv, "clear"sv,
+	};
+	auto& cmd = debugger.cmd;
+	if (tokens.size() == 3) {
+		cmd.completeString(tokens, cmds);
+	} else if (tokens[2] == "start") {
+		if (tokens[tokens.size() - 2] == "-debuggable") {
+			cmd.completeString(tokens, std::views::keys(debugger.getDebuggables()));
+		} else {
+			static constexpr std::array options = {"-debuggable"sv, "-bits"sv};
+			cmd.completeString(tokens, options);
+		}
+	} else if ((tokens[2] == "search") && (tokens.size() == 4)) {
+		static constexpr std::array ops = {"=="sv, "!="sv, "<"sv, "<="sv, ">"sv, ">="sv};
+		cmd.completeString(tokens, ops);
+	}
+}
+
+std::string MemorySearch::help(std::span<const TclObject> tokens) const
+{
+	constexpr auto generalHelp =
+		"debug memsearch <subcommand> [<arguments>]\n"
+		"  Search memory for locations that change in a specific way (e.g. to\n"
+		"  find cheats). Possible subcommands are:\n"
+		"    start    start a new search\n"
+		"    search   keep the locations that match a comparison\n"
+		"    update   take a new snapshot, without dropping locations\n"
+		"    retain   only keep the given locations\n"
+		"    results  get the remaining locations\n"
+		"    count    the number of remaining locations\n"
+		"    active   is a search in progress?\n"
+		"    clear    stop the search\n"
+		"  Type 'help debug memsearch <subcommand>' for help about a specific subcommand.\n";
+
+	constexpr auto startHelp =
+		"debug memsearch start [-debuggable <name>] [-bits 8|16]\n"
+		"  Take a snapshot of the given debuggable (default 'memory') and make\n"
+		"  all locations a candidate. Values are 8-bit (default) or little\n"
+		"  endian 16-bit.\n";
+
+	constexpr auto searchHelp =
+		"debug memsearch search <operator> [<value>]\n"
+		"  Take a new snapshot and only keep the locations for which\n"
+		"  '<new> <operator> <old>' holds, or '<new> <operator> <value>' when a\n"
+		"  value is given. Operator is one of == != < <= > >=. Returns the\n"
+		"  number of remaining locations.\n";
+
+	constexpr auto retainHelp =
+		"debug memsearch retain <addresses>\n"
+		"  Only keep the locations that are in the given list. Together with\n"
+		"  'update' and 'results' this allows arbitrary (Tcl) search criteria.\n"
+		"  Returns the number of remaining locations.\n";
+
+	constexpr auto resultsHelp =
+		"debug memsearch results [<max>]\n"
+		"  Returns the first <max> (default all) remaining locations, as a list\n"
+		"  of {<address> <old> <new>} triples. <old> is the value in the\n"
+		"  snapshot before the last one.\n";
+
+	constexpr auto simpleHelp =
+		"debug memsearch update|count|active|clear\n"
+		"  Take a new snapshot, query the state of the search or stop it.\n";
+
+	auto numTokens = tokens.size();
+	assert(numTokens >= 2);
+	if (numTokens == 2) {
+		return generalHelp;
+	} else if (tokens[2] == "start") {
+		return startHelp;
+	} else if (tokens[2] == "search") {
+		return searchHelp;
+	} else if (tokens[2] == "retain") {
+		return retainHelp;
+	} else if (tokens[2] == "results") {
+		return resultsHelp;
+	} else if (tokens[2] == one_of("update", "count", "active", "clear")) {
+		return simpleHelp;
+	} else {
+		return "Unknown subcommand, use 'help debug memsearch' to see a list of valid subcommands.\n";
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,132 @@
+#ifndef MEMORYSEARCH_HH
+#define MEMORYSEARCH_HH
+
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class Debugger;
+class TclObject;
+
+/** Searches a debuggable (typically 'memory' or a memory mapper) for
+  * locations whose value changes in a specific way, e.g. to find the
+  * location of the number of lives in a game (a.k.a. cheat finder).
+  *
+  * A search starts with a snapshot of the debuggable, and with all
+  * locations as candidate. Each search step takes a new snapshot and keeps
+  * only the candidates for which 'new <op> old' or 'new <op> value' holds.
+  * Values are 8-bit or (little endian) 16-bit. The candidates are stored
+  * as a bitset, and the 8-bit comparisons are done on 64 locations at a
+  * time (using SSE2 when available). Words without any candidate are
+  * skipped, so later search steps are very fast.
+  */
+class MemorySearch
+{
+public:
+	enum class Op : uint8_t { EQ, NE, LT, LE, GT, GE };
+	struct Result {
+		unsigned address;
+		unsigned oldValue;
+		unsigned newValue;
+	};
+
+	/** The snapshots and the candidates, independent of where the
+	  * snapshots come from. */
+	class State {
+	public:
+		/** Start a new search on a first snapshot, with 8 or 16 bit
+		  * values. All locations are candidates. */
+		void start(std::span<const uint8_t> data, unsigned bits);
+		/** Take a new snapshot: 'read' must fill the given span (of the
+		  * same size as the first snapshot). */
+		void update(std::invocable<std::span<uint8_t>> auto read) {
+			assert(isActive());
+			std::swap(prevSnapshot, lastSnapshot);
+			read(std::span{lastSnapshot.data(), size});
+		}
+		/** Only keep the candidates for which 'new <op> old' or (when
+		  * given) 'new <op> value' holds, on the last two snapshots. */
+		void filter(Op op, std::optional<unsigned> value);
+		/** Only keep the candidates that are also in 'addresses'. */
+		void retain(std::span<const unsigned> addresses);
+		void clear();
+
+		[[nodiscard]] bool isActive() const { return !candidates.empty(); }
+		[[nodiscard]] unsigned getBits() const { return bits; }
+		[[nodiscard]] unsigned getSize() const { return size; }
+		[[nodiscard]] size_t count() const;
+		[[nodiscard]] std::vector<Result> getResults(size_t max = size_t(-1)) const;
+
+	private:
+		[[nodiscard]] unsigned getValue(std::span<const uint8_t> data, unsigned address) const;
+
+	private:
+		unsigned bits = 8;
+		unsigned size = 0; // size of the snapshots
+		// Both padded to a multiple of 64 bytes.
+		std::vector<uint8_t> prevSnapshot;
+		std::vector<uint8_t> lastSnapshot;
+		std::vector<uint64_t> candidates; // bit per address
+	};
+
+public:
+	explicit MemorySearch(Debugger& debugger);
+
+	void execute(std::span<const TclObject> tokens, TclObject& result);
+	void tabCompletion(std::vector<std::string>& tokens) const;
+	[[nodiscard]] std::string help(std::span<const TclObject> tokens) const;
+
+	/** Start a new search on the given debuggable, with 8 or 16 bit
+	  * values. Throws MSXException when the debuggable doesn't exist. */
+	void start(std::string debuggableName, unsigned bits);
+	/** Take a new snapshot, and only keep the candidates for which
+	  * 'new <op> old' or (when given) 'new <op> value' holds. */
+	void search(Op op, std::optional<unsigned> value = {});
+	/** Take a new snapshot without dropping candidates. */
+	void update();
+	/** Only keep the candidates that are also in 'addresses'. */
+	void retain(std::span<const unsigned> addresses);
+	void clear();
+
+	[[nodiscard]] bool isActive() const { return state.isActive(); }
+	[[nodiscard]] const std::string& getDebuggableName() const { return debuggableName; }
+	[[nodiscard]] unsigned getBits() const { return state.getBits(); }
+	[[nodiscard]] size_t count() const { return state.count(); }
+	/** The first (at most) 'max' candidates, with the value in the
+	  * previous and in the last snapshot. Sorted on address. */
+	[[nodiscard]] std::vector<Result> getResults(size_t max = size_t(-1)) const {
+		return state.getResults(max);
+	}
+
+	/** Copy the search state of another machine. */
+	void transfer(const MemorySearch& other);
+
+	[[nodiscard]] static std::optional<Op> parseOp(std::string_view str);
+
+private:
+	void takeSnapshot();
+
+private:
+	Debugger& debugger;
+
+	std::string debuggableName;
+	State state;
+};
+
+/** The search kernel: only keep the candidates (a bit per location) for
+  * which 'new <op> old' or (when given) 'new <op> value' holds. Both
+  * buffers hold (at least) 64 bytes per word of 'candidates'. For 16-bit
+  * values the byte after each candidate is read as well. */
+void filterCandidates(MemorySearch::Op op, unsigned bits, std::span<uint64_t> candidates,
+                      const uint8_t* newData, const uint8_t* oldData,
+                      std::optional<unsigned> value);
+
+} // namespace openmsx
+
+#endif
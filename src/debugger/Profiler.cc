@@ -0,0 +1,454 @@
+#include "Profiler.hh"
+
+#include "Debugger.hh"
+#include "SymbolManager.hh"
+
+#include "CPURegs.hh"
+#include "CommandException.hh"
+#include "FileOperations.hh"
+#include "Interpreter.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXException.hh"
+#include "MSXMotherBoard.hh"
+#include "Reactor.hh"
+#include "TclArgParser.hh"
+#include "TclObject.hh"
+
+#include "FileContext.hh"
+#include "hash_map.hh"
+#include "narrow.hh"
+#include "one_of.hh"
+#include "stl.hh"
+#include "strCat.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <ranges>
+
+using namespace std::literals;
+
+namespace openmsx {
+
+Profiler::Profiler(Debugger& debugger_)
+	: Schedulable(debugger_.getMotherBoard().getScheduler())
+	, debugger(debugger_)
+	, symbolManager(debugger.getMotherBoard().getReactor().getSymbolManager())
+	, nodes(1)
+{
+}
+
+void Profiler::start(EmuTime time, unsigned intervalCycles)
+{
+	auto& motherBoard = debugger.getMotherBoard();
+	auto& msxCpu = motherBoard.getCPU();
+	if (cpu) stop(time);
+
+	freq = msxCpu.getFreq();
+	interval = EmuDuration::hz(freq) * std::max(intervalCycles, 1u);
+	if (pcSamples.empty()) pcSamples.assign(0x10000, 0);
+	cpu = &msxCpu;
+	cpu->setProfiler(this);
+	schedule(time);
+}
+
+void Profiler::stop(EmuTime time)
+{
+	if (!cpu) return;
+	// account the calls that are still in progress
+	leaveFunction(0xFFFF, time);
+	cpu->setProfiler(nullptr);
+	cpu = nullptr;
+	removeSyncPoints();
+}
+
+void Profiler::cpuDeleted()
+{
+	// the CPU is already (being) destroyed, don't touch it anymore
+	cpu = nullptr;
+	stack.clear();
+	removeSyncPoints();
+}
+
+void Profiler::clear()
+{
+	nodes.assign(1, Node{});
+	stack.clear();
+	std::ranges::fill(pcSamples, 0);
+	totalSamples = 0;
+}
+
+void Profiler::transfer(const Profiler& other)
+{
+	nodes = other.nodes;
+	pcSamples = other.pcSamples;
+	totalSamples = other.totalSamples;
+	freq = other.freq;
+}
+
+void Profiler::schedule(EmuTime time)
+{
+	setSyncPoint(time + interval);
+}
+
+void Profiler::executeUntil(EmuTime time)
+{
+	if (!cpu) return;
+	if (!debugger.getMotherBoard().getCPUInterface().isFastForward()) {
+		auto pc = cpu->getRegisters().getPC();
+		++pcSamples[pc];
+		++nodes[stack.empty() ? ROOT : stack.back().node].samples;
+		++totalSamples;
+	}
+	schedule(time);
+}
+
+// The CPU can run slightly ahead of the time that's passed to Tcl commands.
+[[nodiscard]] static EmuDuration elapsed(EmuTime start, EmuTime end)
+{
+	return (end > start) ? (end - start) : EmuDuration::zero();
+}
+
+unsigned Profiler::getChild(unsigned node, uint16_t address)
+{
+	for (auto child : nodes[node].children) {
+		if (nodes[child].address == address) return child;
+	}
+	auto child = narrow<unsigned>(nodes.size());
+	nodes[node].children.push_back(child);
+	auto& n = nodes.emplace_back();
+	n.address = address;
+	n.parent = node;
+	return child;
+}
+
+void Profiler::enterFunction(uint16_t address, uint16_t sp, EmuTime time)
+{
+	if (stack.size() == MAX_DEPTH) return; // the matching 'ret' won't pop anything
+	if (debugger.getMotherBoard().getCPUInterface().isFastForward()) return;
+	auto node = getChild(stack.empty() ? ROOT : stack.back().node, address);
+	++nodes[node].calls;
+	stack.emplace_back(node, sp, time);
+}
+
+void Profiler::leaveFunction(uint16_t sp, EmuTime time)
+{
+	// The stack grows downwards: deeper calls have a lower stack pointer.
+	// Normally only the top frame gets removed, but all frames whose return
+	// address is at or below the current stack pointer are finished.
+	while (!stack.empty() && (stack.back().sp <= sp)) {
+		const auto& frame = stack.back();
+		nodes[frame.node].time = nodes[frame.node].time + elapsed(frame.start, time);
+		stack.pop_back();
+	}
+}
+
+EmuDuration Profiler::getSelfTime(std::span<const EmuDuration> times, unsigned node) const
+{
+	auto children = EmuDuration::zero();
+	for (auto child : nodes[node].children) children = children + times[child];
+	return (times[node] > children) ? (times[node] - children) : EmuDuration::zero();
+}
+
+std::vector<EmuDuration> Profiler::getNodeTimes(EmuTime time) const
+{
+	auto result = to_vector(std::views::transform(nodes, &Node::time));
+	for (const auto& frame : stack) {
+		result[frame.node] = result[frame.node] + elapsed(frame.start, time);
+	}
+	return result;
+}
+
+uint64_t Profiler::toCycles(EmuDuration d) const
+{
+	return uint64_t(d.toDouble() * freq + 0.5);
+}
+
+std::string Profiler::getFunctionName(uint16_t address) const
+{
+	if (auto syms = symbolManager.lookupValue(address); !syms.empty()) {
+		return syms.front()->name;
+	}
+	// e.g. a function without a label of its own, after a local label
+	if (auto syms = symbolManager.lookupNearest(address); !syms.empty()) {
+		const auto* sym = syms.front();
+		if ((address - sym->value) < 0x100) {
+			return strCat(sym->name, "+0x", hex_string<2>(address - sym->value));
+		}
+	}
+	return strCat("0x", hex_string<4>(address));
+}
+
+std::string Profiler::getPathName(unsigned node) const
+{
+	std::vector<unsigned> path;
+	for (auto n = node; n != ROOT; n = nodes[n].parent) {
+		path.push_back(n);
+	}
+	std::string result = "[toplevel]";
+	for (auto n : std::views::reverse(path)) {
+		strAppend(result, ';', getFunctionName(nodes[n].address));
+	}
+	return result;
+}
+
+std::vector<Profiler::FunctionStats> Profiler::getFunctionStats(EmuTime time) const
+{
+	auto times = getNodeTimes(time);
+	hash_map<uint16_t, FunctionStats> functions;
+	for (auto i : xrange(size_t(1), nodes.size())) {
+		const auto& node = nodes[i];
+		auto [it, inserted] = functions.try_emplace(
+			node.address, FunctionStats{node.address, 0, 0, 0, 0});
+		auto& stats = it->second;
+		stats.calls += node.calls;
+		stats.samples += node.samples;
+
+		stats.selfCycles += toCycles(getSelfTime(times, narrow<unsigned>(i)));
+
+		// for recursive calls only count the outermost call
+		bool recursive = false;
+		for (auto p = node.parent; p != ROOT; p = nodes[p].parent) {
+			if (nodes[p].address == node.address) {
+				recursive = true;
+				break;
+			}
+		}
+		if (!recursive) stats.inclusiveCycles += toCycles(times[i]);
+	}
+	auto result = to_vector(std::views::values(functions));
+	std::ranges::sort(result, std::greater{}, &FunctionStats::selfCycles);
+	return result;
+}
+
+void Profiler::exportFolded(zstring_view filename) const
+{
+	std::ofstream os(filename.c_str());
+	if (!os) throw MSXException("Cannot open file for writing: ", filename);
+
+	for (auto i : xrange(nodes.size())) {
+		if (auto samples = nodes[i].samples) {
+			os << getPathName(narrow<unsigned>(i)) << ' ' << samples << '\n';
+		}
+	}
+	if (!os) throw MSXException("Error while writing file: ", filename);
+}
+
+void Profiler::exportCallgrind(zstring_view filename, EmuTime time) const
+{
+	std::ofstream os(filename.c_str());
+	if (!os) throw MSXException("Cannot open file for writing: ", filename);
+
+	os << "# callgrind format\n"
+	      "version: 1\n"
+	      "creator: openMSX\n"
+	      "positions: line\n"
+	      "events: Cycles Samples\n\n";
+
+	// aggregate per (caller, callee) pair
+	static constexpr uint32_t TOPLEVEL = 0x10000; // not a valid address
+	struct Call {
+		uint32_t callee;
+		uint64_t calls = 0;
+		uint64_t cycles = 0;
+	};
+	struct Function {
+		uint64_t selfCycles = 0;
+		uint64_t samples = 0;
+		std::vector<Call> callees;
+	};
+	auto times = getNodeTimes(time);
+	auto key = [&](unsigned n) {
+		return (n == ROOT) ? TOPLEVEL : uint32_t(nodes[n].address);
+	};
+	hash_map<uint32_t, Function> functions;
+	for (auto i : xrange(narrow<unsigned>(nodes.size()))) {
+		const auto& node = nodes[i];
+		auto& func = functions[key(i)];
+		func.samples += node.samples;
+		if (i != ROOT) func.selfCycles += toCycles(getSelfTime(times, i));
+		for (auto child : node.children) {
+			auto callee = key(child);
+			auto it = std::ranges::find(func.callees, callee, &Call::callee);
+			if (it == func.callees.end()) {
+				it = func.callees.insert(it, Call{callee});
+			}
+			it->calls += nodes[child].calls;
+			it->cycles += toCycles(times[child]);
+		}
+	}
+
+	auto name = [&](uint32_t address) {
+		return (address == TOPLEVEL) ? "[toplevel]"s : getFunctionName(narrow<uint16_t>(address));
+	};
+	for (const auto& [address, func] : functions) {
+		os << "fn=" << name(address) << '\n'
+		   << "0 " << func.selfCycles << ' ' << func.samples << '\n';
+		for (const auto& call : func.callees) {
+			os << "cfn=" << name(call.callee) << '\n'
+			   << "calls=" << call.calls << " 0\n"
+			   << "0 " << call.cycles << '\n';
+		}
+		os << '\n';
+	}
+	if (!os) throw MSXException("Error while writing file: ", filename);
+}
+
+void Profiler::execute(std::span<const TclObject> tokens, TclObject& result, EmuTime time)
+{
+	auto& cmd = debugger.cmd;
+	auto& interp = cmd.getInterpreter();
+	cmd.checkNumArgs(tokens, Completer::AtLeast{3}, "subcommand ?arg ...?");
+	cmd.executeSubCommand(tokens[2].getString(),
+		"start", [&]{
+			int intervalCycles = DEFAULT_INTERVAL;
+			std::array info = {valueArg("-interval", intervalCycles)};
+			auto arguments = parseTclArgs(interp, tokens.subspan(3), info);
+			if (!arguments.empty()) throw SyntaxError();
+			if (intervalCycles <= 0) throw CommandException("Interval must be positive.");
+			start(time, narrow<unsigned>(intervalCycles));
+		},
+		"stop", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			stop(time);
+		},
+		"clear", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			clear();
+		},
+		"running", [&]{
+			cmd.checkNumArgs(tokens, 3, "");
+			result = isRunning();
+		},
+		"functions", [&]{
+			cmd.checkNumArgs(tokens, Completer::Between{3, 4}, "?count?");
+			auto stats = getFunctionStats(time);
+			if (tokens.size() == 4) {
+				stats.resize(std::min(stats.size(), size_t(tokens[3].getInt(interp))));
+			}
+			for (const auto& s : stats) {
+				result.addListElement(makeTclList(
+					getFunctionName(s.address), s.address, s.calls,
+					s.inclusiveCycles, s.selfCycles, s.samples));
+			}
+		},
+		"samples", [&]{
+			cmd.checkNumArgs(tokens, Completer::Between{3, 4}, "?count?");
+			std::vector<std::pair<uint16_t, uint32_t>> hot;
+			for (auto addr : xrange(pcSamples.size())) {
+				if (auto n = pcSamples[addr]) hot.emplace_back(narrow<uint16_t>(addr), n);
+			}
+			std::ranges::sort(hot, std::greater{}, [](const auto& p) { return p.second; });
+			if (tokens.size() == 4) {
+				hot.resize(std::min(hot.size(), size_t(tokens[3].getInt(interp))));
+			}
+			for (const auto& [addr, n] : hot) {
+				result.addListElement(makeTclList(addr, n));
+			}
+		},
+		"export", [&]{
+			std::string_view format = "callgrind";
+			std::array info = {valueArg("-format", format)};
+			auto arguments = parseTclArgs(interp, tokens.subspan(3), info);
+			if (arguments.size() != 1) throw SyntaxError();
+			auto filename = FileOperations::expandTilde(std::string(arguments[0].getString()));
+			try {
+				if (format == "callgrind") {
+					exportCallgrind(filename, time);
+				} else if (format == "folded") {
+					exportFolded(filename);
+				} else {
+					throw CommandException("Unknown format: ", format, ", must be one of 'callgrind' or 'folded'.");
+				}
+			} catch (MSXException& e) {
+				throw CommandException(e.getMessage());
+			}
+			result = filename;
+		});
+}
+
+void Profiler::tabCompletion(std::vector<std::string>& tokens) const
+{
+	static constexpr std::array cmds = {
+		"start"sv, "stop"sv, "clear"sv, "running"sv, "functions"sv, "samples"sv, "export"sv,
+	};
+	auto& cmd = debugger.cmd;
+	if (tokens.size() == 3) {
+		cmd.completeString(tokens, cmds);
+	} else if (tokens[2] == "start") {
+		static constexpr std::array options = {"-interval"sv};
+		cmd.completeString(tokens, options);
+	} else if (tokens[2] == "export") {
+		if (tokens[tokens.size() - 2] == "-format") {
+			static constexpr std::array formats = {"callgrind"sv, "folded"sv};
+			cmd.completeString(tokens, formats);
+		} else {
+			cmd.completeFileName(tokens, userFileContext());
+		}
+	}
+}
+
+std::string Profiler::help(std::span<const TclObject> tokens) const
+{
+	constexpr auto generalHelp =
+		"debug profile <subcommand> [<arguments>]\n"
+		"  Profile the emulated code. Possible subcommands are:\n"
+		"    start      start (or continue) collecting profile data\n"
+		"    stop       stop collecting profile data\n"
+		"    clear      drop the collected profile data\n"
+		"    running    is the profiler running?\n"
+		"    functions  show the statistics per function\n"
+		"    samples    show the most sampled addresses\n"
+		"    export     write the profile data to a file\n"
+		"  Type 'help debug profile <subcommand>' for help about a specific subcommand.\n";
+
+	constexpr auto startHelp =
+		"debug profile start [-interval <cycles>]\n"
+		"  Start collecting profile data. A function is the target of a CALL or\n"
+		"  RST instruction, or an interrupt routine. The number of CPU cycles\n"
+		"  spent in each function is measured, and every <cycles> CPU cycles\n"
+		"  (default 1000) the program counter is sampled.\n";
+
+	constexpr auto functionsHelp =
+		"debug profile functions [<count>]\n"
+		"  Returns a list with per function: name, address, number of calls,\n"
+		"  inclusive cycles, self cycles and number of samples.\n"
+		"  The list is sorted on self cycles, optionally only the first <count>\n"
+		"  functions are returned. Functions are named via the symbol manager.\n";
+
+	constexpr auto samplesHelp =
+		"debug profile samples [<count>]\n"
+		"  Returns a list of address-count pairs, sorted on count.\n";
+
+	constexpr auto exportHelp =
+		"debug profile export <filename> [-format <format>]\n"
+		"  Write the profile data to a file. The format is one of:\n"
+		"  * callgrind: for KCachegrind (default)\n"
+		"  * folded:    folded stacks, input for flamegraph.pl or speedscope\n";
+
+	constexpr auto simpleHelp =
+		"debug profile stop|clear|running\n"
+		"  Stop collecting, drop all collected data or query the state of the profiler.\n";
+
+	auto size = tokens.size();
+	assert(size >= 2);
+	if (size == 2) {
+		return generalHelp;
+	} else if (tokens[2] == "start") {
+		return startHelp;
+	} else if (tokens[2] == "functions") {
+		return functionsHelp;
+	} else if (tokens[2] == "samples") {
+		return samplesHelp;
+	} else if (tokens[2] == "export") {
+		return exportHelp;
+	} else if (tokens[2] == one_of("stop", "clear", "running")) {
+		return simpleHelp;
+	} else {
+		return "Unknown subcommand, use 'help debug profile' to see a list of valid subcommands.\n";
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,126 @@
+#ifndef PROFILER_HH
+#define PROFILER_HH
+
+#include "EmuDuration.hh"
+#include "EmuTime.hh"
+#include "Schedulable.hh"
+
+#include "zstring_view.hh"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class Debugger;
+class MSXCPU;
+class SymbolManager;
+class TclObject;
+
+/** Profiler for the emulated code.
+  *
+  * This combines two techniques:
+  * - The CPU reports CALL/RST/RET instructions and the start of interrupt
+  *   routines. This is used to build a call tree and to measure the number
+  *   of cycles spent in each function (in each calling context).
+  * - Every N cycles the PC is sampled, and attributed to the function at
+  *   the top of the call stack.
+  *
+  * The return of a function is detected by comparing the stack pointer with
+  * the stack pointer right after the call. So code that drops its return
+  * address (e.g. 'pop hl ; ret') is handled correctly.
+  *
+  * When the profiler is not running the only overhead is a nullptr check
+  * in the CPU call/ret emulation.
+  */
+class Profiler final : public Schedulable
+{
+public:
+	struct Node {
+		uint16_t address = 0; // entry address of the function
+		unsigned parent = 0;
+		uint64_t calls = 0;
+		uint64_t samples = 0; // samples with this node as innermost function
+		EmuDuration time = EmuDuration::zero(); // total time of the completed calls
+		std::vector<unsigned> children;
+	};
+	struct FunctionStats {
+		uint16_t address;
+		uint64_t calls;
+		uint64_t samples;
+		uint64_t inclusiveCycles;
+		uint64_t selfCycles;
+	};
+	static constexpr unsigned DEFAULT_INTERVAL = 1000; // in CPU cycles
+
+public:
+	explicit Profiler(Debugger& debugger);
+
+	void execute(std::span<const TclObject> tokens, TclObject& result, EmuTime time);
+	void tabCompletion(std::vector<std::string>& tokens) const;
+	[[nodiscard]] std::string help(std::span<const TclObject> tokens) const;
+
+	void start(EmuTime time, unsigned interval = DEFAULT_INTERVAL);
+	void stop(EmuTime time);
+	void clear();
+	[[nodiscard]] bool isRunning() const { return cpu != nullptr; }
+	[[nodiscard]] uint64_t getTotalSamples() const { return totalSamples; }
+
+	/** Called when the CPU is about to be deleted. */
+	void cpuDeleted();
+
+	/** Copy the collected data from another machine (e.g. when going back
+	  * in time). The profiler of the new machine is not started. */
+	void transfer(const Profiler& other);
+
+	// called by the CPU
+	void enterFunction(uint16_t address, uint16_t sp, EmuTime time);
+	void leaveFunction(uint16_t sp, EmuTime time);
+
+	/** Statistics per function, sorted on (decreasing) self cycles. Calls
+	  * that are still in progress are included up to the given time. */
+	[[nodiscard]] std::vector<FunctionStats> getFunctionStats(EmuTime time) const;
+	[[nodiscard]] std::string getFunctionName(uint16_t address) const;
+
+	/** Folded stacks (input for flamegraph.pl, speedscope, ...). */
+	void exportFolded(zstring_view filename) const;
+	/** Callgrind format (for KCachegrind, QCachegrind, ...). */
+	void exportCallgrind(zstring_view filename, EmuTime time) const;
+
+private:
+	[[nodiscard]] unsigned getChild(unsigned node, uint16_t address);
+	[[nodiscard]] std::vector<EmuDuration> getNodeTimes(EmuTime time) const;
+	[[nodiscard]] EmuDuration getSelfTime(std::span<const EmuDuration> times, unsigned node) const;
+	[[nodiscard]] uint64_t toCycles(EmuDuration d) const;
+	[[nodiscard]] std::string getPathName(unsigned node) const;
+	void schedule(EmuTime time);
+
+	// Schedulable
+	void executeUntil(EmuTime time) override;
+
+private:
+	struct Frame {
+		unsigned node;
+		uint16_t sp; // stack pointer right after the call (points to the return address)
+		EmuTime start;
+	};
+	static constexpr unsigned ROOT = 0;
+	static constexpr size_t MAX_DEPTH = 256;
+
+	Debugger& debugger;
+	SymbolManager& symbolManager;
+	MSXCPU* cpu = nullptr; // only non-nullptr while running
+
+	std::vector<Node> nodes; // nodes[ROOT] is code outside any (seen) call
+	std::vector<Frame> stack;
+	std::vector<uint32_t> pcSamples; // per address, only allocated once started
+	uint64_t totalSamples = 0;
+	EmuDuration interval = EmuDuration::zero();
+	unsigned freq = 3579545; // frequency of the CPU when profiling was started
+};
+
+} // namespace openmsx
+
+#endif
@@ -2,11 +2,16 @@
 
 #include "CommandController.hh"
 #include "File.hh"
+#include "FileException.hh"
+#include "FileOperations.hh"
 #include "Interpreter.hh"
 #include "TclObject.hh"
 
 #include "StringOp.hh"
+#include "endian.hh"
+#include "hash_set.hh"
 #include "narrow.hh"
+#include "ranges.hh"
 #include "static_vector.hh"
 #include "stl.hh"
 #include "strCat.hh"
@@ -16,6 +21,8 @@
 #include <bit>
 #include <cassert>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <ranges>
 
 namespace openmsx {
@@ -391,37 +398,145 @@ template std::optional<uint32_t> SymbolManager::parseValue<uint32_t>(std::string
 	return result;
 }
 
-[[nodiscard]] SymbolFile SymbolManager::loadSymbolFile(
-	zstring_view filename, SymbolFile::Type type,
-	std::optional<uint8_t> slot, std::optional<uint16_t> segment)
+[[nodiscard]] SymbolFile SymbolManager::parseSymbolFile(
+	std::string_view filename, std::string_view buffer, SymbolFile::Type type)
 {
-	auto buf = File(filename).mmap<const char>();
-	std::string_view buffer(buf.data(), buf.size());
-
 	using enum SymbolFile::Type;
 	if (type == AUTO_DETECT) {
 		type = detectType(filename, buffer);
 	}
 	assert(type != AUTO_DETECT);
 
+	switch (type) {
+		case ASMSX:
+			return loadASMSX(filename, buffer);
+		case GENERIC:
+			return loadGeneric(filename, buffer);
+		case HTC:
+			return loadHTC(filename, buffer);
+		case LINKMAP:
+			return loadLinkMap(filename, buffer);
+		case NOICE:
+			return loadNoICE(filename, buffer);
+		case VASM:
+			return loadVASM(filename, buffer);
+		case WLALINK_NOGMB:
+			return loadNoGmb(filename, buffer);
+		default: UNREACHABLE;
+	}
+}
+
+// Parsing large symbol files takes a while, so the result is cached on disk.
+// Layout of a cache file (all values little endian):
+//   header:     magic, version (2 x 32-bit), size, modification date (of the
+//               symbol file, 2 x 64-bit), requested type, type, hasSegmentInfo
+//               (3 x 8-bit), number of symbols (32-bit)
+//   per symbol: value (2 bytes), segment (2 bytes), flags (1 byte, bit 0:
+//               segment is valid), name length (2 bytes), name
+static constexpr uint32_t CACHE_MAGIC = 0x43594d53; // "SMYC"
+static constexpr uint32_t CACHE_VERSION = 2;
+static constexpr size_t CACHE_HEADER_SIZE = 2 * 4 + 2 * 8 + 3 * 1 + 4;
+static constexpr size_t CACHE_SYMBOL_SIZE = 2 * 2 + 1 + 2;
+static constexpr size_t CACHE_MIN_FILE_SIZE = 64 * 1024; // smaller files are parsed fast enough
+
+std::vector<uint8_t> SymbolManager::serializeCache(
+	const SymbolFile& file, const FileOperations::FileStamp& stamp, SymbolFile::Type requestedType)
+{
+	std::vector<uint8_t> data(CACHE_HEADER_SIZE);
+	Endian::write_UA_L32(&data[0], CACHE_MAGIC);
+	Endian::write_UA_L32(&data[4], CACHE_VERSION);
+	Endian::write_UA_L64(&data[8], stamp.size);
+	Endian::write_UA_L64(&data[16], stamp.modificationDate);
+	data[24] = uint8_t(requestedType);
+	data[25] = uint8_t(file.type);
+	data[26] = file.hasSegmentInfo;
+	Endian::write_UA_L32(&data[27], narrow<uint32_t>(file.symbols.size()));
+	for (const auto& sym : file.symbols) {
+		auto pos = data.size();
+		data.resize(pos + CACHE_SYMBOL_SIZE);
+		Endian::write_UA_L16(&data[pos + 0], sym.value);
+		Endian::write_UA_L16(&data[pos + 2], sym.segment.value_or(0));
+		data[pos + 4] = sym.segment.has_value();
+		Endian::write_UA_L16(&data[pos + 5], narrow<uint16_t>(sym.name.size()));
+		append(data, std::span{std::bit_cast<const uint8_t*>(sym.name.data()), sym.name.size()});
+	}
+	return data;
+}
+
+std::optional<SymbolFile> SymbolManager::deserializeCache(
+	std::span<const uint8_t> data, const FileOperations::FileStamp& stamp,
+	SymbolFile::Type requestedType, std::string_view filename)
+{
+	if (data.size() < CACHE_HEADER_SIZE) return {};
+	if (Endian::read_UA_L32(&data[0]) != CACHE_MAGIC) return {};
+	if (Endian::read_UA_L32(&data[4]) != CACHE_VERSION) return {};
+	if (Endian::read_UA_L64(&data[8]) != stamp.size) return {};
+	if (Endian::read_UA_L64(&data[16]) != stamp.modificationDate) return {};
+	if (data[24] != uint8_t(requestedType)) return {};
+	auto type = data[25];
+	if ((type == uint8_t(SymbolFile::Type::AUTO_DETECT)) ||
+	    (type >= uint8_t(SymbolFile::Type::LAST))) return {};
+	auto num = Endian::read_UA_L32(&data[27]);
+
+	SymbolFile result;
+	result.filename = filename;
+	result.type = SymbolFile::Type(type);
+	result.hasSegmentInfo = data[26] != 0;
+	result.symbols.reserve(std::min<size_t>(num, data.size() / CACHE_SYMBOL_SIZE));
+	size_t pos = CACHE_HEADER_SIZE;
+	for (uint32_t i = 0; i < num; ++i) {
+		if ((pos + CACHE_SYMBOL_SIZE) > data.size()) return {};
+		auto value = Endian::read_UA_L16(&data[pos + 0]);
+		auto segment = Endian::read_UA_L16(&data[pos + 2]);
+		bool hasSegment = data[pos + 4] & 1;
+		auto len = Endian::read_UA_L16(&data[pos + 5]);
+		pos += CACHE_SYMBOL_SIZE;
+		if ((pos + len) > data.size()) return {};
+		result.symbols.emplace_back(
+			std::string(std::bit_cast<const char*>(&data[pos]), len), value, std::nullopt,
+			hasSegment ? std::optional<uint16_t>(segment) : std::nullopt);
+		pos += len;
+	}
+	if (pos != data.size()) return {};
+	return result;
+}
+
+[[nodiscard]] SymbolFile SymbolManager::loadSymbolFile(
+	zstring_view filename, SymbolFile::Type type,
+	std::optional<uint8_t> slot, std::optional<uint16_t> segment)
+{
+	File file(filename);
+	auto buf = file.mmap<const char>();
+	std::string_view buffer(buf.data(), buf.size());
+
 	auto symbolFile = [&]{
-		switch (type) {
-			case ASMSX:
-				return loadASMSX(filename, buffer);
-			case GENERIC:
-				return loadGeneric(filename, buffer);
-			case HTC:
-				return loadHTC(filename, buffer);
-			case LINKMAP:
-				return loadLinkMap(filename, buffer);
-			case NOICE:
-				return loadNoICE(filename, buffer);
-			case VASM:
-				return loadVASM(filename, buffer);
-			case WLALINK_NOGMB:
-				return loadNoGmb(filename, buffer);
-			default: UNREACHABLE;
+		if (buffer.size() < CACHE_MIN_FILE_SIZE) {
+			return parseSymbolFile(filename, buffer, type);
 		}
+		// The cache is only valid for this exact file and for the
+		// requested type.
+		FileOperations::FileStamp stamp{
+			.size = buffer.size(),
+			.modificationDate = uint64_t(file.getModificationDate())};
+		auto cacheName = FileOperations::getCacheFileName(".symbolcache", filename, ".sym");
+		try {
+			File cacheFile(cacheName, "rb");
+			auto cacheBuf = cacheFile.mmap<const uint8_t>();
+			if (auto cached = deserializeCache(cacheBuf, stamp, type, filename)) {
+				return std::move(*cached);
+			}
+		} catch (FileException&) {
+			// not (yet) cached
+		}
+		auto result = parseSymbolFile(filename, buffer, type);
+		try {
+			FileOperations::prepareCacheFile(cacheName);
+			File cacheFile(cacheName, File::OpenMode::TRUNCATE);
+			cacheFile.write(serializeCache(result, stamp, type));
+		} catch (FileException&) {
+			// ignore, we'll parse the file again next time
+		}
+		return result;
 	}();
 
 	// Update slot info for the file and each of its symbol
@@ -438,21 +553,84 @@ template std::optional<uint32_t> SymbolManager::parseValue<uint32_t>(std::string
 	return symbolFile;
 }
 
-void SymbolManager::refresh()
+[[nodiscard]] static bool containsSymbol(const SymbolFile& file, const Symbol* sym)
 {
-	// Drop caches
-	lookupValueCache.clear();
+	auto* first = file.symbols.data();
+	auto* last = first + file.symbols.size();
+	return (std::less_equal<>{}(first, sym)) && (std::less<>{}(sym, last));
+}
+
+// The result must be the same as when all files were (re)loaded in order, also
+// when a file in the middle of the list is reloaded.
+void SymbolManager::addToIndex(const SymbolFile& file)
+{
+	auto filePos = narrow<size_t>(&file - files.data());
+	assert(filePos < files.size());
+	auto later = std::span(files).subspan(filePos + 1);
 
 	// Allow to access symbol-values in Tcl expression with syntax: $sym(JIFFY)
+	// When a later file defines the same name, that one wins.
+	hash_set<std::string_view> shadowed;
+	for (const auto& f : later) {
+		for (const auto& sym : f.symbols) shadowed.insert(sym.name);
+	}
 	auto& interp = commandController.getInterpreter();
 	TclObject arrayName("sym");
-	interp.unsetVariable(arrayName.getString().c_str());
-	for (const auto& file : files) {
-		for (const auto& sym : file.symbols) {
-			interp.setVariable(arrayName, TclObject(sym.name), TclObject(sym.value));
+	for (const auto& sym : file.symbols) {
+		if (shadowed.contains(sym.name)) continue;
+		interp.setVariable(arrayName, TclObject(sym.name), TclObject(sym.value));
+	}
+
+	// Symbols with the same value are ordered on file position (and on
+	// position within the file).
+	auto isLater = [&](const Symbol* sym) {
+		return std::ranges::any_of(later, [&](const SymbolFile& f) { return containsSymbol(f, sym); });
+	};
+	auto added = to_vector(std::views::transform(file.symbols, [](const auto& sym) { return &sym; }));
+	std::ranges::stable_sort(added, {}, &Symbol::value);
+	std::vector<const Symbol*> merged;
+	merged.reserve(valueIndex.size() + added.size());
+	auto it = valueIndex.begin();
+	auto end = valueIndex.end();
+	for (const auto* sym : added) {
+		while ((it != end) &&
+		       (((*it)->value < sym->value) ||
+		        (((*it)->value == sym->value) && !isLater(*it)))) {
+			merged.push_back(*it++);
 		}
+		merged.push_back(sym);
 	}
+	merged.insert(merged.end(), it, end);
+	valueIndex = std::move(merged);
+}
 
+void SymbolManager::removeFromIndex(const SymbolFile& file)
+{
+	std::erase_if(valueIndex, [&](const Symbol* sym) { return containsSymbol(file, sym); });
+
+	// Remove the Tcl variables of this file, but restore the ones that are
+	// (also) defined in another file. Files are visited in order, so the
+	// last file that defines a name wins.
+	auto& interp = commandController.getInterpreter();
+	hash_set<std::string_view> removed;
+	for (const auto& sym : file.symbols) {
+		if (removed.insert(sym.name).second) {
+			interp.unsetVariable("sym", sym.name.c_str());
+		}
+	}
+	TclObject arrayName("sym");
+	for (const auto& f : files) {
+		if (&f == &file) continue;
+		for (const auto& sym : f.symbols) {
+			if (removed.contains(sym.name)) {
+				interp.setVariable(arrayName, TclObject(sym.name), TclObject(sym.value));
+			}
+		}
+	}
+}
+
+void SymbolManager::notify()
+{
 	if (observer) observer->notifySymbolsChanged();
 }
 
@@ -466,10 +644,13 @@ bool SymbolManager::reloadFile(
 	if (auto it = std::ranges::find(files, filename, &SymbolFile::filename);
 	    it == files.end()) {
 		files.push_back(std::move(file));
+		addToIndex(files.back());
 	} else {
+		removeFromIndex(*it);
 		*it = std::move(file);
+		addToIndex(*it);
 	}
-	refresh();
+	notify();
 	return true;
 }
 
@@ -477,14 +658,17 @@ void SymbolManager::removeFile(std::string_view filename)
 {
 	auto it = std::ranges::find(files, filename, &SymbolFile::filename);
 	if (it == files.end()) return; // not found
+	removeFromIndex(*it);
 	files.erase(it);
-	refresh();
+	notify();
 }
 
 void SymbolManager::removeAllFiles()
 {
 	files.clear();
-	refresh();
+	valueIndex.clear();
+	commandController.getInterpreter().unsetVariable("sym");
+	notify();
 }
 
 std::optional<uint16_t> SymbolManager::lookupSymbol(std::string_view str) const
@@ -516,20 +700,26 @@ std::optional<uint16_t> SymbolManager::parseSymbolOrValue(std::string_view str)
 	return parseValue<uint16_t>(str);
 }
 
-std::span<Symbol const * const> SymbolManager::lookupValue(uint16_t value)
+std::span<Symbol const * const> SymbolManager::lookupValue(uint16_t value) const
 {
-	if (lookupValueCache.empty()) {
-		for (const auto& file : files) {
-			for (const auto& sym : file.symbols) {
-				auto [it, inserted] = lookupValueCache.try_emplace(sym.value, std::vector<const Symbol*>{});
-				it->second.push_back(&sym);
-			}
-		}
-	}
-	if (auto* sym = lookup(lookupValueCache, value)) {
-		return *sym;
-	}
-	return {};
+	auto [first, last] = std::ranges::equal_range(valueIndex, value, {}, &Symbol::value);
+	return {first, last};
+}
+
+std::span<Symbol const * const> SymbolManager::lookupRange(uint16_t begin, unsigned end) const
+{
+	if (end <= begin) return {};
+	auto first = std::ranges::lower_bound(valueIndex, begin, {}, &Symbol::value);
+	auto last = std::ranges::lower_bound(first, valueIndex.end(), end, {},
+		[](const Symbol* sym) { return unsigned(sym->value); });
+	return {first, last};
+}
+
+std::span<Symbol const * const> SymbolManager::lookupNearest(uint16_t value) const
+{
+	auto it = std::ranges::upper_bound(valueIndex, value, {}, &Symbol::value);
+	if (it == valueIndex.begin()) return {};
+	return lookupValue((*std::prev(it))->value);
 }
 
 SymbolFile* SymbolManager::findFile(std::string_view filename)
@@ -1,8 +1,9 @@
 #ifndef SYMBOL_MANAGER_HH
 #define SYMBOL_MANAGER_HH
 
+#include "FileOperations.hh"
+
 #include "function_ref.hh"
-#include "hash_map.hh"
 #include "zstring_view.hh"
 
 #include <cassert>
@@ -86,7 +87,13 @@ public:
 
 	[[nodiscard]] const auto& getFiles() const { return files; }
 	[[nodiscard]] SymbolFile* findFile(std::string_view filename);
-	[[nodiscard]] std::span<Symbol const * const> lookupValue(uint16_t value);
+	[[nodiscard]] std::span<Symbol const * const> lookupValue(uint16_t value) const;
+	// All symbols with a value in the range [begin, end), sorted on value.
+	[[nodiscard]] std::span<Symbol const * const> lookupRange(uint16_t begin, unsigned end) const;
+	// All symbols with the largest value that is smaller than or equal to
+	// the given value (e.g. the function containing an address). Empty
+	// when there is no such symbol.
+	[[nodiscard]] std::span<Symbol const * const> lookupNearest(uint16_t value) const;
 	[[nodiscard]] std::optional<uint16_t> lookupSymbol(std::string_view s) const;
 	[[nodiscard]] std::optional<uint16_t> parseSymbolOrValue(std::string_view s) const;
 
@@ -113,18 +120,31 @@ public:
 	[[nodiscard]] static SymbolFile loadNoGmb(std::string_view filename, std::string_view buffer);
 	[[nodiscard]] static SymbolFile loadASMSX(std::string_view filename, std::string_view buffer);
 	[[nodiscard]] static SymbolFile loadLinkMap(std::string_view filename, std::string_view buffer);
+	[[nodiscard]] static SymbolFile parseSymbolFile(
+		std::string_view filename, std::string_view buffer, SymbolFile::Type type);
 	[[nodiscard]] static SymbolFile loadSymbolFile(
 		zstring_view filename, SymbolFile::Type type,
 		std::optional<uint8_t> slot, std::optional<uint16_t> segment);
+	[[nodiscard]] static std::vector<uint8_t> serializeCache(
+		const SymbolFile& file, const FileOperations::FileStamp& stamp, SymbolFile::Type requestedType);
+	[[nodiscard]] static std::optional<SymbolFile> deserializeCache(
+		std::span<const uint8_t> data, const FileOperations::FileStamp& stamp,
+		SymbolFile::Type requestedType, std::string_view filename);
 
 private:
-	void refresh();
+	void addToIndex(const SymbolFile& file);
+	void removeFromIndex(const SymbolFile& file);
+	void notify();
 
 private:
 	CommandController& commandController;
 	SymbolObserver* observer = nullptr; // only one for now, could become a vector later
 	std::vector<SymbolFile> files;
-	hash_map<uint16_t, std::vector<const Symbol*>> lookupValueCache; // calculated from 'files'
+	// All symbols of all files, sorted on value. Symbols with the same
+	// value are ordered on the position of their file in 'files' and then
+	// on their position within that file. Updated incrementally when a
+	// file is (re)loaded or removed.
+	std::vector<const Symbol*> valueIndex;
 };
 
 
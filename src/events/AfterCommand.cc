@@ -13,6 +13,7 @@
 #include "Reactor.hh"
 #include "Schedulable.hh"
 #include "TclObject.hh"
+#include "Timer.hh"
 
 #include "strCat.hh"
 #include "StringOp.hh"
@@ -40,7 +41,7 @@ struct DelayedCommand {
 
 	void execute() {
 		try {
-			command.executeCommand(afterCommand.getInterpreter());
+			afterCommand.executeDelayed(command);
 		} catch (CommandException& e) {
 			afterCommand.getCommandController().getCliComm().printWarning(
 				"Error executing delayed command: ", e.getMessage());
@@ -199,6 +200,8 @@ void AfterCommand::execute(std::span<const TclObject> tokens, TclObject& result)
 		afterInfo(tokens, result);
 	} else if (subCmd == "cancel") {
 		afterCancel(tokens, result);
+	} else if (subCmd == "stats") {
+		afterStats(tokens, result);
 	} else {
 		// A valid integer?
 		if (auto time = tokens[1].getOptionalInt()) {
@@ -357,6 +360,64 @@ void AfterCommand::afterCancel(std::span<const TclObject> tokens, TclObject& /*r
 	// It's not an error if no match is found
 }
 
+void AfterCommand::afterStats(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, Between{2, 3}, "?reset?");
+	if (tokens.size() == 3) {
+		if (tokens[2] != "reset") throw SyntaxError();
+		stats.clear();
+		return;
+	}
+	// slowest (in total) first
+	auto sorted = to_vector(std::views::transform(stats, [](const auto& p) { return &p; }));
+	std::ranges::sort(sorted, std::greater{}, [](const auto* p) { return p->second.total; });
+	for (const auto* p : sorted) {
+		const auto& [cmd, s] = *p;
+		result.addListElement(makeTclList(cmd, s.count, s.total, s.max));
+	}
+}
+
+void AfterCommand::executeDelayed(const TclObject& command)
+{
+	auto str = command.getString();
+	// Take a copy (a reference to the same Tcl_Obj), the command could
+	// e.g. call 'after' which might clear 'compiledCmds'.
+	TclObject cmd = command;
+	bool compile = true;
+	if (auto* compiled = lookup(compiledCmds, str)) {
+		cmd = *compiled;
+	} else if (seenCmds.erase(str)) {
+		// executed for the second time, from now on reuse its bytecode
+		if (compiledCmds.size() >= MAX_COMPILED) compiledCmds.clear();
+		compiledCmds.emplace(std::string(str), command);
+	} else {
+		if (seenCmds.size() >= MAX_COMPILED) seenCmds.clear();
+		seenCmds.emplace(std::string(str));
+		compile = false;
+	}
+
+	auto start = Timer::getTime();
+	auto update = [&] {
+		auto duration = Timer::getTime() - start;
+		auto it = stats.find(str);
+		if (it == stats.end()) {
+			if (stats.size() >= MAX_STATS) return;
+			it = stats.emplace(std::string(str), Stats{}).first;
+		}
+		auto& s = it->second;
+		++s.count;
+		s.total += duration;
+		s.max = std::max(s.max, duration);
+	};
+	try {
+		cmd.executeCommand(getInterpreter(), compile);
+	} catch (CommandException&) {
+		update();
+		throw;
+	}
+	update();
+}
+
 std::string AfterCommand::help(std::span<const TclObject> /*tokens*/) const
 {
 	return "after time     <seconds> <command>  execute a command after some time (MSX time)\n"
@@ -368,7 +429,9 @@ std::string AfterCommand::help(std::span<const TclObject> /*tokens*/) const
 	       "after machine_switch <command>      execute a command after a switch to a new machine\n"
 	       "after quit <command>                execute a command after a quit event\n"
 	       "after info                          list all postponed commands\n"
-	       "after cancel <id>                   cancel the postponed command with given id\n";
+	       "after cancel <id>                   cancel the postponed command with given id\n"
+	       "after stats ?reset?                 show (or reset) the execution time per command:\n"
+	       "                                    a list of {command count total-us max-us}, slowest first\n";
 }
 
 void AfterCommand::tabCompletion(std::vector<std::string>& tokens) const
@@ -377,9 +440,13 @@ void AfterCommand::tabCompletion(std::vector<std::string>& tokens) const
 		using namespace std::literals;
 		static constexpr std::array cmds = {
 			"time"sv, "realtime"sv, "idle"sv, "frame"sv, "break"sv, "boot"sv,
-			"machine_switch"sv, "quit"sv, "info"sv, "cancel"sv,
+			"machine_switch"sv, "quit"sv, "info"sv, "cancel"sv, "stats"sv,
 		};
 		completeString(tokens, cmds);
+	} else if ((tokens.size() == 3) && (tokens[1] == "stats")) {
+		using namespace std::literals;
+		static constexpr std::array options = {"reset"sv};
+		completeString(tokens, options);
 	}
 	// TODO : make more complete
 }
@@ -5,8 +5,15 @@
 #include "EventListener.hh"
 
 #include "Command.hh"
+#include "TclObject.hh"
+
+#include "hash_map.hh"
+#include "hash_set.hh"
+#include "xxhash.hh"
 
 #include <concepts>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace openmsx {
@@ -43,6 +50,9 @@ private:
 	void afterIdle    (std::span<const TclObject> tokens, TclObject& result);
 	void afterInfo    (std::span<const TclObject> tokens, TclObject& result) const;
 	void afterCancel  (std::span<const TclObject> tokens, TclObject& result);
+	void afterStats   (std::span<const TclObject> tokens, TclObject& result);
+
+	void executeDelayed(const TclObject& command);
 
 	// EventListener
 	bool signalEvent(const Event& event) override;
@@ -52,6 +62,25 @@ private:
 	Reactor& reactor;
 	EventDistributor& eventDistributor;
 
+	// Scripts typically re-register the same command every frame, but
+	// each time with a new TclObject. Keep one object per command (string)
+	// alive, so that its compiled bytecode can be reused. Only commands
+	// that were executed before get compiled, one-shot commands are
+	// evaluated directly.
+	static constexpr size_t MAX_COMPILED = 256;
+	hash_map<std::string, TclObject, XXHasher> compiledCmds;
+	hash_set<std::string, std::identity, XXHasher> seenCmds; // executed once
+
+	// Execution time statistics per command (string), in microseconds.
+	struct Stats {
+		uint64_t count = 0;
+		uint64_t total = 0;
+		uint64_t max = 0;
+	};
+	static constexpr size_t MAX_STATS = 1000;
+	hash_map<std::string, Stats, XXHasher> stats;
+
+	friend struct DelayedCommand;
 	friend class AfterCmd;
 	friend class AfterTimedCmd;
 	friend class AfterRealTimeCmd;
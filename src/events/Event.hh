@@ -411,6 +411,10 @@ class Rs232TesterEvent           final : public SimpleEvent {};
 class Rs232NetEvent              final : public SimpleEvent {};
 class ImGuiDelayedActionEvent    final : public SimpleEvent {};
 
+/** Send (from a helper thread) when an asynchronous store_machine command
+  * finished writing its file. */
+class StoreMachineDoneEvent      final : public SimpleEvent {};
+
 
 // --- Put all (non-abstract) Event classes into a std::variant ---
 
@@ -452,7 +456,8 @@ using Event = std::variant<
 	Rs232TesterEvent,
 	Rs232NetEvent,
 	ImGuiDelayedActionEvent,
-	ImGuiActiveEvent
+	ImGuiActiveEvent,
+	StoreMachineDoneEvent
 >;
 
 template<typename T>
@@ -501,6 +506,7 @@ enum class EventType : uint8_t
 	RS232_NET                = event_index<Rs232NetEvent>,
 	IMGUI_DELAYED_ACTION     = event_index<ImGuiDelayedActionEvent>,
 	IMGUI_ACTIVE             = event_index<ImGuiActiveEvent>,
+	STORE_MACHINE_DONE       = event_index<StoreMachineDoneEvent>,
 
 	NUM_EVENT_TYPES // must be last
 };
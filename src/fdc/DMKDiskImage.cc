@@ -5,8 +5,10 @@
 #include "FilePool.hh"
 #include "RawTrack.hh"
 
+#include "MemBuffer.hh"
 #include "narrow.hh"
 #include "one_of.hh"
+#include "ranges.hh"
 #include "xrange.hh"
 
 #include <algorithm>
@@ -75,20 +77,51 @@ void DMKDiskImage::seekTrack(uint8_t track, uint8_t side)
 void DMKDiskImage::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 {
 	assert(side < 2);
-	output.clear(dmkTrackLen);
 	if ((singleSided && side) || (track >= numTracks)) {
 		// no such side/track, only clear output
+		output.clear(dmkTrackLen);
 		return;
 	}
 
-	seekTrack(track, side);
+	if (const auto* cached = trackCache.find(track, side)) {
+		output = *cached;
+		return;
+	}
 
-	// Read idam data (still needs to be converted).
-	std::array<uint8_t, 2 * 64> idamBuf;
-	file->read(idamBuf);
+	// Cache miss. In a DMK image both sides of a cylinder are stored
+	// next to each other, so read (and decode) the whole cylinder in one
+	// go: software that reads one side very often reads the other side
+	// next. A truncated image might not (completely) contain the second
+	// side of the last cylinder, then only read the requested side.
+	size_t trackSize = 2 * 64 + dmkTrackLen; // idam table + raw data
+	seekTrack(track, 0);
+	bool readAhead = !singleSided &&
+	                 ((file->getPos() + 2 * trackSize) <= file->getSize());
+	if (!readAhead) seekTrack(track, side);
+	unsigned firstSide = readAhead ? 0 : side;
+	unsigned numSides  = readAhead ? 2 : 1;
+	MemBuffer<uint8_t> buf(numSides * trackSize);
+	file->read(std::span{buf.data(), buf.size()});
+
+	for (auto i : xrange(numSides)) {
+		auto s = narrow<uint8_t>(firstSide + i);
+		auto trackData = std::span{buf.data() + i * trackSize, trackSize};
+		if (s == side) {
+			decodeTrack(trackData, output);
+			if (auto* entry = trackCache.insert(track, side)) {
+				*entry = output;
+			}
+		} else if (auto* entry = trackCache.insert(track, s)) {
+			decodeTrack(trackData, *entry);
+		}
+	}
+}
 
-	// Read raw track data.
-	file->read(output.getRawBuffer());
+void DMKDiskImage::decodeTrack(std::span<const uint8_t> trackData, RawTrack& output) const
+{
+	output.clear(dmkTrackLen);
+	auto idamBuf = trackData.first(2 * 64);
+	copy_to_range(trackData.subspan(2 * 64), output.getRawBuffer());
 
 	// Convert idam data into an easier to work with internal format.
 	int lastIdam = -1;
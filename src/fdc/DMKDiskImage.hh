@@ -3,6 +3,7 @@
 
 #include "Disk.hh"
 #include <memory>
+#include <span>
 
 namespace openmsx {
 
@@ -32,6 +33,7 @@ private:
 	void detectGeometryFallback() override;
 
 	void seekTrack(uint8_t track, uint8_t side);
+	void decodeTrack(std::span<const uint8_t> trackData, RawTrack& output) const;
 	void doWriteTrack(uint8_t track, uint8_t side, const RawTrack& input);
 	void extendImageToTrack(uint8_t track);
 
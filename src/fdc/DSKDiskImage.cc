@@ -4,6 +4,8 @@
 #include "Filename.hh"
 #include "FilePool.hh"
 
+#include "ranges.hh"
+
 namespace openmsx {
 
 DSKDiskImage::DSKDiskImage(const Filename& fileName)
@@ -11,6 +13,7 @@ DSKDiskImage::DSKDiskImage(const Filename& fileName)
 	, file(std::make_shared<File>(fileName.getResolved(), File::OpenMode::PRE_CACHE))
 {
 	setNbSectors(file->getSize() / sizeof(SectorBuffer));
+	mappedFile = mapImageFile(*file);
 }
 
 DSKDiskImage::DSKDiskImage(const Filename& fileName,
@@ -19,11 +22,17 @@ DSKDiskImage::DSKDiskImage(const Filename& fileName,
 	, file(std::move(file_))
 {
 	setNbSectors(file->getSize() / sizeof(SectorBuffer));
+	mappedFile = mapImageFile(*file);
 }
 
 void DSKDiskImage::readSectorsImpl(
 	std::span<SectorBuffer> buffers, size_t startSector)
 {
+	if (auto view = getSectorsViewImpl(startSector, buffers.size());
+	    !view.empty()) {
+		copy_to_range(view, buffers);
+		return;
+	}
 	file->seek(startSector * sizeof(SectorBuffer));
 	file->read(buffers);
 }
@@ -32,6 +41,17 @@ void DSKDiskImage::writeSectorImpl(size_t sector, const SectorBuffer& buf)
 {
 	file->seek(sector * sizeof(buf));
 	file->write(buf.raw);
+	if (sector < mappedFile.size()) {
+		// private mapping, keep it in sync with the file
+		mappedFile[sector] = buf;
+	}
+}
+
+std::span<const SectorBuffer> DSKDiskImage::getSectorsViewImpl(
+	size_t startSector, size_t num)
+{
+	if ((startSector + num) > mappedFile.size()) return {};
+	return {&mappedFile[startSector], num};
 }
 
 bool DSKDiskImage::isWriteProtectedImpl() const
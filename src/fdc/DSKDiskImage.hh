@@ -20,9 +20,12 @@ private:
 	void writeSectorImpl(size_t sector, const SectorBuffer& buf) override;
 	[[nodiscard]] bool isWriteProtectedImpl() const override;
 	[[nodiscard]] Sha1Sum getSha1SumImpl(FilePool& filePool) override;
+	[[nodiscard]] std::span<const SectorBuffer> getSectorsViewImpl(
+		size_t startSector, size_t num) override;
 
 private:
 	const std::shared_ptr<File> file;
+	MappedFile<SectorBuffer> mappedFile; // empty if not mapped
 };
 
 } // namespace openmsx
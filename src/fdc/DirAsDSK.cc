@@ -273,6 +273,7 @@ DirAsDSK::DirAsDSK(DiskChanger& diskChanger_, CliComm& cliComm_,
 	, cliComm(cliComm_)
 	, hostDir(FileOperations::expandTilde(hostDir_.getResolved() + '/'))
 	, syncMode(syncMode_)
+	, dirWatcher(hostDir)
 	, nofSectors((diskChanger_.isDoubleSidedDrive() ? 2 : 1) * SECTORS_PER_TRACK * NUM_TRACKS)
 	, nofSectorsPerFat(narrow<unsigned>((((3 * nofSectors) / (2 * SECTORS_PER_CLUSTER)) + SECTOR_SIZE - 1) / SECTOR_SIZE))
 	, firstSector2ndFAT(FIRST_FAT_SECTOR + nofSectorsPerFat)
@@ -406,6 +407,41 @@ void DirAsDSK::readSectorImpl(size_t sector, SectorBuffer& buf)
 
 void DirAsDSK::syncWithHost()
 {
+	auto changes = dirWatcher.readChanges();
+	if (changes.fullScan) {
+		// Initial sync, or we can't track host changes (anymore).
+		fullSyncWithHost();
+		return;
+	}
+
+	// Only re-examine the host entries that were reported as changed. Use
+	// the same order as in fullSyncWithHost() (and for the same reasons).
+	for (const auto& hostName : changes.removed) {
+		if (auto dirIdx = findHostFileInDSK(hostName);
+		    dirIdx.sector != unsigned(-1)) {
+			checkDeletedHostFile(dirIdx);
+		}
+	}
+	for (const auto& hostName : changes.modified) {
+		if (auto dirIdx = findHostFileInDSK(hostName);
+		    dirIdx.sector != unsigned(-1)) {
+			checkModifiedHostFile(dirIdx);
+		}
+	}
+	for (auto& hostSubDir : std::exchange(retryHostDirs, {})) {
+		if (!contains(changes.newEntriesIn, hostSubDir)) {
+			changes.newEntriesIn.push_back(std::move(hostSubDir));
+		}
+	}
+	for (const auto& hostSubDir : changes.newEntriesIn) {
+		addNewHostFilesInDir(hostSubDir);
+	}
+}
+
+void DirAsDSK::fullSyncWithHost()
+{
+	retryHostDirs.clear(); // all directories are (re)scanned anyway
+
 	// Check for removed host files. This frees up space in the virtual
 	// disk. Do this first because otherwise later actions may fail (run
 	// out of virtual disk space) for no good reason.
@@ -437,19 +473,26 @@ void DirAsDSK::checkDeletedHostFiles()
 			// mapDirs. Ignore it.
 			continue;
 		}
-		auto fullHostName = tmpStrCat(hostDir, mapDir.hostName);
-		auto isMSXDirectory = bool(msxDir(dirIdx).attrib &
-		                           MSXDirEntry::Attrib::DIRECTORY);
-		auto fst = FileOperations::getStat(fullHostName);
-		if (!fst || (FileOperations::isDirectory(*fst) != isMSXDirectory)) {
-			// TODO also check access permission
-			// Error stat-ing file, or directory/file type is not
-			// the same on the msx and host side (e.g. a host file
-			// has been removed and a host directory with the same
-			// name has been created). In both cases delete the msx
-			// entry (if needed it will be recreated soon).
-			deleteMSXFile(dirIdx);
-		}
+		checkDeletedHostFile(dirIdx);
+	}
+}
+
+void DirAsDSK::checkDeletedHostFile(DirIndex dirIdx)
+{
+	const auto* mapDir = lookup(mapDirs, dirIdx);
+	assert(mapDir);
+	auto fullHostName = tmpStrCat(hostDir, mapDir->hostName);
+	auto isMSXDirectory = bool(msxDir(dirIdx).attrib &
+	                           MSXDirEntry::Attrib::DIRECTORY);
+	auto fst = FileOperations::getStat(fullHostName);
+	if (!fst || (FileOperations::isDirectory(*fst) != isMSXDirectory)) {
+		// TODO also check access permission
+		// Error stat-ing file, or directory/file type is not
+		// the same on the msx and host side (e.g. a host file
+		// has been removed and a host directory with the same
+		// name has been created). In both cases delete the msx
+		// entry (if needed it will be recreated soon).
+		deleteMSXFile(dirIdx);
 	}
 }
 
@@ -523,30 +566,37 @@ void DirAsDSK::checkModifiedHostFiles()
 			// See comment in checkDeletedHostFiles().
 			continue;
 		}
-		auto fullHostName = tmpStrCat(hostDir, mapDir.hostName);
-		auto isMSXDirectory = bool(msxDir(dirIdx).attrib &
-		                           MSXDirEntry::Attrib::DIRECTORY);
-		auto fst = FileOperations::getStat(fullHostName);
-		if (fst && (FileOperations::isDirectory(*fst) == isMSXDirectory)) {
-			// Detect changes in host file.
-			// Heuristic: we use filesize and modification time to detect
-			// changes in file content.
-			//  TODO do we need both filesize and mtime or is mtime alone
-			//       enough?
-			// We ignore time/size changes in directories,
-			// typically such a change indicates one of the files
-			// in that directory is changed/added/removed. But such
-			// changes are handled elsewhere.
-			if (!isMSXDirectory &&
-			    ((mapDir.mtime    != fst->st_mtime) ||
-			     (mapDir.filesize != size_t(fst->st_size)))) {
-				importHostFile(dirIdx, *fst);
-			}
-		} else {
-			// Only very rarely happens (because checkDeletedHostFiles()
-			// checked this just recently).
-			deleteMSXFile(dirIdx);
+		checkModifiedHostFile(dirIdx);
+	}
+}
+
+void DirAsDSK::checkModifiedHostFile(DirIndex dirIdx)
+{
+	const auto* mapDir = lookup(mapDirs, dirIdx);
+	assert(mapDir);
+	auto fullHostName = tmpStrCat(hostDir, mapDir->hostName);
+	auto isMSXDirectory = bool(msxDir(dirIdx).attrib &
+	                           MSXDirEntry::Attrib::DIRECTORY);
+	auto fst = FileOperations::getStat(fullHostName);
+	if (fst && (FileOperations::isDirectory(*fst) == isMSXDirectory)) {
+		// Detect changes in host file.
+		// Heuristic: we use filesize and modification time to detect
+		// changes in file content.
+		//  TODO do we need both filesize and mtime or is mtime alone
+		//       enough?
+		// We ignore time/size changes in directories,
+		// typically such a change indicates one of the files
+		// in that directory is changed/added/removed. But such
+		// changes are handled elsewhere.
+		if (!isMSXDirectory &&
+		    ((mapDir->mtime    != fst->st_mtime) ||
+		     (mapDir->filesize != size_t(fst->st_size)))) {
+			importHostFile(dirIdx, *fst);
 		}
+	} else {
+		// Only very rarely happens (because checkDeletedHostFiles()
+		// checked this just recently).
+		deleteMSXFile(dirIdx);
 	}
 }
 
@@ -740,10 +790,34 @@ void DirAsDSK::addNewHostFiles(const std::string& hostSubDir, unsigned msxDirSec
 			}
 		} catch (MSXException& e) {
 			cliComm.printWarning(e.getMessage());
+			if (!contains(retryHostDirs, hostSubDir)) {
+				retryHostDirs.push_back(hostSubDir);
+			}
 		}
 	}
 }
 
+void DirAsDSK::addNewHostFilesInDir(const std::string& hostSubDir)
+{
+	if (hostSubDir.empty()) {
+		addNewHostFiles({}, firstDirSector);
+		return;
+	}
+	// Locate the msx directory that corresponds to this host directory.
+	// When not found, the directory itself is new. Then it will be
+	// (recursively) added via its parent directory.
+	assert(hostSubDir.ends_with('/'));
+	auto dirIdx = findHostFileInDSK(std::string_view(hostSubDir).substr(0, hostSubDir.size() - 1));
+	if (dirIdx.sector == unsigned(-1)) return;
+	if (!(msxDir(dirIdx).attrib & MSXDirEntry::Attrib::DIRECTORY)) return;
+	unsigned cluster = msxDir(dirIdx).startCluster;
+	if ((cluster < FIRST_CLUSTER) || (cluster >= maxCluster)) {
+		// Sanity check on cluster range.
+		return;
+	}
+	addNewHostFiles(hostSubDir, clusterToSector(cluster));
+}
+
 void DirAsDSK::addNewDirectory(const std::string& hostSubDir, const std::string& hostName,
                                unsigned msxDirSector, const FileOperations::Stat& fst)
 {
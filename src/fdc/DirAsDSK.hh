@@ -1,6 +1,7 @@
 #ifndef DIRASDSK_HH
 #define DIRASDSK_HH
 
+#include "DirWatcher.hh"
 #include "DiskImageUtils.hh"
 #include "EmuTime.hh"
 #include "FileOperations.hh"
@@ -8,7 +9,9 @@
 
 #include "hash_map.hh"
 
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace openmsx {
 
@@ -71,7 +74,9 @@ private:
 	void writeDIREntry(DirIndex dirIndex, DirIndex dirDirIndex,
 	                   const MSXDirEntry& newEntry);
 	void syncWithHost();
+	void fullSyncWithHost();
 	void checkDeletedHostFiles();
+	void checkDeletedHostFile(DirIndex dirIdx);
 	void deleteMSXFile(DirIndex dirIndex);
 	void deleteMSXFilesInDir(unsigned msxDirSector);
 	void freeFATChain(unsigned cluster);
@@ -90,6 +95,8 @@ private:
 	[[nodiscard]] bool checkMSXFileExists(std::span<const char, 11> msxfilename,
 	                                      unsigned msxDirSector);
 	void checkModifiedHostFiles();
+	void checkModifiedHostFile(DirIndex dirIdx);
+	void addNewHostFilesInDir(const std::string& hostSubDir);
 	void setMSXTimeStamp(DirIndex dirIndex, const FileOperations::Stat& fst);
 	void importHostFile(DirIndex dirIndex, const FileOperations::Stat& fst);
 	void exportToHost(DirIndex dirIndex, DirIndex dirDirIndex);
@@ -134,6 +141,13 @@ private:
 
 	EmuTime lastAccess = EmuTime::zero(); // last time there was a sector read/write
 
+	// Tracks which host files changed since the last sync.
+	DirWatcher dirWatcher;
+	// Host (sub)directories containing files that failed to import (e.g.
+	// because the virtual disk was full). Retried on the next sync, even
+	// when nothing changed on the host.
+	std::vector<std::string> retryHostDirs;
+
 	// For each directory entry that has a mapped host file/directory we
 	// store the name, last modification time and size of the corresponding
 	// host file/dir.
@@ -21,6 +21,12 @@ void Disk::writeTrack(uint8_t track, uint8_t side, const RawTrack& input)
 	flushCaches();
 }
 
+void Disk::flushCaches()
+{
+	SectorAccessibleDisk::flushCaches();
+	trackCache.clear();
+}
+
 bool Disk::isDoubleSided()
 {
 	if (!nbSides) {
@@ -3,13 +3,12 @@
 
 #include "DiskName.hh"
 #include "SectorAccessibleDisk.hh"
+#include "TrackCache.hh"
 
 #include <cstdint>
 
 namespace openmsx {
 
-class RawTrack;
-
 class Disk : public SectorAccessibleDisk
 {
 public:
@@ -31,6 +30,10 @@ public:
 
 	[[nodiscard]] bool isDoubleSided();
 
+	/** Set the number of tracks that are kept in the (decoded) track
+	  * cache, see TrackCache. Zero disables caching. */
+	void setTrackCacheSize(unsigned size) { trackCache.resize(size); }
+
 protected:
 	explicit Disk(DiskName name);
 	[[nodiscard]] size_t physToLog(uint8_t track, uint8_t side, uint8_t sector);
@@ -46,6 +49,11 @@ protected:
 
 	virtual void writeTrackImpl(uint8_t track, uint8_t side, const RawTrack& input) = 0;
 
+	void flushCaches() override;
+
+protected:
+	TrackCache trackCache;
+
 private:
 	const DiskName name;
 	unsigned sectorsPerTrack;
@@ -13,6 +13,7 @@
 #include "Reactor.hh"
 
 #include "StringOp.hh"
+#include "narrow.hh"
 
 #include <memory>
 
@@ -32,11 +33,24 @@ DiskFactory::DiskFactory(Reactor& reactor_)
 		DirAsDSK::BootSectorType::DOS2, EnumSetting<DirAsDSK::BootSectorType>::Map{
 			{"DOS1", DirAsDSK::BootSectorType::DOS1},
 			{"DOS2", DirAsDSK::BootSectorType::DOS2}})
+	, trackCacheSetting(
+		reactor.getCommandController(), "disk_track_cache_size",
+		"number of tracks per disk image that are kept in the track cache, "
+		"only has effect on newly inserted disks",
+		TrackCache::DEFAULT_SIZE, 0, 160)
 {
 }
 
 std::unique_ptr<Disk> DiskFactory::createDisk(
 	const std::string& diskImage, DiskChanger& diskChanger)
+{
+	auto disk = createDiskImpl(diskImage, diskChanger);
+	disk->setTrackCacheSize(narrow<unsigned>(trackCacheSetting.getInt()));
+	return disk;
+}
+
+std::unique_ptr<Disk> DiskFactory::createDiskImpl(
+	const std::string& diskImage, DiskChanger& diskChanger)
 {
 	if (diskImage == "ramdsk") {
 		return std::make_unique<RamDSKDiskImage>();
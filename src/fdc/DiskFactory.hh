@@ -3,6 +3,7 @@
 
 #include "DirAsDSK.hh"
 #include "EnumSetting.hh"
+#include "IntegerSetting.hh"
 #include <string>
 
 namespace openmsx {
@@ -18,10 +19,15 @@ public:
 	[[nodiscard]] std::unique_ptr<Disk> createDisk(
 		const std::string& diskImage, DiskChanger& diskChanger);
 
+private:
+	[[nodiscard]] std::unique_ptr<Disk> createDiskImpl(
+		const std::string& diskImage, DiskChanger& diskChanger);
+
 private:
 	Reactor& reactor;
 	EnumSetting<DirAsDSK::SyncMode> syncDirAsDSKSetting;
 	EnumSetting<DirAsDSK::BootSectorType> bootSectorSetting;
+	IntegerSetting trackCacheSetting;
 };
 
 } // namespace openmsx
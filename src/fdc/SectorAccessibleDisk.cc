@@ -3,6 +3,8 @@
 #include "DiskExceptions.hh"
 #include "DiskImageUtils.hh"
 #include "EmptyDiskPatch.hh"
+#include "File.hh"
+#include "FileException.hh"
 #include "IPSPatch.hh"
 
 #include "enumerate.hh"
@@ -90,12 +92,41 @@ void SectorAccessibleDisk::writeSectors(
 	}
 }
 
-
 size_t SectorAccessibleDisk::getNbSectors()
 {
 	return getNbSectorsImpl();
 }
 
+std::span<const SectorBuffer> SectorAccessibleDisk::getSectorsView(
+	size_t startSector, size_t num)
+{
+	// Patches are applied while copying (in readSectors()), so there's
+	// no unpatched direct view possible.
+	if (hasPatches() || (num == 0)) return {};
+	return getSectorsViewImpl(startSector, num);
+}
+
+std::span<const SectorBuffer> SectorAccessibleDisk::getSectorsViewImpl(
+	size_t /*startSector*/, size_t /*num*/)
+{
+	return {};
+}
+
+MappedFile<SectorBuffer> SectorAccessibleDisk::mapImageFile(File& file)
+{
+	// For compressed images the (decompressed) content is already held
+	// in memory, mapping it would only create yet another copy.
+	if (!file.isLocalFile()) return {};
+	try {
+		// Only the accessed sectors get read from disk, don't read
+		// a (multi-GB) hard disk image in advance.
+		return file.mmap<SectorBuffer>(0, false);
+	} catch (FileException&) {
+		// e.g. not enough address space for a huge image
+		return {};
+	}
+}
+
 void SectorAccessibleDisk::applyPatch(Filename patchFile)
 {
 	patch = std::make_unique<IPSPatch>(std::move(patchFile), std::move(patch));
@@ -3,6 +3,7 @@
 
 #include "DiskImageUtils.hh"
 #include "Filename.hh"
+#include "MappedFile.hh"
 
 #include "sha1.hh"
 
@@ -12,6 +13,7 @@
 
 namespace openmsx {
 
+class File;
 class FilePool;
 class PatchInterface;
 
@@ -27,6 +29,16 @@ public:
 	void writeSectors(std::span<const SectorBuffer> buffers, size_t startSector);
 	[[nodiscard]] size_t getNbSectors();
 
+	/** Get direct (zero-copy) read-only access to a range of sectors.
+	 * This is only possible for some types of disk images (e.g. memory
+	 * mapped image files) and only when no patches are applied. When it's
+	 * not possible, an empty span is returned and the caller should fall
+	 * back to readSectors(). The result remains valid till the next
+	 * (non-const) operation on this disk.
+	 */
+	[[nodiscard]] std::span<const SectorBuffer> getSectorsView(
+		size_t startSector, size_t num);
+
 	// write protected stuff
 	[[nodiscard]] bool isWriteProtected() const;
 	void forceWriteProtect();
@@ -64,6 +76,20 @@ protected:
 	virtual void flushCaches();
 	virtual Sha1Sum getSha1SumImpl(FilePool& filePool);
 
+	// Default implementation returns an empty span (no direct access).
+	[[nodiscard]] virtual std::span<const SectorBuffer> getSectorsViewImpl(
+		size_t startSector, size_t num);
+
+	/** Helper for disk images backed by a File: memory map the whole
+	 * image so that sectors can be accessed without a seek()+read() per
+	 * sector. This only maps regular (uncompressed) local files, for
+	 * other files (or when mapping fails) an empty MappedFile is returned
+	 * and the caller should keep using regular file I/O.
+	 * The mapping is private: writes must be done both to the file and to
+	 * the mapping.
+	 */
+	[[nodiscard]] static MappedFile<SectorBuffer> mapImageFile(File& file);
+
 private:
 	virtual void writeSectorImpl(size_t sector, const SectorBuffer& buf) = 0;
 	[[nodiscard]] virtual size_t getNbSectorsImpl() = 0;
@@ -1,6 +1,7 @@
 #include "SectorBasedDisk.hh"
 
 #include "MSXException.hh"
+#include "RawTrack.hh"
 
 #include "narrow.hh"
 #include "xrange.hh"
@@ -34,21 +35,20 @@ void SectorBasedDisk::writeTrackImpl(uint8_t track, uint8_t side, const RawTrack
 
 void SectorBasedDisk::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 {
-	// Try to cache the last result of this method (the cache will be
-	// flushed on any write to the disk). This very simple cache mechanism
-	// will typically already have a very high hit-rate. For example during
-	// emulation of a WD2793 read sector, we also emulate the search for
-	// the correct sector. So the disk rotates from sector to sector, and
-	// each time we re-read the track data (because EmuTime has passed).
-	// Typically the software will also read several sectors from the same
-	// track before moving to the next.
+	// Cache the result of this method (the cache will be flushed on any
+	// write to the disk). For example during emulation of a WD2793 read
+	// sector, we also emulate the search for the correct sector. So the
+	// disk rotates from sector to sector, and each time we re-read the
+	// track data (because EmuTime has passed). Typically the software
+	// will also read several sectors from the same track before moving
+	// to the next, or it alternates between the two sides of a cylinder
+	// or between the FAT/directory and the data area. That's why we keep
+	// a few tracks instead of only the last one.
 	checkCaches();
-	int num = track | (side << 8);
-	if (num == cachedTrackNum) {
-		output = cachedTrackData;
+	if (const auto* cached = trackCache.find(track, side)) {
+		output = *cached;
 		return;
 	}
-	cachedTrackNum = num;
 
 	// This disk image only stores the actual sector data, not all the
 	// extra gap, sync and header information that is in reality stored
@@ -116,8 +116,12 @@ void SectorBasedDisk::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 
 			auto logicalSector = physToLog(track, side, narrow<uint8_t>(j + 1));
 			SectorBuffer buf;
-			readSector(logicalSector, buf);
-			for (auto r : buf.raw) output.write(idx++, r);
+			auto view = getSectorsView(logicalSector, 1);
+			if (view.empty()) {
+				readSector(logicalSector, buf);
+				view = std::span{&buf, 1};
+			}
+			for (auto r : view[0].raw) output.write(idx++, r);
 
 			uint16_t dataCrc = output.calcCrc(idx - (512 + 4), 512 + 4);
 			output.write(idx++, narrow_cast<uint8_t>(dataCrc >> 8));   // CRC (high byte)
@@ -135,15 +139,11 @@ void SectorBasedDisk::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 		// real disk, you simply read an 'empty' track. So we do the
 		// same here.
 		output.clear(RawTrack::STANDARD_SIZE);
-		cachedTrackNum = -1; // needed?
+		return; // don't cache
+	}
+	if (auto* entry = trackCache.insert(track, side)) {
+		*entry = output;
 	}
-	cachedTrackData = output;
-}
-
-void SectorBasedDisk::flushCaches()
-{
-	Disk::flushCaches();
-	cachedTrackNum = -1;
 }
 
 size_t SectorBasedDisk::getNbSectorsImpl()
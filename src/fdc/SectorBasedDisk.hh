@@ -2,7 +2,6 @@
 #define SECTORBASEDDISK_HH
 
 #include "Disk.hh"
-#include "RawTrack.hh"
 
 namespace openmsx {
 
@@ -15,7 +14,6 @@ class SectorBasedDisk : public Disk
 protected:
 	explicit SectorBasedDisk(DiskName name);
 	void detectGeometry() override;
-	void flushCaches() override;
 
 	void setNbSectors(size_t num);
 
@@ -30,8 +28,6 @@ private:
 
 private:
 	size_t nbSectors = size_t(-1); // to detect misuse
-	RawTrack cachedTrackData;
-	int cachedTrackNum = -1;
 };
 
 } // namespace openmsx
@@ -0,0 +1,57 @@
+#include "TrackCache.hh"
+
+#include <algorithm>
+
+namespace openmsx {
+
+[[nodiscard]] static constexpr int trackNum(uint8_t track, uint8_t side)
+{
+	return track | (side << 8);
+}
+
+TrackCache::TrackCache(unsigned size)
+	: entries(size)
+{
+}
+
+void TrackCache::resize(unsigned size)
+{
+	entries.clear();
+	entries.resize(size);
+	useCounter = 0;
+}
+
+const RawTrack* TrackCache::find(uint8_t track, uint8_t side)
+{
+	int num = trackNum(track, side);
+	auto it = std::ranges::find(entries, num, &Entry::num);
+	if (it == entries.end()) return nullptr;
+	it->lastUse = ++useCounter;
+	return &it->data;
+}
+
+RawTrack* TrackCache::insert(uint8_t track, uint8_t side)
+{
+	if (entries.empty()) return nullptr;
+	int num = trackNum(track, side);
+	// Prefer an existing entry for the same track, otherwise take the
+	// least recently used one (unused entries have 'lastUse == 0').
+	auto it = std::ranges::find(entries, num, &Entry::num);
+	if (it == entries.end()) {
+		it = std::ranges::min_element(entries, {}, &Entry::lastUse);
+	}
+	it->num = num;
+	it->lastUse = ++useCounter;
+	return &it->data;
+}
+
+void TrackCache::clear()
+{
+	for (auto& e : entries) {
+		e.num = -1;
+		e.lastUse = 0;
+	}
+	useCounter = 0;
+}
+
+} // namespace openmsx
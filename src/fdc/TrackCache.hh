@@ -0,0 +1,57 @@
+#ifndef TRACKCACHE_HH
+#define TRACKCACHE_HH
+
+#include "RawTrack.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace openmsx {
+
+/** Small LRU cache of RawTracks, indexed by (track, side).
+  *
+  * Producing a RawTrack is relatively expensive: for sector based images
+  * the full track (gaps, headers, CRCs) must be synthesized, for DMK
+  * images it must be read from the file. Emulated disk software often
+  * alternates between a couple of tracks (e.g. FAT, directory and data
+  * area, or both sides of the same cylinder), so remembering more than
+  * just the last track avoids most of that work.
+  *
+  * The cache must be cleared on any change to the disk content.
+  */
+class TrackCache
+{
+public:
+	static constexpr unsigned DEFAULT_SIZE = 8;
+
+	explicit TrackCache(unsigned size = DEFAULT_SIZE);
+
+	/** Change the number of cached tracks. This also clears the cache.
+	  * A size of zero disables caching. */
+	void resize(unsigned size);
+	[[nodiscard]] unsigned size() const { return unsigned(entries.size()); }
+
+	/** Returns the cached track, or nullptr on a cache miss. */
+	[[nodiscard]] const RawTrack* find(uint8_t track, uint8_t side);
+
+	/** Reserve an entry for the given track (evicting the least recently
+	  * used one) and return it so that the caller can fill it in.
+	  * Returns nullptr when caching is disabled. */
+	[[nodiscard]] RawTrack* insert(uint8_t track, uint8_t side);
+
+	/** Remove all tracks from the cache. */
+	void clear();
+
+private:
+	struct Entry {
+		RawTrack data;
+		int num = -1; // track | (side << 8), or -1 when unused
+		uint32_t lastUse = 0;
+	};
+	std::vector<Entry> entries;
+	uint32_t useCounter = 0;
+};
+
+} // namespace openmsx
+
+#endif
@@ -1,12 +1,15 @@
 #include "CompressedFileAdapter.hh"
 
 #include "FileException.hh"
+#include "FileOperations.hh"
 #include "MappedFile.hh"
+#include "ZlibInflate.hh"
 
 #include "hash_set.hh"
 #include "ranges.hh"
 #include "xxhash.hh"
 
+#include <algorithm>
 #include <cstring>
 
 namespace openmsx {
@@ -40,14 +43,37 @@ CompressedFileAdapter::~CompressedFileAdapter()
 	}
 }
 
+void CompressedFileAdapter::open()
+{
+	if (decompressed || indexed) return;
+
+	if (!decompressCache.contains(filename)) {
+		// don't read the whole (possibly huge) file in advance, in
+		// indexed mode only small parts of it get accessed
+		auto input = MappedFile<const uint8_t>(file->mmap(0, true, false));
+		auto header = parseHeader(input);
+		// (For gzip the size hint is only correct modulo 4GB.)
+		if (std::max(header.sizeHint, input.size()) >= INDEX_THRESHOLD) {
+			openIndexed(std::move(input), std::move(header));
+			return;
+		}
+	}
+	decompress();
+}
+
 void CompressedFileAdapter::decompress()
 {
 	if (decompressed) return;
+	indexed.reset(); // e.g. mmap() was called after read()
 
 	auto it = decompressCache.find(filename);
 	if (it == end(decompressCache)) {
 		auto d = std::make_unique<Decompressed>();
-		decompress(*file, *d);
+		auto input = MappedFile<const uint8_t>(file->mmap(0, true, true));
+		auto header = parseHeader(input);
+		ZlibInflate zlib(std::span<const uint8_t>(input).subspan(header.dataOffset));
+		d->buf = zlib.inflate(header.sizeHint);
+		d->originalName = std::move(header.originalName);
 		d->cachedModificationDate = getModificationDate();
 		d->cachedURL = filename;
 		it = decompressCache.insert_noDuplicateCheck(std::move(d));
@@ -59,9 +85,71 @@ void CompressedFileAdapter::decompress()
 	file.reset();
 }
 
+void CompressedFileAdapter::openIndexed(MappedFile<const uint8_t> input, Header header)
+{
+	auto ind = std::make_unique<Indexed>();
+	auto data = std::span<const uint8_t>(input).subspan(header.dataOffset);
+
+	// The index is cached on disk, it's only valid for this exact
+	// (compressed) file.
+	FileOperations::FileStamp stamp{
+		.size = input.size(),
+		.modificationDate = uint64_t(getModificationDate())};
+	auto indexFile = FileOperations::getCacheFileName(".inflateindex", filename, ".idx");
+	if (auto index = InflateIndex::load(indexFile, stamp)) {
+		ind->index = std::move(*index);
+	} else {
+		ind->index = InflateIndex::build(data);
+		try {
+			FileOperations::prepareCacheFile(indexFile);
+			ind->index.save(indexFile, stamp);
+		} catch (FileException&) {
+			// ignore, we'll rebuild the index next time
+		}
+	}
+	ind->input = std::move(input);
+	ind->dataOffset = header.dataOffset;
+	ind->originalName = std::move(header.originalName);
+	indexed = std::move(ind);
+}
+
+std::span<const uint8_t> CompressedFileAdapter::getChunk(size_t chunk)
+{
+	auto& ind = *indexed;
+	++ind.useCounter;
+	if (auto it = std::ranges::find(ind.cache, chunk, &CachedChunk::chunk);
+	    it != ind.cache.end()) {
+		it->lastUse = ind.useCounter;
+		return it->data;
+	}
+	// Replace the least recently used entry.
+	auto& entry = *std::ranges::min_element(ind.cache, {}, &CachedChunk::lastUse);
+	entry.chunk = size_t(-1); // in case extract() throws
+	entry.data = ind.index.extract(
+		std::span<const uint8_t>(ind.input).subspan(ind.dataOffset), chunk);
+	entry.chunk = chunk;
+	entry.lastUse = ind.useCounter;
+	return entry.data;
+}
+
 void CompressedFileAdapter::read(std::span<uint8_t> buffer)
 {
-	decompress();
+	open();
+	if (indexed) {
+		const auto& index = indexed->index;
+		if (index.size() < (pos + buffer.size())) {
+			throw FileException("Read beyond end of file");
+		}
+		while (!buffer.empty()) {
+			auto chunk = index.chunkOf(pos);
+			auto data = getChunk(chunk).subspan(pos - index.chunkBegin(chunk));
+			auto num = std::min(data.size(), buffer.size());
+			copy_to_range(data.first(num), buffer);
+			buffer = buffer.subspan(num);
+			pos += num;
+		}
+		return;
+	}
 	if (decompressed->buf.size() < (pos + buffer.size())) {
 		throw FileException("Read beyond end of file");
 	}
@@ -74,7 +162,7 @@ void CompressedFileAdapter::write(std::span<const uint8_t> /*buffer*/)
 	throw FileException("Writing to compressed files not yet supported");
 }
 
-MappedFileImpl CompressedFileAdapter::mmap(size_t extra, bool is_const)
+MappedFileImpl CompressedFileAdapter::mmap(size_t extra, bool is_const, bool /*populate*/)
 {
 	decompress();
 	return {std::span{decompressed->buf}, extra, is_const};
@@ -82,8 +170,8 @@ MappedFileImpl CompressedFileAdapter::mmap(size_t extra, bool is_const)
 
 size_t CompressedFileAdapter::getSize()
 {
-	decompress();
-	return decompressed->buf.size();
+	open();
+	return indexed ? indexed->index.size() : decompressed->buf.size();
 }
 
 void CompressedFileAdapter::seek(size_t newPos)
@@ -108,8 +196,8 @@ void CompressedFileAdapter::flush()
 
 zstring_view CompressedFileAdapter::getOriginalName()
 {
-	decompress();
-	return decompressed->originalName;
+	open();
+	return indexed ? indexed->originalName : decompressed->originalName;
 }
 
 bool CompressedFileAdapter::isReadOnly() const
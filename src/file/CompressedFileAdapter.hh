@@ -2,10 +2,13 @@
 #define COMPRESSEDFILEADAPTER_HH
 
 #include "FileBase.hh"
+#include "InflateIndex.hh"
+#include "MappedFile.hh"
 
 #include "MemBuffer.hh"
 #include "zstring_view.hh"
 
+#include <array>
 #include <memory>
 
 namespace openmsx {
@@ -23,7 +26,7 @@ public:
 
 	void read(std::span<uint8_t> buffer) final;
 	void write(std::span<const uint8_t> buffer) final;
-	[[nodiscard]] MappedFileImpl mmap(size_t extra, bool is_const) final;
+	[[nodiscard]] MappedFileImpl mmap(size_t extra, bool is_const, bool populate) final;
 	[[nodiscard]] size_t getSize() final;
 	void seek(size_t pos) final;
 	[[nodiscard]] size_t getPos() final;
@@ -34,18 +37,53 @@ public:
 	[[nodiscard]] time_t getModificationDate() final;
 
 protected:
+	struct Header {
+		std::string originalName;
+		size_t dataOffset = 0;   // start of the raw deflate stream
+		size_t sizeHint = 65536; // expected size of the decompressed data
+	};
+
 	explicit CompressedFileAdapter(std::unique_ptr<FileBase> file, zstring_view filename);
 	~CompressedFileAdapter() override;
-	virtual void decompress(FileBase& file, Decompressed& decompressed) = 0;
+
+	/** Parse the header of the compressed container format.
+	  * @param data The full (compressed) file content.
+	  * @throws FileException when the header is invalid.
+	  */
+	[[nodiscard]] virtual Header parseHeader(std::span<const uint8_t> data) = 0;
 
 private:
+	// Large files are not fully decompressed in memory. Instead we build
+	// (or load from a previous session) an InflateIndex and decompress
+	// only the chunks that are actually read.
+	static constexpr size_t INDEX_THRESHOLD = 16 * 1024 * 1024;
+
+	struct CachedChunk {
+		size_t chunk = size_t(-1);
+		uint64_t lastUse = 0;
+		MemBuffer<uint8_t> data;
+	};
+	struct Indexed {
+		MappedFile<const uint8_t> input; // the compressed file
+		size_t dataOffset;
+		std::string originalName;
+		InflateIndex index;
+		std::array<CachedChunk, 4> cache; // recently decompressed chunks
+		uint64_t useCounter = 0;
+	};
+
+	void open();
 	void decompress();
+	void openIndexed(MappedFile<const uint8_t> input, Header header);
+	[[nodiscard]] std::span<const uint8_t> getChunk(size_t chunk);
 
 private:
 	// invariant: exactly one of 'file' and 'decompressed' is '!= nullptr'
+	//            'indexed' can only be set when 'file' is set
 	std::unique_ptr<FileBase> file;
 	std::string filename;
 	const Decompressed* decompressed = nullptr;
+	std::unique_ptr<Indexed> indexed;
 	size_t pos = 0;
 };
 
@@ -0,0 +1,171 @@
+#include "DirWatcher.hh"
+
+#include "FileOperations.hh"
+#include "ReadDir.hh"
+
+#include "one_of.hh"
+#include "strCat.hh"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace openmsx {
+
+DirWatcher::DirWatcher(std::string dir)
+	: hostDir(std::move(dir))
+{
+	assert(hostDir.ends_with('/'));
+#ifdef __linux__
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd != -1) {
+		addWatches({});
+	}
+#endif
+}
+
+DirWatcher::~DirWatcher()
+{
+	stop();
+}
+
+bool DirWatcher::isActive() const
+{
+#ifdef __linux__
+	return fd != -1;
+#else
+	return false;
+#endif
+}
+
+void DirWatcher::stop()
+{
+#ifdef __linux__
+	if (fd != -1) {
+		close(fd); // also removes all watches
+		fd = -1;
+	}
+	watches.clear();
+#endif
+}
+
+void DirWatcher::addWatches([[maybe_unused]] const std::string& subDir)
+{
+#ifdef __linux__
+	if (fd == -1) return;
+
+	static constexpr uint32_t MASK =
+		IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+		IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+		IN_ONLYDIR;
+	auto path = strCat(hostDir, subDir);
+	int wd = inotify_add_watch(fd, path.c_str(), MASK);
+	if (wd == -1) {
+		if (errno == one_of(ENOENT, ENOTDIR)) {
+			// Already removed again, we'll get an event for that.
+			return;
+		}
+		// Typically ENOSPC (too many watches), we can't reliably
+		// track changes anymore, switch to polling.
+		stop();
+		return;
+	}
+	watches[wd] = subDir;
+
+	ReadDir dir(path);
+	while (auto* d = dir.getEntry()) {
+		std::string_view name = d->d_name;
+		if (name.starts_with('.')) continue; // also skips '.' and '..'
+		auto sub = strCat(subDir, name, '/');
+		if (FileOperations::isDirectory(strCat(hostDir, sub))) {
+			addWatches(sub);
+		}
+	}
+#endif
+}
+
+DirWatcher::Changes DirWatcher::readChanges()
+{
+	Changes result;
+#ifdef __linux__
+	// Process all pending events.
+	alignas(inotify_event) std::array<char, 4096> buf;
+	while (!needFullScan && (fd != -1)) {
+		auto len = read(fd, buf.data(), buf.size());
+		if (len <= 0) break; // EAGAIN: no more events
+
+		for (ssize_t pos = 0; pos < len; /**/) {
+			inotify_event event;
+			memcpy(&event, &buf[pos], sizeof(event));
+			const char* namePtr = &buf[pos + sizeof(event)];
+			pos += ssize_t(sizeof(event) + event.len);
+
+			if (event.mask & IN_Q_OVERFLOW) {
+				// Events were dropped.
+				needFullScan = true;
+				break;
+			}
+			const auto* subDir = lookup(watches, event.wd);
+			if (!subDir) continue; // watch was already removed
+			if (event.mask & IN_IGNORED) {
+				watches.erase(event.wd);
+				continue;
+			}
+			if (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+				if (subDir->empty()) {
+					// The top directory itself is gone.
+					needFullScan = true;
+					break;
+				}
+				continue; // reported via the parent directory
+			}
+			if (event.len == 0) continue;
+			// zero-terminated (and possibly zero-padded) within 'event.len'
+			std::string_view name(namePtr, strnlen(namePtr, event.len));
+			if (name.starts_with('.')) continue;
+
+			auto path = strCat(*subDir, name);
+			if (event.mask & (IN_DELETE | IN_MOVED_FROM)) {
+				result.removed.push_back(std::move(path));
+				continue;
+			}
+			if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+				result.newEntriesIn.push_back(*subDir);
+				if (event.mask & IN_ISDIR) {
+					addWatches(strCat(path, '/'));
+					continue;
+				}
+			}
+			if (!(event.mask & IN_ISDIR)) {
+				// Also for IN_MOVED_TO: possibly an existing
+				// file got replaced.
+				result.modified.push_back(std::move(path));
+			}
+		}
+	}
+#endif
+	if (needFullScan || !isActive()) {
+		needFullScan = false;
+		Changes full;
+		full.fullScan = true;
+		return full;
+	}
+
+	auto removeDuplicates = [](std::vector<std::string>& v) {
+		std::ranges::sort(v);
+		v.erase(std::ranges::unique(v).begin(), v.end());
+	};
+	removeDuplicates(result.modified);
+	removeDuplicates(result.removed);
+	removeDuplicates(result.newEntriesIn);
+	return result;
+}
+
+} // namespace openmsx
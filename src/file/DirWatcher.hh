@@ -0,0 +1,75 @@
+#ifndef DIRWATCHER_HH
+#define DIRWATCHER_HH
+
+#include "hash_map.hh"
+
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+/** Watches a host directory (recursively) for changes.
+ *
+ * This allows a client to only re-examine those host files that actually
+ * changed, instead of periodically stat()-ing all of them. On Linux this is
+ * implemented via inotify. On other platforms (or when inotify cannot be
+ * used, e.g. because the per-user limit on watches is reached) the watcher
+ * is inactive and readChanges() always requests a full rescan, so the
+ * client falls back to polling.
+ *
+ * Hidden entries (name starting with '.') are not reported.
+ */
+class DirWatcher
+{
+public:
+	struct Changes {
+		// All paths are relative to the watched directory.
+		std::vector<std::string> modified; // content (possibly) changed
+		std::vector<std::string> removed;  // deleted or renamed away
+		// Directories (ending in '/', or empty for the top directory)
+		// that (possibly) got new entries.
+		std::vector<std::string> newEntriesIn;
+		// When set, the lists above are incomplete: rescan everything.
+		bool fullScan = false;
+
+		[[nodiscard]] bool empty() const {
+			return !fullScan && modified.empty() && removed.empty() &&
+			       newEntriesIn.empty();
+		}
+	};
+
+public:
+	/** @param dir The directory to watch, must end in '/'. */
+	explicit DirWatcher(std::string dir);
+	DirWatcher(const DirWatcher&) = delete;
+	DirWatcher(DirWatcher&&) = delete;
+	DirWatcher& operator=(const DirWatcher&) = delete;
+	DirWatcher& operator=(DirWatcher&&) = delete;
+	~DirWatcher();
+
+	/** Are changes being tracked (true) or does every call to
+	  * readChanges() request a full rescan (false)?
+	  */
+	[[nodiscard]] bool isActive() const;
+
+	/** Returns all changes since the previous call (never blocks).
+	  * The first call after construction always requests a full scan.
+	  */
+	[[nodiscard]] Changes readChanges();
+
+private:
+	void addWatches(const std::string& subDir);
+	void stop();
+
+private:
+	const std::string hostDir;
+	bool needFullScan = true;
+#ifdef __linux__
+	hash_map<int, std::string> watches; // watch descriptor -> subdir
+	int fd = -1;
+#endif
+};
+
+} // namespace openmsx
+
+#endif
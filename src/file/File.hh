@@ -102,10 +102,14 @@ public:
 	 * terminator after the file. Often this implementation can do that
 	 * without extra cost (so no need to allocate a buffer, read the file
 	 * and add some zeros).
+	 *
+	 * By default the whole file is read when it's mapped. For (huge) files
+	 * of which only small parts get accessed, pass 'populate=false', then
+	 * the parts are only read from disk on first access.
 	 */
 	template<typename T>
-	[[nodiscard]] MappedFile<T> mmap(size_t extra = 0) {
-		return MappedFile<T>(file->mmap(extra * sizeof(T), std::is_const_v<T>));
+	[[nodiscard]] MappedFile<T> mmap(size_t extra = 0, bool populate = true) {
+		return MappedFile<T>(file->mmap(extra * sizeof(T), std::is_const_v<T>, populate));
 	}
 
 	/** Returns the size of this file
@@ -156,11 +160,13 @@ public:
 	 */
 	[[nodiscard]] time_t getModificationDate();
 
-private:
-	friend class LocalFileReference;
-	/** This is an internal method used by LocalFileReference. */
+	/** Is this a regular (uncompressed) file on the local filesystem?
+	 * Only for such files mmap() really maps the file, for other files
+	 * it returns (a copy of) an in-memory buffer.
+	 */
 	[[nodiscard]] bool isLocalFile() const;
 
+private:
 	std::unique_ptr<FileBase> file;
 };
 
@@ -2,10 +2,12 @@
 
 #include "FileException.hh"
 #include "ReadDir.hh"
+#include "foreach_file.hh"
 
 #include "StringOp.hh"
 #include "narrow.hh"
 #include "one_of.hh"
+#include "sha1.hh"
 #include "strCat.hh"
 #include "unistdp.hh"
 
@@ -13,13 +15,17 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
 #include <cerrno>
 #include <cstdlib>
 #include <filesystem>
 #include <format>
 #include <iterator>
+#include <span>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #ifdef	_WIN32
 #ifndef _WIN32_IE
@@ -425,6 +431,48 @@ const std::string& getUserDataDir()
 	return *result;
 }
 
+// Per directory. An entry that is still in use but got evicted is simply
+// rebuilt the next time.
+static constexpr size_t MAX_CACHE_ENTRIES = 64;
+
+std::string getCacheFileName(
+	std::string_view cacheDir, std::string_view filename, std::string_view extension)
+{
+	auto path = getAbsolutePath(expandTilde(std::string(filename)));
+	std::error_code ec;
+	if (auto resolved = fs::weakly_canonical(makeFsPath(path), ec); !ec) {
+#ifdef _WIN32
+		path = getConventionalPath(utf16to8(resolved.wstring()));
+#else
+		path = resolved.string();
+#endif
+	}
+	return strCat(getUserDataDir(), '/', cacheDir, '/',
+		SHA1::calc({std::bit_cast<const uint8_t*>(path.data()), path.size()}),
+		extension);
+}
+
+void prepareCacheFile(zstring_view cacheFile)
+{
+	auto dir = std::string(getDirName(cacheFile));
+	mkdirp(dir);
+
+	// Keep the most recently written entries. The entry that's about to
+	// be (re)written doesn't count.
+	std::vector<std::pair<time_t, std::string>> entries;
+	foreach_file(dir, [&](const std::string& path, const Stat& st) {
+		if (path != cacheFile.view()) {
+			entries.emplace_back(getModificationDate(st), path);
+		}
+	});
+	if (entries.size() < MAX_CACHE_ENTRIES) return;
+	auto numRemove = entries.size() - (MAX_CACHE_ENTRIES - 1);
+	std::ranges::nth_element(entries, entries.begin() + narrow<ptrdiff_t>(numRemove - 1));
+	for (const auto& e : std::span{entries}.first(numRemove)) {
+		unlink(e.second); // ignore errors
+	}
+}
+
 const std::string& getSystemDataDir()
 {
 	static std::optional<std::string> result;
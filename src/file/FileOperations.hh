@@ -6,6 +6,7 @@
 #include "unistdp.hh" // needed for mode_t definition when building with VC++
 #include "zstring_view.hh"
 
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <optional>
@@ -242,6 +243,35 @@ namespace openmsx::FileOperations {
 	 */
 	[[nodiscard]] const std::string& getUserDataDir();
 
+	/**
+	 * Identifies one version of a file. Data that is derived from a file
+	 * and cached on disk (see getCacheFileName()) is only valid as long as
+	 * the size and the modification time of that file don't change.
+	 */
+	struct FileStamp {
+		uint64_t size = 0;
+		uint64_t modificationDate = 0;
+		[[nodiscard]] bool operator==(const FileStamp&) const = default;
+	};
+
+	/**
+	 * Get the name of the file in which data derived from 'filename' is
+	 * cached. That's a file in the directory 'cacheDir' (e.g. ".oggindex")
+	 * in the user data dir, named after the SHA1 of the resolved absolute
+	 * path of 'filename'. So the same file always gets the same entry, no
+	 * matter how it was opened.
+	 */
+	[[nodiscard]] std::string getCacheFileName(
+		std::string_view cacheDir, std::string_view filename, std::string_view extension);
+
+	/**
+	 * Call this before (re)writing a cache file obtained from
+	 * getCacheFileName(). It creates the directory when needed and removes
+	 * the oldest entries in it, so that the number of entries stays limited.
+	 * @throws FileException
+	 */
+	void prepareCacheFile(zstring_view cacheFile);
+
 	/**
 	 * Get system directory.
 	 * UNI*Y: statically defined as "/opt/openMSX/share".
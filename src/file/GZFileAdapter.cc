@@ -1,9 +1,12 @@
 #include "GZFileAdapter.hh"
 
 #include "FileException.hh"
-#include "MappedFile.hh"
 #include "ZlibInflate.hh"
 
+#include "endian.hh"
+
+#include <algorithm>
+
 namespace openmsx {
 
 static constexpr uint8_t ASCII_FLAG  = 0x01; // bit 0 set: file probably ascii text
@@ -54,14 +57,20 @@ GZFileAdapter::GZFileAdapter(std::unique_ptr<FileBase> file_, zstring_view filen
 	return true;
 }
 
-void GZFileAdapter::decompress(FileBase& f, Decompressed& d)
+CompressedFileAdapter::Header GZFileAdapter::parseHeader(std::span<const uint8_t> data)
 {
-	auto mmap = MappedFile<const uint8_t>(f.mmap(0, true));
-	ZlibInflate zlib(mmap);
-	if (!skipHeader(zlib, d.originalName)) {
+	Header header;
+	ZlibInflate zlib(data);
+	if (!skipHeader(zlib, header.originalName)) {
 		throw FileException("Not a gzip header");
 	}
-	d.buf = zlib.inflate();
+	header.dataOffset = data.size() - zlib.getRemainingInput();
+	// The gzip trailer contains the decompressed size (modulo 2^32).
+	if (data.size() >= (header.dataOffset + 8)) {
+		header.sizeHint = std::max<size_t>(
+			Endian::read_UA_L32(&data[data.size() - 4]), 1);
+	}
+	return header;
 }
 
 } // namespace openmsx
@@ -11,7 +11,7 @@ public:
 	explicit GZFileAdapter(std::unique_ptr<FileBase> file, zstring_view filename);
 
 private:
-	void decompress(FileBase& file, Decompressed& decompressed) override;
+	[[nodiscard]] Header parseHeader(std::span<const uint8_t> data) override;
 };
 
 } // namespace openmsx
@@ -0,0 +1,217 @@
+#include "InflateIndex.hh"
+
+#include "File.hh"
+#include "FileException.hh"
+#include "MappedFile.hh"
+
+#include "endian.hh"
+#include "narrow.hh"
+#include "ranges.hh"
+#include "scope_exit.hh"
+#include "stl.hh"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+
+#define ZLIB_CONST
+#include <zlib.h>
+
+namespace openmsx {
+
+static constexpr uint32_t INDEX_MAGIC = 0x58444e49; // "INDX"
+static constexpr uint32_t INDEX_VERSION = 2;
+
+// Feed input in parts that fit in zlib's 'uInt' counters.
+static void feedInput(z_stream& s, std::span<const uint8_t> input)
+{
+	if (s.avail_in != 0) return;
+	auto consumed = size_t(s.next_in - input.data());
+	auto remaining = input.size() - consumed;
+	s.avail_in = uInt(std::min<size_t>(remaining, std::numeric_limits<uInt>::max()));
+}
+
+InflateIndex InflateIndex::build(std::span<const uint8_t> input)
+{
+	z_stream s = {};
+	if (int err = inflateInit2(&s, -MAX_WBITS); err != Z_OK) {
+		throw FileException("Error initializing inflate struct: ", zError(err));
+	}
+	scope_exit e([&] { inflateEnd(&s); });
+	s.next_in = input.data();
+
+	InflateIndex result;
+	result.points.push_back(AccessPoint{.outPos = 0, .inPos = 0, .bits = 0, .window = {}});
+
+	// Output is discarded, except for the last 32kB (needed to create
+	// access points). So decompress into a circular window buffer.
+	std::array<uint8_t, WINDOW_SIZE> window;
+	size_t totalOut = 0;
+	size_t last = 0; // output position of the last access point
+	while (true) {
+		if (s.avail_out == 0) {
+			s.next_out = window.data();
+			s.avail_out = WINDOW_SIZE;
+		}
+		feedInput(s, input);
+		auto before = s.avail_out;
+		// Z_BLOCK: return at the end of each deflate block
+		int err = inflate(&s, Z_BLOCK);
+		totalOut += before - s.avail_out;
+		if (err == Z_STREAM_END) break;
+		if ((err == Z_BUF_ERROR) && (s.next_in == (input.data() + input.size()))) {
+			throw FileException("Error while decompressing: unexpected end of file.");
+		}
+		if (err != Z_OK && err != Z_BUF_ERROR) {
+			throw FileException("Error while decompressing: ", zError(err));
+		}
+		// At the end of a block, but not after the last block?
+		if ((s.data_type & 128) && !(s.data_type & 64) &&
+		    ((totalOut - last) > SPAN)) {
+			auto n = std::min(totalOut, WINDOW_SIZE);
+			auto wpos = WINDOW_SIZE - s.avail_out; // next write position
+			AccessPoint p{
+				.outPos = totalOut,
+				.inPos = uint64_t(s.next_in - input.data()),
+				.bits = narrow<uint8_t>(s.data_type & 7),
+				.window = std::vector<uint8_t>(n)};
+			// Un-rotate the circular buffer.
+			auto tail = n - std::min(n, wpos); // part before wrap-around
+			copy_to_range(std::span{window}.subspan(WINDOW_SIZE - tail, tail), p.window);
+			copy_to_range(std::span{window}.subspan(wpos - (n - tail), n - tail),
+			              std::span{p.window}.subspan(tail));
+			result.points.push_back(std::move(p));
+			last = totalOut;
+		}
+	}
+	result.totalSize = totalOut;
+	return result;
+}
+
+size_t InflateIndex::chunkOf(size_t offset) const
+{
+	assert(offset < totalSize);
+	auto it = std::ranges::upper_bound(points, offset, {}, &AccessPoint::outPos);
+	assert(it != points.begin());
+	return (it - points.begin()) - 1;
+}
+
+size_t InflateIndex::chunkEnd(size_t chunk) const
+{
+	return ((chunk + 1) < points.size()) ? points[chunk + 1].outPos : totalSize;
+}
+
+MemBuffer<uint8_t> InflateIndex::extract(std::span<const uint8_t> input, size_t chunk) const
+{
+	assert(chunk < points.size());
+	const auto& p = points[chunk];
+	if ((p.inPos > input.size()) || (p.bits && (p.inPos == 0))) {
+		throw FileException("Invalid inflate index");
+	}
+
+	z_stream s = {};
+	if (int err = inflateInit2(&s, -MAX_WBITS); err != Z_OK) {
+		throw FileException("Error initializing inflate struct: ", zError(err));
+	}
+	scope_exit e([&] { inflateEnd(&s); });
+
+	s.next_in = input.data() + p.inPos;
+	if (p.bits) {
+		// The access point starts in the middle of a byte.
+		inflatePrime(&s, p.bits, input[p.inPos - 1] >> (8 - p.bits));
+	}
+	if (!p.window.empty()) {
+		inflateSetDictionary(&s, p.window.data(), uInt(p.window.size()));
+	}
+
+	MemBuffer<uint8_t> result(chunkEnd(chunk) - p.outPos);
+	s.next_out = result.data();
+	s.avail_out = uInt(result.size()); // chunks are small
+	while (s.avail_out != 0) {
+		feedInput(s, input);
+		int err = inflate(&s, Z_NO_FLUSH);
+		if (err == Z_STREAM_END) break;
+		if (err != Z_OK) {
+			throw FileException("Error while decompressing: ", zError(err));
+		}
+	}
+	if (s.avail_out != 0) {
+		throw FileException("Error while decompressing: unexpected end of stream.");
+	}
+	return result;
+}
+
+// Index file layout (all little endian):
+//   header:       magic, version, #points (3 x 32-bit),
+//                 size, modification date (of the input file), totalSize (3 x 64-bit)
+//   per point:    outPos, inPos (2 x 64-bit), bits (8-bit), windowSize (16-bit), window
+static constexpr size_t HEADER_SIZE = 3 * 4 + 3 * 8;
+static constexpr size_t POINT_SIZE = 2 * 8 + 1 + 2;
+
+std::optional<InflateIndex> InflateIndex::load(
+	zstring_view filename, const FileOperations::FileStamp& stamp)
+{
+	try {
+		File file(filename, "rb");
+		auto buf = file.mmap<const uint8_t>();
+		std::span data{buf.data(), buf.size()};
+		if (data.size() < HEADER_SIZE) return {};
+		if (Endian::read_UA_L32(&data[0]) != INDEX_MAGIC) return {};
+		if (Endian::read_UA_L32(&data[4]) != INDEX_VERSION) return {};
+		auto num = Endian::read_UA_L32(&data[8]);
+		if (Endian::read_UA_L64(&data[12]) != stamp.size) return {};
+		if (Endian::read_UA_L64(&data[20]) != stamp.modificationDate) return {};
+
+		InflateIndex result;
+		result.totalSize = Endian::read_UA_L64(&data[28]);
+		result.points.reserve(num);
+		size_t pos = HEADER_SIZE;
+		for (uint32_t i = 0; i < num; ++i) {
+			if ((pos + POINT_SIZE) > data.size()) return {};
+			AccessPoint p;
+			p.outPos = Endian::read_UA_L64(&data[pos + 0]);
+			p.inPos  = Endian::read_UA_L64(&data[pos + 8]);
+			p.bits   = data[pos + 16];
+			auto windowSize = Endian::read_UA_L16(&data[pos + 17]);
+			pos += POINT_SIZE;
+			if ((windowSize > WINDOW_SIZE) || (p.bits > 7) ||
+			    ((pos + windowSize) > data.size())) return {};
+			if (!result.points.empty() && (p.outPos <= result.points.back().outPos)) return {};
+			p.window.assign(&data[pos], &data[pos] + windowSize);
+			pos += windowSize;
+			result.points.push_back(std::move(p));
+		}
+		if (result.points.empty() || (result.points.front().outPos != 0) ||
+		    (result.points.back().outPos > result.totalSize)) {
+			return {};
+		}
+		return result;
+	} catch (FileException&) {
+		return {};
+	}
+}
+
+void InflateIndex::save(zstring_view filename, const FileOperations::FileStamp& stamp) const
+{
+	std::vector<uint8_t> data(HEADER_SIZE);
+	Endian::write_UA_L32(&data[0], INDEX_MAGIC);
+	Endian::write_UA_L32(&data[4], INDEX_VERSION);
+	Endian::write_UA_L32(&data[8], narrow<uint32_t>(points.size()));
+	Endian::write_UA_L64(&data[12], stamp.size);
+	Endian::write_UA_L64(&data[20], stamp.modificationDate);
+	Endian::write_UA_L64(&data[28], totalSize);
+	for (const auto& p : points) {
+		auto pos = data.size();
+		data.resize(pos + POINT_SIZE);
+		Endian::write_UA_L64(&data[pos + 0], p.outPos);
+		Endian::write_UA_L64(&data[pos + 8], p.inPos);
+		data[pos + 16] = p.bits;
+		Endian::write_UA_L16(&data[pos + 17], narrow<uint16_t>(p.window.size()));
+		append(data, p.window);
+	}
+	File file(filename, File::OpenMode::TRUNCATE);
+	file.write(data);
+}
+
+} // namespace openmsx
@@ -0,0 +1,77 @@
+#ifndef INFLATEINDEX_HH
+#define INFLATEINDEX_HH
+
+#include "FileOperations.hh"
+#include "MemBuffer.hh"
+#include "zstring_view.hh"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace openmsx {
+
+/** Random access into a raw deflate stream.
+ *
+ * Deflate streams can normally only be decompressed from the start. This
+ * class uses the technique from zlib's 'zran.c' example: during one full
+ * decompression pass an 'access point' is recorded roughly every SPAN
+ * output bytes. Such an access point stores the position in the compressed
+ * input (with bit-granularity) together with the last 32kB of output that
+ * came before it (the deflate window). That's all that's needed to restart
+ * decompression at that point.
+ *
+ * The output between two consecutive access points is called a 'chunk'.
+ * Chunks can be decompressed independently from each other.
+ */
+class InflateIndex
+{
+public:
+	static constexpr size_t SPAN = 1024 * 1024;
+	static constexpr size_t WINDOW_SIZE = 32 * 1024;
+
+	/** Decompress the full (raw deflate) input once and build the index.
+	  * @throws FileException on corrupt input.
+	  */
+	[[nodiscard]] static InflateIndex build(std::span<const uint8_t> input);
+
+	/** Load an index previously stored with save().
+	  * Returns nullopt when the file doesn't exist, is corrupt, or was
+	  * stored for a different 'stamp' (of the compressed input file).
+	  */
+	[[nodiscard]] static std::optional<InflateIndex> load(
+		zstring_view filename, const FileOperations::FileStamp& stamp);
+	/** Store this index, @throws FileException. */
+	void save(zstring_view filename, const FileOperations::FileStamp& stamp) const;
+
+	/** Total size of the decompressed data. */
+	[[nodiscard]] size_t size() const { return totalSize; }
+
+	[[nodiscard]] size_t numChunks() const { return points.size(); }
+	/** The chunk that contains the given offset, @pre offset < size(). */
+	[[nodiscard]] size_t chunkOf(size_t offset) const;
+	[[nodiscard]] size_t chunkBegin(size_t chunk) const { return points[chunk].outPos; }
+	[[nodiscard]] size_t chunkEnd(size_t chunk) const;
+
+	/** Decompress one chunk.
+	  * @param input The same input as was used to build this index.
+	  * @param chunk The chunk number, @pre chunk < numChunks().
+	  * @throws FileException on corrupt input.
+	  */
+	[[nodiscard]] MemBuffer<uint8_t> extract(std::span<const uint8_t> input, size_t chunk) const;
+
+private:
+	struct AccessPoint {
+		uint64_t outPos; // position in the decompressed output
+		uint64_t inPos;  // position in the input (in bytes) ..
+		uint8_t bits;    // .. minus this number of bits (0-7)
+		std::vector<uint8_t> window; // output right before 'outPos'
+	};
+	std::vector<AccessPoint> points; // sorted on outPos, first is at 0
+	size_t totalSize = 0;
+};
+
+} // namespace openmsx
+
+#endif
@@ -105,9 +105,9 @@ void LocalFile::write(std::span<const uint8_t> buffer)
 	}
 }
 
-MappedFileImpl LocalFile::mmap(size_t extra, bool is_const)
+MappedFileImpl LocalFile::mmap(size_t extra, bool is_const, bool populate)
 {
-	return {*this, extra, is_const};
+	return {*this, extra, is_const, populate};
 }
 
 size_t LocalFile::getSize()
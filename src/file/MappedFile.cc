@@ -28,7 +28,7 @@ static size_t getPageSize()
 #endif
 }
 
-MappedFileImpl::MappedFileImpl(LocalFile& file, size_t extra, bool is_const)
+MappedFileImpl::MappedFileImpl(LocalFile& file, size_t extra, bool is_const, bool populate)
 {
 	auto fileSize = file.getSize();
 	sz = fileSize + extra;
@@ -49,7 +49,7 @@ MappedFileImpl::MappedFileImpl(LocalFile& file, size_t extra, bool is_const)
 	}
 
 	// Step 1: mmap the file
-	mapFile(file, is_const);
+	mapFile(file, is_const, populate);
 	if (extra == 0) {
 		return; // common case: no extra bytes requested, we're done
 	}
@@ -132,7 +132,7 @@ void MappedFileImpl::release() noexcept
 	sz = 0;
 }
 
-void MappedFileImpl::mapFile(LocalFile& file, bool is_const)
+void MappedFileImpl::mapFile(LocalFile& file, bool is_const, bool populate)
 {
 #ifdef _WIN32
 	int fd = file.getFD();
@@ -159,7 +159,7 @@ void MappedFileImpl::mapFile(LocalFile& file, bool is_const)
 	auto prot = PROT_READ | (is_const ? 0 : PROT_WRITE);
 	auto flags = MAP_PRIVATE;
 	#ifndef __APPLE__
-	flags |= MAP_POPULATE; // MAP_POPULATE not supported on macOS
+	if (populate) flags |= MAP_POPULATE; // MAP_POPULATE not supported on macOS
 	#endif
 
 	int fd = file.getFD();
@@ -169,7 +169,7 @@ void MappedFileImpl::mapFile(LocalFile& file, bool is_const)
 		throw FileException("mmap failed");
 	}
 	#ifdef __APPLE__
-	madvise(ptr, sz, MADV_WILLNEED); // instead of MAP_POPULATE
+	if (populate) madvise(ptr, sz, MADV_WILLNEED); // instead of MAP_POPULATE
 	#endif
 #endif
 
@@ -51,7 +51,9 @@ public:
 	}
 
 	// A LocalFile can use mmap() (if supported by the OS).
-	MappedFileImpl(LocalFile& file, size_t extra, bool is_const);
+	// With 'populate' the whole file is read in advance, otherwise pages
+	// are only read when they're accessed.
+	MappedFileImpl(LocalFile& file, size_t extra, bool is_const, bool populate);
 
 	// For a non-LocalFile (e.g. a compressed file), we can't use mmap().
 	MappedFileImpl(std::span<const uint8_t> buf, size_t extra, bool is_const);
@@ -74,7 +76,7 @@ private:
 
 	void release() noexcept;
 
-	void mapFile(LocalFile& file, bool is_const);
+	void mapFile(LocalFile& file, bool is_const, bool populate);
 	void unmapFile(void* p, size_t size);
 
 private:
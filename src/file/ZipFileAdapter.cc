@@ -1,9 +1,10 @@
 #include "ZipFileAdapter.hh"
 
 #include "FileException.hh"
-#include "MappedFile.hh"
 #include "ZlibInflate.hh"
 
+#include <algorithm>
+
 namespace openmsx {
 
 ZipFileAdapter::ZipFileAdapter(std::unique_ptr<FileBase> file_, zstring_view filename_)
@@ -11,10 +12,10 @@ ZipFileAdapter::ZipFileAdapter(std::unique_ptr<FileBase> file_, zstring_view fil
 {
 }
 
-void ZipFileAdapter::decompress(FileBase& f, Decompressed& d)
+CompressedFileAdapter::Header ZipFileAdapter::parseHeader(std::span<const uint8_t> data)
 {
-	auto mmap = MappedFile<const uint8_t>(f.mmap(0, true));
-	ZlibInflate zlib(mmap);
+	Header header;
+	ZlibInflate zlib(data);
 
 	if (zlib.get32LE() != 0x04034B50) {
 		throw FileException("Invalid ZIP file");
@@ -35,10 +36,12 @@ void ZipFileAdapter::decompress(FileBase& f, Decompressed& d)
 	unsigned origSize = zlib.get32LE(); // uncompressed size
 	unsigned filenameLen = zlib.get16LE(); // filename length
 	unsigned extraFieldLen = zlib.get16LE(); // extra field length
-	d.originalName = zlib.getString(filenameLen); // original filename
+	header.originalName = zlib.getString(filenameLen); // original filename
 	zlib.skip(extraFieldLen); // skip "extra field"
 
-	d.buf = zlib.inflate(origSize);
+	header.dataOffset = data.size() - zlib.getRemainingInput();
+	header.sizeHint = std::max(origSize, 1u);
+	return header;
 }
 
 } // namespace openmsx
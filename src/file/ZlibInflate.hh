@@ -29,6 +29,9 @@ public:
 	[[nodiscard]] std::string getString(size_t len);
 	[[nodiscard]] std::string getCString();
 
+	/** Number of not yet consumed input bytes. */
+	[[nodiscard]] size_t getRemainingInput() const { return s.avail_in; }
+
 	[[nodiscard]] MemBuffer<uint8_t> inflate(size_t sizeHint = 65536);
 
 private:
@@ -13,6 +13,7 @@
 #include "Timer.hh"
 
 #include "narrow.hh"
+#include "ranges.hh"
 #include "serialize.hh"
 #include "tiger.hh"
 
@@ -64,6 +65,7 @@ HD::HD(const DeviceConfig& config)
 		file.truncate(size_t(config.getChildDataAsInt("size", 0)) * 1024 * 1024);
 		filesize = file.getSize();
 	}
+	mappedFile = mapImageFile(file);
 	tigerTree.emplace(*this, filesize, filename.getResolved());
 
 	(*hdInUse)[id] = true;
@@ -104,9 +106,11 @@ void HD::setMedia(const TclObject& info, EmuTime /*time*/)
 
 void HD::switchImage(const Filename& newFilename)
 {
+	mappedFile = {}; // unmap old image before opening the new one
 	file = File(newFilename.getResolved());
 	filename = newFilename;
 	filesize = file.getSize();
+	mappedFile = mapImageFile(file);
 	tigerTree.emplace(*this, filesize, filename.getResolved());
 	motherBoard.getMSXCliComm().update(CliComm::UpdateType::MEDIA, getName(),
 	                                   filename.getResolved());
@@ -120,6 +124,11 @@ size_t HD::getNbSectorsImpl()
 void HD::readSectorsImpl(
 	std::span<SectorBuffer> buffers, size_t startSector)
 {
+	if (auto view = getSectorsViewImpl(startSector, buffers.size());
+	    !view.empty()) {
+		copy_to_range(view, buffers);
+		return;
+	}
 	file.seek(startSector * sizeof(SectorBuffer));
 	file.read(buffers);
 }
@@ -128,6 +137,10 @@ void HD::writeSectorImpl(size_t sector, const SectorBuffer& buf)
 {
 	file.seek(sector * sizeof(buf));
 	file.write(buf.raw);
+	if (sector < mappedFile.size()) {
+		// private mapping, keep it in sync with the file
+		mappedFile[sector] = buf;
+	}
 	tigerTree->notifyChange(sector * sizeof(buf), sizeof(buf),
 	                        file.getModificationDate());
 }
@@ -145,6 +158,13 @@ Sha1Sum HD::getSha1SumImpl(FilePool& filePool)
 	return filePool.getSha1Sum(file, filename.getResolved());
 }
 
+std::span<const SectorBuffer> HD::getSectorsViewImpl(
+	size_t startSector, size_t num)
+{
+	if ((startSector + num) > mappedFile.size()) return {};
+	return {&mappedFile[startSector], num};
+}
+
 void HD::showProgress(size_t position, size_t maxPosition)
 {
 	// only show progress iff:
@@ -249,6 +269,7 @@ void HD::serialize(Archive& ar, unsigned version)
 			//  - So to get in the same state as the initial
 			//    savestate we again close the file. Otherwise the
 			//    checksum-check code below goes wrong.
+			mappedFile = {};
 			file.close();
 		} else {
 			tmp.updateAfterLoadState();
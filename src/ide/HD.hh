@@ -55,6 +55,8 @@ private:
 	[[nodiscard]] size_t getNbSectorsImpl() override;
 	[[nodiscard]] bool isWriteProtectedImpl() const override;
 	[[nodiscard]] Sha1Sum getSha1SumImpl(FilePool& filePool) override;
+	[[nodiscard]] std::span<const SectorBuffer> getSectorsViewImpl(
+		size_t startSector, size_t num) override;
 
 	// DiskContainer:
 	[[nodiscard]] SectorAccessibleDisk* getSectorAccessibleDisk() override;
@@ -75,6 +77,7 @@ private:
 	std::optional<TigerTree> tigerTree; // delayed init
 
 	File file;
+	MappedFile<SectorBuffer> mappedFile; // empty if not mapped
 	Filename filename;
 	size_t filesize;
 
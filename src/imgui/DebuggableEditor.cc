@@ -299,7 +299,9 @@ void DebuggableEditor::drawExport(const Sizes& s, Debuggable& debuggable)
 			  (exportDestination != OUTPUT_FILE || !exportFilename.empty());
 		im::Disabled(!ok, [&]{
 			if (ImGui::Button("Export")) {
-				auto fetch = [&](unsigned address) { return debuggable.read(address); };
+				std::vector<uint8_t> exportData(*end - *begin + 1);
+				debuggable.readBlock(*begin, exportData);
+				auto fetch = [&](unsigned address) { return exportData[address - *begin]; };
 				try {
 					auto output = (exportFormatted == EXPORT_FORMATTED)
 						? ((exportFormat == FORMAT_ASCII)
@@ -587,6 +589,12 @@ void DebuggableEditor::drawContents(const Sizes& s, Debuggable& debuggable, unsi
 		auto addr = unsigned(line) * columns;
 		ImGui::StrCat(formatAddr(s, addr), ':');
 
+		// fetch the whole line at once
+		std::array<uint8_t, MAX_COLUMNS> lineBuf;
+		auto lineData = std::span{lineBuf}.first(std::min(unsigned(columns), memSize - addr));
+		debuggable.readBlock(addr, lineData);
+		auto lineStart = addr;
+
 		auto previewDataTypeSize = DataTypeGetSize(previewDataType);
 		auto inside = [](unsigned a, unsigned start, unsigned size) {
 			return (start <= a) && (a < (start + size));
@@ -655,7 +663,7 @@ void DebuggableEditor::drawContents(const Sizes& s, Debuggable& debuggable, unsi
 					},
 					ImGuiInputTextFlags_CharsHexadecimal);
 			} else {
-				uint8_t b = debuggable.read(addr);
+				uint8_t b = lineData[addr - lineStart];
 				bool changed = drawChanges && (b != snapshot[addr]);
 				bool grey = (b == 0) && greyOutZeroes;
 				im::StyleColor(changed || grey, ImGuiCol_Text, changed ? changedColor : greyColor, [&]{
@@ -707,7 +715,7 @@ void DebuggableEditor::drawContents(const Sizes& s, Debuggable& debuggable, unsi
 							return b;
 						});
 				} else {
-					uint8_t c = debuggable.read(addr);
+					uint8_t c = lineData[addr - lineStart];
 					bool changed = drawChanges && (c != snapshot[addr]);
 					char display = formatAsciiData(c);
 					bool grey = display != char(c);
@@ -252,7 +252,9 @@ static void setOnce(std::shared_ptr<WatchPoint>& wp, bool o) { wp->setOnce(o); }
 static void setOnce(DebugCondition& cond,            bool o) { cond.setOnce(o); }
 
 struct DummyScopedChange {};
-[[nodiscard]] static DummyScopedChange getScopedChange(BreakPoint&, MSXCPUInterface&) { return {}; }
+[[nodiscard]] static auto getScopedChange(BreakPoint&, MSXCPUInterface& cpuInterface) {
+	return cpuInterface.getScopedChangeBreakPoints();
+}
 [[nodiscard]] static auto getScopedChange(std::shared_ptr<WatchPoint>& wp, MSXCPUInterface& cpuInterface) {
 	return cpuInterface.getScopedChangeWatchpoint(wp);
 }
@@ -650,8 +652,10 @@ void ImGuiBreakPoints::refreshSymbols()
 	for (auto& bp : MSXCPUInterface::getBreakPoints()) {
 		bp.evaluateAddress(interp);
 	}
+	MSXCPUInterface::rebuildBreakPointIndex();
 	if (auto* motherBoard = manager.getReactor().getMotherBoard()) {
 		auto& cpuInterface = motherBoard->getCPUInterface();
+		cpuInterface.updateBreakPointCache();
 		for (auto& wp : cpuInterface.getWatchPoints()) {
 			auto sc = getScopedChange(wp, cpuInterface);
 			wp->evaluateAddress(interp);
@@ -4,21 +4,26 @@
 #include "ImGuiManager.hh"
 #include "ImGuiUtils.hh"
 
+#include "Debugger.hh"
+#include "MSXException.hh"
+#include "MSXMotherBoard.hh"
+
 #include "narrow.hh"
-#include "stl.hh"
 
-#include <ranges>
+#include <optional>
 
 namespace openmsx {
 
 using namespace std::literals;
 
-void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
+void ImGuiCheatFinder::paint(MSXMotherBoard* motherBoard)
 {
-	if (!show) return;
+	if (!show || !motherBoard) return;
 
+	auto& memSearch = motherBoard->getDebugger().getMemorySearch();
 	bool start = false;
-	std::string searchExpr;
+	std::optional<MemorySearch::Op> searchOp;
+	bool compareToValue = false;
 
 	ImGui::SetNextWindowSize(gl::vec2{35, 0} * ImGui::GetFontSize(), ImGuiCond_FirstUseEver);
 	im::Window("Cheat Finder", &show, [&]{
@@ -34,40 +39,53 @@ void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
 			           "  openMSX tutorial: Working with the Cheat Finder\n"
 			           "  http://www.youtube.com/watch?v=F11ltfkCtKo\n"
 			           "The UI has changed, but the ideas remain the same.");
-			im::Disabled(searchResults.empty(), [&]{
+			im::Disabled(searchResults.empty() || !memSearch.isActive(), [&]{
 				ImGui::TextUnformatted("Compare"sv);
 				im::Indent([&]{
+					using enum MemorySearch::Op;
 					auto bSize = ImVec2{tSize, 0.0f};
-					if (ImGui::Button("<",  bSize)) searchExpr = "$new < $old";
+					if (ImGui::Button("<",  bSize)) searchOp = LT;
 					simpleToolTip("Search for memory locations with strictly decreased value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button("<=", bSize)) searchExpr = "$new <= $old";
+					if (ImGui::Button("<=", bSize)) searchOp = LE;
 					simpleToolTip("Search for memory locations with decreased value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button("!=", bSize)) searchExpr = "$new != $old";
+					if (ImGui::Button("!=", bSize)) searchOp = NE;
 					simpleToolTip("Search for memory locations with changed value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button("==", bSize)) searchExpr = "$new == $old";
+					if (ImGui::Button("==", bSize)) searchOp = EQ;
 					simpleToolTip("Search for memory locations with unchanged value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button(">=", bSize)) searchExpr = "$new >= $old";
+					if (ImGui::Button(">=", bSize)) searchOp = GE;
 					simpleToolTip("Search for memory locations with increased value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button(">",  bSize)) searchExpr = "$new > $old";
+					if (ImGui::Button(">",  bSize)) searchOp = GT;
 					simpleToolTip("Search for memory locations with strictly increased value");
 				});
 				ImGui::TextUnformatted("Specific value"sv);
 				im::Indent([&]{
 					ImGui::SetNextItemWidth(3 * ImGui::GetFontSize());
-					ImGui::InputScalar("##value", ImGuiDataType_U8, &searchValue);
+					if (wordSearch) {
+						ImGui::InputScalar("##value", ImGuiDataType_U16, &searchValue);
+					} else {
+						uint8_t value8 = narrow_cast<uint8_t>(searchValue);
+						if (ImGui::InputScalar("##value", ImGuiDataType_U8, &value8)) {
+							searchValue = value8;
+						}
+					}
 					ImGui::SameLine();
 					if (ImGui::Button("Go")) {
-						searchExpr = strCat("$new == ", searchValue);
+						searchOp = MemorySearch::Op::EQ;
+						compareToValue = true;
 					}
 					simpleToolTip("Search for memory locations with a specific value");
 				});
 			});
 			start |= ImGui::Button("Restart search");
+			ImGui::SameLine();
+			start |= ImGui::Checkbox("16-bit", &wordSearch);
+			simpleToolTip("Search for (little endian) 16-bit values instead of 8-bit values.\n"
+			              "Changing this restarts the search.");
 		});
 
 		ImGui::SameLine();
@@ -110,21 +128,18 @@ void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
 		});
 	});
 
-	if (start) {
-		manager.execute(TclObject("cheat_finder::start"));
-		searchExpr = "1"; // could be optimized, but good enough
-	}
-	if (!searchExpr.empty()) {
-		auto result = manager.execute(makeTclList("cheat_finder::search", searchExpr)).value_or(TclObject{});
-		searchResults = to_vector(std::views::transform(xrange(result.size()), [&](size_t i) {
-			auto line = result.getListIndexUnchecked(i);
-			auto addr     = line.getListIndexUnchecked(0).getOptionalInt().value_or(0);
-			auto oldValue = line.getListIndexUnchecked(1).getOptionalInt().value_or(0);
-			auto newValue = line.getListIndexUnchecked(2).getOptionalInt().value_or(0);
-			return SearchResult{.address = narrow_cast<uint16_t>(addr),
-			                    .oldValue = narrow_cast<uint8_t>(oldValue),
-			                    .newValue = narrow_cast<uint8_t>(newValue)};
-		}));
+	if (!start && !searchOp) return;
+	try {
+		if (start) {
+			memSearch.start("memory", wordSearch ? 16 : 8);
+		} else {
+			memSearch.search(*searchOp, compareToValue ? std::optional<unsigned>(searchValue)
+			                                           : std::nullopt);
+		}
+		searchResults = memSearch.getResults();
+	} catch (MSXException& e) {
+		manager.printError("Cheat finder: ", e.getMessage());
+		searchResults.clear();
 	}
 }
 
@@ -3,6 +3,8 @@
 
 #include "ImGuiPart.hh"
 
+#include "MemorySearch.hh"
+
 #include <cstdint>
 #include <vector>
 
@@ -19,13 +21,9 @@ public:
 	bool show = false;
 
 private:
-	struct SearchResult {
-		uint16_t address;
-		uint8_t oldValue;
-		uint8_t newValue;
-	};
-	std::vector<SearchResult> searchResults;
-	uint8_t searchValue = 0;
+	std::vector<MemorySearch::Result> searchResults;
+	uint16_t searchValue = 0;
+	bool wordSearch = false; // 16-bit values
 };
 
 } // namespace openmsx
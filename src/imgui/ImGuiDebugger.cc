@@ -8,6 +8,7 @@
 #include "ImGuiDisassembly.hh"
 #include "ImGuiManager.hh"
 #include "ImGuiPalette.hh"
+#include "ImGuiProfiler.hh"
 #include "ImGuiRasterViewer.hh"
 #include "ImGuiSpriteViewer.hh"
 #include "ImGuiTraceViewer.hh"
@@ -269,6 +270,7 @@ void ImGuiDebugger::showMenu(MSXMotherBoard* motherBoard)
 		ImGui::MenuItem("Symbol manager", nullptr, &manager.symbols->show);
 		ImGui::MenuItem("Watch expression", nullptr, &manager.watchExpr->show);
 		ImGui::MenuItem("Probe/Trace viewer", nullptr, &manager.traceViewer->show);
+		ImGui::MenuItem("Profiler", nullptr, &manager.profiler->show);
 		ImGui::Separator();
 		if (ImGui::MenuItem("VDP bitmap viewer")) {
 			openOrCreate(manager, bitmapViewers);
@@ -16,6 +16,7 @@
 #include "ImGuiOpenFile.hh"
 #include "ImGuiOsdIcons.hh"
 #include "ImGuiPalette.hh"
+#include "ImGuiProfiler.hh"
 #include "ImGuiRasterViewer.hh"
 #include "ImGuiReverseBar.hh"
 #include "ImGuiSCCViewer.hh"
@@ -172,6 +173,7 @@ ImGuiManager::ImGuiManager(Reactor& reactor_)
 	symbols = std::make_unique<ImGuiSymbols>(*this);
 	watchExpr = std::make_unique<ImGuiWatchExpr>(*this);
 	traceViewer = std::make_unique<ImGuiTraceViewer>(*this);
+	profiler = std::make_unique<ImGuiProfiler>(*this);
 	vdpRegs = std::make_unique<ImGuiVdpRegs>(*this);
 	palette = std::make_unique<ImGuiPalette>(*this);
 	rasterViewer = std::make_unique<ImGuiRasterViewer>(*this, *traceViewer);
@@ -45,6 +45,7 @@ class ImGuiMsxMusicViewer;
 class ImGuiOpenFile;
 class ImGuiOsdIcons;
 class ImGuiPalette;
+class ImGuiProfiler;
 class ImGuiRasterViewer;
 class ImGuiReverseBar;
 class ImGuiSCCViewer;
@@ -158,6 +159,7 @@ public:
 	std::unique_ptr<ImGuiSymbols> symbols;
 	std::unique_ptr<ImGuiWatchExpr> watchExpr;
 	std::unique_ptr<ImGuiTraceViewer> traceViewer;
+	std::unique_ptr<ImGuiProfiler> profiler;
 	std::unique_ptr<ImGuiVdpRegs> vdpRegs;
 	std::unique_ptr<ImGuiPalette> palette;
 	std::unique_ptr<ImGuiRasterViewer> rasterViewer;
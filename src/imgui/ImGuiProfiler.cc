@@ -0,0 +1,197 @@
+#include "ImGuiProfiler.hh"
+
+#include "ImGuiCpp.hh"
+#include "ImGuiDebugger.hh"
+#include "ImGuiManager.hh"
+#include "ImGuiOpenFile.hh"
+#include "ImGuiUtils.hh"
+
+#include "Debugger.hh"
+#include "MSXException.hh"
+#include "MSXMotherBoard.hh"
+
+#include "strCat.hh"
+#include "unreachable.hh"
+
+#include <imgui.h>
+
+#include <cassert>
+
+namespace openmsx {
+
+void ImGuiProfiler::save(ImGuiTextBuffer& buf)
+{
+	savePersistent(buf, *this, persistentElements);
+}
+
+void ImGuiProfiler::loadLine(std::string_view name, zstring_view value)
+{
+	loadOnePersistent(name, value, *this, persistentElements);
+}
+
+void ImGuiProfiler::paint(MSXMotherBoard* motherBoard)
+{
+	if (!show || !motherBoard) return;
+
+	auto& profiler = motherBoard->getDebugger().getProfiler();
+	auto time = motherBoard->getCurrentTime();
+	stats = profiler.getFunctionStats(time);
+	totalCycles = 0;
+	for (const auto& s : stats) totalCycles += s.selfCycles;
+	checkSort();
+
+	ImGui::SetNextWindowSize(gl::vec2{40, 20} * ImGui::GetFontSize(), ImGuiCond_FirstUseEver);
+	im::Window("Profiler", &show, [&]{
+		drawControls(profiler, time);
+		ImGui::Separator();
+		drawTable(profiler);
+	});
+}
+
+void ImGuiProfiler::drawControls(Profiler& profiler, EmuTime time)
+{
+	bool running = profiler.isRunning();
+	if (ImGui::Button(running ? "Stop" : "Start")) {
+		if (running) {
+			profiler.stop(time);
+		} else {
+			profiler.start(time, narrow<unsigned>(interval));
+		}
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Clear")) {
+		profiler.clear();
+	}
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6.0f);
+	im::Disabled(running, [&]{
+		if (ImGui::InputInt("sample interval (cycles)", &interval, 0, 0)) {
+			interval = std::clamp(interval, 1, 1000000);
+		}
+	});
+	ImGui::SameLine();
+	im::Disabled(stats.empty(), [&]{
+		if (ImGui::Button("Export ...")) {
+			ImGui::OpenPopup("export-profile");
+		}
+	});
+	im::Popup("export-profile", [&]{
+		auto doExport = [&](const char* title, const char* filter, auto func) {
+			manager.openFile->selectNewFile(title, filter, [this, func](const std::string& fn) {
+				// Look up the profiler again, the machine may have been
+				// switched or deleted while the file dialog was open.
+				auto* motherBoard = manager.getReactor().getMotherBoard();
+				if (!motherBoard) {
+					manager.printError("Couldn't export profile: no active machine");
+					return;
+				}
+				try {
+					func(motherBoard->getDebugger().getProfiler(),
+					     motherBoard->getCurrentTime(), fn);
+				} catch (MSXException& e) {
+					manager.printError("Couldn't export profile: ", e.getMessage());
+				}
+			});
+		};
+		if (ImGui::MenuItem("Callgrind ...")) {
+			doExport("Export profile (callgrind)", "Callgrind (*.out){.out}",
+			         [](const Profiler& p, EmuTime t, const std::string& fn) { p.exportCallgrind(fn, t); });
+		}
+		if (ImGui::MenuItem("Folded stacks (flame graph) ...")) {
+			doExport("Export profile (folded stacks)", "Folded stacks (*.folded){.folded}",
+			         [](const Profiler& p, EmuTime /*t*/, const std::string& fn) { p.exportFolded(fn); });
+		}
+	});
+	ImGui::SameLine();
+	ImGui::StrCat("samples: ", profiler.getTotalSamples());
+}
+
+void ImGuiProfiler::drawTable(const Profiler& profiler)
+{
+	int flags = ImGuiTableFlags_Resizable
+	          | ImGuiTableFlags_Reorderable
+	          | ImGuiTableFlags_Hideable
+	          | ImGuiTableFlags_Sortable
+	          | ImGuiTableFlags_RowBg
+	          | ImGuiTableFlags_BordersV
+	          | ImGuiTableFlags_BordersOuter
+	          | ImGuiTableFlags_SizingStretchProp
+	          | ImGuiTableFlags_ScrollY;
+	im::Table("functions", 7, flags, [&]{
+		ImGui::TableSetupScrollFreeze(0, 1); // Make top row always visible
+		ImGui::TableSetupColumn("function", ImGuiTableColumnFlags_NoHide);
+		ImGui::TableSetupColumn("address");
+		ImGui::TableSetupColumn("calls");
+		ImGui::TableSetupColumn("inclusive cycles");
+		ImGui::TableSetupColumn("self cycles", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("self %");
+		ImGui::TableSetupColumn("samples");
+		ImGui::TableHeadersRow();
+		if (auto* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs && sortSpecs->SpecsDirty) {
+			sortSpecs->SpecsDirty = false;
+			if (sortSpecs->SpecsCount == 1) {
+				sortColumn = sortSpecs->Specs->ColumnIndex;
+				sortAscending = sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending;
+				checkSort();
+			}
+		}
+
+		im::ScopedFont sf(manager.fontMono);
+		im::ListClipperID(stats.size(), [&](int i) {
+			const auto& s = stats[i];
+			if (ImGui::TableNextColumn()) {
+				auto name = profiler.getFunctionName(s.address);
+				if (ImGui::Selectable(name.c_str(), false,
+				                      ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
+					if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+						manager.debugger->setGotoTarget(s.address);
+					}
+				}
+				simpleToolTip("double-click to show in disassembly");
+			}
+			if (ImGui::TableNextColumn()) {
+				ImGui::StrCat(hex_string<4>(s.address));
+			}
+			if (ImGui::TableNextColumn()) {
+				ImGui::StrCat(s.calls);
+			}
+			if (ImGui::TableNextColumn()) {
+				ImGui::StrCat(s.inclusiveCycles);
+			}
+			if (ImGui::TableNextColumn()) {
+				ImGui::StrCat(s.selfCycles);
+			}
+			if (ImGui::TableNextColumn()) {
+				auto perc = totalCycles ? (100.0 * double(s.selfCycles) / double(totalCycles)) : 0.0;
+				ImGui::Text("%.1f", perc);
+			}
+			if (ImGui::TableNextColumn()) {
+				ImGui::StrCat(s.samples);
+			}
+		});
+	});
+}
+
+void ImGuiProfiler::checkSort()
+{
+	auto sortOn = [&](auto proj) {
+		if (sortAscending) {
+			std::ranges::stable_sort(stats, std::less{}, proj);
+		} else {
+			std::ranges::stable_sort(stats, std::greater{}, proj);
+		}
+	};
+	switch (sortColumn) {
+		using S = Profiler::FunctionStats;
+		case 0: // function name: sort on address
+		case 1: sortOn(&S::address); break;
+		case 2: sortOn(&S::calls); break;
+		case 3: sortOn(&S::inclusiveCycles); break;
+		case 4:
+		case 5: /* self % */ sortOn(&S::selfCycles); break;
+		case 6: sortOn(&S::samples); break;
+		default: UNREACHABLE;
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,44 @@
+#ifndef IMGUI_PROFILER_HH
+#define IMGUI_PROFILER_HH
+
+#include "ImGuiPart.hh"
+
+#include "Profiler.hh"
+
+#include <vector>
+
+namespace openmsx {
+
+class ImGuiProfiler final : public ImGuiPart
+{
+public:
+	using ImGuiPart::ImGuiPart;
+
+	[[nodiscard]] zstring_view iniName() const override { return "profiler"; }
+	void save(ImGuiTextBuffer& buf) override;
+	void loadLine(std::string_view name, zstring_view value) override;
+	void paint(MSXMotherBoard* motherBoard) override;
+
+public:
+	bool show = false;
+
+private:
+	void drawControls(Profiler& profiler, EmuTime time);
+	void drawTable(const Profiler& profiler);
+	void checkSort();
+
+	std::vector<Profiler::FunctionStats> stats; // recalculated every frame
+	uint64_t totalCycles = 0;
+	int interval = Profiler::DEFAULT_INTERVAL;
+	int sortColumn = 4; // self cycles
+	bool sortAscending = false;
+
+	static constexpr auto persistentElements = std::tuple{
+		PersistentElement      {"show",     &ImGuiProfiler::show},
+		PersistentElementMinMax{"interval", &ImGuiProfiler::interval, 1, 1000001},
+	};
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,146 @@
+#include "OggIndex.hh"
+
+#include "File.hh"
+#include "FileException.hh"
+
+#include "endian.hh"
+#include "narrow.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace openmsx {
+
+static constexpr uint32_t INDEX_MAGIC = 0x4947474f; // "OGGI"
+static constexpr uint32_t INDEX_VERSION = 2;
+
+// Index file layout (all little endian):
+//   header:     magic, version, #video pages, #audio pages (4 x 32-bit),
+//               size, modification date (of the ogg file, 2 x 64-bit)
+//   video page: offset, frame, keyFrame (3 x 64-bit)
+//   audio page: offset, sample (2 x 64-bit)
+static constexpr size_t HEADER_SIZE = 4 * 4 + 2 * 8;
+static constexpr size_t VIDEO_PAGE_SIZE = 3 * 8;
+static constexpr size_t AUDIO_PAGE_SIZE = 2 * 8;
+
+void OggIndex::addVideoPage(size_t offset, size_t frame, size_t keyFrame)
+{
+	// Ignore pages that don't advance (only possible in a corrupt stream),
+	// find() needs both the offsets and the frames to be sorted.
+	if (!video.empty() && ((offset <= video.back().offset) ||
+	                       (frame <= video.back().frame))) return;
+	if (keyFrame > frame) return;
+	video.push_back({.offset = offset, .frame = frame, .keyFrame = keyFrame});
+}
+
+void OggIndex::addAudioPage(size_t offset, size_t sample)
+{
+	if (!audio.empty() && ((offset <= audio.back().offset) ||
+	                       (sample <= audio.back().sample))) return;
+	audio.push_back({.offset = offset, .sample = sample});
+}
+
+OggIndex::SeekPoint OggIndex::find(size_t frame, size_t sample) const
+{
+	assert(!empty());
+
+	// The first page on which a frame at or after 'frame' ends.
+	auto v = std::ranges::lower_bound(video, uint64_t(frame), {}, &VideoPage::frame);
+	if (v == video.end()) --v;
+	// The frames on this page from its key frame onwards depend on that key
+	// frame. Frames before it depend on an earlier key frame, which is not
+	// recorded when multiple key frames end on the same page. The key frame
+	// of the previous page is then used instead: that's too early, but it
+	// still works.
+	size_t keyFrame = (v->keyFrame <= frame) ? v->keyFrame
+	                : (v != video.begin())   ? std::prev(v)->keyFrame
+	                                         : 1;
+
+	// The key frame packet may start on an earlier page than the one on
+	// which it ends, but not before the end of the page with the frame
+	// before it.
+	auto k = std::ranges::lower_bound(video, uint64_t(keyFrame), {}, &VideoPage::frame);
+	uint64_t videoOffset = (k == video.begin()) ? 0 : std::prev(k)->offset;
+
+	// Vorbis needs the previous packet to decode the overlapping part, and
+	// the position in the stream is only known at the end of a page. So
+	// start two pages before the one on which 'sample' ends.
+	auto a = std::ranges::lower_bound(audio, uint64_t(sample), {}, &AudioPage::sample);
+	auto n = size_t(std::distance(audio.begin(), a));
+	uint64_t audioOffset = (n >= 2) ? audio[n - 2].offset : 0;
+
+	return {.offset = narrow<size_t>(std::min(videoOffset, audioOffset)),
+	        .keyFrame = keyFrame};
+}
+
+std::optional<OggIndex> OggIndex::load(
+	zstring_view filename, const FileOperations::FileStamp& stamp)
+{
+	try {
+		File file(filename, "rb");
+		auto buf = file.mmap<const uint8_t>();
+		std::span data{buf.data(), buf.size()};
+		if (data.size() < HEADER_SIZE) return {};
+		if (Endian::read_UA_L32(&data[0]) != INDEX_MAGIC) return {};
+		if (Endian::read_UA_L32(&data[4]) != INDEX_VERSION) return {};
+		auto numVideo = Endian::read_UA_L32(&data[8]);
+		auto numAudio = Endian::read_UA_L32(&data[12]);
+		if (Endian::read_UA_L64(&data[16]) != stamp.size) return {};
+		if (Endian::read_UA_L64(&data[24]) != stamp.modificationDate) return {};
+		if (data.size() != (HEADER_SIZE + numVideo * VIDEO_PAGE_SIZE
+		                                + numAudio * AUDIO_PAGE_SIZE)) return {};
+
+		OggIndex result;
+		result.video.reserve(numVideo);
+		result.audio.reserve(numAudio);
+		size_t pos = HEADER_SIZE;
+		for (uint32_t i = 0; i < numVideo; ++i) {
+			result.addVideoPage(narrow_cast<size_t>(Endian::read_UA_L64(&data[pos +  0])),
+			                    narrow_cast<size_t>(Endian::read_UA_L64(&data[pos +  8])),
+			                    narrow_cast<size_t>(Endian::read_UA_L64(&data[pos + 16])));
+			pos += VIDEO_PAGE_SIZE;
+		}
+		for (uint32_t i = 0; i < numAudio; ++i) {
+			result.addAudioPage(narrow_cast<size_t>(Endian::read_UA_L64(&data[pos + 0])),
+			                    narrow_cast<size_t>(Endian::read_UA_L64(&data[pos + 8])));
+			pos += AUDIO_PAGE_SIZE;
+		}
+		// addXXXPage() skips invalid entries
+		if ((result.video.size() != numVideo) || (result.audio.size() != numAudio) ||
+		    result.empty()) {
+			return {};
+		}
+		return result;
+	} catch (FileException&) {
+		return {};
+	}
+}
+
+void OggIndex::save(zstring_view filename, const FileOperations::FileStamp& stamp) const
+{
+	std::vector<uint8_t> data(HEADER_SIZE + video.size() * VIDEO_PAGE_SIZE
+	                                      + audio.size() * AUDIO_PAGE_SIZE);
+	Endian::write_UA_L32(&data[0], INDEX_MAGIC);
+	Endian::write_UA_L32(&data[4], INDEX_VERSION);
+	Endian::write_UA_L32(&data[8], narrow<uint32_t>(video.size()));
+	Endian::write_UA_L32(&data[12], narrow<uint32_t>(audio.size()));
+	Endian::write_UA_L64(&data[16], stamp.size);
+	Endian::write_UA_L64(&data[24], stamp.modificationDate);
+	size_t pos = HEADER_SIZE;
+	for (const auto& v : video) {
+		Endian::write_UA_L64(&data[pos +  0], v.offset);
+		Endian::write_UA_L64(&data[pos +  8], v.frame);
+		Endian::write_UA_L64(&data[pos + 16], v.keyFrame);
+		pos += VIDEO_PAGE_SIZE;
+	}
+	for (const auto& a : audio) {
+		Endian::write_UA_L64(&data[pos + 0], a.offset);
+		Endian::write_UA_L64(&data[pos + 8], a.sample);
+		pos += AUDIO_PAGE_SIZE;
+	}
+	File file(filename, File::OpenMode::TRUNCATE);
+	file.write(data);
+}
+
+} // namespace openmsx
@@ -0,0 +1,76 @@
+#ifndef OGGINDEX_HH
+#define OGGINDEX_HH
+
+#include "FileOperations.hh"
+#include "zstring_view.hh"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace openmsx {
+
+/** Seek index for the ogg files used as laserdisc images.
+ *
+ * Without an index, seeking requires a bisection over the file, where each
+ * step reads and parses a couple of pages, followed by a search for the
+ * key frame. This class records, for every page on which a theora or vorbis
+ * packet ends, the file offset together with the granule position of that
+ * page (the frame and its key frame, resp. the sample number). Then the
+ * page to start reading from can be found with a binary search.
+ *
+ * The index is built in one pass over all pages of the file (see OggReader)
+ * and cached on disk, so that this only has to happen once per file.
+ */
+class OggIndex
+{
+public:
+	struct SeekPoint {
+		size_t offset;   // position in the file to start reading
+		size_t keyFrame; // the first frame that must be decoded
+	};
+
+	/** Load an index previously stored with save().
+	  * Returns nullopt when the file doesn't exist, is corrupt, or was
+	  * stored for a different 'stamp' (of the ogg file).
+	  */
+	[[nodiscard]] static std::optional<OggIndex> load(
+		zstring_view filename, const FileOperations::FileStamp& stamp);
+	/** Store this index, @throws FileException. */
+	void save(zstring_view filename, const FileOperations::FileStamp& stamp) const;
+
+	/** Add a page, must be done in the order of the file.
+	  * @param offset Position of the start of the page in the file.
+	  * @param frame The last frame that ends on this page.
+	  * @param keyFrame The key frame that 'frame' depends on.
+	  */
+	void addVideoPage(size_t offset, size_t frame, size_t keyFrame);
+	/** @param sample The sample position at the end of this page. */
+	void addAudioPage(size_t offset, size_t sample);
+
+	[[nodiscard]] bool empty() const { return video.empty() || audio.empty(); }
+	/** The number of the last frame in the file, @pre !empty(). */
+	[[nodiscard]] size_t getTotalFrames() const { return video.back().frame; }
+
+	/** Where to start reading so that both 'frame' (and the frames it
+	  * depends on) and 'sample' are decoded, @pre !empty().
+	  */
+	[[nodiscard]] SeekPoint find(size_t frame, size_t sample) const;
+
+private:
+	struct VideoPage {
+		uint64_t offset;
+		uint64_t frame;
+		uint64_t keyFrame;
+	};
+	struct AudioPage {
+		uint64_t offset;
+		uint64_t sample;
+	};
+	std::vector<VideoPage> video; // sorted on offset and frame
+	std::vector<AudioPage> audio; // sorted on offset and sample
+};
+
+} // namespace openmsx
+
+#endif
@@ -3,7 +3,10 @@
 #include "yuv2rgb.hh"
 
 #include "CliComm.hh"
+#include "FileException.hh"
+#include "FileOperations.hh"
 #include "MSXException.hh"
+#include "RawFrame.hh"
 
 #include "MemoryOps.hh"
 #include "narrow.hh"
@@ -48,6 +51,76 @@ Frame::~Frame()
 }
 
 
+// Reads all pages of the file (with its own file handle and ogg sync state,
+// independent of the decoding) and records their positions in an OggIndex.
+struct OggReader::IndexBuilder
+{
+	explicit IndexBuilder(const std::string& filename)
+		: file(filename)
+		, fileSize(file.getSize())
+	{
+		ogg_sync_init(&sync);
+	}
+	IndexBuilder(const IndexBuilder&) = delete;
+	IndexBuilder(IndexBuilder&&) = delete;
+	IndexBuilder& operator=(const IndexBuilder&) = delete;
+	IndexBuilder& operator=(IndexBuilder&&) = delete;
+	~IndexBuilder()
+	{
+		ogg_sync_clear(&sync);
+	}
+
+	/** Process the next part of the file, returns false at the end. */
+	bool step(int videoSerial, int audioSerial, int granuleShift);
+
+	File file;
+	size_t fileSize;
+	size_t fileOffset = 0; // end of the data passed to 'sync'
+	size_t pageOffset = 0; // start of the next page in 'sync'
+	ogg_sync_state sync;
+	OggIndex index;
+};
+
+bool OggReader::IndexBuilder::step(int videoSerial, int audioSerial, int granuleShift)
+{
+	static constexpr size_t CHUNK = 64 * 1024;
+
+	// Add all pages in the data read so far.
+	ogg_page page;
+	while (long ret = ogg_sync_pageseek(&sync, &page)) {
+		if (ret < 0) {
+			// skipped bytes that are not part of a page
+			pageOffset += size_t(-ret);
+			continue;
+		}
+		auto offset = pageOffset;
+		pageOffset += size_t(ret);
+
+		// Only pages on which a packet ends have a granule position.
+		// Also skip the header pages (position 0).
+		auto granule = ogg_page_granulepos(&page);
+		if (granule <= 0) continue;
+
+		int serial = ogg_page_serialno(&page);
+		if (serial == videoSerial) {
+			auto key = size_t(granule >> granuleShift);
+			auto intra = size_t(granule & ((ogg_int64_t(1) << granuleShift) - 1));
+			index.addVideoPage(offset, key + intra, key); // see frameNo()
+		} else if (serial == audioSerial) {
+			index.addAudioPage(offset, size_t(granule));
+		}
+	}
+
+	if (fileOffset >= fileSize) return false;
+	auto chunk = std::min(CHUNK, fileSize - fileOffset);
+	char* buffer = ogg_sync_buffer(&sync, long(chunk));
+	file.read(std::span{buffer, chunk});
+	fileOffset += chunk;
+	ogg_sync_wrote(&sync, long(chunk));
+	return true;
+}
+
+
 OggReader::OggReader(const std::string& filename, CliComm& cli_)
 	: cli(cli_)
 	, file(filename)
@@ -181,6 +254,12 @@ OggReader::OggReader(const std::string& filename, CliComm& cli_)
 		if (ti.pixel_fmt != TH_PF_420) {
 			throw MSXException("Video must be YUV420");
 		}
+
+		loadIndex(filename);
+
+		// also determines the total number of frames
+		std::scoped_lock lock(mutex);
+		doSeek(1, 0);
 	} catch (MSXException&) {
 		th_setup_free(tsi);
 		th_info_clear(&ti);
@@ -192,6 +271,9 @@ OggReader::OggReader(const std::string& filename, CliComm& cli_)
 	th_setup_free(tsi);
 	th_info_clear(&ti);
 	th_comment_clear(&tc);
+
+	flushWarnings();
+	decodeThread = std::thread([this] { decodeThreadLoop(); });
 }
 
 void OggReader::cleanup()
@@ -218,9 +300,163 @@ void OggReader::cleanup()
 
 OggReader::~OggReader()
 {
+	{
+		std::scoped_lock lock(mutex);
+		quitThread = true;
+	}
+	decodeCondition.notify_one();
+	decodeThread.join();
 	cleanup();
 }
 
+void OggReader::flushWarnings()
+{
+	for (const auto& w : warnings) {
+		cli.printWarning(w);
+	}
+	warnings.clear();
+}
+
+void OggReader::decodeThreadLoop()
+{
+	std::unique_lock lock(mutex);
+	while (true) {
+		decodeCondition.wait(lock, [&] {
+			return quitThread || pendingSeek || nextFrameToConvert() ||
+			       (!endOfStream && needLookAhead()) || indexBuilder;
+		});
+		if (quitThread) return;
+
+		try {
+			if (pendingSeek) {
+				doPendingSeek();
+			} else if (convertNextFrame()) {
+				// done
+			} else if (!endOfStream && needLookAhead()) {
+				if (!nextPacket()) {
+					endOfStream = true;
+				}
+			} else {
+				buildIndexStep();
+			}
+		} catch (MSXException& e) {
+			printWarning("Error reading laserdisc image: ", e.getMessage());
+			endOfStream = true;
+		}
+	}
+}
+
+void OggReader::loadIndex(const std::string& filename)
+{
+	// The index is cached on disk, it's only valid for this exact file. It's
+	// not stored next to the image, that location might not be writable.
+	indexStamp = {.size = fileSize,
+	              .modificationDate = uint64_t(file.getModificationDate())};
+	indexFilename = FileOperations::getCacheFileName(".oggindex", filename, ".idx");
+	index = OggIndex::load(indexFilename, indexStamp);
+	if (index) {
+		indexedFileSize = fileSize;
+	} else {
+		indexBuilder = std::make_unique<IndexBuilder>(filename);
+	}
+}
+
+void OggReader::buildIndexStep()
+{
+	// Must be called with 'mutex' locked, by the decoder thread. The
+	// builder is only used by this thread, so it can run without the lock.
+	mutex.unlock();
+	bool more = false;
+	bool valid = false;
+	try {
+		more = indexBuilder->step(videoSerial, audioSerial, granuleShift);
+		valid = !more && !indexBuilder->index.empty();
+	} catch (MSXException&) {
+		// ignore, seeking falls back to bisection
+	}
+	if (valid) {
+		try {
+			FileOperations::prepareCacheFile(indexFilename);
+			indexBuilder->index.save(indexFilename, indexStamp);
+		} catch (FileException&) {
+			// ignore, we'll rebuild the index next time
+		}
+	}
+	mutex.lock();
+
+	if (more) return;
+	if (valid) {
+		index = std::move(indexBuilder->index);
+		indexedFileSize = indexBuilder->fileSize;
+	}
+	indexBuilder.reset();
+}
+
+bool OggReader::needLookAhead() const
+{
+	// Number of frames that are decoded ahead of the last requested one.
+	static constexpr size_t LOOK_AHEAD = 8;
+
+	if (frameList.size() >= (1uz << granuleShift)) {
+		// Stay well below the sanity check in getFrameNo().
+		return false;
+	}
+	if (frameList.empty() || (frameList.back()->no == size_t(-1))) {
+		return true;
+	}
+
+	// Playback freezes at a stop frame, after which the software
+	// typically seeks elsewhere. So the frames after it are not needed
+	// any time soon. Note: stop frames are numbered at 30Hz.
+	auto limit = requestedFrame + LOOK_AHEAD;
+	auto scale = size_t(frameRate / 30);
+	auto it = std::ranges::upper_bound(stopFrames, (requestedFrame + scale - 1) / scale);
+	if (it != stopFrames.end()) {
+		limit = std::min(limit, *it * scale);
+	}
+	const auto& last = frameList.back();
+	return (last->no + last->length) <= limit;
+}
+
+Frame* OggReader::nextFrameToConvert() const
+{
+	// At 60Hz also the frame before the requested one is shown.
+	auto first = requestedFrame - std::min(requestedFrame, 1uz);
+	for (const auto& frame : frameList) {
+		if (frame->converted || (frame->no == size_t(-1))) continue;
+		if ((frame->no + frame->length) <= first) continue; // not needed anymore
+		if (frame.get() == converting) continue;
+		return frame.get();
+	}
+	return nullptr;
+}
+
+bool OggReader::convertNextFrame()
+{
+	// Must be called with 'mutex' locked.
+	auto* frame = nextFrameToConvert();
+	if (!frame) return false;
+
+	converting = frame;
+	mutex.unlock();
+	if (!frame->rgb) {
+		frame->rgb = std::make_unique<RawFrame>(
+			frame->buffer[0].width, frame->buffer[0].height);
+	}
+	yuv2rgb::convert(frame->buffer, *frame->rgb);
+	mutex.lock();
+	frame->converted = true;
+	converting = nullptr;
+	idleCondition.notify_all();
+	return true;
+}
+
+void OggReader::waitForConversion()
+{
+	// Must be called with 'mutex' locked.
+	idleCondition.wait(mutex, [&] { return !converting; });
+}
+
 /** Vorbis only records the ogg position (in no. of samples) once per ogg
  * page. After seeking we have already decoded some audio before we encounter
  * the exact position we are at. Fixup the positions and discard any unwanted
@@ -236,7 +472,7 @@ void OggReader::vorbisFoundPosition()
 
 	// last is now the first vorbis audio decoded
 	if (last > currentSample) {
-		cli.printWarning("missing part of audio stream");
+		printWarning("missing part of audio stream");
 	}
 
 	currentSample = std::max(currentSample, vorbisPos);
@@ -393,7 +629,7 @@ void OggReader::readVorbis(ogg_packet* packet)
 			vorbisFoundPosition();
 		} else {
 			if (vorbisPos != size_t(packet->granulepos)) {
-				cli.printWarning(
+				printWarning(
 					"vorbis audio out of sync, expected ",
 					vorbisPos, ", got ", packet->granulepos);
 				vorbisPos = packet->granulepos;
@@ -510,69 +746,80 @@ void OggReader::readTheora(ogg_packet* packet)
 
 	keyFrame = size_t(-1);
 
+	// Frames before the current position are decoded (they're needed to
+	// decode the following frames), but not stored.
+	bool wanted = (frameno == size_t(-1)) || (frameno >= currentFrame);
+	std::unique_ptr<Frame> frame;
+	if (wanted && !recycleFrameList.empty()) {
+		frame = std::move(recycleFrameList.back());
+		recycleFrameList.pop_back();
+	}
+
+	// Decoding is the expensive part, don't block the other thread
+	// meanwhile. Only this thread can use the decoder now (see
+	// nextPacket()) and 'frame' is not shared yet.
+	decoding = true;
+	mutex.unlock();
 	int rc = th_decode_packetin(theora, packet, nullptr);
+	bool decoded = false;
+	if ((rc == 0) && wanted) {
+		th_ycbcr_buffer yuv;
+		if (th_decode_ycbcr_out(theora, yuv) == 0) {
+			if (!frame) {
+				frame = std::make_unique<Frame>(yuv);
+			}
+			size_t y_size  = yuv[0].height * size_t(yuv[0].stride);
+			size_t uv_size = yuv[1].height * size_t(yuv[1].stride);
+			std::ranges::copy(std::span{yuv[0].data,  y_size}, frame->buffer[0].data);
+			std::ranges::copy(std::span{yuv[1].data, uv_size}, frame->buffer[1].data);
+			std::ranges::copy(std::span{yuv[2].data, uv_size}, frame->buffer[2].data);
+			frame->converted = false;
+			decoded = true;
+		}
+	}
+	mutex.lock();
+	decoding = false;
+	idleCondition.notify_all();
+
 	switch (rc) {
 	case TH_DUPFRAME:
 		if (frameList.empty()) {
-			cli.printWarning("Theora error: dup frame encountered "
+			printWarning("Theora error: dup frame encountered "
 					 "without preceding frame");
 		} else {
 			frameList.back()->length++;
 		}
 		break;
 	case TH_EIMPL:
-		cli.printWarning("Theora error: not capable of reading this");
+		printWarning("Theora error: not capable of reading this");
 		break;
 	case TH_EFAULT:
-		cli.printWarning("Theora error: API not used correctly");
+		printWarning("Theora error: API not used correctly");
 		break;
 	case TH_EBADPACKET:
-		cli.printWarning("Theora error: bad packet");
+		printWarning("Theora error: bad packet");
 		break;
 	case 0:
 		break;
 	default:
-		cli.printWarning("Theora error: unknown error ", rc);
+		printWarning("Theora error: unknown error ", rc);
 		break;
 	}
 
-	if (rc) {
-		return;
-	}
-
-	th_ycbcr_buffer yuv;
-
-	if (th_decode_ycbcr_out(theora, yuv) != 0) {
-		return;
-	}
-
-	if ((frameno != size_t(-1)) && (frameno < currentFrame)) {
+	if (!decoded) {
+		if (frame) recycleFrameList.push_back(std::move(frame));
 		return;
 	}
 
 	currentFrame = frameno + 1;
 
-	std::unique_ptr<Frame> frame;
-	if (recycleFrameList.empty()) {
-		frame = std::make_unique<Frame>(yuv);
-	} else {
-		frame = std::move(recycleFrameList.back());
-		recycleFrameList.pop_back();
-	}
-
-	size_t y_size  = yuv[0].height * size_t(yuv[0].stride);
-	size_t uv_size = yuv[1].height * size_t(yuv[1].stride);
-	std::ranges::copy(std::span{yuv[0].data,  y_size}, frame->buffer[0].data);
-	std::ranges::copy(std::span{yuv[1].data, uv_size}, frame->buffer[1].data);
-	std::ranges::copy(std::span{yuv[2].data, uv_size}, frame->buffer[2].data);
-
 	// At lot of frames have frame number -1, only some have the correct
 	// frame number. We continue counting from the previous known
 	// postion
 	Frame* last = frameList.empty() ? nullptr : frameList.back().get();
 	if (last && (last->no != size_t(-1))) {
 		if (frameno != one_of(size_t(-1), last->no + last->length)) {
-			cli.printWarning("Theora frame sequence wrong");
+			printWarning("Theora frame sequence wrong");
 		} else {
 			frameno = last->no + last->length;
 		}
@@ -597,6 +844,12 @@ void OggReader::readTheora(ogg_packet* packet)
 
 void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 {
+	std::scoped_lock lock(mutex);
+	doPendingSeek();
+	flushWarnings();
+	requestedFrame = frameno;
+	decodeCondition.notify_one();
+
 	Frame* frame;
 	while (true) {
 		// If there are no frames or the frames we have read
@@ -612,6 +865,7 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		// Remove unneeded frames. Note that at 60Hz the odd and
 		// and even frame are displayed during still, so we can
 		// only throw away the one two frames ago
+		waitForConversion();
 		while (frameList.size() >= 3 && frameList[2]->no <= frameno) {
 			recycleFrameList.push_back(frameList.pop_front());
 		}
@@ -619,7 +873,7 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		if (!frameList.empty() && frameList[0]->no > frameno) {
 			// we're missing frames!
 			frame = frameList[0].get();
-			cli.printWarning(
+			printWarning(
 					"Cannot find frame ", frameno, " using ",
 			        frame->no, " instead");
 			break;
@@ -643,7 +897,7 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		if (frameList.size() > (2uz << granuleShift)) {
 			// We've got more than twice as many frames
 			// as the maximum distance between key frames.
-			cli.printWarning("Cannot find frame ", frameno);
+			printWarning("Cannot find frame ", frameno);
 			return;
 		}
 
@@ -653,7 +907,24 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		}
 	}
 
-	yuv2rgb::convert(frame->buffer, rawFrame);
+	// Normally the decoder thread already converted the frame (or is
+	// busy doing so). Otherwise convert it now, it may be shown again
+	// (e.g. when the player is in still mode).
+	waitForConversion();
+	if (!frame->converted) {
+		if (!frame->rgb) {
+			frame->rgb = std::make_unique<RawFrame>(
+				frame->buffer[0].width, frame->buffer[0].height);
+		}
+		yuv2rgb::convert(frame->buffer, *frame->rgb);
+		frame->converted = true;
+	}
+	for (auto y : xrange(frame->rgb->getHeight())) {
+		auto width = frame->rgb->getLineWidthDirect(y);
+		std::ranges::copy(frame->rgb->getLineDirect(y).first(width),
+		                  rawFrame.getLineDirect(y).begin());
+		rawFrame.setLineWidth(y, width);
+	}
 }
 
 void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
@@ -664,6 +935,10 @@ void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
 
 const AudioFragment* OggReader::getAudio(size_t sample)
 {
+	std::scoped_lock lock(mutex);
+	doPendingSeek();
+	flushWarnings();
+
 	// Read while position is unknown
 	while (audioList.empty() ||
 	       audioList.front()->position == AudioFragment::UNKNOWN_POS) {
@@ -707,6 +982,10 @@ const AudioFragment* OggReader::getAudio(size_t sample)
 
 bool OggReader::nextPacket()
 {
+	// Must be called with 'mutex' locked. Wait till the other thread
+	// is done with the decoders (see readTheora()).
+	idleCondition.wait(mutex, [&] { return !decoding; });
+
 	ogg_packet packet;
 	ogg_page page;
 
@@ -736,14 +1015,14 @@ bool OggReader::nextPacket()
 		int serial = ogg_page_serialno(&page);
 		if (serial == audioSerial) {
 			if (ogg_stream_pagein(&vorbisStream, &page)) {
-				cli.printWarning("Failed to submit vorbis page");
+				printWarning("Failed to submit vorbis page");
 			}
 		} else if (serial == videoSerial) {
 			if (ogg_stream_pagein(&theoraStream, &page)) {
-				cli.printWarning("Failed to submit theora page");
+				printWarning("Failed to submit theora page");
 			}
 		} else if (serial != skeletonSerial) {
-			cli.printWarning("Unexpected stream with serial ",
+			printWarning("Unexpected stream with serial ",
 			                 serial, " in ogg file");
 		}
 	}
@@ -774,7 +1053,7 @@ bool OggReader::nextPage(ogg_page* page)
 		fileOffset += chunk;
 
 		if (ogg_sync_wrote(&sync, long(chunk)) == -1) {
-			cli.printWarning("Internal error: ogg_sync_wrote failed");
+			printWarning("Internal error: ogg_sync_wrote failed");
 		}
 	}
 
@@ -847,6 +1126,18 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 	// we assume that only data will be added to it and the ogg streams
 	// are exactly as before
 	fileSize = file.getSize();
+
+	if (index && (fileSize == indexedFileSize)) {
+		totalFrames = index->getTotalFrames();
+		if (sample < getSampleRate() || frame <= 30) {
+			keyFrame = 1;
+			return 0;
+		}
+		auto [offset, key] = index->find(frame, sample);
+		keyFrame = key;
+		return offset;
+	}
+
 	auto offset = fileSize - 1;
 
 	while (offset > 0) {
@@ -919,6 +1210,29 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 
 bool OggReader::seek(size_t frame, size_t samples)
 {
+	{
+		std::scoped_lock lock(mutex);
+		pendingSeek = SeekRequest{.frame = frame, .sample = samples};
+		requestedFrame = frame;
+		endOfStream = false;
+	}
+	decodeCondition.notify_one();
+	return true;
+}
+
+void OggReader::doPendingSeek()
+{
+	if (!pendingSeek) return;
+	auto [frame, sample] = *pendingSeek;
+	pendingSeek.reset();
+	doSeek(frame, sample);
+}
+
+void OggReader::doSeek(size_t frame, size_t samples)
+{
+	// Must be called with 'mutex' locked.
+	idleCondition.wait(mutex, [&] { return !decoding && !converting; });
+
 	// Remove all queued frames
 	recycleFrameList.insert(end(recycleFrameList),
 		std::move_iterator(begin(frameList)),
@@ -944,8 +1258,6 @@ bool OggReader::seek(size_t frame, size_t samples)
 	currentSample = samples;
 
 	vorbis_synthesis_restart(&vd);
-
-	return true;
 }
 
 bool OggReader::stopFrame(size_t frame) const
@@ -2,19 +2,26 @@
 #define OGGREADER_HH
 
 #include "File.hh"
+#include "OggIndex.hh"
 
 #include "circular_buffer.hh"
 #include "narrow.hh"
+#include "strCat.hh"
 
 #include <ogg/ogg.h>
 #include <theora/theoradec.h>
 #include <vorbis/codec.h>
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace openmsx {
@@ -43,8 +50,32 @@ struct Frame
 	th_ycbcr_buffer buffer;
 	size_t no;
 	int length;
+
+	// The frame converted to RGB (by the decoder thread), only valid when
+	// 'converted' is set.
+	std::unique_ptr<RawFrame> rgb;
+	bool converted = false;
 };
 
+/** Reads the video and audio from an ogg file.
+  *
+  * A background thread decodes the video ahead of the last requested frame
+  * (and with it the interleaved audio) and converts the frames to RGB, so
+  * that getFrameNo() usually only has to copy the result. Seeking is also
+  * done by this thread; it's started by seek() and only waited for when
+  * video or audio is requested before it's finished.
+  *
+  * All state is protected by 'mutex'. Decoding a theora packet and
+  * converting a frame are done without holding it, while 'decoding'
+  * resp. 'converting' is set: only one thread at a time can use the
+  * decoders, and a frame that is being converted can't be recycled.
+  *
+  * Seeking uses an OggIndex when one is available. Otherwise it is built
+  * by the decoder thread, when it has nothing else to do, and stored on
+  * disk for the next time this file is used. Meanwhile seeking falls back
+  * to a bisection over the file.
+  */
+
 class OggReader
 {
 public:
@@ -68,6 +99,22 @@ public:
 
 private:
 	void cleanup();
+	void doSeek(size_t frame, size_t sample);
+	void doPendingSeek();
+	void decodeThreadLoop();
+	[[nodiscard]] bool needLookAhead() const;
+	[[nodiscard]] Frame* nextFrameToConvert() const;
+	bool convertNextFrame();
+	void waitForConversion();
+	void loadIndex(const std::string& filename);
+	void buildIndexStep();
+
+	// CliComm may only be used from the main thread, so warnings are
+	// queued and printed by flushWarnings().
+	template<typename... Args> void printWarning(Args&&... args) {
+		warnings.push_back(strCat(std::forward<Args>(args)...));
+	}
+	void flushWarnings();
 	void readTheora(ogg_packet* packet);
 	void theoraHeaderPage(ogg_page* page, th_info& ti, th_comment& tc,
 	                      th_setup_info*& tsi);
@@ -110,7 +157,7 @@ private:
 	size_t keyFrame{size_t(-1)};
 	size_t currentFrame{1};
 	int granuleShift;
-	size_t totalFrames;
+	std::atomic<size_t> totalFrames = 0;
 
 	cb_queue<std::unique_ptr<Frame>> frameList;
 	std::vector<std::unique_ptr<Frame>> recycleFrameList;
@@ -134,6 +181,32 @@ private:
 		size_t frame;
 	};
 	std::vector<ChapterFrame> chapters; // sorted on chapter
+
+	// Background decoding
+	struct SeekRequest {
+		size_t frame;
+		size_t sample;
+	};
+	std::optional<SeekRequest> pendingSeek;
+	size_t requestedFrame{1}; // last frame passed to getFrameNo() or seek()
+	const Frame* converting{nullptr}; // frame being converted outside the lock
+	std::vector<std::string> warnings;
+	bool decoding{false}; // a theora packet is being decoded outside the lock
+	bool endOfStream{false}; // decoder thread can't read any further
+	bool quitThread{false};
+	std::mutex mutex;
+	std::condition_variable decodeCondition; // work for the decoder thread, or quit
+	std::condition_variable_any idleCondition; // 'decoding' or 'converting' was reset
+
+	// Seek index
+	struct IndexBuilder;
+	std::optional<OggIndex> index;
+	size_t indexedFileSize{0}; // the index is only valid for this file size
+	std::string indexFilename;
+	FileOperations::FileStamp indexStamp;
+	std::unique_ptr<IndexBuilder> indexBuilder; // only used by the decoder thread
+
+	std::thread decodeThread;
 };
 
 } // namespace openmsx
@@ -97,9 +97,9 @@ uint8_t RamDebuggable::read(unsigned address)
 	return ram[address];
 }
 
-void RamDebuggable::readBlock(unsigned start, std::span<uint8_t> output)
+std::span<const uint8_t> RamDebuggable::getDirectBlock()
 {
-	copy_to_range(std::span{ram}.subspan(start, output.size()), output);
+	return std::span{ram};
 }
 
 void RamDebuggable::write(unsigned address, uint8_t value)
@@ -23,7 +23,7 @@ public:
 	              static_string_view description, Ram& ram, bool* debugWrite);
 	uint8_t read(unsigned address) override;
 	void write(unsigned address, uint8_t value) override;
-	void readBlock(unsigned start, std::span<uint8_t> output) override;
+	[[nodiscard]] std::span<const uint8_t> getDirectBlock() override;
 private:
 	Ram& ram;
 	bool* debugWrite;
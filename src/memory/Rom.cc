@@ -43,7 +43,7 @@ public:
 	[[nodiscard]] unsigned getSize() const override;
 	[[nodiscard]] std::string_view getDescription() const override;
 	[[nodiscard]] uint8_t read(unsigned address) override;
-	void readBlock(unsigned start, std::span<uint8_t> output) override;
+	[[nodiscard]] std::span<const uint8_t> getDirectBlock() override;
 	void write(unsigned address, uint8_t value) override;
 	void moved(Rom& r);
 private:
@@ -416,9 +416,9 @@ uint8_t RomDebuggable::read(unsigned address)
 	return (*rom)[address];
 }
 
-void RomDebuggable::readBlock(unsigned start, std::span<uint8_t> output)
+std::span<const uint8_t> RomDebuggable::getDirectBlock()
 {
-	copy_to_range(std::span{*rom}.subspan(start, output.size()), output);
+	return std::span{*rom};
 }
 
 void RomDebuggable::write(unsigned /*address*/, uint8_t /*value*/)
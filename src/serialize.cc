@@ -184,10 +184,37 @@ void MemInputArchive::serialize_blob(const char* /*tag*/, std::span<uint8_t> dat
 
 ////
 
-XmlOutputArchive::XmlOutputArchive(zstring_view filename_)
-	: filename(filename_)
-	, writer(*this)
+// Alternatives, useful for debugging: "hex" or "base64".
+static constexpr std::string_view BLOB_ENCODING = "gz-base64";
+
+[[nodiscard]] static std::string encodeBlob(std::span<const uint8_t> data)
 {
+	if constexpr (BLOB_ENCODING == "hex") {
+		return HexDump::encode(data);
+	} else if constexpr (BLOB_ENCODING == "base64") {
+		return Base64::encode(data);
+	} else {
+		// TODO check for overflow?
+		auto len = data.size();
+		auto dstLen = uLongf(len + len / 1000 + 12 + 1); // worst-case
+		MemBuffer<uint8_t> buf(dstLen);
+		if (compress2(buf.data(), &dstLen,
+		              std::bit_cast<const Bytef*>(data.data()),
+		              uLong(len), 9)
+		    != Z_OK) {
+			throw MSXException("Error while compressing blob.");
+		}
+		return Base64::encode(buf.first(dstLen));
+	}
+}
+
+void XmlSnapshot::write(zstring_view filename) const
+{
+	gzFile file = nullptr;
+	auto error = [&] [[noreturn]] {
+		if (file) gzclose(file);
+		throw XMLException("could not write \"", filename, '"');
+	};
 	{
 		auto f = FileOperations::openFile(filename, "wb");
 		if (!f) error();
@@ -202,6 +229,30 @@ XmlOutputArchive::XmlOutputArchive(zstring_view filename_)
 		// uses the dup()'ed file descriptor.
 	}
 
+	auto writeStr = [&](std::string_view str) {
+		if ((gzwrite(file, str.data(), unsigned(str.size())) == 0) && !str.empty()) {
+			error();
+		}
+	};
+	std::string_view remaining = text;
+	size_t done = 0;
+	for (const auto& blob : blobs) {
+		writeStr(remaining.substr(0, blob.pos - done));
+		remaining.remove_prefix(blob.pos - done + 1); // also skip placeholder
+		done = blob.pos + 1;
+		writeStr(encodeBlob(blob.data));
+	}
+	writeStr(remaining);
+
+	if (gzclose(file) != Z_OK) {
+		file = nullptr;
+		error();
+	}
+}
+
+XmlOutputArchive::XmlOutputArchive()
+	: writer(*this)
+{
 	static constexpr std::string_view header =
 		"<?xml version=\"1.0\" ?>\n"
 		"<!DOCTYPE openmsx-serialize SYSTEM 'openmsx-serialize.dtd'>\n";
@@ -213,39 +264,42 @@ XmlOutputArchive::XmlOutputArchive(zstring_view filename_)
 	writer.attribute("platform", TARGET_PLATFORM);
 }
 
-void XmlOutputArchive::close()
+XmlOutputArchive::XmlOutputArchive(zstring_view filename_)
+	: XmlOutputArchive()
 {
-	if (!file) return; // already closed
+	filename = filename_;
+}
 
+void XmlOutputArchive::finish()
+{
+	assert(!finished);
 	writer.end("serial");
+	finished = true;
+}
 
-	if (gzclose(file) != Z_OK) {
-		error();
-	}
-	file = nullptr;
+void XmlOutputArchive::close()
+{
+	if (finished) return; // already closed
+	assert(!filename.empty());
+	finish();
+	snapshot.write(filename);
 }
 
-XmlOutputArchive::~XmlOutputArchive()
+XmlSnapshot XmlOutputArchive::releaseSnapshot() &&
 {
-	try {
-		close();
-	} catch (...) {
-		// Eat exception. Explicitly call close() if you want to handle errors.
-	}
+	assert(filename.empty());
+	finish();
+	return std::move(snapshot);
 }
 
 void XmlOutputArchive::write(std::span<const char> buf)
 {
-	if ((gzwrite(file, buf.data(), unsigned(buf.size())) == 0) && !buf.empty()) {
-		error();
-	}
+	snapshot.text.append(buf.data(), buf.size());
 }
 
 void XmlOutputArchive::write1(char c)
 {
-	if (gzputc(file, c) == -1) {
-		error();
-	}
+	snapshot.text += c;
 }
 
 void XmlOutputArchive::check(bool condition) const
@@ -253,15 +307,6 @@ void XmlOutputArchive::check(bool condition) const
 	assert(condition); (void)condition;
 }
 
-void XmlOutputArchive::error()
-{
-	if (file) {
-		gzclose(file);
-		file = nullptr;
-	}
-	throw XMLException("could not write \"", filename, '"');
-}
-
 void XmlOutputArchive::saveChar(char c)
 {
 	writer.data(std::string_view(&c, 1));
@@ -324,32 +369,14 @@ void XmlOutputArchive::endTag(const char* tag)
 void XmlOutputArchive::serialize_blob(
 	const char* tag, std::span<const uint8_t> data, bool /*diff*/)
 {
-	std::string_view encoding;
-	std::string tmp;
-	if (false) {
-		// useful for debugging
-		encoding = "hex";
-		tmp = HexDump::encode(data);
-	} else if (false) {
-		encoding = "base64";
-		tmp = Base64::encode(data);
-	} else {
-		encoding = "gz-base64";
-		// TODO check for overflow?
-		auto len = data.size();
-		auto dstLen = uLongf(len + len / 1000 + 12 + 1); // worst-case
-		MemBuffer<uint8_t> buf(dstLen);
-		if (compress2(buf.data(), &dstLen,
-		              std::bit_cast<const Bytef*>(data.data()),
-		              uLong(len), 9)
-		    != Z_OK) {
-			throw MSXException("Error while compressing blob.");
-		}
-		tmp = Base64::encode(buf.first(dstLen));
-	}
+	// Only copy the data here, encoding (compressing) it is postponed
+	// till the snapshot is written, see XmlSnapshot::write().
 	writer.begin(tag);
-	writer.attribute("encoding", encoding);
-	writer.dataRaw(tmp);
+	writer.attribute("encoding", BLOB_ENCODING);
+	writer.dataRaw("?"); // placeholder, replaced by the encoded data
+	MemBuffer<uint8_t> copy(data.size());
+	copy_to_range(data, std::span{copy.data(), copy.size()});
+	snapshot.blobs.emplace_back(snapshot.text.size() - 1, std::move(copy));
 	writer.end(tag);
 }
 
@@ -840,12 +840,41 @@ private:
 
 ////
 
+/** The result of serializing into an XmlOutputArchive, but with the
+  * expensive steps (compressing the blobs, gzip-compressing the XML text
+  * and writing the file) not yet done. This makes it possible to take a
+  * snapshot on the emulation thread and write it from another thread:
+  * write() doesn't touch any shared state.
+  */
+class XmlSnapshot
+{
+public:
+	/** Encode the blobs, compress and write to the given file.
+	  * @throws XMLException */
+	void write(zstring_view filename) const;
+
+//internal:
+	struct Blob {
+		size_t pos; // position of the (1 character) placeholder in 'text'
+		MemBuffer<uint8_t> data;
+	};
+	std::string text;
+	std::vector<Blob> blobs;
+};
+
 class XmlOutputArchive final : public OutputArchiveBase<XmlOutputArchive>
 {
 public:
+	/** Serialize to memory, use releaseSnapshot() to obtain the result. */
+	XmlOutputArchive();
+	/** Serialize to the given file. Nothing is written until close() is
+	  * called (so a failed serialization doesn't leave a partial file). */
 	explicit XmlOutputArchive(zstring_view filename);
 	void close();
-	~XmlOutputArchive();
+
+	/** Finish serialization, without writing anything to disk.
+	  * Only for archives created with the default constructor. */
+	[[nodiscard]] XmlSnapshot releaseSnapshot() &&;
 
 	template<typename T> void saveImpl(const T& t)
 	{
@@ -910,12 +939,15 @@ public:
 	void write(std::span<const char> buf);
 	void write1(char c);
 	void check(bool condition) const;
-	[[noreturn]] void error();
 
 private:
-	zstring_view filename;
-	gzFile file = nullptr;
+	void finish();
+
+private:
+	std::string filename; // empty when serializing to memory
+	XmlSnapshot snapshot;
 	XMLOutputStream<XmlOutputArchive> writer;
+	bool finished = false;
 };
 
 class XmlInputArchive final : public InputArchiveBase<XmlInputArchive>
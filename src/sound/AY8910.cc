@@ -582,6 +582,9 @@ uint8_t AY8910::peekRegister(unsigned reg, EmuTime time) const
 void AY8910::writeRegister(unsigned reg, uint8_t value, EmuTime time)
 {
 	if (reg >= 16) return;
+	if (reg < AY_PORTA) {
+		recordRegisterWrite(VGMRecorder::Chip::PSG, 0, uint8_t(reg), value, time);
+	}
 	if ((reg < AY_PORTA) && (reg == AY_ESHAPE || regs[reg] != value)) {
 		// Update the output buffer before changing the register.
 		updateStream(time);
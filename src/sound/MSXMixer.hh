@@ -6,6 +6,7 @@
 #include "InfoTopic.hh"
 #include "Mixer.hh"
 #include "Schedulable.hh"
+#include "VGMRecorder.hh"
 
 #include "Observer.hh"
 #include "dynarray.hh"
@@ -140,6 +141,8 @@ public:
 	[[nodiscard]] const SoundDeviceInfo* findDeviceInfo(std::string_view name) const;
 	[[nodiscard]] const auto& getDeviceInfos() const { return infos; }
 
+	[[nodiscard]] VGMRecorder& getVGMRecorder() { return vgmRecorder; }
+
 	void reInit();
 
 private:
@@ -187,6 +190,8 @@ private:
 		void tabCompletion(std::vector<std::string>& tokens) const override;
 	} soundDeviceInfo;
 
+	VGMRecorder vgmRecorder;
+
 	AviRecorder* recorder = nullptr;
 	unsigned synchronousCounter = 0;
 
@@ -288,6 +288,9 @@ uint8_t SCC::getFreqVol(unsigned address) const
 void SCC::writeMem(uint8_t address, uint8_t value, EmuTime time)
 {
 	updateStream(time);
+	if (isRecordingRegisters(VGMRecorder::Chip::SCC)) [[unlikely]] {
+		recordVGM(address, value, time);
+	}
 
 	switch (currentMode) {
 	case Mode::Real:
@@ -339,6 +342,57 @@ void SCC::writeMem(uint8_t address, uint8_t value, EmuTime time)
 	}
 }
 
+void SCC::recordVGM(uint8_t address, uint8_t value, EmuTime time)
+{
+	// translate to the VGM K051649 ports:
+	//  0: waveform, 1: frequency, 2: volume, 3: key on/off,
+	//  4: waveform (SCC+), 5: deformation register
+	auto record = [&](uint8_t port, uint8_t reg) {
+		recordRegisterWrite(VGMRecorder::Chip::SCC, port, reg, value, time);
+	};
+	auto freqVol = [&](uint8_t offset) {
+		offset &= 0x0F; // region is visible twice
+		if (offset < 0x0A) {
+			record(1, offset);
+		} else if (offset < 0x0F) {
+			record(2, offset - 0x0A);
+		} else {
+			record(3, 0);
+		}
+	};
+	switch (currentMode) {
+	case Mode::Real:
+		if (address < 0x80) {
+			record(0, address);
+		} else if (address < 0xA0) {
+			freqVol(address);
+		} else if (address >= 0xE0) {
+			record(5, 0);
+		}
+		break;
+	case Mode::Compatible:
+		if (address < 0x80) {
+			record(0, address);
+		} else if (address < 0xA0) {
+			freqVol(address);
+		} else if ((0xC0 <= address) && (address < 0xE0)) {
+			record(5, 0);
+		}
+		break;
+	case Mode::Plus:
+		if (address < 0xA0) {
+			record(4, address);
+		} else if (address < 0xC0) {
+			freqVol(address);
+		} else if (address < 0xE0) {
+			record(5, 0);
+		}
+		break;
+	default:
+		UNREACHABLE;
+	}
+}
+
 float SCC::getAmplificationFactorImpl() const
 {
 	return 1.0f / 128.0f;
@@ -45,6 +45,7 @@ private:
 	void setDeformRegHelper(uint8_t value);
 	void setFreqVol(unsigned address, uint8_t value, EmuTime time);
 	[[nodiscard]] uint8_t getFreqVol(unsigned address) const;
+	void recordVGM(uint8_t address, uint8_t value, EmuTime time);
 
 private:
 	static constexpr int CLOCK_FREQ = 3579545;
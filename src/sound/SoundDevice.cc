@@ -49,6 +49,7 @@ void SoundDevice::addFill(float*& buf, float val, unsigned num)
 SoundDevice::SoundDevice(MSXMixer& mixer_, std::string_view name_, static_string_view description_,
 			 unsigned numChannels_, unsigned inputRate, bool stereo_)
 	: mixer(mixer_)
+	, vgmRecorder(mixer.getVGMRecorder())
 	, name(makeUnique(mixer, name_))
 	, description(description_)
 	, numChannels(numChannels_)
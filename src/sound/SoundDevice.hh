@@ -2,6 +2,7 @@
 #define SOUNDDEVICE_HH
 
 #include "EmuTime.hh"
+#include "VGMRecorder.hh"
 #include "WavWriter.hh"
 #include "static_string_view.hh"
 
@@ -244,6 +245,20 @@ protected:
 	  */
 	[[nodiscard]] bool mixChannels(float* dataOut, size_t samples);
 
+	[[nodiscard]] bool isRecordingRegisters(VGMRecorder::Chip chip) const {
+		return vgmRecorder.isRecording(chip);
+	}
+	/** Report a register write to the VGM recorder. This is cheap when
+	  * the chip is not being recorded. See VGMRecorder::write() for the
+	  * meaning of the parameters.
+	  */
+	void recordRegisterWrite(VGMRecorder::Chip chip, uint8_t port, uint8_t reg,
+	                         uint8_t value, EmuTime time) {
+		if (vgmRecorder.isRecording(chip)) [[unlikely]] {
+			vgmRecorder.write(getName(), chip, port, reg, value, time);
+		}
+	}
+
 	/** See MSXMixer::getHostSampleClock(). */
 	[[nodiscard]] const DynamicClock& getHostSampleClock() const;
 	[[nodiscard]] double getEffectiveSpeed() const;
@@ -254,6 +269,7 @@ private:
 	};
 
 	MSXMixer& mixer;
+	VGMRecorder& vgmRecorder;
 	const std::string name;
 	const static_string_view description;
 
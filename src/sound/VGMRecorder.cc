@@ -0,0 +1,403 @@
+#include "VGMRecorder.hh"
+
+#include "CommandException.hh"
+#include "FileContext.hh"
+#include "MSXCliComm.hh"
+#include "MSXMotherBoard.hh"
+#include "TclObject.hh"
+
+#include "StringOp.hh"
+#include "endian.hh"
+#include "unreachable.hh"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <utility>
+
+namespace openmsx {
+
+using namespace std::literals;
+
+static constexpr unsigned VGM_RATE = 44100; // wait commands are in samples at 44.1kHz
+static constexpr size_t HEADER_SIZE = 0x100;
+
+static constexpr std::array<std::string_view, size_t(VGMRecorder::Chip::NUM)> chipNames = {
+	"PSG"sv, "MSX-Music"sv, "SFG"sv, "MSX-Audio"sv, "OPL3"sv, "MoonSound"sv, "SCC"sv,
+};
+
+VGMRecorder::VGMRecorder(MSXMotherBoard& motherBoard_)
+	: motherBoard(motherBoard_)
+	, cmd(motherBoard, *this)
+{
+}
+
+VGMRecorder::~VGMRecorder()
+{
+	if (!isActive()) return;
+	try {
+		// machine is deleted while recording, keep what we have
+		finish();
+	} catch (MSXException&) {
+		// ignore
+	}
+}
+
+void VGMRecorder::start(std::string filename_, unsigned chips)
+{
+	assert(!isActive());
+	assert(chips != 0);
+	file = FileOperations::openFile(filename_, "wb");
+	if (!file) {
+		throw MSXException("Couldn't open file for writing: ", filename_);
+	}
+	// header is filled in when the recording is stopped
+	std::array<uint8_t, HEADER_SIZE> header = {};
+	if (fwrite(header.data(), header.size(), 1, file.get()) != 1) {
+		file.reset();
+		throw MSXException("Error while writing VGM file: ", filename_);
+	}
+
+	filename = std::move(filename_);
+	chipMask = chips;
+	buffer.clear();
+	buffer.reserve(BUFFER_SIZE);
+	dataSize = 0;
+	baseTicks = 0;
+	ticks = 0;
+	started = false;
+	sccPlusUsed = false;
+	instances = {};
+
+	writeError = false;
+	startWriter();
+}
+
+void VGMRecorder::transfer(VGMRecorder& other)
+{
+	assert(!isActive());
+	if (!other.isActive()) return;
+
+	// The writer thread works on 'other', restart it for this object.
+	other.stopWriter();
+	file = std::move(other.file);
+	filename = std::move(other.filename);
+	chipMask = std::exchange(other.chipMask, 0);
+	buffer.clear();
+	buffer.reserve(BUFFER_SIZE);
+	dataSize = other.dataSize;
+	ticks = other.ticks;
+	started = other.started;
+	sccPlusUsed = other.sccPlusUsed;
+	instances = std::move(other.instances);
+	writeError = other.writeError;
+	if (started) {
+		// Continue the timeline where the other machine stopped. This
+		// machine has a different time (e.g. earlier, after a reverse).
+		baseTicks = other.baseTicks +
+		            (other.motherBoard.getCurrentTime() - other.startTime).getTicksAt(VGM_RATE);
+		startTime = motherBoard.getCurrentTime();
+		lastWrite = startTime;
+	}
+	startWriter();
+}
+
+void VGMRecorder::stop(EmuTime time)
+{
+	assert(isActive());
+	if (started) updateTime(time);
+	finish();
+}
+
+void VGMRecorder::abort()
+{
+	assert(isActive());
+	stopWriter();
+	chipMask = 0;
+	file.reset();
+	FileOperations::unlink(filename);
+}
+
+void VGMRecorder::finish()
+{
+	append({0x66}); // end of sound data
+	stopWriter();
+
+	auto header = makeHeader();
+	chipMask = 0;
+	bool ok = (fseek(file.get(), 0, SEEK_SET) == 0) &&
+	          (fwrite(header.data(), header.size(), 1, file.get()) == 1);
+	file.reset();
+	if (!ok || writeError) {
+		throw MSXException("Error while writing VGM file: ", filename);
+	}
+}
+
+void VGMRecorder::appendData(std::span<const uint8_t> data)
+{
+	assert(isActive());
+	buffer.insert(buffer.end(), data.begin(), data.end());
+	dataSize += data.size();
+	if (buffer.size() >= BUFFER_SIZE) flush();
+}
+
+void VGMRecorder::append(std::initializer_list<uint8_t> bytes)
+{
+	buffer.insert(buffer.end(), bytes);
+	dataSize += bytes.size();
+	if (buffer.size() >= BUFFER_SIZE) flush();
+}
+
+void VGMRecorder::updateTime(EmuTime time)
+{
+	if (!started) {
+		started = true;
+		startTime = time;
+		motherBoard.getMSXCliComm().printInfo(
+			"VGM recording started, data was written to one of the sound chips recording for.");
+	}
+	lastWrite = time;
+	uint64_t newTicks = baseTicks + (time - startTime).getTicksAt(VGM_RATE);
+	while (newTicks > ticks) {
+		auto step = std::min<uint64_t>(newTicks - ticks, 0xFFFF);
+		ticks += step;
+		append({0x61, uint8_t(step & 0xFF), uint8_t(step >> 8)});
+	}
+}
+
+int VGMRecorder::getInstance(Chip chip, std::string_view device)
+{
+	if (chip == Chip::OPL4) {
+		// The FM and the wave part of the same MoonSound are separate
+		// sound devices ("<name> FM" and "<name> wave").
+		device = device.substr(0, device.rfind(' '));
+	}
+	auto& inst = instances[size_t(chip)];
+	for (int i = 0; i < 2; ++i) {
+		if (inst.names[i] == device) return i;
+		if (inst.names[i].empty()) {
+			inst.names[i] = device;
+			return i;
+		}
+	}
+	if (!inst.warned) {
+		inst.warned = true;
+		motherBoard.getMSXCliComm().printWarning(
+			"VGM supports at most two ", chipNames[size_t(chip)],
+			" chips, not recording ", device, '.');
+	}
+	return -1;
+}
+
+void VGMRecorder::write(std::string_view device, Chip chip, uint8_t port, uint8_t reg,
+                        uint8_t value, EmuTime time)
+{
+	assert(isRecording(chip));
+	int instance = getInstance(chip, device);
+	if (instance < 0) return;
+	bool second = instance == 1;
+	updateTime(time);
+	// The second chip of a type either has its own commands, or bit 7 set
+	// in the register or port number.
+	auto sel = [&](uint8_t first, uint8_t other) { return second ? other : first; };
+	auto hi = uint8_t(second ? 0x80 : 0x00);
+	switch (chip) {
+	case Chip::PSG:    append({0xA0, uint8_t(reg | hi), value}); break;
+	case Chip::OPLL:   append({sel(0x51, 0xA1), reg, value}); break;
+	case Chip::YM2151: append({sel(0x54, 0xA4), reg, value}); break;
+	case Chip::Y8950:  append({sel(0x5C, 0xAC), reg, value}); break;
+	case Chip::OPL3:   append({port ? sel(0x5F, 0xAF) : sel(0x5E, 0xAE), reg, value}); break;
+	case Chip::OPL4:   append({0xD0, uint8_t(port | hi), reg, value}); break;
+	case Chip::SCC:
+		if (port == 4) sccPlusUsed = true;
+		append({0xD2, uint8_t(port | hi), reg, value});
+		break;
+	default:
+		UNREACHABLE;
+	}
+}
+
+void VGMRecorder::flush()
+{
+	std::vector<uint8_t> next;
+	{
+		std::scoped_lock lock(mutex);
+		queue.push_back(std::move(buffer));
+		if (!spare.empty()) {
+			next = std::move(spare.back());
+			spare.pop_back();
+		}
+	}
+	condition.notify_one();
+	next.reserve(BUFFER_SIZE);
+	buffer = std::move(next);
+}
+
+void VGMRecorder::startWriter()
+{
+	quit = false;
+	thread = std::thread([this]{ writerLoop(); });
+}
+
+void VGMRecorder::stopWriter()
+{
+	if (!buffer.empty()) flush();
+	{
+		std::scoped_lock lock(mutex);
+		quit = true;
+	}
+	condition.notify_one();
+	thread.join();
+	queue.clear();
+	spare.clear();
+}
+
+void VGMRecorder::writerLoop()
+{
+	std::unique_lock lock(mutex);
+	while (true) {
+		condition.wait(lock, [&]{ return quit || !queue.empty(); });
+		if (queue.empty()) return; // quit, and everything is written
+
+		auto buf = std::move(queue.front());
+		queue.pop_front();
+		lock.unlock();
+		bool ok = fwrite(buf.data(), 1, buf.size(), file.get()) == buf.size();
+		buf.clear();
+		lock.lock();
+		if (!ok) writeError = true;
+		spare.push_back(std::move(buf));
+	}
+}
+
+std::vector<uint8_t> VGMRecorder::makeHeader() const
+{
+	std::vector<uint8_t> header(HEADER_SIZE, 0);
+	auto put = [&](size_t offset, uint32_t value) {
+		Endian::write_UA_L32(&header[offset], value);
+	};
+	auto clock = [&](size_t offset, Chip chip, uint32_t freq) {
+		if (!isRecording(chip)) return;
+		// bit 30 indicates that there are two chips of this type
+		bool dual = !instances[size_t(chip)].names[1].empty();
+		put(offset, freq | (dual ? 0x4000'0000 : 0));
+	};
+	std::ranges::copy("Vgm "sv, header.begin());
+	put(0x04, uint32_t(HEADER_SIZE + dataSize - 4)); // end-of-file offset
+	put(0x08, 0x161); // version 1.61
+	clock(0x10, Chip::OPLL, 3579545);
+	put(0x18, uint32_t(ticks)); // total number of samples
+	clock(0x30, Chip::YM2151, 3579545);
+	put(0x34, HEADER_SIZE - 0x34); // relative offset to the VGM data
+	clock(0x58, Chip::Y8950, 3579545);
+	clock(0x5C, Chip::OPL3, 14318182);
+	clock(0x60, Chip::OPL4, 33868800);
+	clock(0x74, Chip::PSG, 1789773);
+	// bit 31 of the K051649 clock selects the SCC+
+	clock(0x9C, Chip::SCC, 1789773 | (sccPlusUsed ? 0x8000'0000 : 0));
+	return header;
+}
+
+
+// class VGMRecorder::Cmd
+
+VGMRecorder::Cmd::Cmd(MSXMotherBoard& motherBoard_, VGMRecorder& recorder_)
+	: Command(motherBoard_.getCommandController(), "vgm_recorder")
+	, motherBoard(motherBoard_)
+	, recorder(recorder_)
+{
+}
+
+void VGMRecorder::Cmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{2}, "subcommand ?arg ...?");
+	auto& interp = getInterpreter();
+	auto checkActive = [&] {
+		if (!recorder.isActive()) throw CommandException("Not recording.");
+	};
+	executeSubCommand(tokens[1].getString(),
+		"start", [&]{
+			checkNumArgs(tokens, AtLeast{4}, "filename chip ?chip ...?");
+			if (recorder.isActive()) throw CommandException("Already recording.");
+			unsigned chips = 0;
+			for (const auto& arg : tokens.subspan(3)) {
+				auto name = arg.getString();
+				auto it = std::ranges::find_if(chipNames, [&](auto n) { return StringOp::casecmp{}(n, name); });
+				if (it == chipNames.end()) {
+					throw CommandException("Unknown sound chip: ", name);
+				}
+				chips |= 1 << std::distance(chipNames.begin(), it);
+			}
+			try {
+				recorder.start(std::string(tokens[2].getString()), chips);
+			} catch (MSXException& e) {
+				throw CommandException(e.getMessage());
+			}
+		},
+		"stop", [&]{
+			checkNumArgs(tokens, 2, "");
+			checkActive();
+			try {
+				recorder.stop(motherBoard.getCurrentTime());
+			} catch (MSXException& e) {
+				throw CommandException(e.getMessage());
+			}
+		},
+		"abort", [&]{
+			checkNumArgs(tokens, 2, "");
+			checkActive();
+			recorder.abort();
+		},
+		"data", [&]{
+			checkNumArgs(tokens, 3, "data");
+			checkActive();
+			recorder.appendData(tokens[2].getBinary(interp));
+		},
+		"active", [&]{
+			checkNumArgs(tokens, 2, "");
+			result = recorder.isActive();
+		},
+		"first_write", [&]{
+			checkNumArgs(tokens, 2, "");
+			checkActive();
+			// (before 'startTime' in case of a transferred recording)
+			result = recorder.started
+			       ? recorder.startTime.toDouble() - double(recorder.baseTicks) / VGM_RATE
+			       : 0.0;
+		},
+		"last_write", [&]{
+			checkNumArgs(tokens, 2, "");
+			checkActive();
+			result = recorder.started ? recorder.lastWrite.toDouble() : 0.0;
+		});
+}
+
+std::string VGMRecorder::Cmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Low level VGM recorder, normally used via the 'vgm_rec' script.\n"
+	       "vgm_recorder start <filename> <chip> ...  start recording the register writes of the given chips\n"
+	       "                                          (PSG, MSX-Music, SFG, MSX-Audio, OPL3, MoonSound or SCC)\n"
+	       "vgm_recorder stop                         stop recording and finish the VGM file\n"
+	       "vgm_recorder abort                        stop recording and delete the VGM file\n"
+	       "vgm_recorder data <binary>                append raw VGM data (e.g. a data block)\n"
+	       "vgm_recorder active                       is a recording in progress?\n"
+	       "vgm_recorder first_write                  time of the first recorded register write (0 if none yet)\n"
+	       "vgm_recorder last_write                   time of the last recorded register write (0 if none yet)\n";
+}
+
+void VGMRecorder::Cmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static constexpr std::array subCmds = {
+			"start"sv, "stop"sv, "abort"sv, "data"sv, "active"sv, "first_write"sv, "last_write"sv,
+		};
+		completeString(tokens, subCmds);
+	} else if ((tokens.size() == 3) && (tokens[1] == "start")) {
+		completeFileName(tokens, userFileContext());
+	} else if ((tokens.size() >= 4) && (tokens[1] == "start")) {
+		completeString(tokens, chipNames, false);
+	}
+}
+
+} // namespace openmsx
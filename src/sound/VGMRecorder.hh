@@ -0,0 +1,146 @@
+#ifndef VGMRECORDER_HH
+#define VGMRECORDER_HH
+
+#include "Command.hh"
+#include "EmuTime.hh"
+#include "FileOperations.hh"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+
+/** Records the register writes of the sound chips in VGM format.
+  *
+  * The sound chips report their register writes via
+  * SoundDevice::recordRegisterWrite(). When the chip is not being recorded
+  * that's only a bit test. Otherwise the write is appended (as a VGM
+  * command, preceded by a wait command) to an in-memory buffer. Full
+  * buffers are handed over to a background thread that writes them to
+  * disk. When the recording is stopped the VGM header is filled in.
+  *
+  * Timing starts at the first recorded register write, so that the silence
+  * before the music starts is not recorded.
+  *
+  * VGM supports two chips of each type. The sound devices are told apart by
+  * name, the first one that writes is recorded as the first chip, the next
+  * one as the second chip. Writes of a third chip of the same type are
+  * dropped (with a warning).
+  */
+class VGMRecorder
+{
+public:
+	enum class Chip : uint8_t {
+		PSG,    // AY8910
+		OPLL,   // YM2413
+		YM2151,
+		Y8950,
+		OPL3,   // YMF262
+		OPL4,   // YMF278B (both the FM and the wave part)
+		SCC,    // K051649 (also SCC+)
+		NUM
+	};
+
+public:
+	explicit VGMRecorder(MSXMotherBoard& motherBoard);
+	VGMRecorder(const VGMRecorder&) = delete;
+	VGMRecorder(VGMRecorder&&) = delete;
+	VGMRecorder& operator=(const VGMRecorder&) = delete;
+	VGMRecorder& operator=(VGMRecorder&&) = delete;
+	~VGMRecorder();
+
+	[[nodiscard]] bool isRecording(Chip chip) const {
+		return (chipMask >> unsigned(chip)) & 1;
+	}
+	[[nodiscard]] bool isActive() const { return chipMask != 0; }
+
+	/** Record a register write of the sound device with the given name.
+	  * Meaning of 'port' depends on the chip:
+	  * - OPL3, OPL4: the register bank (OPL4: 2 is the wave part)
+	  * - SCC: the VGM K051649 port (0=waveform, 1=frequency, 2=volume,
+	  *   3=key on/off, 4=SCC+ waveform, 5=deformation)
+	  * - other chips: ignored
+	  * Should only be called when isRecording(chip) is true. */
+	void write(std::string_view device, Chip chip, uint8_t port, uint8_t reg,
+	           uint8_t value, EmuTime time);
+
+	/** Start recording the given chips (a bitmask of Chip values). */
+	void start(std::string filename, unsigned chips);
+	void stop(EmuTime time);
+	void abort();
+	/** Append raw VGM data, e.g. data blocks or markers. */
+	void appendData(std::span<const uint8_t> data);
+
+	/** Take over the recording (if any) of the recorder of another machine.
+	  * Used when reverse replaces the machine, then the recording continues
+	  * on the new machine, right after what was recorded so far. */
+	void transfer(VGMRecorder& other);
+
+private:
+	[[nodiscard]] int getInstance(Chip chip, std::string_view device);
+	void updateTime(EmuTime time);
+	void append(std::initializer_list<uint8_t> bytes);
+	void flush();
+	void startWriter();
+	void stopWriter();
+	void finish();
+	void writerLoop();
+	[[nodiscard]] std::vector<uint8_t> makeHeader() const;
+
+private:
+	static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+	MSXMotherBoard& motherBoard;
+
+	struct Cmd final : Command {
+		Cmd(MSXMotherBoard& motherBoard, VGMRecorder& recorder);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	private:
+		MSXMotherBoard& motherBoard;
+		VGMRecorder& recorder;
+	} cmd;
+
+	// only accessed from the emulation thread
+	unsigned chipMask = 0;
+	std::string filename;
+	std::vector<uint8_t> buffer; // not yet handed over to the writer thread
+	size_t dataSize = 0; // total size of the VGM data (excluding header)
+	EmuTime startTime = EmuTime::zero();
+	EmuTime lastWrite = EmuTime::zero();
+	uint64_t baseTicks = 0; // recorded before 'startTime' (on a previous machine)
+	uint64_t ticks = 0; // at 44100Hz, since the first write
+	bool started = false; // seen the first register write?
+	bool sccPlusUsed = false;
+	struct Instances {
+		std::array<std::string, 2> names; // in order of the first write, empty if unused
+		bool warned = false; // about a third chip
+	};
+	std::array<Instances, size_t(Chip::NUM)> instances;
+
+	// shared with the writer thread
+	FileOperations::FILE_t file;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::vector<uint8_t>> queue; // full buffers
+	std::vector<std::vector<uint8_t>> spare; // written buffers, for reuse
+	bool quit = false;
+	bool writeError = false;
+};
+
+} // namespace openmsx
+
+#endif
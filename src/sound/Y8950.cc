@@ -914,6 +914,8 @@ void Y8950::writeReg(uint8_t rg, uint8_t data, EmuTime time)
 		-1, -1, -1, -1, -1, -1, -1, -1
 	};
 
+	recordRegisterWrite(VGMRecorder::Chip::Y8950, 0, rg, data, time);
+
 	// TODO only for registers that influence sound
 	// TODO also ADPCM
 	//if (rg >= 0x20) {
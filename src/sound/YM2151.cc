@@ -651,6 +651,7 @@ void YM2151::refreshEG(std::span<YM2151Operator, 4> op)
 
 void YM2151::writeReg(uint8_t r, uint8_t v, EmuTime time)
 {
+	recordRegisterWrite(VGMRecorder::Chip::YM2151, 0, r, v, time);
 	updateStream(time);
 
 	YM2151Operator& op = oper[(r & 0x07) * 4 + ((r & 0x18) >> 3)];
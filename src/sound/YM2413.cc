@@ -96,6 +96,11 @@ void YM2413::writePort(bool port, uint8_t value, EmuTime time)
 	assert(offset >= 0);
 	assert(offset < 18);
 
+	if (!port) {
+		registerLatch = value;
+	} else {
+		recordRegisterWrite(VGMRecorder::Chip::OPLL, 0, registerLatch, value, time);
+	}
 	core->writePort(port, value, offset);
 }
 
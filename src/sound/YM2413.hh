@@ -37,6 +37,7 @@ private:
 
 private:
 	const std::unique_ptr<YM2413Core> core;
+	uint8_t registerLatch = 0; // only used for the VGM recorder, the core has its own latch
 
 	struct Debuggable final : SimpleDebuggable {
 		Debuggable(MSXMotherBoard& motherBoard, const std::string& name);
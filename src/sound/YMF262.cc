@@ -1039,6 +1039,8 @@ void YMF262::writeReg(unsigned r, uint8_t v, EmuTime time)
 		// in OPL2 mode the only accessible in set #2 is register 0x05
 		r &= ~0x100;
 	}
+	recordRegisterWrite(isYMF278 ? VGMRecorder::Chip::OPL4 : VGMRecorder::Chip::OPL3,
+	                    uint8_t(r >> 8), uint8_t(r & 0xFF), v, time);
 	writeReg512(r, v, time);
 }
 void YMF262::writeReg512(unsigned r, uint8_t v, EmuTime time)
@@ -580,6 +580,7 @@ void YMF278::keyOnHelper(YMF278::Slot& slot) const
 
 void YMF278::writeReg(uint8_t reg, uint8_t data, EmuTime time)
 {
+	recordRegisterWrite(VGMRecorder::Chip::OPL4, 2, reg, data, time); // port 2 is the wave part
 	updateStream(time); // TODO optimize only for regs that directly influence sound
 	writeRegDirect(reg, data, time);
 }
@@ -0,0 +1,172 @@
+#include "catch.hpp"
+#include "BitmapConverter.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace openmsx;
+using Pixel = BitmapConverter::Pixel;
+
+// Straightforward implementations, one VRAM byte at a time.
+static void refGraphic4(std::span<const Pixel, 32> pal16, std::span<const uint8_t, 128> vram, std::span<Pixel> out)
+{
+	for (auto i : xrange(128)) {
+		out[2 * i + 0] = pal16[vram[i] >> 4];
+		out[2 * i + 1] = pal16[vram[i] & 15];
+	}
+}
+
+static void refGraphic5(std::span<const Pixel, 32> pal16, std::span<const uint8_t, 128> vram, std::span<Pixel> out)
+{
+	for (auto i : xrange(128)) {
+		unsigned data = vram[i];
+		out[4 * i + 0] = pal16[ 0 +  (data >> 6)     ];
+		out[4 * i + 1] = pal16[16 + ((data >> 4) & 3)];
+		out[4 * i + 2] = pal16[ 0 + ((data >> 2) & 3)];
+		out[4 * i + 3] = pal16[16 + ((data >> 0) & 3)];
+	}
+}
+
+static void refGraphic6(std::span<const Pixel, 32> pal16, std::span<const uint8_t, 128> vram0,
+                        std::span<const uint8_t, 128> vram1, std::span<Pixel> out)
+{
+	for (auto i : xrange(128)) {
+		out[4 * i + 0] = pal16[vram0[i] >> 4];
+		out[4 * i + 1] = pal16[vram0[i] & 15];
+		out[4 * i + 2] = pal16[vram1[i] >> 4];
+		out[4 * i + 3] = pal16[vram1[i] & 15];
+	}
+}
+
+static void refGraphic7(std::span<const Pixel, 256> pal256, std::span<const uint8_t, 128> vram0,
+                        std::span<const uint8_t, 128> vram1, std::span<Pixel> out)
+{
+	for (auto i : xrange(128)) {
+		out[2 * i + 0] = pal256[vram0[i]];
+		out[2 * i + 1] = pal256[vram1[i]];
+	}
+}
+
+static void refYJK(std::span<const Pixel, 32> pal16, std::span<const Pixel, 32768> pal32768,
+                   std::span<const uint8_t, 128> vram0, std::span<const uint8_t, 128> vram1,
+                   bool yae, std::span<Pixel> out)
+{
+	for (auto i : xrange(64)) {
+		std::array<int, 4> p = {
+			vram0[2 * i + 0],
+			vram1[2 * i + 0],
+			vram0[2 * i + 1],
+			vram1[2 * i + 1],
+		};
+		int j = (p[2] & 7) + ((p[3] & 3) << 3) - ((p[3] & 4) << 3);
+		int k = (p[0] & 7) + ((p[1] & 3) << 3) - ((p[1] & 4) << 3);
+		for (auto n : xrange(4)) {
+			if (yae && (p[n] & 0x08)) {
+				out[4 * i + n] = pal16[p[n] >> 4];
+			} else {
+				int y = p[n] >> 3;
+				int r = std::clamp(y + j,                       0, 31);
+				int g = std::clamp(y + k,                       0, 31);
+				int b = std::clamp((5 * y - 2 * j - k + 2) / 4, 0, 31);
+				out[4 * i + n] = pal32768[(r << 10) + (g << 5) + b];
+			}
+		}
+	}
+}
+
+TEST_CASE("BitmapConverter")
+{
+	std::mt19937 gen(1234);
+	std::array<Pixel, 32> pal16;
+	std::array<Pixel, 256> pal256;
+	std::vector<Pixel> pal32768(32768);
+	for (auto& p : pal16)    p = Pixel(gen());
+	for (auto& p : pal256)   p = Pixel(gen());
+	for (auto& p : pal32768) p = Pixel(gen());
+	BitmapConverter converter(pal16, pal256, std::span<const Pixel, 32768>(pal32768));
+
+	std::array<uint8_t, 128> vram0, vram1;
+	std::array<Pixel, 512> expected, actual;
+	auto check = [&](uint8_t base, uint8_t reg25, unsigned width, bool planar, auto ref) {
+		for (auto iter : xrange(20)) {
+			for (auto& v : vram0) v = uint8_t(gen());
+			for (auto& v : vram1) v = uint8_t(gen());
+			if (iter == 0) {
+				// extreme values for the YJK calculation
+				std::ranges::fill(vram0, 0xFF);
+				std::ranges::fill(vram1, 0x04);
+			}
+			ref();
+			// M5..M3 bits are in R#0, YJK and YAE in R#25
+			converter.setDisplayMode(DisplayMode(uint8_t(base >> 1), 0, reg25));
+			if (planar) {
+				converter.convertLinePlanar(actual, vram0, vram1);
+			} else {
+				converter.convertLine(actual, vram0);
+			}
+			CHECK(std::equal(expected.begin(), expected.begin() + width, actual.begin()));
+		}
+	};
+
+	SECTION("Graphic4") {
+		check(DisplayMode::GRAPHIC4, 0, 256, false, [&] { refGraphic4(pal16, vram0, expected); });
+	}
+	SECTION("Graphic5") {
+		check(DisplayMode::GRAPHIC5, 0, 512, false, [&] { refGraphic5(pal16, vram0, expected); });
+		// palette change must be picked up
+		pal16[17] = 0x12345678;
+		converter.palette16Changed();
+		check(DisplayMode::GRAPHIC5, 0, 512, false, [&] { refGraphic5(pal16, vram0, expected); });
+	}
+	SECTION("Graphic6") {
+		check(DisplayMode::GRAPHIC6, 0, 512, true, [&] { refGraphic6(pal16, vram0, vram1, expected); });
+	}
+	SECTION("Graphic7") {
+		check(DisplayMode::GRAPHIC7, 0, 256, true, [&] { refGraphic7(pal256, vram0, vram1, expected); });
+	}
+	SECTION("YJK") {
+		check(DisplayMode::GRAPHIC7, 0x08, 256, true, [&] {
+			refYJK(pal16, std::span<const Pixel, 32768>(pal32768), vram0, vram1, false, expected); });
+	}
+	SECTION("YAE") {
+		check(DisplayMode::GRAPHIC7, 0x18, 256, true, [&] {
+			refYJK(pal16, std::span<const Pixel, 32768>(pal32768), vram0, vram1, true, expected); });
+	}
+}
+
+TEST_CASE("BitmapConverter: all YJK combinations")
+{
+	// Every combination of j, k and y, once for each position in the group.
+	std::array<uint8_t, 128> vram0, vram1;
+	std::array<uint16_t, 256> indices;
+	for (auto jk : xrange(64 * 64)) {
+		int j = jk & 63;
+		int k = jk >> 6;
+		for (int y0 : {0, 16}) {
+			for (auto g : xrange(64)) {
+				int y = (y0 + g) & 31;
+				vram0[2 * g + 0] = uint8_t((y << 3) | (k & 7));
+				vram1[2 * g + 0] = uint8_t((((y + 1) & 31) << 3) | (k >> 3));
+				vram0[2 * g + 1] = uint8_t((((y + 2) & 31) << 3) | (j & 7));
+				vram1[2 * g + 1] = uint8_t((((y + 3) & 31) << 3) | (j >> 3));
+			}
+			BitmapConverter::calcYJKIndices(indices, vram0, vram1, false);
+			int sj = (j ^ 32) - 32;
+			int sk = (k ^ 32) - 32;
+			for (auto i : xrange(256)) {
+				int yy = (y0 + i / 4 + i % 4) & 31;
+				int r = std::clamp(yy + sj,                        0, 31);
+				int gg = std::clamp(yy + sk,                       0, 31);
+				int b = std::clamp((5 * yy - 2 * sj - sk + 2) / 4, 0, 31);
+				if (indices[i] != (r << 10) + (gg << 5) + b) {
+					FAIL("j=" << sj << " k=" << sk << " y=" << yy);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,318 @@
+#include "catch.hpp"
+#include "CompiledCondition.hh"
+
+#include "Interpreter.hh"
+#include "TclObject.hh"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+using namespace openmsx;
+
+namespace {
+
+// Tcl versions of the commands that CompiledCondition evaluates natively,
+// they work on the same (fake) machine state. In the same namespaces as the
+// real scripts in share/scripts.
+constexpr const char* const script = R"(
+proc debug {subcmd name addr} {
+	switch -- $name {
+		memory     {lindex $::mem  $addr}
+		{CPU regs} {lindex $::regs $addr}
+	}
+}
+namespace eval cpuregs {
+	proc reg {name} {dict get $::regvalues [string toupper $name]}
+	namespace export reg
+}
+namespace eval disasm {
+	proc peek     {addr {m memory}} {debug read $m $addr}
+	proc peek_s8  {addr {m memory}} {
+		set b [peek $addr $m]
+		expr {($b < 128) ? $b : $b - 256}
+	}
+	proc peek16    {addr {m memory}} {expr {[peek $addr $m] + 256 * [peek [expr {$addr + 1}] $m]}}
+	proc peek16_BE {addr {m memory}} {expr {256 * [peek $addr $m] + [peek [expr {$addr + 1}] $m]}}
+	proc peek_s16  {addr {m memory}} {
+		set w [peek16 $addr $m]
+		expr {($w < 32768) ? $w : $w - 65536}
+	}
+	namespace export peek*
+}
+namespace eval slot {
+	proc address_in_slot {addr ps ss} {
+		set page [expr {$addr >> 14}]
+		set pcps [lindex $::primary $page]
+		if {$ps ne "X" && $pcps != $ps} {return 0}
+		if {$ss ne "X" && [lindex $::expanded $pcps] && [lindex $::secondary $page] != $ss} {return 0}
+		return 1
+	}
+	proc pc_in_slot    {ps {ss X}} {address_in_slot [reg PC] $ps $ss}
+	proc watch_in_slot {ps {ss X}} {address_in_slot $::wp_last_address $ps $ss}
+	namespace export pc_in_slot watch_in_slot
+}
+namespace import cpuregs::* disasm::* slot::*
+)";
+
+constexpr std::array<std::string_view, 28> byteRegs = {
+	"A",   "F",   "B",   "C",   "D",   "E",   "H",   "L",
+	"A2",  "F2",  "B2",  "C2",  "D2",  "E2",  "H2",  "L2",
+	"IXH", "IXL", "IYH", "IYL", "PCH", "PCL", "SPH", "SPL",
+	"I",   "R",   "IM",  "IFF",
+};
+constexpr std::array<std::string_view, 12> wordRegs = {
+	"AF",  "BC",  "DE",  "HL",
+	"AF2", "BC2", "DE2", "HL2",
+	"IX",  "IY",  "PC",  "SP",
+};
+
+constexpr std::array<int, 4> primary   = {0, 1, 3, 3};
+constexpr std::array<int, 4> secondary = {0, 0, 2, 1};
+constexpr std::array<int, 4> expanded  = {0, 0, 0, 1};
+
+struct FakeMachine final : CompiledCondition::Machine
+{
+	std::vector<uint8_t> mem = std::vector<uint8_t>(0x10000);
+	std::array<uint8_t, 28> regs = {};
+
+	[[nodiscard]] std::optional<uint8_t> read(std::string_view debuggable, int64_t addr) override
+	{
+		if (debuggable == "memory" && (0 <= addr) && (addr < int64_t(mem.size()))) {
+			return mem[addr];
+		}
+		if (debuggable == "CPU regs" && (0 <= addr) && (addr < int64_t(regs.size()))) {
+			return regs[addr];
+		}
+		return {};
+	}
+
+	[[nodiscard]] uint16_t getPC() override
+	{
+		return uint16_t(256 * regs[20] + regs[21]);
+	}
+
+	[[nodiscard]] std::optional<bool> inSlot(int64_t addr, int64_t ps, int64_t ss) override
+	{
+		auto page = addr >> 14;
+		auto pcPs = primary[page];
+		if ((ps != -1) && (pcPs != ps)) return false;
+		if ((ss != -1) && expanded[pcPs] && (secondary[page] != ss)) return false;
+		return true;
+	}
+
+	// Fill with pseudo random data, with many small values so that
+	// comparisons are sometimes true.
+	void randomize(unsigned seed)
+	{
+		uint32_t x = seed * 2654435761u + 1;
+		auto next = [&] {
+			x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+			return (x & 4) ? uint8_t(x >> 8) : uint8_t((x >> 8) & 3);
+		};
+		for (auto& m : mem) m = next();
+		for (auto& r : regs) r = next();
+	}
+
+	void exportToTcl(Interpreter& interp) const
+	{
+		TclObject tclMem;
+		for (auto m : mem) tclMem.addListElement(m);
+		interp.setVariable(TclObject("mem"), tclMem);
+
+		TclObject tclRegs;
+		TclObject regValues;
+		for (size_t i = 0; i < regs.size(); ++i) {
+			tclRegs.addListElement(regs[i]);
+			regValues.addDictKeyValue(byteRegs[i], regs[i]);
+		}
+		for (size_t i = 0; i < wordRegs.size(); ++i) {
+			regValues.addDictKeyValue(wordRegs[i], 256 * regs[2 * i] + regs[2 * i + 1]);
+		}
+		interp.setVariable(TclObject("regs"), tclRegs);
+		interp.setVariable(TclObject("regvalues"), regValues);
+	}
+};
+
+void setupInterpreter(Interpreter& interp)
+{
+	auto toList = [](const auto& array) {
+		TclObject result;
+		for (auto a : array) result.addListElement(a);
+		return result;
+	};
+	interp.setVariable(TclObject("primary"), toList(primary));
+	interp.setVariable(TclObject("secondary"), toList(secondary));
+	interp.setVariable(TclObject("expanded"), toList(expanded));
+	interp.execute(script);
+}
+
+} // namespace
+
+TEST_CASE("CompiledCondition: compare with Tcl")
+{
+	static constexpr std::array conditions = {
+		// registers
+		"[reg A] == 2",
+		"[reg a] != [reg B]",
+		"[reg HL] > 1000",
+		"[reg pc] == 0x4000 || [reg PC] < 0x8000",
+		"[reg SP] <= 0xF000 && [reg IXh] != 3",
+		"[reg a2] | [reg f2]",
+		"[reg IX] - [reg IY] < 0",
+		"[reg de2] >> 8 == [reg D2]",
+		"[reg I] + [reg R] + [reg IM] + [reg IFF]",
+		"~[reg B] & 0xff",
+		"!([reg E] ^ 1)",
+		// memory
+		"[peek 0x4000] == 0x2",
+		"[peek16 0x4000] == 0x0302",
+		"[peek_s8 0x10] < 0",
+		"[peek16_BE 0x10] > [peek16 0x10]",
+		"[peek_s16 0x20] < -100",
+		"[peek [reg HL]] == [peek 0x1234 memory]",
+		"[peek $counter] == 1",
+		"[peek [expr {[reg HL] + 1}]] >= 2",
+		"[debug read memory 0x100] == [peek 256]",
+		"[debug read {CPU regs} 0] == [reg A]",
+		"[debug read \"CPU regs\" 7] == [reg L]",
+		// literals and variables
+		"$counter > 10 || $counter == 3",
+		"${counter} % 4 == 1",
+		"$::counter * 2 >= 0b1010",
+		"0o17 == 15 && 0XfF == 255 && 0B11 == 3",
+		"-5 / 2 == -3 && -5 % 3 == 1 && 5 % -3 == -1",
+		"(1 << 40) > 0 && (-16 >> 2) == -4",
+		"[reg A] ? [peek 1] : [peek 2]",
+		"[reg A] == 1 ? [reg B] == 2 : [reg C] == 3 ? 1 : 0",
+		"[expr {[reg C] + 1}] == 2",
+		"3 - 2 - 1 == 0 && 2 + 3 * 4 == 14 && (2 + 3) * 4 == 20",
+		"1 < 2 == 1 && 4 & 5 ^ 6 | 8",
+		// slots
+		"[pc_in_slot 0]",
+		"[pc_in_slot 3 1]",
+		"[pc_in_slot 1 X]",
+		"[pc_in_slot X 2]",
+		"[watch_in_slot 3 2]",
+		"[watch_in_slot 3]",
+	};
+
+	Interpreter interp;
+	setupInterpreter(interp);
+	FakeMachine machine;
+
+	int numTrue = 0;
+	int numFalse = 0;
+	for (unsigned seed = 0; seed < 16; ++seed) {
+		machine.randomize(seed);
+		machine.exportToTcl(interp);
+		interp.setVariable(TclObject("counter"), TclObject(int(seed)));
+		interp.setVariable(TclObject("wp_last_address"), TclObject(int(seed * 0x1111)));
+		for (const auto* condition : conditions) {
+			INFO("seed " << seed << ": " << condition);
+			auto compiled = CompiledCondition::compile(condition);
+			REQUIRE(compiled);
+			auto result = compiled->evaluate(machine, interp);
+			REQUIRE(result);
+			CHECK(*result == TclObject(condition).evalBool(interp));
+			++(*result ? numTrue : numFalse);
+		}
+	}
+	CHECK(numTrue > 100);
+	CHECK(numFalse > 100);
+}
+
+TEST_CASE("CompiledCondition: evaluate via Tcl")
+{
+	// Either not supported by the compiler or only known at run-time. In
+	// both cases the condition must (also) be evaluated via Tcl.
+	static constexpr std::array unsupported = {
+		"$sym(FOO) == 3",       // symbol (array element)
+		"[reg A] == 1.5",       // float
+		"2 ** 3",               // exponentiation
+		"abs(-3)",              // function
+		"[peek 0x10] eq 3",     // string comparison
+		"010 == 8",             // old style octal
+		"[string length abc]",  // other command
+		"[reg A] == 1; foo",    // multiple commands
+		"[reg A 3]",            // too many arguments
+		"[pc_in_slot 1 0 3]",   // mapper check
+		"[peek \"$addr\"]",     // substitution in quotes
+		"9223372036854775808",  // bignum
+	};
+	for (const auto* condition : unsupported) {
+		INFO(condition);
+		CHECK(!CompiledCondition::compile(condition));
+	}
+
+	Interpreter interp;
+	setupInterpreter(interp);
+	FakeMachine machine;
+	machine.exportToTcl(interp);
+	interp.setVariable(TclObject("zero"), TclObject(0));
+
+	static constexpr std::array failing = {
+		"$undefined == 3",     // variable doesn't exist
+		"1 / $zero",           // division by zero
+		"[peek 0x10000]",      // out of range
+		"[peek 0 {foo}]",      // debuggable doesn't exist
+		"-9223372036854775807 - 2 < 0", // overflow
+	};
+	for (const auto* condition : failing) {
+		INFO(condition);
+		auto compiled = CompiledCondition::compile(condition);
+		REQUIRE(compiled);
+		CHECK(!compiled->evaluate(machine, interp));
+	}
+}
+
+TEST_CASE("CompiledCondition: redefined commands")
+{
+	Interpreter interp;
+	FakeMachine machine;
+	machine.mem[0] = 42;
+	machine.regs[0] = 7;
+
+	auto peekCond = CompiledCondition::compile("[peek 0] == 42");
+	auto regCond = CompiledCondition::compile("[reg A] == 7");
+	REQUIRE(peekCond);
+	REQUIRE(regCond);
+
+	// commands don't exist (yet)
+	CHECK(!peekCond->evaluate(machine, interp));
+	CHECK(!regCond->evaluate(machine, interp));
+
+	setupInterpreter(interp);
+	machine.exportToTcl(interp);
+	CHECK(peekCond->evaluate(machine, interp) == true);
+	CHECK(regCond->evaluate(machine, interp) == true);
+
+	// overriding 'peek' in the global namespace
+	interp.execute("proc peek {addr {m memory}} {return 0}");
+	CHECK(!peekCond->evaluate(machine, interp));
+	CHECK(regCond->evaluate(machine, interp) == true);
+	CHECK(!TclObject("[peek 0] == 42").evalBool(interp));
+
+	// restore the original
+	interp.execute("rename peek {}; namespace import disasm::peek");
+	CHECK(peekCond->evaluate(machine, interp) == true);
+
+	// renaming
+	interp.execute("rename reg reg_orig");
+	CHECK(!regCond->evaluate(machine, interp));
+	interp.execute("rename reg_orig reg");
+	CHECK(regCond->evaluate(machine, interp) == true);
+
+	// redefining the original (the imported command remains)
+	interp.execute("proc ::cpuregs::reg {name} {return 0}");
+	CHECK(interp.getCommandOrigin("reg") == "::cpuregs::reg");
+	CHECK(!regCond->evaluate(machine, interp));
+	CHECK(!TclObject("[reg A] == 7").evalBool(interp));
+	// also for newly compiled conditions
+	auto regCond2 = CompiledCondition::compile("[reg A] == 7");
+	REQUIRE(regCond2);
+	CHECK(!regCond2->evaluate(machine, interp));
+	// other commands are still evaluated natively
+	CHECK(peekCond->evaluate(machine, interp) == true);
+}
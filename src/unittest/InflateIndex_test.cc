@@ -0,0 +1,93 @@
+#include "catch.hpp"
+#include "InflateIndex.hh"
+
+#include "FileOperations.hh"
+#include "xrange.hh"
+
+#include <cstdint>
+#include <vector>
+
+#define ZLIB_CONST
+#include <zlib.h>
+
+using namespace openmsx;
+
+// Somewhat compressible data, large enough to get several chunks.
+static std::vector<uint8_t> generateData(size_t size)
+{
+	std::vector<uint8_t> result(size);
+	uint32_t x = 12345;
+	for (auto i : xrange(size)) {
+		x = x * 1103515245 + 12345;
+		result[i] = uint8_t((x >> 24) & 0x0F) + uint8_t(i >> 16);
+	}
+	return result;
+}
+
+static std::vector<uint8_t> rawDeflate(const std::vector<uint8_t>& input)
+{
+	z_stream s = {};
+	REQUIRE(deflateInit2(&s, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	std::vector<uint8_t> result(deflateBound(&s, uLong(input.size())));
+	s.next_in = input.data();
+	s.avail_in = uInt(input.size());
+	s.next_out = result.data();
+	s.avail_out = uInt(result.size());
+	REQUIRE(deflate(&s, Z_FINISH) == Z_STREAM_END);
+	result.resize(s.total_out);
+	deflateEnd(&s);
+	return result;
+}
+
+static void checkAllChunks(const InflateIndex& index,
+                           const std::vector<uint8_t>& compressed,
+                           const std::vector<uint8_t>& expected)
+{
+	CHECK(index.size() == expected.size());
+	for (auto chunk : xrange(index.numChunks())) {
+		auto begin = index.chunkBegin(chunk);
+		auto end = index.chunkEnd(chunk);
+		CHECK(index.chunkOf(begin) == chunk);
+		CHECK(index.chunkOf(end - 1) == chunk);
+		auto data = index.extract(compressed, chunk);
+		REQUIRE(data.size() == (end - begin));
+		CHECK(std::equal(data.begin(), data.end(), expected.begin() + begin));
+	}
+}
+
+TEST_CASE("InflateIndex")
+{
+	auto original = generateData(5 * InflateIndex::SPAN + 1234);
+	auto compressed = rawDeflate(original);
+
+	auto index = InflateIndex::build(compressed);
+	CHECK(index.numChunks() > 1);
+	CHECK(index.chunkBegin(0) == 0);
+	CHECK(index.chunkEnd(index.numChunks() - 1) == original.size());
+	checkAllChunks(index, compressed, original);
+
+	SECTION("save/load") {
+		auto filename = FileOperations::getTempDir() + "/inflateindex_unittest.idx";
+		FileOperations::FileStamp stamp{.size = compressed.size(), .modificationDate = 42};
+		index.save(filename, stamp);
+		auto loaded = InflateIndex::load(filename, stamp);
+		REQUIRE(loaded);
+		CHECK(loaded->numChunks() == index.numChunks());
+		checkAllChunks(*loaded, compressed, original);
+
+		// different file
+		CHECK(!InflateIndex::load(filename, {.size = stamp.size, .modificationDate = 43}));
+		CHECK(!InflateIndex::load(filename, {.size = stamp.size + 1, .modificationDate = 42}));
+		FileOperations::unlink(filename);
+		CHECK(!InflateIndex::load(filename, stamp)); // doesn't exist
+	}
+}
+
+TEST_CASE("InflateIndex: small input")
+{
+	auto original = generateData(1000);
+	auto compressed = rawDeflate(original);
+	auto index = InflateIndex::build(compressed);
+	CHECK(index.numChunks() == 1);
+	checkAllChunks(index, compressed, original);
+}
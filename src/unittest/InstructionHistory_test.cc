@@ -0,0 +1,158 @@
+#include "catch.hpp"
+#include "InstructionHistory.hh"
+
+#include <cstdint>
+#include <vector>
+
+using namespace openmsx;
+using Entry = InstructionHistory::Entry;
+using Buffer = InstructionHistory::Buffer;
+
+// Instructions with PC jumps (every 7th), changes in registers 0-7 (every
+// 3rd), changes in registers 8-11 (every 5th) and irregular time steps.
+static std::vector<Entry> generate(size_t count)
+{
+	std::vector<Entry> result;
+	Entry e;
+	e.time = EmuTime::fromUint64(1000);
+	e.pc = 0x4000;
+	for (size_t i = 0; i < count; ++i) {
+		if (i != 0) {
+			e.time = EmuTime::fromUint64(e.time.toUint64() + 1 + (i % 11) * (i % 13) * 1000);
+			e.pc = (i % 7 == 0) ? uint16_t(i * 0x1234) : uint16_t(e.pc + e.length);
+		}
+		if (i % 3 == 0) {
+			e.regs[InstructionHistory::AF] = uint16_t(i);
+			e.regs[InstructionHistory::SP] = uint16_t(0xF000 - i);
+		}
+		if (i % 5 == 0) {
+			e.regs[InstructionHistory::HL2] = uint16_t(i * 3);
+			e.regs[InstructionHistory::MISC] = uint16_t(i & 0x3f);
+		}
+		e.length = uint8_t(1 + (i % 4));
+		e.opcode = {};
+		for (unsigned j = 0; j < e.length; ++j) e.opcode[j] = uint8_t(i + j);
+		result.push_back(e);
+	}
+	// a very long time step (varint of more than 4 bytes)
+	if (count > 10) {
+		result[10].time = EmuTime::fromUint64(result[9].time.toUint64() + (uint64_t(1) << 40));
+		for (size_t i = 11; i < count; ++i) {
+			result[i].time = EmuTime::fromUint64(result[i].time.toUint64() + (uint64_t(1) << 40));
+		}
+	}
+	return result;
+}
+
+static void record(Buffer& buffer, const Entry& e)
+{
+	if (buffer.isLastBlockFull()) buffer.beginBlock(e.time);
+	buffer.append(e);
+}
+
+static void checkEqual(const Entry& actual, const Entry& expected)
+{
+	CHECK(actual.time == expected.time);
+	CHECK(actual.pc == expected.pc);
+	CHECK(actual.length == expected.length);
+	CHECK(actual.opcode == expected.opcode);
+	CHECK(actual.regs == expected.regs);
+}
+
+static void checkContents(const Buffer& buffer, std::span<const Entry> expected)
+{
+	REQUIRE(buffer.size() == expected.size());
+	size_t i = 0;
+	buffer.forEach([&](const Entry& e) {
+		INFO("instruction " << i);
+		REQUIRE(i < expected.size());
+		checkEqual(e, expected[i]);
+		++i;
+	});
+	CHECK(i == expected.size());
+}
+
+TEST_CASE("InstructionHistory: record and decode")
+{
+	static constexpr auto N = 2 * InstructionHistory::BLOCK_SIZE + 100;
+	auto entries = generate(N);
+	Buffer buffer;
+	for (const auto& e : entries) record(buffer, e);
+
+	const auto& blocks = buffer.getBlocks();
+	REQUIRE(blocks.size() == 3);
+	CHECK(blocks[0].count == InstructionHistory::BLOCK_SIZE);
+	CHECK(blocks[2].count == 100);
+	checkContents(buffer, entries);
+
+	// the first instruction of a block can be decoded on its own
+	InstructionHistory::Decoder decoder(blocks[1].data);
+	checkEqual(decoder.next(), entries[InstructionHistory::BLOCK_SIZE]);
+
+	// corrupt data
+	auto data = blocks[2].data;
+	data.resize(data.size() - 1);
+	InstructionHistory::Decoder corrupt(data);
+	CHECK_THROWS([&]{ while (!corrupt.atEnd()) (void)corrupt.next(); }());
+
+	auto last = buffer.getLast(150);
+	REQUIRE(last.size() == 150);
+	for (size_t i = 0; i < last.size(); ++i) {
+		checkEqual(last[i], entries[N - 150 + i]);
+	}
+	CHECK(buffer.getLast(N + 10).size() == N);
+}
+
+TEST_CASE("InstructionHistory: depth")
+{
+	static constexpr auto B = InstructionHistory::BLOCK_SIZE;
+	auto entries = generate(3 * B + 1);
+	Buffer buffer;
+	buffer.setDepth(B + 10);
+	for (const auto& e : entries) record(buffer, e);
+	// the first block was dropped, the second one is still needed
+	REQUIRE(buffer.size() == 2 * B + 1);
+	checkContents(buffer, std::span(entries).subspan(B));
+}
+
+TEST_CASE("InstructionHistory: truncate")
+{
+	static constexpr auto B = InstructionHistory::BLOCK_SIZE;
+	auto entries = generate(2 * B + 100);
+	Buffer buffer;
+	for (const auto& e : entries) record(buffer, e);
+
+	SECTION("in the last block") {
+		buffer.truncate(entries[2 * B + 50].time);
+		checkContents(buffer, std::span(entries).first(2 * B + 50));
+	}
+	SECTION("at the start of a block") {
+		buffer.truncate(entries[B].time);
+		CHECK(buffer.getBlocks().size() == 1);
+		checkContents(buffer, std::span(entries).first(B));
+	}
+	SECTION("in an earlier block, then continue recording") {
+		buffer.truncate(entries[B / 2].time);
+		REQUIRE(buffer.getBlocks().size() == 1);
+		checkContents(buffer, std::span(entries).first(B / 2));
+		// continue in the same block, with different instructions
+		auto more = generate(B);
+		std::vector<Entry> expected(entries.begin(), entries.begin() + B / 2);
+		for (auto e : more) {
+			e.time = EmuTime::fromUint64(e.time.toUint64() + entries[B / 2].time.toUint64());
+			record(buffer, e);
+			expected.push_back(e);
+		}
+		CHECK(buffer.getBlocks().size() == 2);
+		checkContents(buffer, expected);
+	}
+	SECTION("everything") {
+		buffer.truncate(entries[0].time);
+		CHECK(buffer.size() == 0);
+		CHECK(buffer.getBlocks().empty());
+	}
+	SECTION("nothing") {
+		buffer.truncate(EmuTime::infinity());
+		checkContents(buffer, entries);
+	}
+}
@@ -20,7 +20,7 @@ void MemoryBufferFile::write(std::span<const uint8_t> /*src*/)
 	throw FileException("Writing to MemoryBufferFile not supported");
 }
 
-MappedFileImpl MemoryBufferFile::mmap(size_t extra, bool is_const)
+MappedFileImpl MemoryBufferFile::mmap(size_t extra, bool is_const, bool /*populate*/)
 {
 	return {buffer, extra, is_const};
 }
@@ -15,7 +15,7 @@ public:
 
 	void read(std::span<uint8_t> dst) override;
 	void write(std::span<const uint8_t> src) override;
-	[[nodiscard]] MappedFileImpl mmap(size_t extra, bool is_const) override;
+	[[nodiscard]] MappedFileImpl mmap(size_t extra, bool is_const, bool populate) override;
 
 	[[nodiscard]] size_t getSize() override;
 	void seek(size_t newPos) override;
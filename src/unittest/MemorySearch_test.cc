@@ -0,0 +1,175 @@
+#include "catch.hpp"
+#include "MemorySearch.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace openmsx;
+using Op = MemorySearch::Op;
+
+static constexpr std::array allOps = {Op::EQ, Op::NE, Op::LT, Op::LE, Op::GT, Op::GE};
+
+[[nodiscard]] static bool reference(Op op, unsigned n, unsigned o)
+{
+	switch (op) {
+		case Op::EQ: return n == o;
+		case Op::NE: return n != o;
+		case Op::LT: return n <  o;
+		case Op::LE: return n <= o;
+		case Op::GT: return n >  o;
+		case Op::GE: return n >= o;
+	}
+	return false;
+}
+
+[[nodiscard]] static unsigned read(const std::vector<uint8_t>& data, unsigned bits, unsigned address)
+{
+	return (bits == 8) ? data[address] : (data[address] | (data[address + 1] << 8));
+}
+
+// Few different values, so that all comparisons are sometimes true.
+[[nodiscard]] static std::vector<uint8_t> randomData(std::mt19937& gen, size_t size)
+{
+	std::uniform_int_distribution<int> dist(0, 3);
+	std::vector<uint8_t> result(size);
+	for (auto& r : result) {
+		auto d = dist(gen);
+		r = (d == 3) ? uint8_t(gen()) : uint8_t(0x7f + d);
+	}
+	return result;
+}
+
+TEST_CASE("MemorySearch: filterCandidates")
+{
+	std::mt19937 gen(1234);
+	for (unsigned size : {1000u, 64u * 5 + 1, 63u}) {
+		auto paddedSize = (size + 63) & ~63u;
+		for (unsigned bits : {8u, 16u}) {
+			unsigned numLocations = (bits == 8) ? size : (size - 1);
+			auto oldData = randomData(gen, size);
+			auto newData = randomData(gen, size);
+			oldData.resize(paddedSize, 0);
+			newData.resize(paddedSize, 0);
+
+			std::vector<uint64_t> initial(paddedSize / 64);
+			for (auto& c : initial) c = uint64_t(gen()) << 32 | gen();
+			for (unsigned a = numLocations; a < paddedSize; ++a) {
+				initial[a / 64] &= ~(uint64_t(1) << (a % 64));
+			}
+
+			for (auto op : allOps) {
+				for (std::optional<unsigned> value : {std::optional<unsigned>{},
+				                                      std::optional<unsigned>{0x7f},
+				                                      std::optional<unsigned>{0x8080}}) {
+					if (value && (*value >= (1u << bits))) continue;
+					INFO("size " << size << ", bits " << bits << ", op " << int(op) <<
+					     ", value " << (value ? int(*value) : -1));
+					auto candidates = initial;
+					filterCandidates(op, bits, candidates, newData.data(), oldData.data(), value);
+					for (unsigned a = 0; a < paddedSize; ++a) {
+						bool before = (initial[a / 64] >> (a % 64)) & 1;
+						bool after = (candidates[a / 64] >> (a % 64)) & 1;
+						bool expected = before &&
+							reference(op, read(newData, bits, a),
+							          value ? *value : read(oldData, bits, a));
+						if (after != expected) {
+							INFO("address " << a);
+							CHECK(after == expected);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("MemorySearch: State")
+{
+	static constexpr unsigned SIZE = 1000; // not a multiple of 64
+	std::vector<uint8_t> data(SIZE);
+	for (unsigned i = 0; i < SIZE; ++i) data[i] = uint8_t(i);
+	auto update = [&](MemorySearch::State& state) {
+		state.update([&](std::span<uint8_t> output) {
+			REQUIRE(output.size() == SIZE);
+			std::ranges::copy(data, output.begin());
+		});
+	};
+
+	SECTION("8-bit") {
+		MemorySearch::State state;
+		CHECK(!state.isActive());
+		state.start(data, 8);
+		CHECK(state.isActive());
+		CHECK(state.count() == SIZE); // tail of the last word is not a candidate
+		auto results = state.getResults();
+		REQUIRE(results.size() == SIZE);
+		CHECK(results.back().address == SIZE - 1);
+
+		data[10] = 99;
+		data[SIZE - 1] = 0;
+		update(state);
+		state.filter(Op::NE, {});
+		results = state.getResults();
+		REQUIRE(results.size() == 2);
+		CHECK(results[0].address == 10);
+		CHECK(results[0].oldValue == 10);
+		CHECK(results[0].newValue == 99);
+		CHECK(results[1].address == SIZE - 1);
+		CHECK(results[1].oldValue == (SIZE - 1) % 256);
+		CHECK(results[1].newValue == 0);
+
+		// no change, compare with a value
+		update(state);
+		state.filter(Op::LT, 50);
+		results = state.getResults();
+		REQUIRE(results.size() == 1);
+		CHECK(results[0].address == SIZE - 1);
+
+		state.clear();
+		CHECK(!state.isActive());
+		CHECK(state.count() == 0);
+	}
+	SECTION("16-bit") {
+		MemorySearch::State state;
+		state.start(data, 16);
+		CHECK(state.count() == SIZE - 1);
+		auto results = state.getResults();
+		REQUIRE(results.size() == SIZE - 1);
+		CHECK(results.back().address == SIZE - 2);
+		CHECK(results.back().newValue == ((SIZE - 1) % 256) * 256 + (SIZE - 2) % 256);
+
+		// changing the last byte changes the last location
+		data[SIZE - 1] = 0x12;
+		update(state);
+		state.filter(Op::NE, {});
+		results = state.getResults();
+		REQUIRE(results.size() == 1);
+		CHECK(results[0].address == SIZE - 2);
+		CHECK(results[0].newValue == 0x1200 + (SIZE - 2) % 256);
+
+		update(state);
+		state.filter(Op::EQ, 0x1200 + (SIZE - 2) % 256);
+		CHECK(state.count() == 1);
+	}
+	SECTION("retain") {
+		MemorySearch::State state;
+		state.start(data, 8);
+		std::vector<unsigned> addresses = {5, 64, 500, SIZE - 1, SIZE, 100'000};
+		state.retain(addresses);
+		auto results = state.getResults();
+		REQUIRE(results.size() == 4);
+		CHECK(results[0].address == 5);
+		CHECK(results[1].address == 64);
+		CHECK(results[2].address == 500);
+		CHECK(results[3].address == SIZE - 1);
+
+		state.retain(std::vector<unsigned>{64, 65, 500});
+		CHECK(state.count() == 2);
+		CHECK(state.getResults(1).size() == 1);
+		CHECK(state.getResults(0).empty());
+	}
+}
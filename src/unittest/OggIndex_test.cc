@@ -0,0 +1,126 @@
+#include "catch.hpp"
+#include "OggIndex.hh"
+
+#include "File.hh"
+#include "FileOperations.hh"
+
+#include <cstdint>
+#include <vector>
+
+using namespace openmsx;
+
+// Video pages with 10 frames and a key frame every 30 frames, each followed
+// by an audio page with 14700 samples (about 10 frames at 44.1kHz).
+static OggIndex generateIndex()
+{
+	OggIndex index;
+	size_t offset = 100;
+	size_t sample = 0;
+	for (size_t frame = 10; frame <= 300; frame += 10) {
+		index.addVideoPage(offset, frame, (frame - 1) / 30 * 30 + 1);
+		offset += 1000;
+		sample += 14700;
+		index.addAudioPage(offset, sample);
+		offset += 500;
+	}
+	return index;
+}
+
+static void checkSeekPoint(const OggIndex& index, size_t frame, size_t sample,
+                           size_t offset, size_t keyFrame)
+{
+	auto p = index.find(frame, sample);
+	CHECK(p.offset == offset);
+	CHECK(p.keyFrame == keyFrame);
+}
+
+TEST_CASE("OggIndex: find")
+{
+	auto index = generateIndex();
+	REQUIRE(!index.empty());
+	CHECK(index.getTotalFrames() == 300);
+
+	// start of the file
+	checkSeekPoint(index, 1, 0, 0, 1);
+	checkSeekPoint(index, 5, 14700, 0, 1);
+	// Frame 45 ends on the page with frames 41-50 (at offset 6100) and
+	// depends on key frame 31. That key frame can start right after the
+	// page with frame 30 (at 3100). Sample 58800 ends on the audio page at
+	// 5600, two audio pages before that is at 2600.
+	checkSeekPoint(index, 45, 58800, 2600, 31);
+	// now the video determines the offset
+	checkSeekPoint(index, 45, 88200, 3100, 31);
+	// beyond the end: seek to the last key frame
+	checkSeekPoint(index, 1000, 1'000'000'000, 39100, 271);
+}
+
+TEST_CASE("OggIndex: key frame after the requested frame")
+{
+	// The page with frames 21-30 also contains key frame 25. For frame 22
+	// the key frame of the previous page must be used.
+	OggIndex index;
+	index.addVideoPage(100, 10, 1);
+	index.addVideoPage(200, 20, 11);
+	index.addVideoPage(300, 30, 25);
+	index.addAudioPage(150, 1000);
+	index.addAudioPage(250, 2000);
+	index.addAudioPage(350, 3000);
+
+	checkSeekPoint(index, 22, 3000, 100, 11);
+	checkSeekPoint(index, 26, 3000, 150, 25);
+}
+
+TEST_CASE("OggIndex: invalid pages are ignored")
+{
+	OggIndex index;
+	CHECK(index.empty());
+	index.addVideoPage(100, 10, 1);
+	index.addVideoPage(100, 20, 1); // same offset
+	index.addVideoPage(200, 10, 1); // same frame
+	index.addVideoPage(300, 20, 25); // key frame after frame
+	CHECK(index.empty()); // no audio yet
+	index.addAudioPage(150, 1000);
+	index.addAudioPage(250, 1000); // same sample
+	REQUIRE(!index.empty());
+	CHECK(index.getTotalFrames() == 10);
+	checkSeekPoint(index, 20, 5000, 0, 1);
+}
+
+TEST_CASE("OggIndex: save/load")
+{
+	auto index = generateIndex();
+	auto filename = FileOperations::getTempDir() + "/oggindex_unittest.idx";
+	FileOperations::FileStamp stamp{.size = 45100, .modificationDate = 42};
+	index.save(filename, stamp);
+
+	auto loaded = OggIndex::load(filename, stamp);
+	REQUIRE(loaded);
+	CHECK(loaded->getTotalFrames() == 300);
+	for (size_t frame = 1; frame <= 310; frame += 3) {
+		auto sample = frame * 1470;
+		auto expected = index.find(frame, sample);
+		auto actual = loaded->find(frame, sample);
+		CHECK(actual.offset == expected.offset);
+		CHECK(actual.keyFrame == expected.keyFrame);
+	}
+
+	// different file
+	CHECK(!OggIndex::load(filename, {.size = stamp.size, .modificationDate = 43}));
+	CHECK(!OggIndex::load(filename, {.size = stamp.size + 1, .modificationDate = 42}));
+
+	// truncated index file
+	std::vector<uint8_t> data;
+	{
+		File file(filename);
+		auto buf = file.mmap<const uint8_t>();
+		data.assign(buf.begin(), buf.end() - 1);
+	}
+	{
+		File file(filename, File::OpenMode::TRUNCATE);
+		file.write(data);
+	}
+	CHECK(!OggIndex::load(filename, stamp));
+
+	FileOperations::unlink(filename);
+	CHECK(!OggIndex::load(filename, stamp)); // doesn't exist
+}
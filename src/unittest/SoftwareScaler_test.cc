@@ -0,0 +1,113 @@
+#include "catch.hpp"
+#include "SoftwareScaler.hh"
+
+#include "RawFrame.hh"
+#include "xrange.hh"
+
+#include <cstdint>
+
+using namespace openmsx;
+using Pixel = SoftwareScaler::Pixel;
+
+static void fillFrame(RawFrame& frame, unsigned seed)
+{
+	uint32_t x = seed;
+	for (auto y : xrange(frame.getHeight())) {
+		auto line = frame.getLineDirect(y).first(320);
+		for (auto& p : line) {
+			x = x * 1103515245 + 12345;
+			// few different colors, so that Scale2x finds edges
+			p = 0xFF000000 | (((x >> 16) & 3) * 0x00405060);
+		}
+		frame.setLineWidth(y, 320);
+	}
+}
+
+static bool equalFrames(const RawFrame& f1, const RawFrame& f2, unsigned width)
+{
+	for (auto y : xrange(f1.getHeight())) {
+		auto l1 = f1.getLineDirect(y).first(width);
+		auto l2 = f2.getLineDirect(y).first(width);
+		if (!std::equal(l1.begin(), l1.end(), l2.begin())) return false;
+	}
+	return true;
+}
+
+TEST_CASE("SoftwareScaler: threads don't change the result")
+{
+	RawFrame src(320, 240);
+	fillFrame(src, 1);
+
+	SoftwareScaler::Params params;
+	params.blur = 100;
+	params.scanline = 128;
+	SoftwareScaler serial(0);
+	SoftwareScaler parallel(3);
+	for (auto algo : {RenderSettings::ScaleAlgorithm::SIMPLE,
+	                  RenderSettings::ScaleAlgorithm::SCALE,
+	                  RenderSettings::ScaleAlgorithm::RGBTRIPLET,
+	                  RenderSettings::ScaleAlgorithm::TV}) {
+		params.algorithm = algo;
+		for (unsigned factor : {1, 2, 3, 4}) {
+			RawFrame dst1(320 * factor, 240 * factor);
+			RawFrame dst2(320 * factor, 240 * factor);
+			serial  .scaleImage(src, dst1, params);
+			parallel.scaleImage(src, dst2, params);
+			CHECK(equalFrames(dst1, dst2, 320 * factor));
+		}
+	}
+}
+
+TEST_CASE("SoftwareScaler: simple without effects doubles pixels")
+{
+	RawFrame src(320, 240);
+	fillFrame(src, 2);
+	RawFrame dst(640, 480);
+	SoftwareScaler scaler(0);
+	scaler.scaleImage(src, dst, SoftwareScaler::Params{});
+	for (auto y : xrange(480u)) {
+		CHECK(dst.getLineWidthDirect(y) == 640);
+		auto s = src.getLineDirect(y / 2);
+		auto d = dst.getLineDirect(y);
+		for (auto x : xrange(640u)) {
+			CHECK(d[x] == s[x / 2]);
+		}
+	}
+}
+
+TEST_CASE("SoftwareScaler: scanlines keep alpha")
+{
+	RawFrame src(320, 240);
+	for (auto y : xrange(240u)) {
+		src.setBlank(y, 0xFFC08040);
+	}
+	RawFrame dst(640, 480);
+	SoftwareScaler::Params params;
+	params.scanline = 127; // -> factor 128/256
+	SoftwareScaler scaler(0);
+	scaler.scaleImage(src, dst, params);
+	for (auto x : xrange(640u)) {
+		CHECK(dst.getLineDirect(0)[x] == 0xFFC08040);
+		CHECK(dst.getLineDirect(1)[x] == 0xFF604020);
+	}
+}
+
+TEST_CASE("SoftwareScaler: uniform frame stays uniform with Scale2x")
+{
+	RawFrame src(320, 240);
+	for (auto y : xrange(240u)) {
+		src.setBlank(y, 0xFF123456);
+	}
+	SoftwareScaler::Params params;
+	params.algorithm = RenderSettings::ScaleAlgorithm::SCALE;
+	SoftwareScaler scaler(2);
+	for (unsigned factor : {2, 3}) {
+		RawFrame dst(320 * factor, 240 * factor);
+		scaler.scaleImage(src, dst, params);
+		for (auto y : xrange(240 * factor)) {
+			for (auto p : dst.getLineDirect(y).first(320 * factor)) {
+				CHECK(p == 0xFF123456);
+			}
+		}
+	}
+}
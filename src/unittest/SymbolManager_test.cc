@@ -1,6 +1,21 @@
 #include "catch.hpp"
 #include "SymbolManager.hh"
 
+#include "CommandController.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "Interpreter.hh"
+
+#include "stl.hh"
+#include "strCat.hh"
+#include "unreachable.hh"
+
+#include <algorithm>
+#include <bit>
+#include <ranges>
+#include <string>
+#include <vector>
+
 using namespace openmsx;
 
 TEST_CASE("SymbolManager: isHexDigit")
@@ -331,3 +346,158 @@ TEST_CASE("SymbolManager: loadLinkMap")
 	CHECK(file.symbols[5].name == "last");
 	CHECK(file.symbols[5].value == 0x8765);
 }
+
+TEST_CASE("SymbolManager: symbol cache")
+{
+	std::string_view buffer =
+		"DEF label1 0x10000\n"
+		"DEF label2 0x2345\n"
+		"DEF another 0x3456789a\n";
+	auto file = SymbolManager::loadNoICE("test.noi", buffer);
+	FileOperations::FileStamp stamp{.size = buffer.size(), .modificationDate = 1234};
+	auto type = SymbolFile::Type::AUTO_DETECT;
+	auto data = SymbolManager::serializeCache(file, stamp, type);
+
+	auto cached = SymbolManager::deserializeCache(data, stamp, type, "test.noi");
+	REQUIRE(cached);
+	CHECK(cached->filename == "test.noi");
+	CHECK(cached->type == SymbolFile::Type::NOICE);
+	CHECK(cached->hasSegmentInfo == file.hasSegmentInfo);
+	CHECK(cached->symbols == file.symbols);
+
+	// the file was modified
+	CHECK(!SymbolManager::deserializeCache(data, {.size = stamp.size, .modificationDate = 4321}, type, "test.noi"));
+	CHECK(!SymbolManager::deserializeCache(data, {.size = stamp.size + 1, .modificationDate = 1234}, type, "test.noi"));
+	// a different type was requested
+	CHECK(!SymbolManager::deserializeCache(data, stamp, SymbolFile::Type::NOICE, "test.noi"));
+	// truncated cache file
+	CHECK(!SymbolManager::deserializeCache(std::span{data}.first(data.size() - 1), stamp, type, "test.noi"));
+}
+
+namespace {
+
+// Only the interpreter is used by SymbolManager.
+struct TestCommandController final : CommandController
+{
+	void   registerCompleter(CommandCompleter&, std::string_view) override {}
+	void unregisterCompleter(CommandCompleter&, std::string_view) override {}
+	void   registerCommand(Command&, zstring_view) override {}
+	void unregisterCommand(Command&, std::string_view) override {}
+	TclObject executeCommand(zstring_view command, CliConnection*) override {
+		return interp.execute(command);
+	}
+	void   registerSetting(Setting&) override {}
+	void unregisterSetting(Setting&) override {}
+	CliComm& getCliComm() override { UNREACHABLE; }
+	Interpreter& getInterpreter() override { return interp; }
+
+	Interpreter interp;
+};
+
+struct SymbolFiles
+{
+	~SymbolFiles() {
+		for (const auto& f : created) FileOperations::unlink(f);
+	}
+	void load(const std::string& name, std::string_view contents) {
+		auto filename = FileOperations::getTempDir() + "/symbolmanager_unittest_" + name + ".sym";
+		File file(filename, File::OpenMode::TRUNCATE);
+		file.write(std::span{std::bit_cast<const uint8_t*>(contents.data()), contents.size()});
+		file.close();
+		if (std::ranges::find(created, filename) == created.end()) created.push_back(filename);
+		REQUIRE(manager.reloadFile(filename, SymbolManager::LoadEmpty::ALLOWED,
+		                           SymbolFile::Type::GENERIC, {}, {}));
+	}
+	void remove(const std::string& name) {
+		manager.removeFile(FileOperations::getTempDir() + "/symbolmanager_unittest_" + name + ".sym");
+	}
+	[[nodiscard]] std::string sym(std::string_view name) {
+		return std::string(controller.interp.execute(
+			strCat("if {[info exists ::sym(", name, ")]} {set ::sym(", name, ")} else {set x -}")).getString());
+	}
+
+	TestCommandController controller;
+	SymbolManager manager{controller};
+	std::vector<std::string> created;
+};
+
+[[nodiscard]] std::vector<std::string> names(std::span<Symbol const * const> symbols)
+{
+	return to_vector(std::views::transform(symbols, [](const Symbol* s) { return s->name; }));
+}
+
+// The index as it would be when all files were loaded in order.
+void checkIndex(const SymbolManager& manager)
+{
+	std::vector<const Symbol*> expected;
+	for (const auto& file : manager.getFiles()) {
+		for (const auto& sym : file.symbols) expected.push_back(&sym);
+	}
+	std::ranges::stable_sort(expected, {}, &Symbol::value);
+	auto actual = manager.lookupRange(0, 0x10000);
+	CHECK(std::ranges::equal(actual, expected));
+}
+
+} // namespace
+
+TEST_CASE("SymbolManager: index")
+{
+	SymbolFiles files;
+	auto& manager = files.manager;
+	files.load("a", "a1: equ 0x1000\n"
+	                "same: equ 0x2000\n"
+	                "a2: equ 0x2000\n"
+	                "a3: equ 0x3000\n");
+	files.load("b", "b1: equ 0x2000\n"
+	                "same: equ 0x2100\n"
+	                "b2: equ 0x1000\n");
+	files.load("c", "c1: equ 0x2000\n"
+	                "c2: equ 0x0100\n");
+	checkIndex(manager);
+	CHECK(names(manager.lookupValue(0x2000)) == std::vector<std::string>{"same", "a2", "b1", "c1"});
+	CHECK(names(manager.lookupRange(0x1000, 0x2100)) == std::vector<std::string>{"a1", "b2", "same", "a2", "b1", "c1"});
+	CHECK(names(manager.lookupNearest(0x20ff)) == std::vector<std::string>{"same", "a2", "b1", "c1"});
+	CHECK(names(manager.lookupNearest(0x00ff)).empty());
+	CHECK(files.sym("same") == "8448"); // from the last file: b
+	CHECK(files.sym("a3") == "12288");
+
+	SECTION("reload a file in the middle") {
+		files.load("b", "b1: equ 0x2000\n"
+		                "b3: equ 0x1000\n"
+		                "a3: equ 0x0001\n");
+		checkIndex(manager);
+		CHECK(names(manager.lookupValue(0x1000)) == std::vector<std::string>{"a1", "b3"});
+		CHECK(names(manager.lookupValue(0x2000)) == std::vector<std::string>{"same", "a2", "b1", "c1"});
+		CHECK(names(manager.lookupNearest(0x2fff)) == std::vector<std::string>{"same", "a2", "b1", "c1"});
+		CHECK(files.sym("same") == "8192"); // now only in a
+		CHECK(files.sym("b2") == "-");
+		CHECK(files.sym("a3") == "1");
+
+		// reload the first file, it does not override b
+		files.load("a", "a1: equ 0x2000\n"
+		                "a3: equ 0x3000\n"
+		                "c1: equ 0x4000\n");
+		checkIndex(manager);
+		CHECK(names(manager.lookupValue(0x2000)) == std::vector<std::string>{"a1", "b1", "c1"});
+		CHECK(files.sym("a3") == "1");
+		CHECK(files.sym("c1") == "8192");
+		CHECK(files.sym("same") == "-");
+	}
+	SECTION("remove files") {
+		files.remove("b");
+		checkIndex(manager);
+		CHECK(names(manager.lookupRange(0, 0x10000)) == std::vector<std::string>{"c2", "a1", "same", "a2", "c1", "a3"});
+		CHECK(files.sym("same") == "8192"); // restored from a
+		CHECK(files.sym("b1") == "-");
+
+		files.remove("a");
+		checkIndex(manager);
+		CHECK(names(manager.lookupNearest(0xffff)) == std::vector<std::string>{"c1"});
+		CHECK(files.sym("same") == "-");
+
+		files.remove("c");
+		CHECK(manager.lookupRange(0, 0x10000).empty());
+		CHECK(manager.lookupNearest(0xffff).empty());
+		CHECK(files.sym("c1") == "-");
+	}
+}
@@ -0,0 +1,140 @@
+#include "catch.hpp"
+#include "lz4.hh"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+[[nodiscard]] static std::vector<uint8_t> generate(size_t size, int kind)
+{
+	std::vector<uint8_t> result(size);
+	uint32_t x = 12345;
+	for (size_t i = 0; i < size; ++i) {
+		x = x * 1103515245 + 12345;
+		switch (kind) {
+			case 0: result[i] = 0; break;                        // very compressible
+			case 1: result[i] = uint8_t((i % 37) + (i / 1000)); break; // repeating
+			case 2: result[i] = uint8_t(x >> 24); break;         // random
+			default: result[i] = uint8_t((x >> 28) * (i & 1)); break; // mix
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] static std::vector<uint8_t> compress(const std::vector<uint8_t>& data)
+{
+	std::vector<uint8_t> result(LZ4::compressBound(int(data.size())));
+	auto size = LZ4::compress(data.data(), result.data(), int(data.size()));
+	result.resize(size);
+	return result;
+}
+
+[[nodiscard]] static bool isValid(const std::vector<uint8_t>& block, int dstSize)
+{
+	return LZ4::isValid(block.data(), int(block.size()), dstSize);
+}
+
+TEST_CASE("lz4: isValid() on compressed data")
+{
+	for (size_t size : {0, 1, 12, 13, 100, 4096, 100'000}) {
+		for (int kind : {0, 1, 2, 3}) {
+			INFO("size " << size << ", kind " << kind);
+			auto data = generate(size, kind);
+			auto block = compress(data);
+			REQUIRE(isValid(block, int(size)));
+
+			std::vector<uint8_t> out(size);
+			LZ4::decompress(block.data(), out.data(), int(block.size()), int(size));
+			CHECK(out == data);
+
+			// wrong size
+			CHECK(!isValid(block, int(size) + 1));
+			if (size != 0) CHECK(!isValid(block, int(size) - 1));
+			CHECK(!isValid(block, -1));
+		}
+	}
+}
+
+TEST_CASE("lz4: isValid() on truncated data")
+{
+	auto data = generate(1000, 3);
+	auto block = compress(data);
+	REQUIRE(isValid(block, 1000));
+	for (size_t len = 0; len < block.size(); ++len) {
+		INFO("length " << len);
+		CHECK(!LZ4::isValid(block.data(), int(len), 1000));
+	}
+}
+
+TEST_CASE("lz4: isValid() on hand-made blocks")
+{
+	// 12 literals, a match of 4 bytes, 12 literals: 28 bytes. (The last
+	// match must start at least 12 bytes before the end, the last 5 bytes
+	// must be literals.)
+	auto makeBlock = [](uint8_t offset, uint8_t matchToken = 0) {
+		std::vector<uint8_t> result;
+		result.push_back(uint8_t(0xC0 | matchToken));
+		for (auto c : std::string_view("abcdefghijkl")) result.push_back(uint8_t(c));
+		result.push_back(offset);
+		result.push_back(0);
+		result.push_back(0xC0);
+		for (auto c : std::string_view("mnopqrstuvwx")) result.push_back(uint8_t(c));
+		return result;
+	};
+
+	SECTION("valid") {
+		for (uint8_t offset : {1, 4, 12}) {
+			INFO("offset " << int(offset));
+			auto block = makeBlock(offset);
+			REQUIRE(isValid(block, 28));
+			std::vector<uint8_t> out(28);
+			LZ4::decompress(block.data(), out.data(), int(block.size()), 28);
+			std::string_view expected = "abcdefghijkl";
+			for (int i = 0; i < 4; ++i) {
+				CHECK(out[12 + i] == uint8_t(expected[12 - offset + (i % offset)]));
+			}
+			CHECK(std::string_view(reinterpret_cast<const char*>(&out[16]), 12) == "mnopqrstuvwx");
+		}
+	}
+	SECTION("offset zero") {
+		CHECK(!isValid(makeBlock(0), 28));
+	}
+	SECTION("offset before the start of the output") {
+		CHECK(!isValid(makeBlock(13), 28));
+		CHECK(!isValid(makeBlock(255), 28));
+	}
+	SECTION("match overruns the output") {
+		// match of 4 + 8 bytes
+		CHECK(!isValid(makeBlock(1, 8), 28));
+		CHECK(isValid(makeBlock(1, 8), 28 + 8));
+		// extended match length (15 + 255 + 10 + 4)
+		auto block = makeBlock(1, 15);
+		block.insert(block.begin() + 15, {255, 10});
+		CHECK(!isValid(block, 28));
+		CHECK(isValid(block, 28 + 15 + 255 + 10));
+		// extended length without end
+		block.resize(16);
+		CHECK(!isValid(block, 28 + 15 + 255 + 10));
+	}
+	SECTION("literals overrun the output or the input") {
+		auto block = makeBlock(1);
+		block[0] = 0xF0; // 15 + 200 literals, but only 27 bytes follow
+		block.insert(block.begin() + 1, 200);
+		CHECK(!isValid(block, 28));
+		CHECK(!isValid(block, 1000));
+		// the last literals are longer than the output
+		std::vector<uint8_t> last = {0x50, 'a', 'b', 'c', 'd', 'e'};
+		CHECK(isValid(last, 5));
+		CHECK(!isValid(last, 4));
+		CHECK(!isValid(last, 6));
+	}
+	SECTION("missing offset") {
+		auto block = makeBlock(1);
+		block.resize(14);
+		CHECK(!isValid(block, 28));
+	}
+	SECTION("empty input") {
+		std::vector<uint8_t> empty;
+		CHECK(!LZ4::isValid(empty.data(), 0, 0));
+	}
+}
@@ -690,4 +690,54 @@ safe_match_copy:
 	return int(op - dst); // Nb of output bytes decoded
 }
 
+bool isValid(const uint8_t* src, int compressedSize, int dstSize)
+{
+	// Same parsing as decompress(), but with all the checks from the
+	// original 'safe' decoder, and without producing output.
+	if ((compressedSize <= 0) || (dstSize < 0)) return false;
+	size_t ip = 0;
+	const auto iend = size_t(compressedSize);
+	size_t op = 0;
+	const auto oend = size_t(dstSize);
+
+	auto readLength = [&](size_t& length) {
+		while (true) {
+			if (ip >= iend) return false;
+			auto s = src[ip++];
+			length += s;
+			if (length > oend) return false; // also avoids overflow
+			if (s != 255) return true;
+		}
+	};
+
+	while (true) {
+		if (ip >= iend) return false;
+		unsigned token = src[ip++];
+
+		// literals
+		size_t length = token >> ML_BITS;
+		if ((length == RUN_MASK) && !readLength(length)) return false;
+		if ((length > (iend - ip)) || (length > (oend - op))) return false;
+		ip += length;
+		op += length;
+		if (ip == iend) {
+			// the last sequence has no match, and must fill the output
+			return op == oend;
+		}
+
+		// match
+		if ((iend - ip) < 2) return false;
+		size_t offset = Endian::read_UA_L16(&src[ip]);
+		ip += 2;
+		if ((offset == 0) || (offset > op)) return false;
+		length = token & ML_MASK;
+		if ((length == ML_MASK) && !readLength(length)) return false;
+		length += MINMATCH;
+		// see ../doc/lz4_Block_format.md#parsing-restrictions
+		if ((oend < size_t(MFLIMIT)) || (op > (oend - MFLIMIT))) return false;
+		if (length > (oend - LASTLITERALS - op)) return false;
+		op += length;
+	}
+}
+
 } // namespace LZ4
@@ -37,8 +37,9 @@
 //
 // The most important changes are:
 // - Stripped out all functions we don't use.
-// - Removed all safety checks. We only decompress data returned from the
-//   compress function, and that data is never stored/reloaded from disk.
+// - Removed all safety checks from the decompress function. It should only be
+//   used on data returned from the compress function. Data that was stored on
+//   (and reloaded from) disk must first be checked with isValid().
 // - Rewrite in C++ style.
 // - Use existing openMSX helper functions.
 
@@ -55,6 +56,12 @@ namespace LZ4 {
 
 	[[nodiscard]] int compress(const uint8_t* src, uint8_t* dst, int srcSize);
 	int decompress(const uint8_t* src, uint8_t* dst, int compressedSize, int dstCapacity);
+
+	/** Does 'src' contain a well-formed LZ4 block that decompresses to
+	  * exactly 'dstSize' bytes? Only then it's safe to pass it to
+	  * decompress().
+	  */
+	[[nodiscard]] bool isValid(const uint8_t* src, int compressedSize, int dstSize);
 }
 
 #endif
@@ -2,6 +2,8 @@
 
 #include "AviWriter.hh"
 #include "PostProcessor.hh"
+#include "RawFrame.hh"
+#include "SoftwareScaler.hh"
 
 #include "CliComm.hh"
 #include "CommandException.hh"
@@ -79,6 +81,10 @@ void AviRecorder::start(bool recordAudio, bool recordVideo, bool recordMono,
 				"Current renderer doesn't support video recording.");
 		}
 		// any source is fine because they all have the same bpp
+		if (scaled) {
+			scaler = std::make_unique<SoftwareScaler>();
+			scaledFrame = std::make_unique<RawFrame>(frameWidth, frameHeight);
+		}
 		warnedFps = false;
 		duration = EmuDuration::infinity();
 		prevTime = EmuTime::infinity();
@@ -116,6 +122,8 @@ void AviRecorder::stop()
 	sampleRate = 0;
 	aviWriter.reset();
 	wavWriter.reset();
+	scaler.reset();
+	scaledFrame.reset();
 }
 
 static int16_t float2int16(float f)
@@ -196,6 +204,13 @@ void AviRecorder::addImage(const FrameSource* frame, EmuTime time)
 	if (mixer) {
 		mixer->updateStream(time);
 	}
+	if (scaler) {
+		// Apply the scale algorithm, scanlines, blur, ... as they're
+		// currently shown on screen.
+		scaler->scaleImage(*frame, *scaledFrame, SoftwareScaler::getParams(
+			reactor.getDisplay().getRenderSettings()));
+		frame = scaledFrame.get();
+	}
 	aviWriter->addFrame(frame, audioBuf);
 	audioBuf.clear();
 }
@@ -215,6 +230,7 @@ void AviRecorder::processStart(Interpreter& interp, std::span<const TclObject> t
 	bool recordStereo = false;
 	bool doubleSize   = false;
 	bool tripleSize   = false;
+	bool scaledArg    = false;
 	std::array info = {
 		valueArg("-prefix", prefix),
 		flagArg("-audioonly", audioOnly),
@@ -223,6 +239,7 @@ void AviRecorder::processStart(Interpreter& interp, std::span<const TclObject> t
 		flagArg("-stereo",    recordStereo),
 		flagArg("-doublesize", doubleSize),
 		flagArg("-triplesize", tripleSize),
+		flagArg("-scaled",     scaledArg),
 	};
 	auto arguments = parseTclArgs(interp, tokens.subspan(2), info);
 
@@ -259,6 +276,7 @@ void AviRecorder::processStart(Interpreter& interp, std::span<const TclObject> t
 		frameWidth  *= 3;
 		frameHeight *= 3;
 	}
+	scaled = scaledArg;
 	bool recordAudio = !videoOnly;
 	bool recordVideo = !audioOnly;
 	std::string_view directory = recordVideo ? VIDEO_DIR : AUDIO_DIR;
@@ -334,9 +352,11 @@ std::string AviRecorder::Cmd::help(std::span<const TclObject> /*tokens*/) const
 	       "record status             Query recording state\n"
 	       "\n"
 	       "The start subcommand also accepts an optional -audioonly, -videoonly, "
-	       " -mono, -stereo, -doublesize, -triplesize flag.\n"
+	       " -mono, -stereo, -doublesize, -triplesize, -scaled flag.\n"
 	       "Videos are recorded in a 320x240 size by default, at 640x480 when the "
-	       "-doublesize flag is used and at 960x720 when the -triplesize flag is used.";
+	       "-doublesize flag is used and at 960x720 when the -triplesize flag is used.\n"
+	       "With the -scaled flag the current scale algorithm, scanline and blur "
+	       "settings are applied to the recorded video.";
 }
 
 void AviRecorder::Cmd::tabCompletion(std::vector<std::string>& tokens) const
@@ -350,7 +370,7 @@ void AviRecorder::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 	} else if ((tokens.size() >= 3) && (tokens[1] == "start")) {
 		static constexpr std::array options = {
 			"-prefix"sv, "-videoonly"sv, "-audioonly"sv,
-			"-doublesize"sv, "-triplesize"sv,
+			"-doublesize"sv, "-triplesize"sv, "-scaled"sv,
 			"-mono"sv, "-stereo"sv,
 		};
 		completeFileName(tokens, userFileContext(), options);
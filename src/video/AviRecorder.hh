@@ -19,7 +19,9 @@ class FrameSource;
 class Interpreter;
 class MSXMixer;
 class PostProcessor;
+class RawFrame;
 class Reactor;
+class SoftwareScaler;
 class TclObject;
 class Wav16Writer;
 
@@ -63,6 +65,8 @@ private:
 	std::vector<int16_t> audioBuf;
 	std::unique_ptr<AviWriter>   aviWriter; // can be nullptr
 	std::unique_ptr<Wav16Writer> wavWriter; // can be nullptr
+	std::unique_ptr<SoftwareScaler> scaler; // only for -scaled recordings
+	std::unique_ptr<RawFrame> scaledFrame;  // idem
 	std::vector<PostProcessor*> postProcessors;
 	MSXMixer* mixer = nullptr;
 	EmuDuration duration = EmuDuration::infinity();
@@ -70,6 +74,7 @@ private:
 	unsigned sampleRate;
 	unsigned frameWidth;
 	unsigned frameHeight = 0;
+	bool scaled = false;
 	bool warnedFps;
 	bool warnedSampleRate;
 	bool warnedStereo;
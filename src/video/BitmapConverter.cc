@@ -10,6 +10,10 @@
 #include <bit>
 #include <tuple>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace openmsx {
 
 BitmapConverter::BitmapConverter(
@@ -35,6 +39,14 @@ void BitmapConverter::calcDPalette()
 			dPalette[16 * i + j] = dp;
 		}
 	}
+	// Graphic5: 4 pixels per byte, alternating between the even and odd
+	// palette entries.
+	for (auto i : xrange(256)) {
+		qPalette[i] = {palette16[ 0 +  (i >> 6)     ],
+		               palette16[16 + ((i >> 4) & 3)],
+		               palette16[ 0 + ((i >> 2) & 3)],
+		               palette16[16 + ((i >> 0) & 3)]};
+	}
 }
 
 void BitmapConverter::convertLine(std::span<Pixel> buf, std::span<const uint8_t, 128> vramPtr)
@@ -144,15 +156,15 @@ void BitmapConverter::renderGraphic4(
 
 void BitmapConverter::renderGraphic5(
 	std::span<Pixel, 512> buf,
-	std::span<const uint8_t, 128> vramPtr0) const
+	std::span<const uint8_t, 128> vramPtr0)
 {
+	if (!dPaletteValid) [[unlikely]] {
+		calcDPalette();
+	}
 	Pixel* __restrict pixelPtr = buf.data();
 	for (auto i : xrange(128)) {
-		unsigned data = vramPtr0[i];
-		pixelPtr[4 * i + 0] = palette16[ 0 +  (data >> 6)     ];
-		pixelPtr[4 * i + 1] = palette16[16 + ((data >> 4) & 3)];
-		pixelPtr[4 * i + 2] = palette16[ 0 + ((data >> 2) & 3)];
-		pixelPtr[4 * i + 3] = palette16[16 + ((data >> 0) & 3)];
+		// 4 pixels per iteration, a single 16-byte copy
+		std::ranges::copy(qPalette[vramPtr0[i]], &pixelPtr[4 * i]);
 	}
 }
 
@@ -227,37 +239,79 @@ static constexpr std::tuple<int, int, int> yjk2rgb(int y, int j, int k)
 	return {r, g, b};
 }
 
-void BitmapConverter::renderYJK(
-	std::span<Pixel, 256> buf,
-	std::span<const uint8_t, 128> vramPtr0,
-	std::span<const uint8_t, 128> vramPtr1) const
+#ifdef __SSE2__
+// Same as yjk2rgb() and combining the result in a 15-bit palette index, for
+// 8 pixels in parallel.
+//   'y', 'j', 'k' are signed 16-bit values.
+// The division by 4 in yjk2rgb() rounds towards zero, the shift here rounds
+// down. That only makes a difference for negative values, and those are
+// clamped to 0 anyway.
+static inline __m128i yjk2index(__m128i y, __m128i j, __m128i k)
 {
-	Pixel* __restrict pixelPtr = buf.data();
-	for (auto i : xrange(64)) {
-		std::array<unsigned, 4> p = {
-			vramPtr0[2 * i + 0],
-			vramPtr1[2 * i + 0],
-			vramPtr0[2 * i + 1],
-			vramPtr1[2 * i + 1],
-		};
-		int j = narrow<int>((p[2] & 7) + ((p[3] & 3) << 3)) - narrow<int>((p[3] & 4) << 3);
-		int k = narrow<int>((p[0] & 7) + ((p[1] & 3) << 3)) - narrow<int>((p[1] & 4) << 3);
+	auto clamp = [](__m128i x) {
+		return _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(31));
+	};
+	__m128i r = clamp(_mm_add_epi16(y, j));
+	__m128i g = clamp(_mm_add_epi16(y, k));
+	__m128i y5 = _mm_add_epi16(_mm_slli_epi16(y, 2), y);
+	__m128i j2 = _mm_add_epi16(j, j);
+	__m128i bb = _mm_add_epi16(_mm_sub_epi16(_mm_sub_epi16(y5, j2), k), _mm_set1_epi16(2));
+	__m128i b = clamp(_mm_srai_epi16(bb, 2));
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 10), _mm_slli_epi16(g, 5)), b);
+}
 
-		for (auto n : xrange(4)) {
-			int y = narrow<int>(p[n] >> 3);
-			auto [r, g, b] = yjk2rgb(y, j, k);
-			int col = (r << 10) + (g << 5) + b;
-			pixelPtr[4 * i + n] = palette32768[col];
-		}
+// Calculate the indices for the 16 pixels in 8 bytes of both planes. These
+// bytes are zero-extended to 16 bits: even lanes contain the first byte of a
+// group of 4 pixels (with the low bits of 'k' in plane 0, or 'j' in plane 1),
+// odd lanes the second byte.
+static inline void yjkIndices8(__m128i p0, __m128i p1, bool yae, uint16_t* out)
+{
+	const __m128i seven = _mm_set1_epi16(7);
+	const __m128i sign = _mm_set1_epi16(32);
+	// 6-bit signed values, 'k' in the even lanes, 'j' in the odd lanes.
+	__m128i kj = _mm_or_si128(_mm_and_si128(p0, seven),
+	                          _mm_slli_epi16(_mm_and_si128(p1, seven), 3));
+	kj = _mm_sub_epi16(_mm_xor_si128(kj, sign), sign);
+	// Broadcast to both lanes of the group.
+	__m128i k = _mm_shufflehi_epi16(_mm_shufflelo_epi16(kj, 0xA0), 0xA0); // 2,2,0,0
+	__m128i j = _mm_shufflehi_epi16(_mm_shufflelo_epi16(kj, 0xF5), 0xF5); // 3,3,1,1
+
+	__m128i idx0 = yjk2index(_mm_srli_epi16(p0, 3), j, k);
+	__m128i idx1 = yjk2index(_mm_srli_epi16(p1, 3), j, k);
+	if (yae) {
+		const __m128i flagBit = _mm_set1_epi16(8);
+		auto select = [&](__m128i p, __m128i idx) {
+			__m128i isYae = _mm_cmpeq_epi16(_mm_and_si128(p, flagBit), flagBit);
+			__m128i yaeIdx = _mm_or_si128(_mm_srli_epi16(p, 4),
+			                              _mm_set1_epi16(narrow_cast<short>(BitmapConverter::YAE_FLAG)));
+			return _mm_or_si128(_mm_and_si128(isYae, yaeIdx), _mm_andnot_si128(isYae, idx));
+		};
+		idx0 = select(p0, idx0);
+		idx1 = select(p1, idx1);
 	}
+	// Pixel order within a group is: plane0, plane1, plane0, plane1.
+	auto* o = std::bit_cast<__m128i*>(out);
+	_mm_storeu_si128(o + 0, _mm_unpacklo_epi16(idx0, idx1));
+	_mm_storeu_si128(o + 1, _mm_unpackhi_epi16(idx0, idx1));
 }
+#endif
 
-void BitmapConverter::renderYAE(
-	std::span<Pixel, 256> buf,
+void BitmapConverter::calcYJKIndices(
+	std::span<uint16_t, 256> out,
 	std::span<const uint8_t, 128> vramPtr0,
-	std::span<const uint8_t, 128> vramPtr1) const
+	std::span<const uint8_t, 128> vramPtr1,
+	bool yae)
 {
-	Pixel* __restrict pixelPtr = buf.data();
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	for (size_t i = 0; i < 128; i += 16) {
+		// 32 pixels per iteration
+		__m128i v0 = _mm_loadu_si128(std::bit_cast<const __m128i*>(&vramPtr0[i]));
+		__m128i v1 = _mm_loadu_si128(std::bit_cast<const __m128i*>(&vramPtr1[i]));
+		yjkIndices8(_mm_unpacklo_epi8(v0, zero), _mm_unpacklo_epi8(v1, zero), yae, &out[2 * i +  0]);
+		yjkIndices8(_mm_unpackhi_epi8(v0, zero), _mm_unpackhi_epi8(v1, zero), yae, &out[2 * i + 16]);
+	}
+#else
 	for (auto i : xrange(64)) {
 		std::array<unsigned, 4> p = {
 			vramPtr0[2 * i + 0],
@@ -269,19 +323,44 @@ void BitmapConverter::renderYAE(
 		int k = narrow<int>((p[0] & 7) + ((p[1] & 3) << 3)) - narrow<int>((p[1] & 4) << 3);
 
 		for (auto n : xrange(4)) {
-			Pixel pix;
-			if (p[n] & 0x08) {
-				// YAE
-				pix = palette16[p[n] >> 4];
+			if (yae && (p[n] & 0x08)) {
+				out[4 * i + n] = uint16_t(YAE_FLAG | (p[n] >> 4));
 			} else {
-				// YJK
 				int y = narrow<int>(p[n] >> 3);
 				auto [r, g, b] = yjk2rgb(y, j, k);
-				pix = palette32768[(r << 10) + (g << 5) + b];
+				out[4 * i + n] = narrow<uint16_t>((r << 10) + (g << 5) + b);
 			}
-			pixelPtr[4 * i + n] = pix;
 		}
 	}
+#endif
+}
+
+void BitmapConverter::renderYJK(
+	std::span<Pixel, 256> buf,
+	std::span<const uint8_t, 128> vramPtr0,
+	std::span<const uint8_t, 128> vramPtr1) const
+{
+	std::array<uint16_t, 256> indices;
+	calcYJKIndices(indices, vramPtr0, vramPtr1, false);
+	Pixel* __restrict pixelPtr = buf.data();
+	for (auto i : xrange(256)) {
+		pixelPtr[i] = palette32768[indices[i]];
+	}
+}
+
+void BitmapConverter::renderYAE(
+	std::span<Pixel, 256> buf,
+	std::span<const uint8_t, 128> vramPtr0,
+	std::span<const uint8_t, 128> vramPtr1) const
+{
+	std::array<uint16_t, 256> indices;
+	calcYJKIndices(indices, vramPtr0, vramPtr1, true);
+	Pixel* __restrict pixelPtr = buf.data();
+	for (auto i : xrange(256)) {
+		auto idx = indices[i];
+		pixelPtr[i] = (idx & YAE_FLAG) ? palette16[idx & 15] // YAE
+		                               : palette32768[idx];  // YJK
+	}
 }
 
 void BitmapConverter::renderBogus(std::span<Pixel, 256> buf) const
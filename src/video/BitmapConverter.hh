@@ -86,7 +86,7 @@ private:
 	void renderGraphic4(std::span<Pixel, 256> buf,
 	                    std::span<const uint8_t, 128> vramPtr0);
 	void renderGraphic5(std::span<Pixel, 512> buf,
-	                    std::span<const uint8_t, 128> vramPtr0) const;
+	                    std::span<const uint8_t, 128> vramPtr0);
 	void renderGraphic6(std::span<Pixel, 512> buf,
 	                    std::span<const uint8_t, 128> vramPtr0,
 	                    std::span<const uint8_t, 128> vramPtr1);
@@ -101,12 +101,25 @@ private:
 	                    std::span<const uint8_t, 128> vramPtr1) const;
 	void renderBogus(   std::span<Pixel, 256> buf) const;
 
+public:
+	/** Calculate the index in the 32768-entry palette for each pixel of a
+	  * YJK line. In YAE mode, pixels with the A bit set instead get
+	  * value 'YAE_FLAG | <index in 16-entry palette>'.
+	  * Public for unittest.
+	  */
+	static constexpr uint16_t YAE_FLAG = 0x8000;
+	static void calcYJKIndices(std::span<uint16_t, 256> out,
+	                           std::span<const uint8_t, 128> vramPtr0,
+	                           std::span<const uint8_t, 128> vramPtr1,
+	                           bool yae);
+
 private:
 	std::span<const Pixel, 16 * 2> palette16;
 	std::span<const Pixel, 256>    palette256;
 	std::span<const Pixel, 32768>  palette32768;
 
 	std::array<DPixel, 16 * 16> dPalette;
+	std::array<std::array<Pixel, 4>, 256> qPalette; // for Graphic5
 	DisplayMode mode;
 	bool dPaletteValid = false;
 };
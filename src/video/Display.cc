@@ -337,6 +337,7 @@ void Display::repaintImpl()
 
 	cancelRT(); // cancel delayed repaint
 
+	auto start = Timer::getTime();
 	if (!renderFrozen) {
 		assert(videoSystem);
 		if (OutputSurface* surface = videoSystem->getOutputSurface()) {
@@ -347,6 +348,7 @@ void Display::repaintImpl()
 
 	// update fps statistics
 	auto now = Timer::getTime();
+	paintTime += now - start;
 	auto duration = now - prevTimeStamp;
 	prevTimeStamp = now;
 	frameDurationSum += duration - frameDurations.pop_back();
@@ -424,12 +426,14 @@ void Display::ScreenShotCmd::execute(std::span<const TclObject> tokens, TclObjec
 	bool rawShot = false;
 	bool doubleSize = false;
 	bool withOsd = false;
+	bool scaled = false;
 	std::string size;
 	std::array info = {
 		valueArg("-prefix", prefix),
 		flagArg("-raw", rawShot),
 		flagArg("-doublesize", doubleSize), // bwcompat, alias for -size 640
 		flagArg("-with-osd", withOsd),
+		flagArg("-scaled", scaled),
 		valueArg("-size", size)
 	};
 	auto arguments = parseTclArgs(getInterpreter(), tokens.subspan(1), info);
@@ -443,15 +447,23 @@ void Display::ScreenShotCmd::execute(std::span<const TclObject> tokens, TclObjec
 		throw CommandException("-with-osd cannot be used in "
 		                       "combination with -raw");
 	}
+	if (scaled && !rawShot) {
+		throw CommandException("-scaled option can only be used in "
+		                       "combination with -raw");
+	}
 	if (!size.empty()) {
 		if (!rawShot) {
 			throw CommandException("-size option can only be used in "
 			                       "combination with -raw");
 		}
-		static constexpr std::array<std::string_view, 3> validSizes = { "auto", "320", "640" };
+		static constexpr std::array<std::string_view, 4> validSizes = { "auto", "320", "640", "960" };
 		if (!contains(validSizes, size)) {
 			throw CommandException(strCat("-size option must specify one of: ", join(validSizes, ", ")));
 		}
+		if ((size == "960") && !scaled) {
+			throw CommandException("-size 960 can only be used in "
+			                       "combination with -scaled");
+		}
 		if (doubleSize) {
 			throw CommandException("Only specify either -size or -doublesize");
 		}
@@ -495,9 +507,12 @@ void Display::ScreenShotCmd::execute(std::span<const TclObject> tokens, TclObjec
 			throw CommandException(
 				"Current renderer doesn't support taking screenshots.");
 		}
-		std::optional<unsigned> height = size == "auto" ? std::nullopt : size == "640" ? std::optional(480) : std::optional(240);
+		std::optional<unsigned> height = size == "auto" ? std::nullopt
+		                               : size == "960" ? std::optional(720)
+		                               : size == "640" ? std::optional(480)
+		                                               : std::optional(240);
 		try {
-			videoLayer->takeRawScreenShot(height, filename);
+			videoLayer->takeRawScreenShot(height, filename, scaled);
 		} catch (MSXException& e) {
 			throw CommandException(
 				"Failed to take screenshot: ", e.getMessage());
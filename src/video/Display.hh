@@ -85,6 +85,11 @@ public:
 	// Get the latest fps value
 	[[nodiscard]] float getFps() const;
 
+	/** Total time (in us) spent painting frames, since this object was
+	  * created. Used by the automatic frameskip.
+	  */
+	[[nodiscard]] uint64_t getPaintTime() const { return paintTime; }
+
 private:
 	void resetVideoSystem();
 
@@ -116,6 +121,7 @@ private:
 	CircularBuffer<uint64_t, NUM_FRAME_DURATIONS> frameDurations;
 	uint64_t frameDurationSum;
 	uint64_t prevTimeStamp;
+	uint64_t paintTime = 0;
 
 	struct ScreenShotCmd final : Command {
 		explicit ScreenShotCmd(CommandController& commandController);
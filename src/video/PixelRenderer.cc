@@ -28,19 +28,28 @@ TODO:
 
 #include "narrow.hh"
 #include "one_of.hh"
+#include "ranges.hh"
+#include "stl.hh"
 #include "unreachable.hh"
+#include "xrange.hh"
 
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <system_error>
 
 namespace openmsx {
 
+// When the render thread is used, the already scanned lines are rendered in
+// the background as soon as there are (at least) this many of them.
+static constexpr int ASYNC_RENDER_LINES = 16;
+
 void PixelRenderer::draw(
-	int startX, int startY, int endX, int endY, DrawType drawType, bool atEnd)
+	int startX, int startY, int endX, int endY, DrawType drawType, bool atEnd,
+	bool fullLines)
 {
 	if (drawType == DRAW_BORDER) {
-		rasterizer->drawBorder(startX, startY, endX, endY);
+		drawCommands.push_back({DRAW_BORDER, startX, startY, endX, endY});
 	} else {
 		assert(drawType == DRAW_DISPLAY);
 
@@ -68,18 +77,75 @@ void PixelRenderer::draw(
 		assert(0 <= displayX);
 		assert(displayX + displayWidth <= 512);
 
-		rasterizer->drawDisplay(
-			startX, startY,
-			displayX - vdp.getHorizontalScrollLow() * 2, displayY,
-			displayWidth, displayHeight
-			);
-		if (vdp.spritesEnabled() && !renderSettings.getDisableSprites()) {
-			rasterizer->drawSprites(
-				startX, startY,
-				displayX / 2, displayY,
-				(displayWidth + 1) / 2, displayHeight);
+		drawDisplay(startX, startY, displayX, displayY,
+		            displayWidth, displayHeight, fullLines);
+	}
+}
+
+void PixelRenderer::drawDisplay(
+	int startX, int startY, int displayX, int displayY,
+	int displayWidth, int displayHeight, bool fullLines)
+{
+	bool sprites = vdp.spritesEnabled() && !renderSettings.getDisableSprites();
+	auto drawLines = [&](int fromY, int limitY) {
+		int fromDisplayY = (displayY + fromY - startY) & 255;
+		drawCommands.push_back({DRAW_DISPLAY,
+			startX, fromY,
+			displayX - vdp.getHorizontalScrollLow() * 2, fromDisplayY,
+			displayWidth, limitY - fromY});
+		if (sprites) {
+			drawCommands.push_back({DRAW_SPRITES,
+				startX, fromY,
+				displayX / 2, fromDisplayY,
+				(displayWidth + 1) / 2, limitY - fromY});
+		}
+	};
+
+	int endY = startY + displayHeight;
+	assert(endY <= int(lineStates.size()));
+	if (!fullLines) {
+		// Partially drawn lines are never reused.
+		for (auto y : xrange(startY, endY)) lineStates[y].drawn = 0;
+		drawLines(startY, endY);
+		return;
+	}
+
+	// In these modes consecutive frames show different VRAM pages.
+	bool reuse = !vdp.isInterlaced() && !vdp.isEvenOddEnabled() &&
+	             !vdp.isFastBlinkEnabled();
+	auto flush = [&](int fromY, int limitY, bool unchanged) {
+		if (unchanged) {
+			drawCommands.push_back({DRAW_COPY, 0, fromY, 0, limitY});
+			skippedLines += limitY - fromY;
+		} else {
+			drawLines(fromY, limitY);
 		}
+	};
+	int runStart = startY;
+	bool runUnchanged = false;
+	for (auto y : xrange(startY, endY)) {
+		auto lineDisplayY = uint8_t(displayY + y - startY);
+		bool lineSprites = sprites && !spriteChecker.getSprites(y).empty();
+		bool unchanged = reuse && isLineUnchanged(y, lineDisplayY, lineSprites);
+		lineStates[y] = {++changeCounter, renderedFrames, lineDisplayY, lineSprites};
+		if ((unchanged != runUnchanged) && (y != runStart)) {
+			flush(runStart, y, runUnchanged);
+			runStart = y;
+		}
+		runUnchanged = unchanged;
 	}
+	flush(runStart, endY, runUnchanged);
+}
+
+bool PixelRenderer::isLineUnchanged(int y, uint8_t displayY, bool sprites) const
+{
+	// Sprites are not tracked, so lines with sprites are always drawn.
+	const auto& state = lineStates[y];
+	return (state.drawn > allLinesChanged) &&
+	       (state.drawn > displayLineChanged[displayY]) &&
+	       (state.frame + 1 == renderedFrames) &&
+	       (state.displayY == displayY) &&
+	       !state.sprites && !sprites;
 }
 
 void PixelRenderer::subdivide(
@@ -91,7 +157,7 @@ void PixelRenderer::subdivide(
 		bool atEnd = (startY != endY) || (endX >= clipR);
 		if (startX < clipR) {
 			draw(startX, startY, (atEnd ? clipR : endX),
-			     startY + 1, drawType, atEnd);
+			     startY + 1, drawType, atEnd, false);
 		}
 		if (startY == endY) return;
 		startY++;
@@ -105,17 +171,18 @@ void PixelRenderer::subdivide(
 	}
 	// Full middle lines.
 	if (startY < endY) {
-		draw(clipL, startY, clipR, endY, drawType, true);
+		draw(clipL, startY, clipR, endY, drawType, true, true);
 	}
 	// Actually draw last line if necessary.
 	// The point of keeping top-to-bottom draw order is that it increases
 	// the locality of memory references, which generally improves cache
 	// hit rates.
-	if (drawLast) draw(clipL, endY, endX, endY + 1, drawType, false);
+	if (drawLast) draw(clipL, endY, endX, endY + 1, drawType, false, false);
 }
 
-PixelRenderer::PixelRenderer(VDP& vdp_, Display& display)
+PixelRenderer::PixelRenderer(VDP& vdp_, Display& display_)
 	: vdp(vdp_), vram(vdp.getVRAM())
+	, display(display_)
 	, eventDistributor(vdp.getReactor().getEventDistributor())
 	, realTime(vdp.getMotherBoard().getRealTime())
 	, speedManager(
@@ -135,10 +202,22 @@ PixelRenderer::PixelRenderer(VDP& vdp_, Display& display)
 
 	renderSettings.getMaxFrameSkipSetting().attach(*this);
 	renderSettings.getMinFrameSkipSetting().attach(*this);
+	renderSettings.getRenderThreadSetting().attach(*this);
+	renderSettings.getGammaSetting().attach(*this);
+	renderSettings.getBrightnessSetting().attach(*this);
+	renderSettings.getContrastSetting().attach(*this);
+	renderSettings.getColorMatrixSetting().attach(*this);
+	if (renderSettings.getRenderThread()) startRenderThread();
 }
 
 PixelRenderer::~PixelRenderer()
 {
+	stopRenderThread();
+	renderSettings.getColorMatrixSetting().detach(*this);
+	renderSettings.getContrastSetting().detach(*this);
+	renderSettings.getBrightnessSetting().detach(*this);
+	renderSettings.getGammaSetting().detach(*this);
+	renderSettings.getRenderThreadSetting().detach(*this);
 	renderSettings.getMinFrameSkipSetting().detach(*this);
 	renderSettings.getMaxFrameSkipSetting().detach(*this);
 }
@@ -150,6 +229,7 @@ PostProcessor* PixelRenderer::getPostProcessor() const
 
 const RawFrame* PixelRenderer::getWorkingFrame(EmuTime time)
 {
+	waitForRendering();
 	sync(time, true);
 	return rasterizer->getWorkingFrame();
 }
@@ -161,6 +241,8 @@ const RawFrame* PixelRenderer::getLastFrame() const
 
 void PixelRenderer::reInit()
 {
+	waitForRendering();
+
 	// Don't draw before frameStart() is called.
 	// This for example can happen after a loadstate or after switching
 	// renderer in the middle of a frame.
@@ -169,24 +251,29 @@ void PixelRenderer::reInit()
 
 	rasterizer->reset();
 	displayEnabled = vdp.isDisplayEnabled();
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateDisplayEnabled(bool enabled, EmuTime time)
 {
+	waitForRendering();
 	sync(time, true);
 	displayEnabled = enabled;
 }
 
 void PixelRenderer::frameStart(EmuTime time)
 {
+	waitForRendering();
 	if (!rasterizer->isActive()) {
 		frameSkipCounter = 999.0f;
 		renderFrame = false;
 		prevRenderFrame = false;
 		paintFrame = false;
+		autoSkip.valid = false;
 		return;
 	}
 
+	updateAutoFrameSkip(time);
 	prevRenderFrame = renderFrame;
 	if (vdp.isInterlaced() && renderSettings.getDeinterlace()
 			&& vdp.getEvenOdd() && vdp.isEvenOddEnabled()) {
@@ -197,9 +284,15 @@ void PixelRenderer::frameStart(EmuTime time)
 		//       for every series of skipped frames there is also one painted
 		//       frame, so our boundary checks are offset by one.
 		auto counter = narrow_cast<int>(frameSkipCounter);
-		if (counter < renderSettings.getMinFrameSkip()) {
+		auto minFrameSkip = renderSettings.getMinFrameSkip();
+		auto maxFrameSkip = renderSettings.getMaxFrameSkip();
+		if (renderSettings.getAutoFrameSkip()) {
+			minFrameSkip = std::max(minFrameSkip,
+				std::min(autoSkip.frameSkip, maxFrameSkip));
+		}
+		if (counter < minFrameSkip) {
 			paintFrame = false;
-		} else if (counter > renderSettings.getMaxFrameSkip()) {
+		} else if (counter > maxFrameSkip) {
 			paintFrame = true;
 		} else {
 			paintFrame = realTime.timeLeft(
@@ -221,8 +314,17 @@ void PixelRenderer::frameStart(EmuTime time)
 	renderFrame = true;
 
 	rasterizer->frameStart(time);
+	++renderedFrames;
+	if (vdp.isPalTiming() != prevPalTiming) {
+		// frame is positioned differently
+		prevPalTiming = vdp.isPalTiming();
+		markAllLinesChanged();
+	}
 
 	accuracy = renderSettings.getAccuracy();
+	if (autoSkip.lowAccuracy && accuracy == RenderSettings::Accuracy::PIXEL) {
+		accuracy = RenderSettings::Accuracy::LINE;
+	}
 
 	nextX = 0;
 	nextY = 0;
@@ -231,8 +333,113 @@ void PixelRenderer::frameStart(EmuTime time)
 	textModeCounter = 0;
 }
 
+void PixelRenderer::updateAutoFrameSkip(EmuTime time)
+{
+	auto& as = autoSkip;
+	if (!renderSettings.getAutoFrameSkip() || !throttleManager.isThrottled()) {
+		as = AutoFrameSkip{};
+		return;
+	}
+
+	auto now = Timer::getTime();
+	auto slept = realTime.getSleptTime();
+	auto painted = display.getPaintTime();
+	if (as.valid) {
+		auto frameTime = narrow_cast<float>(
+			realTime.getRealDuration(as.prevFrameStart, time) * 1000000.0);
+		auto paint = narrow_cast<float>(painted - as.prevPainted);
+		auto busy = narrow_cast<float>(now - as.prevTime)
+		          - narrow_cast<float>(slept - as.prevSlept) - paint;
+		// Ignore outliers, e.g. after a pause or when the window was
+		// being dragged.
+		if ((0.0f <= busy) && (busy < 10.0f * frameTime)) {
+			const float ALPHA = 0.1f;
+			auto average = [&](float& avg, float current) {
+				avg = avg * (1 - ALPHA) + current * ALPHA;
+			};
+			as.frameTime = frameTime;
+			if (paint > 0.0f) average(as.paintTime, paint);
+			// 'renderFrame' still refers to the previous frame
+			if (renderFrame) {
+				average(as.renderedTime, busy);
+			} else if (as.emuTime < 0.0f) {
+				as.emuTime = busy;
+			} else {
+				average(as.emuTime, busy);
+			}
+
+			// The emulation time is only known once a frame was
+			// skipped, till then all time is attributed to rendering.
+			auto emu = std::max(as.emuTime, 0.0f);
+			auto render = std::max(as.renderedTime - emu, 0.0f) + as.paintTime;
+			// When skipping 'n' frames after each rendered frame:
+			//   (n + 1) * emu + render <= (n + 1) * frameTime
+			// Keep some margin for variations in the host load.
+			auto framesToSkip = [&](float renderTime) {
+				auto headroom = 0.9f * as.frameTime - emu;
+				if (headroom <= 0.0f) return 999;
+				return int(std::ceil(std::min(renderTime / headroom, 1000.0f))) - 1;
+			};
+
+			int minSkip = renderSettings.getMinFrameSkip();
+			int maxSkip = std::max(minSkip, renderSettings.getMaxFrameSkip());
+			int needed = framesToSkip(render);
+			int target = std::clamp(needed, minSkip, maxSkip);
+			// Go up immediately, go down only when it's needed for a
+			// while, to avoid a fluctuating frame rate.
+			static constexpr int SKIP_HOLD = 50; // ~1s
+			if (target > as.frameSkip) {
+				as.frameSkip = target;
+				as.skipHold = SKIP_HOLD;
+			} else if (target < as.frameSkip) {
+				if (--as.skipHold <= 0) {
+					--as.frameSkip;
+					as.skipHold = SKIP_HOLD;
+				}
+			} else {
+				as.skipHold = SKIP_HOLD;
+			}
+
+			// Even the max frameskip can't keep up: render with line
+			// accuracy. Only go back to pixel accuracy when there is
+			// room for (about) twice the current render time.
+			static constexpr int ACCURACY_HOLD = 250; // ~5s
+			if (!renderSettings.getAutoAccuracy()) {
+				as.lowAccuracy = false;
+			} else if (needed > maxSkip) {
+				as.lowAccuracy = true;
+				as.accuracyHold = ACCURACY_HOLD;
+			} else if (as.lowAccuracy) {
+				if (framesToSkip(2.0f * render) > maxSkip) {
+					as.accuracyHold = ACCURACY_HOLD;
+				} else if (--as.accuracyHold <= 0) {
+					as.lowAccuracy = false;
+				}
+			}
+		}
+	}
+	as.prevFrameStart = time;
+	as.prevTime = now;
+	as.prevSlept = slept;
+	as.prevPainted = painted;
+	as.valid = true;
+}
+
+Renderer::FrameSkipStatus PixelRenderer::getFrameSkipStatus() const
+{
+	auto emu = std::max(autoSkip.emuTime, 0.0f);
+	return {
+		.frameTime = autoSkip.frameTime,
+		.emuTime = emu,
+		.renderTime = std::max(autoSkip.renderedTime - emu, 0.0f) + autoSkip.paintTime,
+		.frameSkip = autoSkip.frameSkip,
+		.lowAccuracy = autoSkip.lowAccuracy,
+	};
+}
+
 void PixelRenderer::frameEnd(EmuTime time)
 {
+	waitForRendering();
 	if (renderFrame) {
 		// Render changes from this last frame.
 		sync(time, true);
@@ -268,81 +475,104 @@ void PixelRenderer::frameEnd(EmuTime time)
 void PixelRenderer::updateHorizontalScrollLow(
 	uint8_t scroll, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
 	rasterizer->setHorizontalScrollLow(scroll);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateHorizontalScrollHigh(
 	uint8_t /*scroll*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateBorderMask(
 	bool masked, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
 	rasterizer->setBorderMask(masked);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateMultiPage(
 	bool /*multiPage*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateTransparency(
 	bool enabled, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
 	rasterizer->setTransparency(enabled);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateSuperimposing(
 	const RawFrame* videoSource, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
 	rasterizer->setSuperimposeVideoFrame(videoSource);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateForegroundColor(
 	uint8_t /*color*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateBackgroundColor(
 	uint8_t color, EmuTime time)
 {
+	waitForRendering();
 	sync(time);
 	rasterizer->setBackgroundColor(color);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateBlinkForegroundColor(
 	uint8_t /*color*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateBlinkBackgroundColor(
 	uint8_t /*color*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateBlinkState(
 	bool /*enabled*/, EmuTime /*time*/)
 {
+	waitForRendering();
 	// TODO: When the sync call is enabled, the screen flashes on
 	//       every call to this method.
 	//       I don't know why exactly, but it's probably related to
 	//       being called at frame start.
 	//sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updatePalette(
 	unsigned index, int grb, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) {
 		sync(time);
 	} else {
@@ -360,24 +590,30 @@ void PixelRenderer::updatePalette(
 		}
 	}
 	rasterizer->setPalette(index, grb);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateVerticalScroll(
 	int /*scroll*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateHorizontalAdjust(
 	int adjust, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
 	rasterizer->setHorizontalAdjust(adjust);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateDisplayMode(
 	DisplayMode mode, EmuTime time)
 {
+	waitForRendering();
 	// Sync if in display area or if border drawing process changes.
 	DisplayMode oldMode = vdp.getDisplayMode();
 	if (displayEnabled
@@ -388,24 +624,31 @@ void PixelRenderer::updateDisplayMode(
 		sync(time, true);
 	}
 	rasterizer->setDisplayMode(mode);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateNameBase(
 	unsigned /*addr*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updatePatternBase(
 	unsigned /*addr*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateColorBase(
 	unsigned /*addr*/, EmuTime time)
 {
+	waitForRendering();
 	if (displayEnabled) sync(time);
+	markAllLinesChanged();
 }
 
 void PixelRenderer::updateSpritesEnabled(
@@ -524,10 +767,94 @@ bool PixelRenderer::checkSync(unsigned offset, EmuTime time) const
 
 void PixelRenderer::updateVRAM(unsigned offset, EmuTime time)
 {
+	// The render thread might still need the old VRAM content.
+	if (renderBusy.load(std::memory_order_acquire) && affectsPendingDraw(offset)) {
+		waitForRendering();
+	}
 	// Note: No need to sync if display is disabled, because then the
 	//       output does not depend on VRAM (only on background color).
 	if (renderFrame && displayEnabled && checkSync(offset, time)) {
 		renderUntil(time);
+	} else if (renderThread.joinable() && renderFrame &&
+	           (accuracy != RenderSettings::Accuracy::SCREEN) &&
+	           ((vdp.getTicksThisFrame(time) / VDP::TICKS_PER_LINE - nextY) >= ASYNC_RENDER_LINES)) {
+		// Render the lines that are already scanned in the background,
+		// while the emulation continues.
+		renderUntil(time, true);
+	}
+	// Only after the lines before 'time' are drawn (with the old content).
+	markVRAMChanged(offset);
+}
+
+void PixelRenderer::markVRAMChanged(unsigned offset)
+{
+	// Same mapping from VRAM address to display lines as in checkSync().
+	auto markLines = [&](unsigned first, unsigned num) {
+		for (auto y : xrange(first, first + num)) {
+			displayLineChanged[y & 255] = changeCounter;
+		}
+	};
+	++changeCounter;
+	DisplayMode mode = vdp.getDisplayMode();
+	switch (mode.getBase()) {
+	case DisplayMode::GRAPHIC2:
+	case DisplayMode::GRAPHIC3:
+		for (const auto* table : {&vram.colorTable, &vram.patternTable}) {
+			if (!table->isInside(offset)) continue;
+			unsigned vramQuarter = (offset & 0x1800) >> 11;
+			unsigned mask = (table->getMask() & 0x1800) >> 11;
+			for (auto i : xrange(4u)) {
+				if ((i & mask) == vramQuarter) markLines(i * 64, 64);
+			}
+		}
+		if (vram.nameTable.isInside(offset)) {
+			markLines(((offset & 0x3FF) / 32) * 8, 8);
+		}
+		break;
+	case DisplayMode::GRAPHIC4:
+	case DisplayMode::GRAPHIC5: {
+		if (vdp.isFastBlinkEnabled()) {
+			markAllLinesChanged();
+			break;
+		}
+		unsigned visiblePage = vram.nameTable.getMask()
+			& (0x10000 | (vdp.getEvenOddMask() << 7));
+		if (((offset & 0x18000) == visiblePage) ||
+		    (vdp.isMultiPageScrolling() &&
+		     ((offset & 0x18000) == (visiblePage & 0x10000)))) {
+			markLines((offset & 0x7FFF) >> 7, 1); // 128 bytes per line
+		}
+		break;
+	}
+	case DisplayMode::GRAPHIC6:
+	case DisplayMode::GRAPHIC7:
+		// Planar: each bank holds 128 bytes of a line. Writes to the
+		// invisible page(s) also mark the line.
+		markLines((offset & 0x7FFF) >> 7, 1);
+		break;
+	case DisplayMode::TEXT1:
+	case DisplayMode::TEXT2:
+	case DisplayMode::GRAPHIC1:
+	case DisplayMode::MULTICOLOR:
+		if (vram.nameTable.isInside(offset)) {
+			auto [columns, tableMask] = [&] -> std::pair<unsigned, unsigned> {
+				switch (mode.getBase()) {
+				case DisplayMode::TEXT1: return {40, 0x3FF};
+				case DisplayMode::TEXT2: return {80, 0xFFF};
+				default:                 return {32, 0x3FF};
+				}
+			}();
+			markLines(((offset & tableMask) / columns) * 8, 8);
+			break;
+		}
+		[[fallthrough]];
+	default:
+		if (vram.nameTable.isInside(offset) ||
+		    vram.colorTable.isInside(offset) ||
+		    vram.patternTable.isInside(offset)) {
+			markAllLinesChanged();
+		}
+		break;
 	}
 }
 
@@ -537,6 +864,7 @@ void PixelRenderer::updateWindow(bool /*enabled*/, EmuTime /*time*/)
 	// This update is redundant: Renderer will be notified in another way
 	// as well (updateDisplayEnabled or updateNameBase, for example).
 	// TODO: Can this be used as the main update method instead?
+	markAllLinesChanged();
 }
 
 void PixelRenderer::sync(EmuTime time, bool force)
@@ -561,7 +889,7 @@ void PixelRenderer::sync(EmuTime time, bool force)
 	}
 }
 
-void PixelRenderer::renderUntil(EmuTime time)
+void PixelRenderer::renderUntil(EmuTime time, bool async)
 {
 	// Translate from time to pixel position.
 	int limitTicks = vdp.getTicksThisFrame(time);
@@ -627,13 +955,156 @@ void PixelRenderer::renderUntil(EmuTime time)
 
 	nextX = limitX;
 	nextY = limitY;
+
+	submitDrawCommands(async);
+}
+
+void PixelRenderer::executeDrawCommands(std::span<const DrawCommand> commands)
+{
+	for (const auto& c : commands) {
+		switch (c.type) {
+		case DRAW_BORDER:
+			rasterizer->drawBorder(c.x0, c.y0, c.x1, c.y1);
+			break;
+		case DRAW_DISPLAY:
+			rasterizer->drawDisplay(c.x0, c.y0, c.x1, c.y1, c.width, c.height);
+			break;
+		case DRAW_SPRITES:
+			rasterizer->drawSprites(c.x0, c.y0, c.x1, c.y1, c.width, c.height);
+			break;
+		case DRAW_COPY:
+			rasterizer->copyLastFrame(c.y0, c.y1);
+			break;
+		default:
+			UNREACHABLE;
+		}
+	}
+}
+
+void PixelRenderer::submitDrawCommands(bool async)
+{
+	if (async && renderThread.joinable()) {
+		if (drawCommands.empty()) return;
+		renderPendingDisplay |= std::ranges::any_of(drawCommands,
+			[](const auto& c) { return c.type != DRAW_BORDER; });
+		{
+			std::scoped_lock lock(renderMutex);
+			append(renderQueue, drawCommands);
+			renderBusy.store(true, std::memory_order_relaxed);
+		}
+		renderCondition.notify_one();
+	} else {
+		// keep the drawing order
+		waitForRendering();
+		executeDrawCommands(drawCommands);
+	}
+	drawCommands.clear();
+}
+
+void PixelRenderer::waitForRendering()
+{
+	if (!renderBusy.load(std::memory_order_acquire)) return;
+	std::unique_lock lock(renderMutex);
+	renderFinished.wait(lock, [&]{ return !renderBusy.load(std::memory_order_relaxed); });
+	renderPendingDisplay = false;
+}
+
+bool PixelRenderer::affectsPendingDraw(unsigned offset) const
+{
+	// Drawing the border doesn't use VRAM.
+	if (!renderPendingDisplay) return false;
+
+	switch (vdp.getDisplayMode().getBase()) {
+	case DisplayMode::GRAPHIC4:
+	case DisplayMode::GRAPHIC5: {
+		if (vdp.isFastBlinkEnabled()) return true;
+		// Same as in checkSync(), but for all lines.
+		unsigned visiblePage = vram.nameTable.getMask()
+			& (0x10000 | (vdp.getEvenOddMask() << 7));
+		if (vdp.isMultiPageScrolling()) {
+			return (offset & 0x18000) == visiblePage
+				|| (offset & 0x18000) == (visiblePage & 0x10000);
+		} else {
+			return (offset & 0x18000) == visiblePage;
+		}
+	}
+	case DisplayMode::GRAPHIC6:
+	case DisplayMode::GRAPHIC7:
+		return true;
+	default:
+		return vram.nameTable.isInside(offset)
+			|| vram.colorTable.isInside(offset)
+			|| vram.patternTable.isInside(offset);
+	}
+}
+
+void PixelRenderer::startRenderThread()
+{
+	if (renderThread.joinable()) return;
+	if (std::thread::hardware_concurrency() < 2) return; // no gain
+	renderQuit = false;
+	try {
+		renderThread = std::thread([this]{ renderThreadLoop(); });
+	} catch (std::system_error&) {
+		// ignore, render in the emulation thread
+	}
+}
+
+void PixelRenderer::stopRenderThread()
+{
+	if (!renderThread.joinable()) return;
+	{
+		std::scoped_lock lock(renderMutex);
+		renderQuit = true;
+	}
+	renderCondition.notify_one();
+	renderThread.join();
+	assert(!renderBusy);
+	renderPendingDisplay = false;
+}
+
+void PixelRenderer::renderThreadLoop()
+{
+	std::vector<DrawCommand> commands;
+	std::unique_lock lock(renderMutex);
+	while (true) {
+		renderCondition.wait(lock, [&]{ return renderQuit || !renderQueue.empty(); });
+		if (renderQueue.empty()) return; // quit, and all commands are executed
+
+		std::swap(commands, renderQueue);
+		lock.unlock();
+		executeDrawCommands(commands);
+		commands.clear();
+		lock.lock();
+		if (renderQueue.empty()) {
+			renderBusy.store(false, std::memory_order_release);
+			renderFinished.notify_all();
+		}
+	}
 }
 
 void PixelRenderer::update(const Setting& setting) noexcept
 {
+	if (&setting == &renderSettings.getRenderThreadSetting()) {
+		if (renderSettings.getRenderThread()) {
+			startRenderThread();
+		} else {
+			stopRenderThread();
+		}
+		return;
+	}
+	if (&setting == one_of(&renderSettings.getGammaSetting(),
+	                       &renderSettings.getBrightnessSetting(),
+	                       &renderSettings.getContrastSetting(),
+	                       &renderSettings.getColorMatrixSetting())) {
+		// The render thread may still be using the old palette.
+		waitForRendering();
+		rasterizer->resetHostPalette();
+		markAllLinesChanged();
+		return;
+	}
 	assert(&setting == one_of(&renderSettings.getMinFrameSkipSetting(),
 	                          &renderSettings.getMaxFrameSkipSetting()));
-	(void)setting;
 	// Force drawing of frame.
 	frameSkipCounter = 999;
 }
@@ -6,8 +6,15 @@
 
 #include "Observer.hh"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
 
 namespace openmsx {
 
@@ -26,6 +33,18 @@ class VideoSourceSetting;
 
 /** Generic implementation of a pixel-based Renderer.
   * Uses a Rasterizer to plot actual pixels for a specific video system.
+  *
+  * Rendering can (partly) be done in a separate thread: the lines that the
+  * VDP has already scanned are rendered in the background while the
+  * emulation continues. Before any VDP state or VRAM that is used for
+  * these lines changes, the emulation waits for the render thread, so the
+  * output is exactly the same as with rendering in the emulation thread.
+  *
+  * Display lines whose inputs (VRAM, VDP state, sprites) didn't change
+  * since they were drawn in the previous rendered frame, are copied from
+  * that frame instead of being converted again. VRAM changes are tracked
+  * per display line via updateVRAM(), all other (notified) state changes
+  * mark all lines as changed.
   */
 class PixelRenderer final : public Renderer, private Observer<Setting>
 {
@@ -38,6 +57,7 @@ public:
 	[[nodiscard]] const RawFrame* getWorkingFrame(EmuTime time) override;
 	[[nodiscard]] const RawFrame* getLastFrame() const override;
 	void reInit() override;
+	void waitForRendering() override;
 	void frameStart(EmuTime time) override;
 	void frameEnd(EmuTime time) override;
 	void updateHorizontalScrollLow(uint8_t scroll, EmuTime time) override;
@@ -62,20 +82,55 @@ public:
 	void updateSpritesEnabled(bool enabled, EmuTime time) override;
 	void updateVRAM(unsigned offset, EmuTime time) override;
 	void updateWindow(bool enabled, EmuTime time) override;
+	[[nodiscard]] unsigned getSkippedLines() const override { return skippedLines; }
+	[[nodiscard]] FrameSkipStatus getFrameSkipStatus() const override;
 
 private:
 	/** Indicates whether the area to be drawn is border or display. */
-	enum DrawType : uint8_t { DRAW_BORDER, DRAW_DISPLAY };
+	enum DrawType : uint8_t { DRAW_BORDER, DRAW_DISPLAY, DRAW_SPRITES, DRAW_COPY };
+
+	/** A call to one of the Rasterizer draw methods. For DRAW_BORDER
+	  * (x0, y0) - (x1, y1) is the area to draw. For DRAW_DISPLAY and
+	  * DRAW_SPRITES (x0, y0) is the position on screen, (x1, y1) the
+	  * position in the display and width x height the size. For
+	  * DRAW_COPY lines [y0, y1) are copied from the previous frame.
+	  */
+	struct DrawCommand {
+		DrawType type;
+		int x0, y0, x1, y1;
+		int width = 0, height = 0;
+	};
 
 	// Observer<Setting> interface:
 	void update(const Setting& setting) noexcept override;
 
 	/** Call the right draw method in the subclass,
 	  * depending on passed drawType.
+	  * @param fullLines Does the area contain complete lines?
+	  *     Only complete lines can be copied from the previous frame.
 	  */
 	void draw(
 		int startX, int startY, int endX, int endY, DrawType drawType,
-		bool atEnd);
+		bool atEnd, bool fullLines);
+
+	/** Generate the draw commands for a part of the display area.
+	  * For complete lines that are unchanged since the previous frame,
+	  * a DRAW_COPY command is generated instead.
+	  */
+	void drawDisplay(
+		int startX, int startY, int displayX, int displayY,
+		int displayWidth, int displayHeight, bool fullLines);
+
+	/** Is line 'y' (showing display line 'displayY') unchanged since it
+	  * was drawn in the previous rendered frame?
+	  */
+	[[nodiscard]] bool isLineUnchanged(int y, uint8_t displayY, bool sprites) const;
+
+	/** Remember which display lines are affected by a VRAM write. */
+	void markVRAMChanged(unsigned offset);
+
+	/** A state change that (possibly) affects all lines. */
+	void markAllLinesChanged() { allLinesChanged = ++changeCounter; }
 
 	/** Subdivide an area specified by two scan positions into a series of
 	  * rectangles.
@@ -90,6 +145,12 @@ private:
 
 	[[nodiscard]] bool checkSync(unsigned offset, EmuTime time) const;
 
+	/** Measure the host time of the previous frame and (re)calculate the
+	  * automatic frameskip, see 'auto_frameskip'. Called at the start of
+	  * each frame.
+	  */
+	void updateAutoFrameSkip(EmuTime time);
+
 	/** Update renderer state to specified moment in time.
 	  * @param time Moment in emulated time to update to.
 	  * @param force When screen accuracy is used,
@@ -102,8 +163,17 @@ private:
 	  * The VRAM should be to be up to date and remain unchanged
 	  * from the current time to the specified time.
 	  * @param time Moment in emulated time to render lines until.
+	  * @param async Render in the render thread (when it is running),
+	  *     otherwise the lines are rendered before this method returns.
 	  */
-	void renderUntil(EmuTime time);
+	void renderUntil(EmuTime time, bool async = false);
+
+	void executeDrawCommands(std::span<const DrawCommand> commands);
+	void submitDrawCommands(bool async);
+	[[nodiscard]] bool affectsPendingDraw(unsigned offset) const;
+	void startRenderThread();
+	void stopRenderThread();
+	void renderThreadLoop();
 
 private:
 	/** The VDP of which the video output is being rendered.
@@ -114,6 +184,7 @@ private:
 	  */
 	VDPVRAM& vram;
 
+	Display& display;
 	EventDistributor& eventDistributor;
 	RealTime& realTime;
 	SpeedManager& speedManager;
@@ -130,6 +201,28 @@ private:
 	float finishFrameDuration = 0.0f;
 	float frameSkipCounter = 999.0f; // force drawing of frame
 
+	/** Automatic frameskip. The host time between two frameStart() calls,
+	  * minus the time spent sleeping and painting, is the time it took to
+	  * emulate (and possibly render) a frame. Separate averages are kept
+	  * for rendered and skipped frames, from these the number of frames
+	  * that must be skipped to keep up with real time is derived.
+	  */
+	struct AutoFrameSkip {
+		EmuTime prevFrameStart = EmuTime::zero();
+		uint64_t prevTime = 0;    // Timer::getTime() at previous frameStart()
+		uint64_t prevSlept = 0;   // RealTime::getSleptTime()   "   "
+		uint64_t prevPainted = 0; // Display::getPaintTime()    "   "
+		float frameTime = 0.0f;     // real time duration of one frame
+		float emuTime = -1.0f;      // skipped frame, negative when unknown
+		float renderedTime = 0.0f;  // rendered frame (emulation + render)
+		float paintTime = 0.0f;     // painting one frame
+		int frameSkip = 0;
+		int skipHold = 0;     // frames before frameSkip can go down
+		int accuracyHold = 0; // frames before accuracy can go up
+		bool lowAccuracy = false;
+		bool valid = false; // are the 'prev' values valid?
+	} autoSkip;
+
 	/** Number of the next position within a line to render.
 	  * Expressed in VDP clock ticks since start of line.
 	  */
@@ -169,6 +262,36 @@ private:
 	  * Used to force a minimal paint rate when throttle is off.
 	  */
 	uint64_t lastPaintTime = 0;
+
+	/** Draw commands generated by renderUntil(), not yet executed.
+	  */
+	std::vector<DrawCommand> drawCommands;
+
+	// Render thread. It's only started on hosts with multiple CPU cores.
+	std::thread renderThread;
+	std::mutex renderMutex;
+	std::condition_variable renderCondition; // new commands or quit
+	std::condition_variable renderFinished;
+	std::vector<DrawCommand> renderQueue; // protected by renderMutex
+	std::atomic<bool> renderBusy = false; // are there queued or executing commands?
+	bool renderQuit = false; // protected by renderMutex
+	bool renderPendingDisplay = false; // (possibly) executing commands for the display area
+
+	// Dirty-line tracking. Changes are ordered by 'changeCounter': a line
+	// is unchanged when it was drawn after the last change that affects it.
+	struct LineState {
+		uint64_t drawn = 0; // changeCounter when drawn, 0 if not completely drawn
+		unsigned frame = 0; // renderedFrames when drawn
+		uint8_t displayY = 0;
+		bool sprites = false; // were there sprites on this line?
+	};
+	std::array<LineState, 313> lineStates; // indexed by absolute line
+	std::array<uint64_t, 256> displayLineChanged = {}; // indexed by display line
+	uint64_t changeCounter = 1;
+	uint64_t allLinesChanged = 1;
+	unsigned renderedFrames = 0; // number of frames passed to the rasterizer
+	unsigned skippedLines = 0; // number of lines copied from the previous frame
+	bool prevPalTiming = false;
 };
 
 } // namespace openmsx
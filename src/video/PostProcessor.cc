@@ -19,6 +19,7 @@
 #include "RawFrame.hh"
 #include "Reactor.hh"
 #include "RenderSettings.hh"
+#include "SoftwareScaler.hh"
 #include "SuperImposedFrame.hh"
 #include "gl_transform.hh"
 
@@ -30,8 +31,10 @@
 #include "ranges.hh"
 #include "stl.hh"
 #include "xrange.hh"
+#include "xxhash.hh"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -159,7 +162,7 @@ static void getScaledFrame(const FrameSource& paintFrame,
 	}
 }
 
-void PostProcessor::takeRawScreenShot(std::optional<unsigned> desiredHeight, const std::string& filename)
+void PostProcessor::takeRawScreenShot(std::optional<unsigned> desiredHeight, const std::string& filename, bool scaled)
 {
 	if (!paintFrame) {
 		throw CommandException("TODO");
@@ -172,10 +175,21 @@ void PostProcessor::takeRawScreenShot(std::optional<unsigned> desiredHeight, con
 		return 480;
 	}();
 
-	inplace_buffer<const FrameSource::Pixel*, 480> lines(uninitialized_tag{}, targetHeight);
+	unsigned width = (targetHeight / 3) * 4;
+	inplace_buffer<const FrameSource::Pixel*, 720> lines(uninitialized_tag{}, targetHeight);
+	if (scaled) {
+		RawFrame scaledFrame(width, targetHeight);
+		SoftwareScaler scaler;
+		scaler.scaleImage(*paintFrame, scaledFrame, SoftwareScaler::getParams(renderSettings));
+		for (auto i : xrange(targetHeight)) {
+			lines[i] = scaledFrame.getLineDirect(i).data();
+		}
+		PNG::saveRGBA(width, lines, filename);
+		return;
+	}
+	assert(targetHeight <= 480);
 	WorkBuffer workBuffer;
 	getScaledFrame(*paintFrame, lines, workBuffer);
-	unsigned width = (targetHeight == 240) ? 320 : 640;
 	PNG::saveRGBA(width, lines, filename);
 }
 
@@ -265,43 +279,57 @@ void PostProcessor::paint(OutputSurface& /*output*/)
 		// Re-uploading the first is not strictly needed. But switching
 		// scalers doesn't happen that often, so it also doesn't hurt
 		// and it keeps the code simpler.
-		uploadFrame();
+		uploadFrame(true);
 	}
 
-	glViewport(0, 0, size.x, size.y);
-	glBindTexture(GL_TEXTURE_2D, 0);
 	auto& renderedFrame = renderedFrames[frameCounter & 1];
-	if (renderedFrame.size != size) {
-		renderedFrame.tex.bind();
-		renderedFrame.tex.setInterpolation(true);
-		glTexImage2D(GL_TEXTURE_2D,     // target
-			     0,                 // level
-			     GL_RGB,            // internal format
-			     size.x,            // width
-			     size.y,            // height
-			     0,                 // border
-			     GL_RGB,            // format
-			     GL_UNSIGNED_BYTE,  // type
-			     nullptr);          // data
-		renderedFrame.fbo = FrameBufferObject(renderedFrame.tex);
-	}
-	renderedFrame.fbo.push();
-
-	for (const auto& r : regions) {
-		auto it = find_unguarded(textures, r.lineWidth, &TextureData::width);
-		auto* superImpose = superImposeVideoFrame
-		                  ? &superImposeTex : nullptr;
-		currScaler->scaleImage(
-			it->tex, superImpose,
-			r.srcStartY, r.srcEndY, r.lineWidth, // src
-			r.dstStartY, r.dstEndY, size.x,   // dst
-			paintFrame->getHeight()); // dst
-	}
+	ScaleParams params{size, scaleAlgorithm,
+	                   renderSettings.getBlurFactor(),
+	                   renderSettings.getScanlineFactor(),
+	                   renderSettings.getScanlineGap()};
+	// Noise and glow change the result in each frame, and a superimposed
+	// frame can change without this frame changing.
+	bool reuseScaled = (renderedFrame.generation == frameGeneration) &&
+	                   (renderedFrame.params == params) &&
+	                   (renderSettings.getNoise() == 0.0f) && (glow == 0) &&
+	                   !superImposeVideoFrame && !superImposeVdpFrame;
+	if (!reuseScaled) {
+		glViewport(0, 0, size.x, size.y);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		if (renderedFrame.size != size) {
+			renderedFrame.tex.bind();
+			renderedFrame.tex.setInterpolation(true);
+			glTexImage2D(GL_TEXTURE_2D,     // target
+				     0,                 // level
+				     GL_RGB,            // internal format
+				     size.x,            // width
+				     size.y,            // height
+				     0,                 // border
+				     GL_RGB,            // format
+				     GL_UNSIGNED_BYTE,  // type
+				     nullptr);          // data
+			renderedFrame.fbo = FrameBufferObject(renderedFrame.tex);
+		}
+		renderedFrame.fbo.push();
+
+		for (const auto& r : regions) {
+			auto it = find_unguarded(textures, r.lineWidth, &TextureData::width);
+			auto* superImpose = superImposeVideoFrame
+			                  ? &superImposeTex : nullptr;
+			currScaler->scaleImage(
+				it->tex, superImpose,
+				r.srcStartY, r.srcEndY, r.lineWidth, // src
+				r.dstStartY, r.dstEndY, size.x,   // dst
+				paintFrame->getHeight()); // dst
+		}
 
-	drawNoise();
-	drawGlow(glow);
+		drawNoise();
+		drawGlow(glow);
 
-	renderedFrame.fbo.pop();
+		renderedFrame.fbo.pop();
+		renderedFrame.generation = frameGeneration;
+		renderedFrame.params = params;
+	}
 	renderedFrame.tex.bind();
 
 	if (renderSettings.getFullStretch()) {
@@ -461,7 +489,7 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 		}
 	}();
 
-	uploadFrame();
+	uploadFrame(false);
 	++frameCounter;
 	noiseX = random_float(0.0f, 1.0f);
 	noiseY = random_float(0.0f, 1.0f);
@@ -480,19 +508,37 @@ void PostProcessor::update(const Setting& setting) noexcept
 	}
 }
 
-void PostProcessor::uploadFrame()
+void PostProcessor::uploadFrame(bool force)
 {
+	auto prevRegions = std::move(regions);
 	createRegions();
+	// The extra lines around each block depend on the regions.
+	force |= regions != prevRegions;
 
 	const unsigned srcHeight = paintFrame->getHeight();
-	for (const auto& r : regions) {
-		// upload data
+	auto getBlock = [&](const Region& r) {
 		// TODO get before/after data from scaler
 		int before = 1;
 		unsigned after  = 1;
-		uploadBlock(narrow<unsigned>(std::max(0, narrow<int>(r.srcStartY) - before)),
-		            std::min(srcHeight, r.srcEndY + after),
-		            r.lineWidth);
+		return std::pair{narrow<unsigned>(std::max(0, narrow<int>(r.srcStartY) - before)),
+		                 std::min(srcHeight, r.srcEndY + after)};
+	};
+	bool changed = force;
+	for (const auto& r : regions) {
+		// upload data
+		auto [startY, endY] = getBlock(r);
+		changed |= uploadBlock(startY, endY, r.lineWidth, force);
+	}
+	if (changed) {
+		++frameGeneration;
+		// possibly upload scaler specific data
+		// The blocks overlap, so always upload all of them, in order.
+		if (currScaler) {
+			for (const auto& r : regions) {
+				auto [startY, endY] = getBlock(r);
+				currScaler->uploadBlock(startY, endY, r.lineWidth, *paintFrame);
+			}
+		}
 	}
 
 	if (superImposeVideoFrame) {
@@ -517,8 +563,18 @@ void PostProcessor::uploadFrame()
 	}
 }
 
-void PostProcessor::uploadBlock(
-	unsigned srcStartY, unsigned srcEndY, unsigned lineWidth)
+static uint64_t hashLine(std::span<const FrameSource::Pixel> line)
+{
+	// Two 32-bit hashes (with a different seed) make collisions unlikely
+	// enough to not show an outdated line.
+	std::span bytes = std::as_bytes(line);
+	const auto* p = std::bit_cast<const uint8_t*>(bytes.data());
+	return (uint64_t(xxhash_impl<false, 0xFF, 0>(p, bytes.size())) << 32)
+	     | xxhash_impl<false, 0xFF, PRIME32_1>(p, bytes.size());
+}
+
+bool PostProcessor::uploadBlock(
+	unsigned srcStartY, unsigned srcEndY, unsigned lineWidth, bool force)
 {
 	// create texture on demand
 	auto it = std::ranges::find(textures, lineWidth, &TextureData::width);
@@ -530,46 +586,67 @@ void PostProcessor::uploadBlock(
 		it = end(textures) - 1;
 	}
 	auto& tex = it->tex;
+	auto& lineHashes = it->lineHashes;
+	if (lineHashes.empty()) {
+		force = true;
+		lineHashes.resize(size_t(height) * 2);
+	}
+#ifdef __APPLE__
+	// See the workaround below, it only works for complete blocks.
+	if (lineWidth == 1) force = true;
+#endif
 
 	// bind texture
 	tex.bind();
 
-	// upload data
+	// upload data, only the lines that changed
 	pbo.bind();
 	auto mapped = pbo.mapWrite();
 	auto numLines = srcEndY - srcStartY;
+	auto uploadLines = [&](unsigned first, unsigned last) { // [first, last)
+		unsigned startY = srcStartY + first;
+#ifdef __APPLE__
+		// The nVidia GL driver for the GeForce 8000/9000 series seems to hang
+		// on texture data replacements that are 1 pixel wide and start on a
+		// line number that is a non-zero multiple of 16.
+		if (lineWidth == 1 && startY != 0 && startY % 16 == 0) {
+			startY--;
+		}
+#endif
+		glTexSubImage2D(
+			GL_TEXTURE_2D,            // target
+			0,                        // level
+			0,                        // offset x
+			narrow<GLint>(startY),    // offset y
+			narrow<GLint>(lineWidth), // width
+			narrow<GLint>(last - first), // height
+			GL_RGBA,                  // format
+			GL_UNSIGNED_BYTE,         // type
+			mapped.subspan(first * size_t(lineWidth)).data()); // data
+	};
+	std::vector<std::pair<unsigned, unsigned>> changedRuns;
 	for (auto yy : xrange(numLines)) {
 		auto dest = mapped.subspan(yy * size_t(lineWidth), lineWidth);
 		auto line = paintFrame->getLine(narrow<int>(yy + srcStartY), dest);
+		auto hash = hashLine(line);
+		auto& stored = lineHashes[yy + srcStartY];
+		if (!force && (stored == hash)) continue;
+		stored = hash;
 		if (line.data() != dest.data()) {
 			copy_to_range(line, dest);
 		}
+		if (!changedRuns.empty() && (changedRuns.back().second == yy)) {
+			changedRuns.back().second = yy + 1;
+		} else {
+			changedRuns.emplace_back(yy, yy + 1);
+		}
 	}
 	pbo.unmap();
-#ifdef __APPLE__
-	// The nVidia GL driver for the GeForce 8000/9000 series seems to hang
-	// on texture data replacements that are 1 pixel wide and start on a
-	// line number that is a non-zero multiple of 16.
-	if (lineWidth == 1 && srcStartY != 0 && srcStartY % 16 == 0) {
-		srcStartY--;
+	for (auto [first, last] : changedRuns) {
+		uploadLines(first, last);
 	}
-#endif
-	glTexSubImage2D(
-		GL_TEXTURE_2D,            // target
-		0,                        // level
-		0,                        // offset x
-		narrow<GLint>(srcStartY), // offset y
-		narrow<GLint>(lineWidth), // width
-		narrow<GLint>(numLines),  // height
-		GL_RGBA,                  // format
-		GL_UNSIGNED_BYTE,         // type
-		mapped.data());           // data
 	pbo.unbind();
-
-	// possibly upload scaler specific data
-	if (currScaler) {
-		currScaler->uploadBlock(srcStartY, srcEndY, lineWidth, *paintFrame);
-	}
+	return !changedRuns.empty();
 }
 
 void PostProcessor::drawGlow(int glow)
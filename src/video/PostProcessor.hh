@@ -9,6 +9,7 @@
 #include "Schedulable.hh"
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -30,6 +31,11 @@ class SuperImposedFrame;
 
 /** A post processor builds the frame that is displayed from the MSX frame,
   * while applying effects such as scalers, noise etc.
+  *
+  * To save work on static screens, a hash is kept for each line in the
+  * textures. Only changed lines are uploaded, and when the whole frame
+  * (and the scaler parameters) didn't change, the previously scaled frame
+  * is reused instead of running the scaler again.
   */
 class PostProcessor final : public VideoLayer, private Schedulable
 {
@@ -100,7 +106,7 @@ public:
 	}
 
 	// VideoLayer
-	void takeRawScreenShot(std::optional<unsigned> height, const std::string& filename) override;
+	void takeRawScreenShot(std::optional<unsigned> height, const std::string& filename, bool scaled) override;
 
 	[[nodiscard]] CliComm& getCliComm();
 
@@ -117,9 +123,15 @@ private:
 
 	void initBuffers();
 	void createRegions();
-	void uploadFrame();
-	void uploadBlock(unsigned srcStartY, unsigned srcEndY,
-	                 unsigned lineWidth);
+	/** Upload the (changed lines of the) paint frame.
+	  * @param force Upload all lines, e.g. after a scaler change.
+	  */
+	void uploadFrame(bool force);
+	/** Upload lines [srcStartY, srcEndY) to the texture for the given
+	  * line width. Returns true iff any of these lines changed.
+	  */
+	bool uploadBlock(unsigned srcStartY, unsigned srcEndY,
+	                 unsigned lineWidth, bool force);
 
 	void preCalcNoise(float factor);
 	void drawNoise() const;
@@ -181,10 +193,24 @@ private:
 	  */
 	std::unique_ptr<GLScaler> currScaler;
 
+	/** All (non-frame) input of the scaler pass. */
+	struct ScaleParams {
+		gl::ivec2 size;
+		RenderSettings::ScaleAlgorithm algorithm = RenderSettings::ScaleAlgorithm::NO;
+		int blur = 0;
+		int scanline = 0;
+		float gap = 0.0f;
+		[[nodiscard]] bool operator==(const ScaleParams&) const = default;
+	};
+
 	struct StoredFrame {
 		gl::ivec2 size; // (re)allocate when window size changes
 		gl::Texture tex;
 		gl::FrameBufferObject fbo;
+		// The content of 'tex' is the scaled frame of this generation,
+		// scaled with these parameters.
+		unsigned generation = 0;
+		ScaleParams params;
 	};
 	std::array<StoredFrame, 2> renderedFrames;
 
@@ -195,6 +221,7 @@ private:
 
 	struct TextureData {
 		gl::ColorTexture tex;
+		std::vector<uint64_t> lineHashes; // hash of each uploaded line
 		[[nodiscard]] unsigned width() const { return tex.getWidth(); }
 	};
 	std::vector<TextureData> textures;
@@ -216,12 +243,16 @@ private:
 		unsigned dstStartY;
 		unsigned dstEndY;
 		unsigned lineWidth;
+		[[nodiscard]] bool operator==(const Region&) const = default;
 	};
 	std::vector<Region> regions;
 	unsigned regionsDstHeight = 0; // 'regions' were calculated for this output height (relevant when changing scale_factor when paused)
 
 	unsigned frameCounter = 0;
 
+	/** Incremented each time the uploaded frame changes. */
+	unsigned frameGeneration = 1;
+
 	/** Currently active scale algorithm, used to detect scaler changes.
 	  */
 	RenderSettings::ScaleAlgorithm scaleAlgorithm = RenderSettings::ScaleAlgorithm::NO;
@@ -61,6 +61,11 @@ public:
 	  */
 	virtual void setBackgroundColor(uint8_t index) = 0;
 
+	/** The gamma, brightness, contrast or color matrix setting changed,
+	  * recalculate the host colors of the palette.
+	  */
+	virtual void resetHostPalette() = 0;
+
 	virtual void setHorizontalAdjust(int adjust) = 0;
 	virtual void setHorizontalScrollLow(uint8_t scroll) = 0;
 	virtual void setBorderMask(bool masked) = 0;
@@ -105,6 +110,14 @@ public:
 		int displayX, int displayY,
 		int displayWidth, int displayHeight) = 0;
 
+	/** Copy complete lines (border and display) from the previous frame
+	  * to the current frame. Used for lines that would be rendered
+	  * exactly the same as in the previous frame.
+	  * @param fromY Y coordinate of copy start in absolute lines.
+	  * @param limitY Y coordinate of copy end in absolute lines (exclusive).
+	  */
+	virtual void copyLastFrame(int fromY, int limitY) = 0;
+
 	/** Is video recording active?
 	  */
 	[[nodiscard]] virtual bool isRecording() const = 0;
@@ -61,6 +61,14 @@ RenderSettings::RenderSettings(CommandController& commandController)
 	, minFrameSkipSetting(commandController,
 		"minframeskip", "set the min amount of frameskip", 0, 0, 100)
 
+	, autoFrameSkipSetting(commandController,
+		"auto_frameskip", "automatically adjust the min amount of "
+		"frameskip to the measured emulation and render time", false)
+
+	, autoAccuracySetting(commandController,
+		"auto_accuracy", "allow auto_frameskip to lower the accuracy "
+		"from pixel to line when skipping frames is not enough", false)
+
 	, fullScreenSetting(commandController,
 		"fullscreen", "full screen display on/off", false)
 
@@ -150,6 +158,11 @@ RenderSettings::RenderSettings(CommandController& commandController)
 	, fullStretchSetting(commandController,
 		"full_stretch", "Stretch the image to fill the entire screen in fullscreen mode", false)
 
+	, renderThreadSetting(commandController,
+		"render_thread", "Convert the MSX video output to pixels in a separate thread, in "
+		"parallel with the emulation (only used on hosts with more than one CPU core). "
+		"This doesn't change the output.", false)
+
 	// Many android devices are relatively low powered. Therefore use
 	// no stretch (value 320) as default for Android because it gives
 	// better performance
@@ -69,6 +69,14 @@ public:
 	[[nodiscard]] IntegerSetting& getMinFrameSkipSetting() { return minFrameSkipSetting; }
 	[[nodiscard]] int getMinFrameSkip() const { return minFrameSkipSetting.getInt(); }
 
+	/** Automatically raise the min frameskip based on measured host time [on, off]. */
+	[[nodiscard]] BooleanSetting& getAutoFrameSkipSetting() { return autoFrameSkipSetting; }
+	[[nodiscard]] bool getAutoFrameSkip() const { return autoFrameSkipSetting.getBoolean(); }
+
+	/** Allow the automatic frameskip to lower the accuracy from pixel to line [on, off]. */
+	[[nodiscard]] BooleanSetting& getAutoAccuracySetting() { return autoAccuracySetting; }
+	[[nodiscard]] bool getAutoAccuracy() const { return autoAccuracySetting.getBoolean(); }
+
 	/** Full screen [on, off]. */
 	[[nodiscard]] BooleanSetting& getFullScreenSetting() { return fullScreenSetting; }
 	[[nodiscard]] bool getFullScreen() const { return fullScreenSetting.getBoolean(); }
@@ -163,6 +171,10 @@ public:
 	[[nodiscard]] BooleanSetting& getFullStretchSetting() { return fullStretchSetting; }
 	[[nodiscard]] bool getFullStretch() const { return fullStretchSetting.getBoolean(); }
 
+	/** Render in a separate thread, in parallel with the emulation? */
+	[[nodiscard]] BooleanSetting& getRenderThreadSetting() { return renderThreadSetting; }
+	[[nodiscard]] bool getRenderThread() const { return renderThreadSetting.getBoolean(); }
+
 	/** Amount of horizontal stretch.
 	  * This number represents the amount of MSX pixels (normal width) that
 	  * will be stretched to the complete width of the host window. */
@@ -224,6 +236,8 @@ private:
 	BooleanSetting deflickerSetting;
 	IntegerSetting maxFrameSkipSetting;
 	IntegerSetting minFrameSkipSetting;
+	BooleanSetting autoFrameSkipSetting;
+	BooleanSetting autoAccuracySetting;
 	BooleanSetting fullScreenSetting;
 	FloatSetting gammaSetting;
 	FloatSetting brightnessSetting;
@@ -243,6 +257,7 @@ private:
 	EnumSetting<DisplayDeform> displayDeformSetting;
 	BooleanSetting vSyncSetting;
 	BooleanSetting fullStretchSetting;
+	BooleanSetting renderThreadSetting;
 	FloatSetting horizontalStretchSetting;
 	FloatSetting pointerHideDelaySetting;
 	BooleanSetting interleaveBlackFrameSetting;
@@ -36,6 +36,30 @@ public:
 	  */
 	virtual void reInit() = 0;
 
+	/** Wait till all pixels that are being rendered in the background
+	  * are finished. The VDP must call this before it changes state
+	  * that is used for rendering, without informing the renderer via
+	  * one of the update methods below.
+	  */
+	virtual void waitForRendering() {}
+
+	/** The number of display lines that were not rendered again because
+	  * they were unchanged since the previous frame (for statistics).
+	  */
+	[[nodiscard]] virtual unsigned getSkippedLines() const { return 0; }
+
+	/** Measurements and decisions of the automatic frameskip
+	  * (for statistics). All durations are in micro seconds.
+	  */
+	struct FrameSkipStatus {
+		float frameTime = 0.0f;  // real time duration of one emulated frame
+		float emuTime = 0.0f;    // host time to emulate one frame
+		float renderTime = 0.0f; // extra host time to render and paint one frame
+		int frameSkip = 0;       // selected min frameskip
+		bool lowAccuracy = false; // accuracy lowered from pixel to line
+	};
+	[[nodiscard]] virtual FrameSkipStatus getFrameSkipStatus() const { return {}; }
+
 	/** Signals the start of a new frame.
 	  * The Renderer can use this to get fixed-per-frame settings from
 	  * the VDP, such as PAL/NTSC timing.
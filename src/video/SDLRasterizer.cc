@@ -11,7 +11,6 @@
 
 #include "MemoryOps.hh"
 #include "enumerate.hh"
-#include "one_of.hh"
 #include "xrange.hh"
 
 #include <algorithm>
@@ -113,20 +112,9 @@ SDLRasterizer::SDLRasterizer(
 				V9938_COLORS[0][0][0];
 		}
 	}
-
-	renderSettings.getGammaSetting()      .attach(*this);
-	renderSettings.getBrightnessSetting() .attach(*this);
-	renderSettings.getContrastSetting()   .attach(*this);
-	renderSettings.getColorMatrixSetting().attach(*this);
 }
 
-SDLRasterizer::~SDLRasterizer()
-{
-	renderSettings.getColorMatrixSetting().detach(*this);
-	renderSettings.getGammaSetting()      .detach(*this);
-	renderSettings.getBrightnessSetting() .detach(*this);
-	renderSettings.getContrastSetting()   .detach(*this);
-}
+SDLRasterizer::~SDLRasterizer() = default;
 
 PostProcessor* SDLRasterizer::getPostProcessor() const
 {
@@ -630,20 +618,32 @@ void SDLRasterizer::drawSprites(
 	}
 }
 
+void SDLRasterizer::copyLastFrame(int fromY, int limitY)
+{
+	// Without a last frame, the PostProcessor gave us back the same frame
+	// again, so the work frame already contains the previous content.
+	const RawFrame* lastFrame = getLastFrame();
+	if (!lastFrame) return;
+
+	int startY = std::max(fromY - lineRenderTop, 0);
+	int endY = std::min(limitY - lineRenderTop, 240);
+	for (auto y : xrange(startY, endY)) {
+		unsigned width = lastFrame->getLineWidthDirect(y);
+		copy_to_range(lastFrame->getLineDirect(y).first(width),
+		              workFrame->getLineDirect(y));
+		workFrame->setLineWidth(y, width);
+	}
+}
+
 bool SDLRasterizer::isRecording() const
 {
 	return postProcessor->isRecording();
 }
 
-void SDLRasterizer::update(const Setting& setting) noexcept
+void SDLRasterizer::resetHostPalette()
 {
-	if (&setting == one_of(&renderSettings.getGammaSetting(),
-	                       &renderSettings.getBrightnessSetting(),
-	                       &renderSettings.getContrastSetting(),
-	                       &renderSettings.getColorMatrixSetting())) {
-		precalcPalette();
-		resetPalette();
-	}
+	precalcPalette();
+	resetPalette();
 }
 
 } // namespace openmsx
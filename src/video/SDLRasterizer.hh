@@ -6,7 +6,6 @@
 #include "Rasterizer.hh"
 #include "SpriteConverter.hh"
 
-#include "Observer.hh"
 
 #include <array>
 #include <cstdint>
@@ -20,14 +19,12 @@ class VDPVRAM;
 class OutputSurface;
 class RawFrame;
 class RenderSettings;
-class Setting;
 class PostProcessor;
 
 /** Rasterizer using a frame buffer approach: it writes pixels to a single
   * rectangular pixel buffer.
   */
 class SDLRasterizer final : public Rasterizer
-                          , private Observer<Setting>
 {
 public:
 	using Pixel = uint32_t;
@@ -52,6 +49,7 @@ public:
 	void setDisplayMode(DisplayMode mode) override;
 	void setPalette(unsigned index, int grb) override;
 	void setBackgroundColor(uint8_t index) override;
+	void resetHostPalette() override;
 	void setHorizontalAdjust(int adjust) override;
 	void setHorizontalScrollLow(uint8_t scroll) override;
 	void setBorderMask(bool masked) override;
@@ -66,6 +64,7 @@ public:
 		int fromX, int fromY,
 		int displayX, int displayY,
 		int displayWidth, int displayHeight) override;
+	void copyLastFrame(int fromY, int limitY) override;
 	[[nodiscard]] bool isRecording() const override;
 
 private:
@@ -91,9 +90,6 @@ private:
 	// Get the border color(s). These are 16bpp or 32bpp host pixels.
 	std::pair<Pixel, Pixel> getBorderColors();
 
-	// Observer<Setting>
-	void update(const Setting& setting) noexcept override;
-
 private:
 	/** The VDP of which the video output is being rendered.
 	  */
@@ -40,6 +40,7 @@ void SpriteChecker::reset(EmuTime time)
 	frameStart(time);
 
 	updateSpritesMethod = &SpriteChecker::updateSprites1;
+	invalidateCache();
 }
 
 inline SpriteChecker::SpritePattern SpriteChecker::calculatePatternNP(
@@ -84,7 +85,29 @@ void SpriteChecker::updateSprites1(int limit)
 	currentLine = limit;
 }
 
-inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
+bool SpriteChecker::isCached(int firstDisplayLine, int num) const
+{
+	return std::ranges::all_of(xrange(num), [&](int line) {
+		return lineCache[(firstDisplayLine + line) & 0xFF].generation == cacheGeneration;
+	});
+}
+
+int SpriteChecker::copyFromCache(int minLine, int maxLine, int displayDelta)
+{
+	int limitSprite = -1;
+	for (auto line : xrange(minLine, maxLine)) {
+		const auto& cached = lineCache[(line + displayDelta) & 0xFF];
+		assert(cached.generation == cacheGeneration);
+		// +1 to also copy the sentinel
+		copy_to_range(subspan(cached.sprites, 0, cached.count + 1), spriteBuffer[line]);
+		spriteCount[line] = cached.count;
+		// Find earliest line where the limit is exceeded.
+		if (limitSprite == -1) limitSprite = cached.limitSprite;
+	}
+	return limitSprite;
+}
+
+inline void SpriteChecker::fillCache1(int firstDisplayLine, int num)
 {
 	// This implementation contains a double for-loop. The outer loop goes
 	// over the sprites, the inner loop over the to-be-checked lines. This
@@ -100,31 +123,29 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	// This routine also needs to detect the sprite number of the 'first'
 	// 5th-sprite-condition. With 'first' meaning the first line where this
 	// condition occurs. Because our loops are swapped compared to the real
-	// VDP, we need some extra fixup logic to correctly detect this.
-
-	// Calculate display line.
-	// This is the line sprites are checked at; the line they are displayed
-	// at is one lower.
-	int displayDelta = vdp.getVerticalScroll() - vdp.getLineZero();
+	// VDP, we store the sprite number per line, copyFromCache() then
+	// picks the first line.
+	assert(num <= 256);
+	for (auto line : xrange(num)) {
+		auto& cached = lineCache[(firstDisplayLine + line) & 0xFF];
+		cached.count = 0;
+		cached.limitSprite = -1;
+	}
 
-	// Get sprites for this line and detect 5th sprite if any.
-	bool limitSprites = limitSpritesSetting.getBoolean();
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
 	int magSize = (mag + 1) * size;
 	auto attributePtr = vram.spriteAttribTable.getReadArea<32 * 4>(0);
 	uint8_t patternIndexMask = size == 16 ? 0xFC : 0xFF;
-	int fifthSpriteNum  = -1;  // no 5th sprite detected yet
-	int fifthSpriteLine = 999; // larger than any possible valid line
 
 	int sprite = 0;
 	for (/**/; sprite < 32; ++sprite) {
 		int y = attributePtr[4 * sprite + 0];
 		if (y == 208) break;
 
-		for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
+		for (int line = 0; line < num; ++line) { // 'line' changes in loop
 			// Calculate line number within the sprite.
-			int displayLine = line + displayDelta;
+			int displayLine = firstDisplayLine + line;
 			int spriteLine = (displayLine - y) & 0xFF;
 			if (spriteLine >= magSize) {
 				// Skip ahead till sprite becomes visible.
@@ -132,17 +153,16 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 				continue;
 			}
 
-			auto visibleIndex = spriteCount[line];
+			auto& cached = lineCache[displayLine & 0xFF];
+			auto visibleIndex = cached.count;
 			if (visibleIndex == 4) {
-				// Find earliest line where this condition occurs.
-				if (line < fifthSpriteLine) {
-					fifthSpriteLine = line;
-					fifthSpriteNum = sprite;
+				if (cached.limitSprite == -1) {
+					cached.limitSprite = narrow<int8_t>(sprite);
 				}
-				if (limitSprites) continue;
+				if (cacheLimitSprites) continue;
 			}
 
-			SpriteInfo& sip = spriteBuffer[line][visibleIndex];
+			SpriteInfo& sip = cached.sprites[visibleIndex];
 			int patternIndex = attributePtr[4 * sprite + 2] & patternIndexMask;
 			if (mag) spriteLine /= 2;
 			sip.pattern = calculatePatternNP(patternIndex, spriteLine);
@@ -151,10 +171,40 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 			if (colorAttrib & 0x80) sip.x -= 32;
 			sip.colorAttrib = colorAttrib;
 
-			spriteCount[line] = visibleIndex + 1;
+			cached.count = visibleIndex + 1;
 		}
 	}
 
+	for (auto line : xrange(num)) {
+		auto& cached = lineCache[(firstDisplayLine + line) & 0xFF];
+		cached.sprites[cached.count].colorAttrib = 0; // sentinel
+		cached.generation = cacheGeneration;
+	}
+	cacheSpriteEnd = sprite;
+}
+
+inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
+{
+	// Calculate display line.
+	// This is the line sprites are checked at; the line they are displayed
+	// at is one lower.
+	int displayDelta = vdp.getVerticalScroll() - vdp.getLineZero();
+
+	// Get sprites for this line and detect 5th sprite if any.
+	if (bool limitSprites = limitSpritesSetting.getBoolean();
+	    limitSprites != cacheLimitSprites) {
+		cacheLimitSprites = limitSprites;
+		invalidateCache();
+	}
+	int firstDisplayLine = minLine + displayDelta;
+	int numLines = std::min(maxLine - minLine, 256); // display lines wrap
+	if (!isCached(firstDisplayLine, numLines)) {
+		fillCache1(firstDisplayLine, numLines);
+	}
+	int fifthSpriteNum = copyFromCache(minLine, maxLine, displayDelta);
+	int sprite = cacheSpriteEnd;
+	int magSize = (vdp.isSpriteMag() + 1) * vdp.getSpriteSize();
+
 	// Update status register.
 	uint8_t status = vdp.getStatusReg0();
 	if (fifthSpriteNum != -1) {
@@ -260,23 +310,20 @@ void SpriteChecker::updateSprites2(int limit)
 	currentLine = limit;
 }
 
-inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
+inline void SpriteChecker::fillCache2(int firstDisplayLine, int num)
 {
-	// See comment in checkSprites1() about order of inner and outer loops.
-
-	// Calculate display line.
-	// This is the line sprites are checked at; the line they are displayed
-	// at is one lower.
-	int displayDelta = vdp.getVerticalScroll() - vdp.getLineZero();
+	// See comment in fillCache1() about order of inner and outer loops.
+	assert(num <= 256);
+	for (auto line : xrange(num)) {
+		auto& cached = lineCache[(firstDisplayLine + line) & 0xFF];
+		cached.count = 0;
+		cached.limitSprite = -1;
+	}
 
-	// Get sprites for this line and detect 5th sprite if any.
-	bool limitSprites = limitSpritesSetting.getBoolean();
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
 	int magSize = (mag + 1) * size;
 	int patternIndexMask = (size == 16) ? 0xFC : 0xFF;
-	int ninthSpriteNum  = -1;  // no 9th sprite detected yet
-	int ninthSpriteLine = 999; // larger than any possible valid line
 
 	// Because it gave a measurable performance boost, we duplicated the
 	// code for planar and non-planar modes.
@@ -289,9 +336,9 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 			int y = attributePtr0[2 * sprite + 0];
 			if (y == 216) break;
 
-			for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
+			for (int line = 0; line < num; ++line) { // 'line' changes in loop
 				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
+				int displayLine = firstDisplayLine + line;
 				int spriteLine = (displayLine - y) & 0xFF;
 				if (spriteLine >= magSize) {
 					// Skip ahead till sprite is visible.
@@ -299,14 +346,13 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 					continue;
 				}
 
-				auto visibleIndex = spriteCount[line];
+				auto& cached = lineCache[displayLine & 0xFF];
+				auto visibleIndex = cached.count;
 				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
-						ninthSpriteNum = sprite;
+					if (cached.limitSprite == -1) {
+						cached.limitSprite = narrow<int8_t>(sprite);
 					}
-					if (limitSprites) continue;
+					if (cacheLimitSprites) continue;
 				}
 
 				if (mag) spriteLine /= 2;
@@ -314,16 +360,14 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 				uint8_t colorAttrib =
 					vram.spriteAttribTable.readPlanar(colorIndex);
 
-				SpriteInfo& sip = spriteBuffer[line][visibleIndex];
+				SpriteInfo& sip = cached.sprites[visibleIndex];
 				int patternIndex = attributePtr0[2 * sprite + 1] & patternIndexMask;
 				sip.pattern = calculatePatternPlanar(patternIndex, spriteLine);
 				sip.x = attributePtr1[2 * sprite + 0];
 				if (colorAttrib & 0x80) sip.x -= 32;
 				sip.colorAttrib = colorAttrib;
 
-				// set sentinel (see below)
-				spriteBuffer[line][visibleIndex + 1].colorAttrib = 0;
-				spriteCount[line] = visibleIndex + 1;
+				cached.count = visibleIndex + 1;
 			}
 		}
 	} else {
@@ -334,9 +378,9 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 			int y = attributePtr0[4 * sprite + 0];
 			if (y == 216) break;
 
-			for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
+			for (int line = 0; line < num; ++line) { // 'line' changes in loop
 				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
+				int displayLine = firstDisplayLine + line;
 				int spriteLine = (displayLine - y) & 0xFF;
 				if (spriteLine >= magSize) {
 					// Skip ahead till sprite is visible.
@@ -344,14 +388,13 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 					continue;
 				}
 
-				auto visibleIndex = spriteCount[line];
+				auto& cached = lineCache[displayLine & 0xFF];
+				auto visibleIndex = cached.count;
 				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
-						ninthSpriteNum = sprite;
+					if (cached.limitSprite == -1) {
+						cached.limitSprite = narrow<int8_t>(sprite);
 					}
-					if (limitSprites) continue;
+					if (cacheLimitSprites) continue;
 				}
 
 				if (mag) spriteLine /= 2;
@@ -364,27 +407,50 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 				// filter them here. See also
 				//    https://github.com/openMSX/openMSX/issues/497
 
-				SpriteInfo& sip = spriteBuffer[line][visibleIndex];
+				SpriteInfo& sip = cached.sprites[visibleIndex];
 				int patternIndex = attributePtr0[4 * sprite + 2] & patternIndexMask;
 				sip.pattern = calculatePatternNP(patternIndex, spriteLine);
 				sip.x = attributePtr0[4 * sprite + 1];
 				if (colorAttrib & 0x80) sip.x -= 32;
 				sip.colorAttrib = colorAttrib;
 
-				// Set sentinel. Sentinel is actually only
-				// needed for sprites with CC=1.
-				// In the past we set the sentinel (for all
-				// lines) at the end. But it's slightly faster
-				// to do it only for lines that actually
-				// contain sprites (even if sentinel gets
-				// overwritten a couple of times for lines with
-				// many sprites).
-				spriteBuffer[line][visibleIndex + 1].colorAttrib = 0;
-				spriteCount[line] = visibleIndex + 1;
+				cached.count = visibleIndex + 1;
 			}
 		}
 	}
 
+	// Set sentinel, it's needed for sprites with CC=1 (see
+	// SpriteConverter::drawMode2()).
+	for (auto line : xrange(num)) {
+		auto& cached = lineCache[(firstDisplayLine + line) & 0xFF];
+		cached.sprites[cached.count].colorAttrib = 0;
+		cached.generation = cacheGeneration;
+	}
+	cacheSpriteEnd = sprite;
+}
+
+inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
+{
+	// Calculate display line.
+	// This is the line sprites are checked at; the line they are displayed
+	// at is one lower.
+	int displayDelta = vdp.getVerticalScroll() - vdp.getLineZero();
+
+	// Get sprites for this line and detect 9th sprite if any.
+	if (bool limitSprites = limitSpritesSetting.getBoolean();
+	    limitSprites != cacheLimitSprites) {
+		cacheLimitSprites = limitSprites;
+		invalidateCache();
+	}
+	int firstDisplayLine = minLine + displayDelta;
+	int numLines = std::min(maxLine - minLine, 256); // display lines wrap
+	if (!isCached(firstDisplayLine, numLines)) {
+		fillCache2(firstDisplayLine, numLines);
+	}
+	int ninthSpriteNum = copyFromCache(minLine, maxLine, displayDelta);
+	int sprite = cacheSpriteEnd;
+	int magSize = (vdp.isSpriteMag() + 1) * vdp.getSpriteSize();
+
 	// Update status register.
 	uint8_t status = vdp.getStatusReg0();
 	if (ninthSpriteNum != -1) {
@@ -499,6 +565,7 @@ void SpriteChecker::serialize(Archive& ar, unsigned version)
 		// first (partial) frame after loadstate.
 		std::ranges::fill(spriteCount, 0);
 		// content of spriteBuffer[] doesn't matter if spriteCount[] is 0
+		invalidateCache();
 	}
 	ar.serialize("collisionX", collisionX,
 	             "collisionY", collisionY);
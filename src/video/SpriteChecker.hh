@@ -115,6 +115,7 @@ public:
 	void updateDisplayMode(DisplayMode mode, EmuTime time) {
 		sync(time);
 		setDisplayMode(mode);
+		invalidateCache();
 
 		// The following is only required when switching from sprite
 		// mode0 to some other mode (in other case it has no effect).
@@ -158,7 +159,7 @@ public:
 	void updateSpriteSizeMag(uint8_t sizeMag, EmuTime time) {
 		(void)sizeMag;
 		sync(time);
-		// TODO: Precalc something?
+		invalidateCache();
 	}
 
 	/** Informs the sprite checker of a change in the TP bit (R#8 bit 5)
@@ -177,7 +178,8 @@ public:
 	void updateVerticalScroll(int scroll, EmuTime time) {
 		(void)scroll;
 		sync(time);
-		// TODO: Precalc something?
+		// No need to invalidate the cache, it's indexed on the line
+		// number in the sprite coordinate system.
 	}
 
 	/** Update sprite checking until specified line.
@@ -267,10 +269,12 @@ public:
 
 	void updateVRAM(unsigned /*offset*/, EmuTime time) override {
 		checkUntil(time);
+		invalidateCache();
 	}
 
 	void updateWindow(bool /*enabled*/, EmuTime time) override {
 		sync(time);
+		invalidateCache();
 	}
 
 	template<typename Archive>
@@ -298,6 +302,27 @@ private:
 		}
 	}
 
+	/** Forget all cached sprite lines. Must be called when anything
+	  * changes that influences which sprites are visible on a line or
+	  * how they look (the sprite tables, their location, sprite size
+	  * and magnification, sprite mode).
+	  */
+	void invalidateCache() {
+		++cacheGeneration;
+	}
+
+	/** Are all lines in the range [firstDisplayLine, firstDisplayLine +
+	  * num) present in the cache? Display lines wrap at 256.
+	  */
+	[[nodiscard]] bool isCached(int firstDisplayLine, int num) const;
+
+	/** Copy the cached sprites of the given lines to spriteBuffer and
+	  * spriteCount.
+	  * @return The number of the sprite that first (in line order)
+	  *         exceeded the sprites-per-line limit, or -1 if none did.
+	  */
+	int copyFromCache(int minLine, int maxLine, int displayDelta);
+
 	/** Calculate sprite patterns for sprite mode 1.
 	  */
 	void updateSprites1(int limit);
@@ -329,6 +354,11 @@ private:
 	  */
 	void checkSprites1(int minLine, int maxLine);
 
+	/** Fill the cache for the given range of display lines, sprite
+	  * mode 1.
+	  */
+	void fillCache1(int firstDisplayLine, int num);
+
 	/** Check sprite collision and number of sprites per line.
 	  * This routine implements sprite mode 2 (MSX2).
 	  * Separated from display code to make MSX behaviour consistent
@@ -341,6 +371,11 @@ private:
 	  */
 	void checkSprites2(int minLine, int maxLine);
 
+	/** Fill the cache for the given range of display lines, sprite
+	  * mode 2.
+	  */
+	void fillCache2(int firstDisplayLine, int num);
+
 private:
 	using UpdateSpritesMethod = void (SpriteChecker::*)(int limit);
 	UpdateSpritesMethod updateSpritesMethod;
@@ -397,6 +432,28 @@ private:
 	  * TODO: Introduce separate update methods for planar/non-planar modes.
 	  */
 	bool planar;
+
+	/** The sprites on a line only depend on the line number within the
+	  * sprite coordinate system (so after vertical scroll), on the
+	  * content of the sprite tables and on some VDP registers. Games
+	  * often don't change sprites for several frames (or only change a
+	  * few of them), so the result of checking a line is cached per
+	  * display line and reused until one of these inputs changes.
+	  */
+	struct CachedLine {
+		std::array<SpriteInfo, 32 + 1> sprites; // +1 for sentinel
+		uint64_t generation = 0; // valid when equal to 'cacheGeneration'
+		uint8_t count;
+		int8_t limitSprite; // first sprite that exceeded the limit, or -1
+	};
+	std::array<CachedLine, 256> lineCache;
+	uint64_t cacheGeneration = 1;
+	/** Number of the sprite that ended the sprite table (Y=208 or
+	  * Y=216), or 32. Calculated together with the cached lines.
+	  */
+	int cacheSpriteEnd = 0;
+	/** Setting 'limitSprites' used to fill the cache. */
+	bool cacheLimitSprites = false;
 };
 SERIALIZE_CLASS_VERSION(SpriteChecker, 2);
 
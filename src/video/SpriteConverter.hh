@@ -12,10 +12,16 @@ TODO:
 
 #include "narrow.hh"
 
+#include <array>
+#include <bit>
 #include <cstdint>
 #include <ranges>
 #include <span>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace openmsx {
 
 /** Utility class for converting VRAM contents to host pixels.
@@ -89,6 +95,62 @@ public:
 		return true; // visible
 	}
 
+	/** Color indices for the 32 pixels starting at 'x' of a sprite with
+	  * color 'color', OR-ed with the colors of the CC=1 sprites that
+	  * follow it (sprite mode 2).
+	  * @param x X-coordinate of the first pixel.
+	  * @param color Color of the sprite with CC=0.
+	  * @param following The sprites following the CC=0 sprite, the list
+	  *     is terminated by a sprite without CC bit (e.g. the sentinel).
+	  */
+	[[nodiscard]] static std::array<uint8_t, 32> mergeColors(
+		int x, uint8_t color, const SpriteChecker::SpriteInfo* following)
+	{
+		// Position the pattern of a following sprite relative to 'x'.
+		auto align = [&](const SpriteChecker::SpriteInfo& info) {
+			int shift = x - info.x;
+			if (shift <= -32 || 32 <= shift) return SpriteChecker::SpritePattern(0);
+			return (shift >= 0) ? (info.pattern << shift) : (info.pattern >> -shift);
+		};
+		std::array<uint8_t, 32> result;
+#ifdef __SSE2__
+		// Expand each pattern bit to a byte mask, 16 pixels at a time.
+		const __m128i bits = _mm_set_epi8(
+			1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+		__m128i lo = _mm_set1_epi8(narrow_cast<char>(color));
+		__m128i hi = lo;
+		for (const auto* info = following; info->colorAttrib & 0x40; ++info) {
+			auto pattern = align(*info);
+			if (!pattern) continue;
+			// bytes in order of the pixels: bits 31-24, 23-16, ...
+			__m128i p = _mm_cvtsi32_si128(narrow_cast<int>(std::byteswap(pattern)));
+			p = _mm_unpacklo_epi8(p, p);     // b0 b0 b1 b1 b2 b2 b3 b3
+			p = _mm_unpacklo_epi16(p, p);    // b0 x4, b1 x4, b2 x4, b3 x4
+			__m128i pLo = _mm_unpacklo_epi32(p, p); // b0 x8, b1 x8
+			__m128i pHi = _mm_unpackhi_epi32(p, p); // b2 x8, b3 x8
+			__m128i mLo = _mm_cmpeq_epi8(_mm_and_si128(pLo, bits), bits);
+			__m128i mHi = _mm_cmpeq_epi8(_mm_and_si128(pHi, bits), bits);
+			__m128i c = _mm_set1_epi8(narrow_cast<char>(info->colorAttrib & 0x0F));
+			lo = _mm_or_si128(lo, _mm_and_si128(mLo, c));
+			hi = _mm_or_si128(hi, _mm_and_si128(mHi, c));
+		}
+		_mm_storeu_si128(std::bit_cast<__m128i*>(&result[ 0]), lo);
+		_mm_storeu_si128(std::bit_cast<__m128i*>(&result[16]), hi);
+#else
+		std::ranges::fill(result, color);
+		for (const auto* info = following; info->colorAttrib & 0x40; ++info) {
+			auto pattern = align(*info);
+			uint8_t c = info->colorAttrib & 0x0F;
+			while (pattern) {
+				auto i = std::countl_zero(pattern);
+				result[i] |= c;
+				pattern &= ~(0x8000'0000u >> i);
+			}
+		}
+#endif
+		return result;
+	}
+
 	/** Draw sprites in sprite mode 1.
 	  * @param absLine Absolute line number.
 	  *     Range is [0..262) for NTSC and [0..313) for PAL.
@@ -169,37 +231,35 @@ public:
 			if (!clipPattern(x, pattern, minX, maxX)) continue;
 			uint8_t c = info.colorAttrib & 0x0F;
 			if (c == 0 && transparency) continue;
+			// Merge in any following CC=1 sprites. Usually there
+			// are none, then all pixels have the same color.
+			const auto* following = &visibleSpritesWithSentinel[i + 1];
+			std::array<uint8_t, 32> colors;
+			if (following->colorAttrib & 0x40) {
+				colors = mergeColors(x, c, following);
+			} else {
+				std::ranges::fill(colors, c);
+			}
 			while (pattern) {
-				if (pattern & 0x8000'0000) {
-					uint8_t color = c;
-					// Merge in any following CC=1 sprites.
-					for (int j = i + 1; /*sentinel*/; ++j) {
-						const SpriteChecker::SpriteInfo& info2 =
-							visibleSpritesWithSentinel[j];
-						if (!(info2.colorAttrib & 0x40)) break;
-						unsigned shift2 = x - info2.x;
-						if ((shift2 < 32) &&
-						   ((info2.pattern << shift2) & 0x8000'0000)) {
-							color |= info2.colorAttrib & 0x0F;
-						}
-					}
-					if constexpr (MODE == DisplayMode::GRAPHIC5) {
-						Pixel pixL = palette[color >> 2];
-						Pixel pixR = palette[color & 3];
-						pixelPtr[x * 2 + 0] = pixL;
-						pixelPtr[x * 2 + 1] = pixR;
+				// Skip over transparent pixels.
+				auto i2 = std::countl_zero(pattern);
+				pattern &= ~(0x8000'0000u >> i2);
+				uint8_t color = colors[i2];
+				int x2 = x + i2;
+				if constexpr (MODE == DisplayMode::GRAPHIC5) {
+					Pixel pixL = palette[color >> 2];
+					Pixel pixR = palette[color & 3];
+					pixelPtr[x2 * 2 + 0] = pixL;
+					pixelPtr[x2 * 2 + 1] = pixR;
+				} else {
+					Pixel pix = palette[color];
+					if constexpr (MODE == DisplayMode::GRAPHIC6) {
+						pixelPtr[x2 * 2 + 0] = pix;
+						pixelPtr[x2 * 2 + 1] = pix;
 					} else {
-						Pixel pix = palette[color];
-						if constexpr (MODE == DisplayMode::GRAPHIC6) {
-							pixelPtr[x * 2 + 0] = pix;
-							pixelPtr[x * 2 + 1] = pix;
-						} else {
-							pixelPtr[x] = pix;
-						}
+						pixelPtr[x2] = pix;
 					}
 				}
-				++x;
-				pattern <<= 1;
 			}
 		}
 	}
@@ -92,6 +92,8 @@ VDP::VDP(const DeviceConfig& config)
 	, msxYPosInfo      (*this)
 	, msxX256PosInfo   (*this)
 	, msxX512PosInfo   (*this)
+	, skippedLinesInfo (*this)
+	, frameSkipInfo    (*this)
 	, frameStartTime(getCurrentTime())
 	, irqVertical  (getMotherBoard(), getName() + ".IRQvertical",   config)
 	, irqHorizontal(getMotherBoard(), getName() + ".IRQhorizontal", config)
@@ -318,6 +320,7 @@ void VDP::resetMasks(EmuTime time)
 
 void VDP::powerUp(EmuTime time)
 {
+	renderer->waitForRendering();
 	vram->clear();
 	reset(time);
 }
@@ -335,6 +338,7 @@ void VDP::reset(EmuTime time)
 	syncCpuVramAccess.removeSyncPoint();
 	syncCmdDone      .removeSyncPoint();
 	pendingCpuAccess = false;
+	renderer->waitForRendering();
 
 	// Reset subsystems.
 	cmdEngine->sync(time);
@@ -1032,6 +1036,9 @@ void VDP::changeRegister(uint8_t reg, uint8_t val, EmuTime time)
 		return;
 	}
 
+	// Not every register change is reported to the renderer.
+	renderer->waitForRendering();
+
 	// Make sure only bits that actually exist are written.
 	val &= controlValueMasks[reg];
 	// Determine the difference between new and old value.
@@ -1910,6 +1917,52 @@ int VDP::MsxX512PosInfo::calc(EmuTime time) const
 }
 
 
+// class SkippedLinesInfo
+
+VDP::SkippedLinesInfo::SkippedLinesInfo(VDP& vdp_)
+	: Info(vdp_, "skipped_lines",
+	       "The number of display lines that were copied from the "
+	       "previous frame instead of being rendered again, because "
+	       "nothing they depend on has changed.")
+{
+}
+
+int VDP::SkippedLinesInfo::calc(EmuTime /*time*/) const
+{
+	return narrow_cast<int>(vdp.renderer->getSkippedLines());
+}
+
+
+// class FrameSkipInfo
+
+VDP::FrameSkipInfo::FrameSkipInfo(VDP& vdp_)
+	: InfoTopic(vdp_.getMotherBoard().getMachineInfoCommand(),
+	            strCat(vdp_.getName(), "_auto_frameskip"))
+	, vdp(vdp_)
+{
+}
+
+void VDP::FrameSkipInfo::execute(std::span<const TclObject> /*tokens*/, TclObject& result) const
+{
+	auto status = vdp.renderer->getFrameSkipStatus();
+	result.addDictKeyValues("frame_time",     status.frameTime,
+	                        "emulation_time", status.emuTime,
+	                        "render_time",    status.renderTime,
+	                        "frameskip",      status.frameSkip,
+	                        "low_accuracy",   status.lowAccuracy);
+}
+
+std::string VDP::FrameSkipInfo::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Measurements and decisions of the 'auto_frameskip' setting, "
+	       "as a dict: the real time duration of one frame, the host "
+	       "time to emulate a frame and the extra host time to render "
+	       "and paint it (all in micro seconds), the selected minimum "
+	       "frameskip and whether the accuracy was lowered from pixel "
+	       "to line (see 'auto_accuracy').";
+}
+
+
 // version 1: initial version
 // version 2: added frameCount
 // version 3: removed verticalAdjust
@@ -1923,6 +1976,9 @@ int VDP::MsxX512PosInfo::calc(EmuTime time) const
 template<typename Archive>
 void VDP::serialize(Archive& ar, unsigned serVersion)
 {
+	if constexpr (Archive::IS_LOADER) {
+		renderer->waitForRendering();
+	}
 	ar.template serializeBase<MSXDevice>(*this);
 
 	if (ar.versionAtLeast(serVersion, 8)) {
@@ -1157,6 +1157,19 @@ private:
 		[[nodiscard]] int calc(EmuTime time) const override;
 	} msxX512PosInfo;
 
+	struct SkippedLinesInfo final : Info {
+		explicit SkippedLinesInfo(VDP& vdp);
+		[[nodiscard]] int calc(EmuTime time) const override;
+	} skippedLinesInfo;
+
+	struct FrameSkipInfo final : InfoTopic {
+		explicit FrameSkipInfo(VDP& vdp);
+		void execute(std::span<const TclObject> tokens,
+		             TclObject& result) const override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		VDP& vdp;
+	} frameSkipInfo;
+
 	/** Renderer that converts this VDP's state into an image.
 	  */
 	std::unique_ptr<Renderer> renderer;
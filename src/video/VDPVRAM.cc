@@ -3,9 +3,11 @@
 #include "Renderer.hh"
 #include "SpriteChecker.hh"
 
+#include "narrow.hh"
 #include "outer.hh"
 #include "ranges.hh"
 #include "serialize.hh"
+#include "xrange.hh"
 
 #include <algorithm>
 #include <array>
@@ -58,6 +60,24 @@ uint8_t VDPVRAM::LogicalVRAMDebuggable::read(unsigned address, EmuTime time)
 	return vram.cpuRead(transform(address), time);
 }
 
+void VDPVRAM::LogicalVRAMDebuggable::readBlock(unsigned start, std::span<uint8_t> output)
+{
+	// Unlike read(), sync the command engine only once, and don't steal
+	// VRAM access slots (reading via the debugger shouldn't influence the
+	// emulation).
+	auto& vram = OUTER(VDPVRAM, logicalVRAMDebug);
+	vram.sync(getMotherBoard().getCurrentTime());
+	if (vram.vdp.getDisplayMode().isPlanar()) {
+		for (auto i : xrange(output.size())) {
+			output[i] = vram.data[transform(narrow<unsigned>(start + i)) & vram.sizeMask];
+		}
+	} else {
+		for (auto i : xrange(output.size())) {
+			output[i] = vram.data[(start + i) & vram.sizeMask];
+		}
+	}
+}
+
 void VDPVRAM::LogicalVRAMDebuggable::write(
 	unsigned address, uint8_t value, EmuTime time)
 {
@@ -83,6 +103,14 @@ uint8_t VDPVRAM::PhysicalVRAMDebuggable::read(unsigned address, EmuTime time)
 	return vram.cpuRead(address, time);
 }
 
+std::span<const uint8_t> VDPVRAM::PhysicalVRAMDebuggable::getDirectBlock()
+{
+	// see LogicalVRAMDebuggable::readBlock()
+	auto& vram = OUTER(VDPVRAM, physicalVRAMDebug);
+	vram.sync(getMotherBoard().getCurrentTime());
+	return vram.getData().first(getSize());
+}
+
 void VDPVRAM::PhysicalVRAMDebuggable::write(
 	unsigned address, uint8_t value, EmuTime time)
 {
@@ -640,6 +640,7 @@ private:
 	public:
 		explicit LogicalVRAMDebuggable(const VDP& vdp);
 		[[nodiscard]] uint8_t read(unsigned address, EmuTime time) override;
+		void readBlock(unsigned start, std::span<uint8_t> output) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
 	private:
 		unsigned transform(unsigned address);
@@ -652,6 +653,7 @@ private:
 	struct PhysicalVRAMDebuggable final : SimpleDebuggable {
 		PhysicalVRAMDebuggable(const VDP& vdp, unsigned actualSize);
 		[[nodiscard]] uint8_t read(unsigned address, EmuTime time) override;
+		[[nodiscard]] std::span<const uint8_t> getDirectBlock() override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
 	} physicalVRAMDebug;
 
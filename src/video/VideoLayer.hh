@@ -40,9 +40,13 @@ public:
 	 * specified, the height will be determined based on the available
 	 * widths in the raw frame. The result will be scaled to either
 	 * '320x240' or '640x480' and written to a png file.
+	 * When 'scaled' is true the current scale algorithm (and scanline,
+	 * blur settings) is applied on the CPU, then a height of '720'
+	 * ('960x720') is also allowed.
 	 */
 	virtual void takeRawScreenShot(
-		std::optional<unsigned> height, const std::string& filename) = 0;
+		std::optional<unsigned> height, const std::string& filename,
+		bool scaled) = 0;
 
 	// We used to test whether a Layer is active by looking at the
 	// Z-coordinate (Z_MSX_ACTIVE vs Z_MSX_PASSIVE). Though in case of
@@ -288,6 +288,10 @@ void ZMBVEncoder::addFullFrame(unsigned& workUsed)
 
 const ZMBVEncoder::Pixel* ZMBVEncoder::getScaledLine(const FrameSource* frame, unsigned y, Pixel* workBuf) const
 {
+	if (frame->getHeight() == height) {
+		// Already scaled to the output size (e.g. by SoftwareScaler).
+		return frame->getLine(narrow<int>(y), std::span<uint32_t>(workBuf, width)).data();
+	}
 	switch (height) {
 	case 240:
 		return frame->getLinePtr320_240(y, std::span<uint32_t, 320>(workBuf, 320)).data();
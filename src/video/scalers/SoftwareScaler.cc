@@ -0,0 +1,338 @@
+#include "SoftwareScaler.hh"
+
+#include "RawFrame.hh"
+
+#include "narrow.hh"
+#include "ranges.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <system_error>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace openmsx {
+
+using Pixel = SoftwareScaler::Pixel;
+
+static constexpr unsigned WIDTH = 320;
+static constexpr unsigned HEIGHT = 240;
+static constexpr unsigned MAX_FACTOR = 4;
+static constexpr unsigned MAX_THREADS = 8;
+
+SoftwareScaler::Params SoftwareScaler::getParams(const RenderSettings& settings)
+{
+	return {
+		.algorithm = settings.getScaleAlgorithm(),
+		.blur = settings.getBlurFactor(),
+		.scanline = settings.getScanlineFactor(),
+		.gap = settings.getScanlineGap(),
+	};
+}
+
+SoftwareScaler::SoftwareScaler(std::optional<unsigned> numThreads)
+{
+	unsigned num = numThreads ? *numThreads
+	             : std::min(std::max(std::thread::hardware_concurrency(), 1u), MAX_THREADS) - 1;
+	try {
+		workers.reserve(num);
+		repeat(num, [&] { workers.emplace_back([this] { workerLoop(); }); });
+	} catch (std::system_error&) {
+		// Continue with the threads that could be created (possibly
+		// none). The calling thread always participates.
+	}
+}
+
+SoftwareScaler::~SoftwareScaler()
+{
+	{
+		std::scoped_lock lock(mutex);
+		quit = true;
+	}
+	workCondition.notify_all();
+	for (auto& t : workers) t.join();
+}
+
+void SoftwareScaler::parallelFor(unsigned num, const std::function<void(unsigned)>& job)
+{
+	if (workers.empty()) {
+		for (auto i : xrange(num)) job(i);
+		return;
+	}
+	{
+		std::scoped_lock lock(mutex);
+		currentJob = &job;
+		numJobs = num;
+		nextJob = 0;
+		doneWorkers = 0;
+		++generation;
+	}
+	workCondition.notify_all();
+	runJobs();
+	// Wait till all workers are done, also the ones that didn't get a
+	// job, so that none of them still refers to 'job' after we return.
+	std::unique_lock lock(mutex);
+	doneCondition.wait(lock, [&] { return doneWorkers == workers.size(); });
+	currentJob = nullptr;
+}
+
+void SoftwareScaler::runJobs()
+{
+	while (true) {
+		unsigned i = nextJob.fetch_add(1);
+		if (i >= numJobs) return;
+		(*currentJob)(i);
+	}
+}
+
+void SoftwareScaler::workerLoop()
+{
+	unsigned seen = 0;
+	while (true) {
+		{
+			std::unique_lock lock(mutex);
+			workCondition.wait(lock, [&] { return quit || (generation != seen); });
+			if (quit) return;
+			seen = generation;
+		}
+		runJobs();
+		{
+			std::scoped_lock lock(mutex);
+			++doneWorkers;
+		}
+		doneCondition.notify_one();
+	}
+}
+
+// Multiply the R,G,B components with 'factor'/256, keep alpha.
+static void darken(std::span<Pixel> line, unsigned factor)
+{
+	if (factor >= 256) return;
+	size_t x = 0;
+#ifdef __SSE2__
+	const __m128i f = _mm_set_epi16(256, short(factor), short(factor), short(factor),
+	                                256, short(factor), short(factor), short(factor));
+	const __m128i zero = _mm_setzero_si128();
+	for (; (x + 4) <= line.size(); x += 4) {
+		auto* p = std::bit_cast<__m128i*>(&line[x]);
+		__m128i in = _mm_loadu_si128(p);
+		__m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(in, zero), f), 8);
+		__m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(in, zero), f), 8);
+		_mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for (; x < line.size(); ++x) {
+		Pixel p = line[x];
+		Pixel rb = (((p & 0x00FF00FF) * factor) >> 8) & 0x00FF00FF;
+		Pixel g  = (((p & 0x0000FF00) * factor) >> 8) & 0x0000FF00;
+		line[x] = (p & 0xFF000000) | rb | g;
+	}
+}
+
+// Mix each pixel with its left and right neighbour, in-place.
+static void blur(std::span<Pixel> line, int factor)
+{
+	if ((factor == 0) || (line.size() < 2)) return;
+	auto w0 = unsigned(512 - factor);
+	auto w1 = unsigned(factor / 2);
+	auto mix = [&](Pixel l, Pixel m, Pixel r) {
+		auto comp = [&](unsigned shift) {
+			unsigned c = ((m >> shift) & 0xFF) * w0
+			           + (((l >> shift) & 0xFF) + ((r >> shift) & 0xFF)) * w1;
+			return (c >> 9) << shift;
+		};
+		return (m & 0xFF000000) | comp(0) | comp(8) | comp(16);
+	};
+	Pixel prev = line[0];
+	for (auto x : xrange(line.size() - 1)) {
+		Pixel curr = line[x];
+		line[x] = mix(prev, curr, line[x + 1]);
+		prev = curr;
+	}
+	line.back() = mix(prev, line.back(), line.back());
+}
+
+// Keep one of the R,G,B components per column at full intensity, scale the
+// others with 'factor'/256.
+static void rgbTriplet(std::span<Pixel> line, unsigned factor, unsigned columns)
+{
+	static constexpr std::array<Pixel, 3> masks = {0x000000FF, 0x0000FF00, 0x00FF0000};
+	for (auto x : xrange(line.size())) {
+		Pixel keep = masks[((x % columns) * 3) / columns];
+		Pixel p = line[x];
+		Pixel other = p & 0x00FFFFFF & ~keep;
+		Pixel rb = (((other & 0x00FF00FF) * factor) >> 8) & 0x00FF00FF;
+		Pixel g  = (((other & 0x0000FF00) * factor) >> 8) & 0x0000FF00;
+		line[x] = (p & (0xFF000000 | keep)) | rb | g;
+	}
+}
+
+// One output row of Scale2x, 'half' selects the upper or lower row.
+static void scale2xRow(std::span<const Pixel, WIDTH> above, std::span<const Pixel, WIDTH> mid,
+                       std::span<const Pixel, WIDTH> below, unsigned half, unsigned repeatX,
+                       std::span<Pixel> out)
+{
+	auto put = [&](unsigned x, Pixel p) {
+		repeat(repeatX, [&] { out[x++] = p; });
+		return x;
+	};
+	unsigned o = 0;
+	for (auto x : xrange(WIDTH)) {
+		Pixel b = half ? below[x] : above[x];
+		Pixel h = half ? above[x] : below[x];
+		Pixel d = mid[x ? x - 1 : x];
+		Pixel e = mid[x];
+		Pixel f = mid[(x < WIDTH - 1) ? x + 1 : x];
+		bool edge = (b != h) && (d != f);
+		o = put(o, (edge && (d == b)) ? d : e);
+		o = put(o, (edge && (b == f)) ? f : e);
+	}
+}
+
+// One output row (0..2) of Scale3x (AdvMAME3x).
+static void scale3xRow(std::span<const Pixel, WIDTH> above, std::span<const Pixel, WIDTH> mid,
+                       std::span<const Pixel, WIDTH> below, unsigned row, std::span<Pixel> out)
+{
+	unsigned o = 0;
+	for (auto x : xrange(WIDTH)) {
+		unsigned xl = x ? x - 1 : x;
+		unsigned xr = (x < WIDTH - 1) ? x + 1 : x;
+		Pixel a = above[xl], b = above[x], c = above[xr];
+		Pixel d = mid[xl],   e = mid[x],   f = mid[xr];
+		Pixel g = below[xl], h = below[x], i = below[xr];
+		if ((b == h) || (d == f)) {
+			out[o++] = e; out[o++] = e; out[o++] = e;
+			continue;
+		}
+		switch (row) {
+		case 0:
+			out[o++] = (d == b) ? d : e;
+			out[o++] = (((d == b) && (e != c)) || ((b == f) && (e != a))) ? b : e;
+			out[o++] = (b == f) ? f : e;
+			break;
+		case 1:
+			out[o++] = (((d == b) && (e != g)) || ((d == h) && (e != a))) ? d : e;
+			out[o++] = e;
+			out[o++] = (((b == f) && (e != i)) || ((h == f) && (e != c))) ? f : e;
+			break;
+		default:
+			out[o++] = (d == h) ? d : e;
+			out[o++] = (((d == h) && (e != i)) || ((h == f) && (e != g))) ? h : e;
+			out[o++] = (h == f) ? f : e;
+			break;
+		}
+	}
+}
+
+// Brightness [0..256] of output row 'row' (of 'factor' rows per input line).
+static unsigned scanlineFactor(const SoftwareScaler::Params& params, unsigned factor, unsigned row)
+{
+	if ((factor < 2) || (params.scanline >= 255)) return 256;
+	auto dark = unsigned(params.scanline) + 1;
+	if (params.algorithm != RenderSettings::ScaleAlgorithm::TV) {
+		return (row == factor - 1) ? dark : 256;
+	}
+	// TV: darken the rows away from the center, the gap setting
+	// determines how large that darker region is.
+	if (params.gap <= 0.0f) return 256;
+	float d = std::abs((float(row) + 0.5f) / float(factor) - 0.5f) * 2.0f;
+	float t = std::clamp((d - (1.0f - params.gap)) / params.gap, 0.0f, 1.0f);
+	return 256 - unsigned(float(256 - dark) * t);
+}
+
+void SoftwareScaler::scaleGroup(const FrameSource& src, RawFrame& dst, const Params& params,
+                                unsigned factor, unsigned group) const
+{
+	const unsigned width = WIDTH * factor;
+	auto getDstLine = [&](unsigned row) {
+		unsigned y = group * factor + row;
+		dst.setLineWidth(y, width);
+		return dst.getLineDirect(y).first(width);
+	};
+	auto store = [](std::span<const Pixel> line, std::span<Pixel> out) {
+		if (line.data() != out.data()) copy_to_range(line, out);
+	};
+
+	if (src.getHeight() != HEIGHT) {
+		// Interlaced (or otherwise non-standard) frame, only scale.
+		for (auto row : xrange(factor)) {
+			auto out = getDstLine(row);
+			unsigned y = group * factor + row;
+			switch (factor) {
+			case 1: store(src.getLinePtr320_240(y, out.first<320>()), out); break;
+			case 2: store(src.getLinePtr640_480(y, out.first<640>()), out); break;
+			case 3: store(src.getLinePtr960_720(y, out.first<960>()), out); break;
+			default: store(src.getLine(narrow<int>((y * src.getHeight()) / dst.getHeight()), out), out); break;
+			}
+		}
+		return;
+	}
+
+	auto algo = params.algorithm;
+	if (algo == RenderSettings::ScaleAlgorithm::HQ) {
+		algo = RenderSettings::ScaleAlgorithm::SCALE;
+	}
+	if ((algo == RenderSettings::ScaleAlgorithm::SCALE) &&
+	    ((factor == 1) || (src.getLineWidth(group) > WIDTH))) {
+		// Only defined on (at most) 320 pixel wide lines.
+		algo = RenderSettings::ScaleAlgorithm::SIMPLE;
+	}
+	if ((algo == RenderSettings::ScaleAlgorithm::RGBTRIPLET) && (factor < 3)) {
+		algo = RenderSettings::ScaleAlgorithm::SIMPLE;
+	}
+
+	if (algo == RenderSettings::ScaleAlgorithm::SCALE) {
+		std::array<Pixel, WIDTH> buf0, buf1, buf2;
+		auto above = src.getLinePtr320_240(group ? group - 1 : group, buf0);
+		auto mid   = src.getLinePtr320_240(group, buf1);
+		auto below = src.getLinePtr320_240(std::min(group + 1, HEIGHT - 1), buf2);
+		for (auto row : xrange(factor)) {
+			auto out = getDstLine(row);
+			if (factor == 3) {
+				scale3xRow(above, mid, below, row, out);
+			} else {
+				scale2xRow(above, mid, below, (2 * row) / factor, factor / 2, out);
+			}
+		}
+		return;
+	}
+
+	// SIMPLE, TV and RGBTRIPLET: first make the full-brightness row, then
+	// copy it to the other rows and apply the scanlines.
+	auto first = getDstLine(0);
+	store(src.getLine(narrow<int>(group), first), first);
+	if (factor >= 2) {
+		blur(first, params.blur);
+	}
+	if (algo == RenderSettings::ScaleAlgorithm::RGBTRIPLET) {
+		rgbTriplet(first, unsigned(params.blur), factor);
+	}
+	for (auto row : xrange(1u, factor)) {
+		copy_to_range(first, getDstLine(row));
+	}
+	for (auto row : xrange(factor)) {
+		darken(dst.getLineDirect(group * factor + row).first(width),
+		       scanlineFactor(params, factor, row));
+	}
+}
+
+void SoftwareScaler::scaleImage(const FrameSource& src, RawFrame& dst, const Params& params)
+{
+	assert((src.getHeight() == HEIGHT) || (src.getHeight() == 2 * HEIGHT));
+	unsigned factor = dst.getHeight() / HEIGHT;
+	assert((factor >= 1) && (factor <= MAX_FACTOR));
+	assert(dst.getHeight() == factor * HEIGHT);
+
+	std::function<void(unsigned)> job = [&](unsigned group) {
+		scaleGroup(src, dst, params, factor, group);
+	};
+	parallelFor(HEIGHT, job);
+}
+
+} // namespace openmsx
@@ -0,0 +1,92 @@
+#ifndef SOFTWARESCALER_HH
+#define SOFTWARESCALER_HH
+
+#include "RenderSettings.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+class FrameSource;
+class RawFrame;
+
+/** CPU implementation of the scale algorithms, for images that are not
+  * painted via openGL, e.g. for video recording and screenshots.
+  *
+  * The result approximates the GL scalers:
+  *  - SIMPLE:     pixel replication, horizontal blur and scanlines
+  *  - SCALE:      Scale2x (also for factor 4) or Scale3x
+  *  - HQ:         not available on the CPU, uses SCALE instead
+  *  - RGBTRIPLET: red, green and blue sub-pixel columns (factor >= 3)
+  *  - TV:         horizontal blur and scanlines with a smooth gap
+  * Frames with 480 lines (interlace) are only scaled, without effects.
+  *
+  * The output lines are processed in groups (all the output lines of one
+  * input line), which are divided over a set of worker threads.
+  */
+class SoftwareScaler
+{
+public:
+	using Pixel = uint32_t;
+
+	struct Params {
+		RenderSettings::ScaleAlgorithm algorithm = RenderSettings::ScaleAlgorithm::SIMPLE;
+		int blur = 0;       // [0..256], see RenderSettings::getBlurFactor()
+		int scanline = 255; // [0..255] brightness of the scanline gap, 255 -> no scanlines
+		float gap = 0.0f;   // [0..1], see RenderSettings::getScanlineGap()
+	};
+
+	/** The parameters as currently selected by the user. */
+	[[nodiscard]] static Params getParams(const RenderSettings& settings);
+
+	/** @param numThreads Number of extra worker threads. By default one
+	  *     less than the number of CPU cores (with a maximum).
+	  */
+	explicit SoftwareScaler(std::optional<unsigned> numThreads = {});
+	SoftwareScaler(const SoftwareScaler&) = delete;
+	SoftwareScaler(SoftwareScaler&&) = delete;
+	SoftwareScaler& operator=(const SoftwareScaler&) = delete;
+	SoftwareScaler& operator=(SoftwareScaler&&) = delete;
+	~SoftwareScaler();
+
+	/** Scale a frame of 240 or 480 lines.
+	  * @param src The frame to scale.
+	  * @param dst Gets 'factor' x 240 lines of 'factor' x 320 pixels,
+	  *     with 'factor' in range [1..4]. Its height determines the factor.
+	  * @param params The scale algorithm and its parameters.
+	  */
+	void scaleImage(const FrameSource& src, RawFrame& dst, const Params& params);
+
+	[[nodiscard]] unsigned getNumThreads() const { return unsigned(workers.size()); }
+
+private:
+	void scaleGroup(const FrameSource& src, RawFrame& dst, const Params& params,
+	                unsigned factor, unsigned group) const;
+	void parallelFor(unsigned num, const std::function<void(unsigned)>& job);
+	void runJobs();
+	void workerLoop();
+
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable workCondition; // new jobs or quit
+	std::condition_variable doneCondition; // all workers finished
+	const std::function<void(unsigned)>* currentJob = nullptr; // protected by mutex
+	unsigned numJobs = 0; // protected by mutex
+	std::atomic<unsigned> nextJob = 0;
+	unsigned generation = 0; // protected by mutex
+	unsigned doneWorkers = 0; // protected by mutex
+	bool quit = false; // protected by mutex
+};
+
+} // namespace openmsx
+
+#endif
@@ -14,14 +14,18 @@
 
 #include "checked_cast.hh"
 #include "narrow.hh"
+#include "ranges.hh"
 #include "stl.hh"
 #include "unreachable.hh"
 #include "xrange.hh"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <iostream>
 #include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace openmsx {
 
@@ -701,6 +705,178 @@ inline void V9990CmdEngine::V9990Bpp16::psetColor(
 	vram.writeVRAMDirect(addr + 0x40000, narrow_cast<uint8_t>(result >> 8));
 }
 
+// Bulk operations ----------------------------------------------------
+// These work on complete VRAM bytes and calculate the logical operation
+// with bitwise operations instead of via logOpLUT, so that the compiler can
+// vectorize the loops. The result is the same as with pset().
+
+// Same as the non-transparent logOpLUT (only the lower 4 bits of 'op').
+[[nodiscard]] static constexpr uint8_t logOpBits(unsigned op, uint8_t src, uint8_t dst)
+{
+	unsigned res = 0;
+	if (op & 1) res |= ~src & ~dst;
+	if (op & 2) res |= ~src &  dst;
+	if (op & 4) res |=  src & ~dst;
+	if (op & 8) res |=  src &  dst;
+	return uint8_t(res);
+}
+
+// The bits of the pixels in 'src' that are not transparent (not zero).
+template<unsigned BPP>
+[[nodiscard]] static constexpr uint8_t opaqueMask(uint8_t src)
+{
+	unsigned m = src;
+	for (unsigned s = 1; s < BPP; s *= 2) m |= m >> s;
+	constexpr unsigned ONES = (1 << BPP) - 1;
+	return uint8_t((m & (0xFF / ONES)) * ONES);
+}
+
+// Same as the 2, 4 or 8 bpp logOpLUT (both transparent and not), combined
+// with the write mask.
+template<unsigned BPP>
+[[nodiscard]] static constexpr uint8_t logOpByte(unsigned op, uint8_t src, uint8_t dst, uint8_t mask)
+{
+	if (op & 0x10) mask &= opaqueMask<BPP>(src);
+	return uint8_t((dst & ~mask) | (logOpBits(op, src, dst) & mask));
+}
+
+// Apply a logical operation with a constant source byte. Transparency must
+// already be applied to 'mask'.
+static void fillBytes(std::span<uint8_t> dst, unsigned op, uint8_t src, uint8_t mask)
+{
+	// per bit: the result for a destination bit that is 1 resp. 0
+	auto ifOne  = uint8_t(((op & 2) ? ~src : 0) | ((op & 8) ? src : 0));
+	auto ifZero = uint8_t(((op & 1) ? ~src : 0) | ((op & 4) ? src : 0));
+	auto keep = uint8_t(~mask | ifOne);
+	auto set  = uint8_t(mask & ifZero);
+	for (auto& d : dst) {
+		d = uint8_t((d & keep) | (~d & set));
+	}
+}
+
+// @pre 'src' and 'dst' don't overlap
+template<unsigned BPP>
+static void copyBytes(std::span<const uint8_t> src, std::span<uint8_t> dst, unsigned op, uint8_t mask)
+{
+	assert(src.size() == dst.size());
+	for (auto i : xrange(dst.size())) {
+		dst[i] = logOpByte<BPP>(op, src[i], dst[i], mask);
+	}
+}
+
+// 16bpp pixels are stored as a low byte in the first and a high byte in the
+// second bank. A pixel is only transparent when both bytes are zero.
+// @pre 'src' and 'dst' don't overlap
+static void copyPixels16(std::span<uint8_t> vram, unsigned srcAddr, unsigned dstAddr,
+                         unsigned num, unsigned op, uint16_t mask)
+{
+	auto srcLo = vram.subspan(srcAddr + 0x00000, num);
+	auto srcHi = vram.subspan(srcAddr + 0x40000, num);
+	auto dstLo = vram.subspan(dstAddr + 0x00000, num);
+	auto dstHi = vram.subspan(dstAddr + 0x40000, num);
+	auto maskLo = uint8_t(mask & 0xFF);
+	auto maskHi = uint8_t(mask >> 8);
+	bool transp = (op & 0x10) != 0;
+	for (auto i : xrange(num)) {
+		auto visible = uint8_t((!transp || (srcLo[i] | srcHi[i])) ? 0xFF : 0x00);
+		dstLo[i] = logOpByte<8>(op & 0x0F, srcLo[i], dstLo[i], maskLo & visible);
+		dstHi[i] = logOpByte<8>(op & 0x0F, srcHi[i], dstHi[i], maskHi & visible);
+	}
+}
+
+// In the Bx modes consecutive VRAM addresses alternate between the two
+// banks. Call 'f(bank, first, num)' for the addresses in [addr, addr + num)
+// of each bank, with 'first' the first (logical) address in that bank. The
+// physical addresses of those are consecutive (transformBx()).
+template<typename F>
+static void forEachBank(unsigned addr, unsigned num, F f)
+{
+	for (unsigned bank : {0u, 1u}) {
+		unsigned first = addr + ((addr ^ bank) & 1);
+		unsigned end = addr + num;
+		if (first < end) f(bank, first, (end - first + 1) / 2);
+	}
+}
+
+#ifdef DEBUG
+// Compare the bulk operations with the logOpLUT based (per pixel) versions,
+// for all 32 LOG values, with a full and with a partial write mask.
+template<unsigned BPP>
+static void checkBulkLogOp(Log mode)
+{
+	std::array<uint8_t, 256> srcBuf, dst;
+	for (unsigned op : xrange(32)) {
+		auto lut = getLogOpImpl((op & 0x10) ? mode : Log::NO_T, op);
+		for (uint8_t mask : {uint8_t(0xFF), uint8_t(0x5A), uint8_t(0x00)}) {
+			for (unsigned src : xrange(256)) {
+				auto src8 = uint8_t(src);
+				auto expected = [&](unsigned d) {
+					return uint8_t((d & ~mask) | (lut[256 * d + src] & mask));
+				};
+				std::ranges::fill(srcBuf, src8);
+				ranges::iota(dst, uint8_t(0));
+				copyBytes<BPP>(srcBuf, dst, op, mask);
+				for (unsigned d : xrange(256)) {
+					assert(dst[d] == expected(d));
+				}
+				ranges::iota(dst, uint8_t(0));
+				auto fillMask = (op & 0x10) ? uint8_t(mask & opaqueMask<BPP>(src8)) : mask;
+				fillBytes(dst, op, src8, fillMask);
+				for (unsigned d : xrange(256)) {
+					assert(dst[d] == expected(d));
+				}
+			}
+		}
+	}
+}
+
+static void checkBulkLogOp16()
+{
+	// Source pixels with a zero low and/or high byte and destination pixels
+	// with all values in both bytes.
+	static constexpr unsigned NUM = 256;
+	static constexpr unsigned SRC = 0x100;
+	static constexpr unsigned DST = 0x200;
+	std::vector<uint8_t> vram(0x80000);
+	for (unsigned op : xrange(32)) {
+		auto lut = getLogOpImpl(Log::NO_T, op);
+		for (uint16_t mask : {uint16_t(0xFFFF), uint16_t(0xA5F0), uint16_t(0x0F3C)}) {
+			for (unsigned seed : xrange(256)) {
+				std::array<uint16_t, NUM> srcPix, dstPix;
+				for (unsigned i : xrange(NUM)) {
+					auto lo = uint8_t((i & 1) ? 0 : (i ^ seed));
+					auto hi = uint8_t((i & 2) ? 0 : (i * 7 + seed));
+					srcPix[i] = uint16_t(lo + 256 * hi);
+					dstPix[i] = uint16_t((i ^ (seed * 3)) + 256 * (i + seed));
+					vram[SRC + i + 0x00000] = lo;
+					vram[SRC + i + 0x40000] = hi;
+					vram[DST + i + 0x00000] = uint8_t(dstPix[i] & 0xFF);
+					vram[DST + i + 0x40000] = uint8_t(dstPix[i] >> 8);
+				}
+				copyPixels16(vram, SRC, DST, NUM, op, mask);
+				for (unsigned i : xrange(NUM)) {
+					// same as V9990Bpp16::logOp()
+					auto newPix = ((op & 0x10) && (srcPix[i] == 0)) ? dstPix[i] : uint16_t(
+						lut[256 * (dstPix[i] & 0xFF) + (srcPix[i] & 0xFF)] +
+						lut[256 * (dstPix[i] >> 8)   + (srcPix[i] >> 8)] * 256);
+					auto expected = uint16_t((dstPix[i] & ~mask) | (newPix & mask));
+					assert(vram[DST + i + 0x00000] == (expected & 0xFF));
+					assert(vram[DST + i + 0x40000] == (expected >> 8));
+				}
+			}
+		}
+	}
+}
+
+static void checkBulkLogOps()
+{
+	checkBulkLogOp<2>(Log::BPP2);
+	checkBulkLogOp<4>(Log::BPP4);
+	checkBulkLogOp<8>(Log::BPP8);
+	checkBulkLogOp16();
+}
+#endif
+
 // ====================================================================
 /** Constructor
   */
@@ -726,6 +902,14 @@ V9990CmdEngine::V9990CmdEngine(V9990& vdp_, EmuTime time_,
 	WM = fgCol = bgCol = 0;
 	ARG = LOG = 0;
 	data = bitsLeft = partial = 0;
+
+#ifdef DEBUG
+	static bool bulkLogOpsChecked = false;
+	if (!bulkLogOpsChecked) {
+		checkBulkLogOps();
+		bulkLogOpsChecked = true;
+	}
+#endif
 }
 
 V9990CmdEngine::~V9990CmdEngine()
@@ -954,6 +1138,120 @@ void V9990CmdEngine::update(const Setting& setting) noexcept
 	brokenTiming = checked_cast<const EnumSetting<bool>&>(setting).getEnum();
 }
 
+unsigned V9990CmdEngine::pixelsUntil(EmuTime limit, EmuDuration delta) const
+{
+	// Same as a loop that executes one pixel per 'delta' while
+	// 'engineTime < limit'.
+	if (engineTime >= limit) return 0;
+	unsigned remaining = ANX + (ANY - 1) * getWrappedNX();
+	auto available = limit - engineTime;
+	if (available > delta * remaining) return remaining;
+	return available.divUp(delta);
+}
+
+template<typename Mode>
+void V9990CmdEngine::fillRow(unsigned num, unsigned pitch, std::span<const uint8_t, 256 * 256> lut)
+{
+	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
+	// For a fill the order of the pixels doesn't matter, start at the left.
+	auto left = (ARG & DIX) ? uint16_t(DX - (num - 1)) : DX;
+
+	if constexpr (Mode::BITS_PER_PIXEL == 16) {
+		unsigned x = left & (pitch - 1);
+		if ((x + num) <= pitch) { // doesn't wrap
+			if ((LOG & 0x10) && (fgCol == 0)) return; // transparent
+			auto vram_ = vram.getWriteBackdoor();
+			auto addr = Mode::addressOf(x, DY, pitch);
+			fillBytes(vram_.subspan(addr + 0x00000, num), LOG, uint8_t(fgCol & 0xFF), uint8_t(WM & 0xFF));
+			fillBytes(vram_.subspan(addr + 0x40000, num), LOG, uint8_t(fgCol >> 8),   uint8_t(WM >> 8));
+			return;
+		}
+	} else if constexpr (!std::is_same_v<Mode, V9990P1> && !std::is_same_v<Mode, V9990P2>) {
+		constexpr unsigned PPB = Mode::PIXELS_PER_BYTE;
+		unsigned width = pitch * PPB;
+		unsigned x = left & (width - 1);
+		// complete bytes in the middle, single pixels at both ends
+		unsigned b0 = (x + PPB - 1) / PPB;
+		unsigned b1 = (x + num) / PPB;
+		if (((x + num) <= width) && (b0 < b1)) {
+			auto vram_ = vram.getWriteBackdoor();
+			forEachBank(DY * pitch + b0, b1 - b0, [&](unsigned bank, unsigned first, unsigned n) {
+				auto src  = narrow_cast<uint8_t>(bank ? (fgCol >> 8) : (fgCol & 0xFF));
+				auto mask = narrow_cast<uint8_t>(bank ? (WM    >> 8) : (WM    & 0xFF));
+				if (LOG & 0x10) mask &= opaqueMask<Mode::BITS_PER_PIXEL>(src);
+				fillBytes(vram_.subspan(V9990VRAM::transformBx(first), n), LOG, src, mask);
+			});
+			for (auto px : xrange(x, b0 * PPB)) {
+				Mode::psetColor(vram, px, DY, pitch, fgCol, WM, lut, LOG);
+			}
+			for (auto px : xrange(b1 * PPB, x + num)) {
+				Mode::psetColor(vram, px, DY, pitch, fgCol, WM, lut, LOG);
+			}
+			return;
+		}
+	}
+	for (auto i : xrange(num)) {
+		Mode::psetColor(vram, uint16_t(DX + i * dx), DY, pitch, fgCol, WM, lut, LOG);
+	}
+}
+
+template<typename Mode>
+void V9990CmdEngine::copyRow(unsigned num, unsigned pitch, std::span<const uint8_t, 256 * 256> lut)
+{
+	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
+
+	// When source and destination are in different rows (they're either
+	// the same or disjoint) and neither wraps, the order of the pixels
+	// doesn't matter.
+	auto srcLeft = (ARG & DIX) ? uint16_t(SX - (num - 1)) : SX;
+	auto dstLeft = (ARG & DIX) ? uint16_t(DX - (num - 1)) : DX;
+	if constexpr (Mode::BITS_PER_PIXEL == 16) {
+		unsigned sx = srcLeft & (pitch - 1);
+		unsigned x  = dstLeft & (pitch - 1);
+		if (((sx + num) <= pitch) && ((x + num) <= pitch) &&
+		    (((SY * pitch) ^ (DY * pitch)) & 0x3FFFF)) {
+			copyPixels16(vram.getWriteBackdoor(), Mode::addressOf(sx, SY, pitch),
+			             Mode::addressOf(x, DY, pitch), num, LOG, WM);
+			return;
+		}
+	} else if constexpr (!std::is_same_v<Mode, V9990P1> && !std::is_same_v<Mode, V9990P2>) {
+		constexpr unsigned PPB = Mode::PIXELS_PER_BYTE;
+		unsigned width = pitch * PPB;
+		unsigned sx = srcLeft & (width - 1);
+		unsigned x  = dstLeft & (width - 1);
+		unsigned b0 = (x + PPB - 1) / PPB;
+		unsigned b1 = (x + num) / PPB;
+		if (((sx + num) <= width) && ((x + num) <= width) &&
+		    (((SY * pitch) ^ (DY * pitch)) & 0x7FFFF) &&
+		    (((sx ^ x) & (PPB - 1)) == 0) && // no shift needed
+		    (b0 < b1)) {
+			auto vram_ = vram.getWriteBackdoor();
+			unsigned srcOffset = (SY * pitch + sx / PPB) - (DY * pitch + x / PPB);
+			forEachBank(DY * pitch + b0, b1 - b0, [&](unsigned bank, unsigned first, unsigned n) {
+				auto mask = narrow_cast<uint8_t>(bank ? (WM >> 8) : (WM & 0xFF));
+				copyBytes<Mode::BITS_PER_PIXEL>(
+					vram_.subspan(V9990VRAM::transformBx(first + srcOffset), n),
+					vram_.subspan(V9990VRAM::transformBx(first), n),
+					LOG, mask);
+			});
+			auto copyPixel = [&](unsigned px) {
+				auto src = Mode::point(vram, px - x + sx, SY, pitch);
+				Mode::pset(vram, px, DY, pitch, src, WM, lut, LOG);
+			};
+			for (auto px : xrange(x, b0 * PPB)) copyPixel(px);
+			for (auto px : xrange(b1 * PPB, x + num)) copyPixel(px);
+			return;
+		}
+	}
+	for (auto i : xrange(num)) {
+		auto sx = uint16_t(SX + i * dx);
+		auto x  = uint16_t(DX + i * dx);
+		auto src = Mode::point(vram, sx, SY, pitch);
+		src = Mode::shift(src, sx, x);
+		Mode::pset(vram, x, DY, pitch, src, WM, lut, LOG);
+	}
+}
+
 // STOP
 void V9990CmdEngine::startSTOP(EmuTime time)
 {
@@ -1046,19 +1344,22 @@ void V9990CmdEngine::startLMMV(EmuTime time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMV(EmuTime limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(*this, LMMV_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
 	auto lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
-
-		DX += dx;
-		if (!--ANX) {
+	// Process all pixels until 'limit' at once, a row at a time.
+	unsigned num = pixelsUntil(limit, delta);
+	engineTime += delta * num;
+	while (num) {
+		unsigned n = std::min<unsigned>(num, ANX);
+		fillRow<Mode>(n, pitch, lut);
+		num -= n;
+
+		DX += uint16_t(n * dx);
+		ANX = uint16_t(ANX - n);
+		if (!ANX) {
 			DX -= uint16_t(NX * dx);
 			DY += dy;
 			if (!--ANY) {
@@ -1139,22 +1440,23 @@ void V9990CmdEngine::startLMMM(EmuTime time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMM(EmuTime limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(*this, LMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
 	auto lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		auto src = Mode::point(vram, SX, SY, pitch);
-		src = Mode::shift(src, SX, DX);
-		Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
-
-		DX += dx;
-		SX += dx;
-		if (!--ANX) {
+	// Process all pixels until 'limit' at once, a row at a time.
+	unsigned num = pixelsUntil(limit, delta);
+	engineTime += delta * num;
+	while (num) {
+		unsigned n = std::min<unsigned>(num, ANX);
+		copyRow<Mode>(n, pitch, lut);
+		num -= n;
+
+		DX += uint16_t(n * dx);
+		SX += uint16_t(n * dx);
+		ANX = uint16_t(ANX - n);
+		if (!ANX) {
 			DX -= uint16_t(NX * dx);
 			SX -= uint16_t(NX * dx);
 			DY += dy;
@@ -1235,15 +1537,14 @@ void V9990CmdEngine::startCMMM(EmuTime time)
 template<typename Mode>
 void V9990CmdEngine::executeCMMM(EmuTime limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(*this, CMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
 	auto lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
+	unsigned num = pixelsUntil(limit, delta);
+	engineTime += delta * num;
+	for (/**/; num; --num) {
 		if (!bitsLeft) {
 			data = vram.readVRAMBx(srcAddress++);
 			bitsLeft = 8;
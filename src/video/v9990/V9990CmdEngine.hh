@@ -7,6 +7,7 @@
 #include "Observer.hh"
 
 #include <cstdint>
+#include <span>
 
 namespace openmsx {
 
@@ -259,6 +260,18 @@ private:
 	                        void executePSET (EmuTime limit);
 	                        void executeADVN (EmuTime limit);
 
+	/** The number of pixels a block command (LMMV, LMMM, CMMM) processes
+	  * until 'limit', when each pixel takes 'delta'.
+	  */
+	[[nodiscard]] unsigned pixelsUntil(EmuTime limit, EmuDuration delta) const;
+
+	/** Process 'num' pixels of the current row for LMMV resp. LMMM at
+	  * once, starting at the current position. This doesn't update the
+	  * coordinates.
+	  */
+	template<typename Mode> void fillRow(unsigned num, unsigned pitch, std::span<const uint8_t, 256 * 256> lut);
+	template<typename Mode> void copyRow(unsigned num, unsigned pitch, std::span<const uint8_t, 256 * 256> lut);
+
 	RenderSettings& settings;
 
 	/** Only call reportV9990Command() when this setting is turned on
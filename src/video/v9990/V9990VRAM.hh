@@ -7,6 +7,7 @@
 #include "TrackedRam.hh"
 
 #include <cstdint>
+#include <span>
 
 namespace openmsx {
 
@@ -79,6 +80,12 @@ public:
 	void writeVRAMDirect(unsigned address, uint8_t value) {
 		data.write(address, value);
 	}
+	/** For bulk operations of the command engine, the same addressing as
+	  * readVRAMDirect(). See TrackedRam::getWriteBackdoor().
+	  */
+	[[nodiscard]] std::span<uint8_t> getWriteBackdoor() {
+		return data.getWriteBackdoor();
+	}
 
 	[[nodiscard]] uint8_t readVRAMCPU(unsigned address, EmuTime time);
 	void writeVRAMCPU(unsigned address, uint8_t val, EmuTime time);